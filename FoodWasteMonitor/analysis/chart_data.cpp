@@ -0,0 +1,126 @@
+/**
+ * Chart Data Layer Implementation
+ */
+
+#include "chart_data.h"
+#include "../utils/content_hash.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Analysis {
+
+std::vector<ChartPoint> downsampleLTTB(const std::vector<float>& values, int threshold) {
+    std::vector<ChartPoint> sampled;
+    int numValues = static_cast<int>(values.size());
+
+    // Nothing to reduce - return the series as-is
+    if (threshold >= numValues || threshold < 3) {
+        sampled.reserve(values.size());
+        for (int i = 0; i < numValues; i++) {
+            sampled.emplace_back(static_cast<float>(i), values[i]);
+        }
+        return sampled;
+    }
+
+    sampled.reserve(threshold);
+
+    // Bucket size, leaving room for the fixed first and last points
+    double bucketSize = static_cast<double>(numValues - 2) / (threshold - 2);
+
+    int selected = 0;
+    sampled.emplace_back(0.0f, values[0]);
+
+    for (int bucket = 0; bucket < threshold - 2; bucket++) {
+        // Average of the next bucket acts as the third triangle vertex
+        int nextStart = static_cast<int>(std::floor((bucket + 1) * bucketSize)) + 1;
+        int nextEnd = std::min(static_cast<int>(std::floor((bucket + 2) * bucketSize)) + 1, numValues);
+
+        double avgX = 0.0;
+        double avgY = 0.0;
+        int nextCount = nextEnd - nextStart;
+        for (int i = nextStart; i < nextEnd; i++) {
+            avgX += i;
+            avgY += values[i];
+        }
+        if (nextCount > 0) {
+            avgX /= nextCount;
+            avgY /= nextCount;
+        } else {
+            avgX = numValues - 1;
+            avgY = values[numValues - 1];
+        }
+
+        // Pick the point in the current bucket with the largest triangle area
+        int rangeStart = static_cast<int>(std::floor(bucket * bucketSize)) + 1;
+        int rangeEnd = static_cast<int>(std::floor((bucket + 1) * bucketSize)) + 1;
+
+        double pointAX = selected;
+        double pointAY = values[selected];
+        double maxArea = -1.0;
+        int maxIndex = rangeStart;
+
+        for (int i = rangeStart; i < rangeEnd; i++) {
+            double area = std::abs((pointAX - avgX) * (values[i] - pointAY) -
+                                   (pointAX - i) * (avgY - pointAY));
+            if (area > maxArea) {
+                maxArea = area;
+                maxIndex = i;
+            }
+        }
+
+        sampled.emplace_back(static_cast<float>(maxIndex), values[maxIndex]);
+        selected = maxIndex;
+    }
+
+    sampled.emplace_back(static_cast<float>(numValues - 1), values[numValues - 1]);
+
+    return sampled;
+}
+
+std::vector<ChartPoint> ChartDataCache::getSeries(const std::string& seriesName,
+                                                  const std::vector<float>& values,
+                                                  int width) {
+    uint64_t signature = computeSignature(values);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto key = std::make_pair(seriesName, width);
+    auto it = m_cache.find(key);
+    if (it != m_cache.end() &&
+        it->second.signature == signature &&
+        it->second.sourceSize == values.size()) {
+        return it->second.points;
+    }
+
+    // Recompute and store for subsequent frames
+    CachedSeries& cached = m_cache[key];
+    cached.signature = signature;
+    cached.sourceSize = values.size();
+    cached.points = downsampleLTTB(values, std::max(3, width));
+
+    return cached.points;
+}
+
+void ChartDataCache::invalidate(const std::string& seriesName) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (seriesName.empty()) {
+        m_cache.clear();
+        return;
+    }
+
+    for (auto it = m_cache.begin(); it != m_cache.end();) {
+        if (it->first.first == seriesName) {
+            it = m_cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+uint64_t ChartDataCache::computeSignature(const std::vector<float>& values) {
+    // Hash of the raw float bits
+    return Utils::fnv1a64(values.data(), values.size() * sizeof(float));
+}
+
+} // namespace Analysis
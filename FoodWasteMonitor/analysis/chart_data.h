@@ -0,0 +1,66 @@
+/**
+ * Chart Data Layer Header
+ *
+ * Downsamples long data series to the pixel width of a chart so that
+ * rendering cost depends on the chart size rather than the series length
+ */
+
+#ifndef CHART_DATA_H
+#define CHART_DATA_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <cstdint>
+
+namespace Analysis {
+
+// A single point of a downsampled series
+struct ChartPoint {
+    float index;    // Position in the source series
+    float value;    // Value at that position
+
+    ChartPoint() : index(0.0f), value(0.0f) {}
+    ChartPoint(float i, float v) : index(i), value(v) {}
+};
+
+// Largest-Triangle-Three-Buckets downsampling.
+// Keeps the first and last points and, for every bucket in between, the
+// point that forms the largest triangle with its neighbours, which preserves
+// peaks and dips that plain decimation would drop.
+std::vector<ChartPoint> downsampleLTTB(const std::vector<float>& values, int threshold);
+
+class ChartDataCache {
+public:
+    ChartDataCache() = default;
+
+    // Get a series downsampled to at most one point per pixel column.
+    // Results are cached per series name and width and are reused for as
+    // long as the source values do not change.
+    std::vector<ChartPoint> getSeries(const std::string& seriesName,
+                                      const std::vector<float>& values,
+                                      int width);
+
+    // Drop cached results for one series, or all series if name is empty
+    void invalidate(const std::string& seriesName = "");
+
+private:
+    struct CachedSeries {
+        uint64_t signature;
+        size_t sourceSize;
+        std::vector<ChartPoint> points;
+
+        CachedSeries() : signature(0), sourceSize(0) {}
+    };
+
+    // Cheap content signature used to detect changed source data
+    static uint64_t computeSignature(const std::vector<float>& values);
+
+    std::map<std::pair<std::string, int>, CachedSeries> m_cache;
+    std::mutex m_mutex;
+};
+
+} // namespace Analysis
+
+#endif // CHART_DATA_H
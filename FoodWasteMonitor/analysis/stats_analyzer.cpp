@@ -3,6 +3,10 @@
  */
 
 #include "stats_analyzer.h"
+#include "../utils/trace.h"
+#include "../utils/metrics.h"
+#include "../utils/task_scheduler.h"
+#include "../utils/logger.h"
 #include <algorithm>
 #include <numeric>
 #include <cmath>
@@ -14,31 +18,85 @@ namespace Analysis {
 
 StatsAnalyzer::StatsAnalyzer(std::shared_ptr<Data::WasteDatabase> database)
     : m_database(database),
-      m_insightsDirty(true) {
+      m_insightsDirty(true),
+      m_updateScheduled(false),
+      m_updateRequested(false) {
 
     // Initialize with current stats
     updateStats();
 }
 
+StatsAnalyzer::~StatsAnalyzer() {
+    // A running update task still uses this object
+    std::unique_lock<std::mutex> lock(m_updateMutex);
+    m_updateCondition.wait(lock, [this]() { return !m_updateScheduled; });
+}
+
 void StatsAnalyzer::updateStats() {
-    // Get latest statistics from the database
-    m_currentStats = m_database->getStatistics();
+    Utils::TraceSpan trace("StatsAnalyzer::updateStats");
 
-    // Mark insights as dirty (need to be recalculated)
-    m_insightsDirty = true;
+    // Get latest statistics from the database
+    Data::WasteStatistics stats = m_database->getStatistics();
 
     // Update trends
-    m_dailyTrend = analyzeDailyTrend();
+    TrendData dailyTrend = analyzeDailyTrend();
 
     // Update prediction model
-    if (!m_dailyTrend.values.empty()) {
-        std::vector<float> xValues(m_dailyTrend.values.size());
+    PredictionModel model;
+    if (!dailyTrend.values.empty()) {
+        std::vector<float> xValues(dailyTrend.values.size());
         std::iota(xValues.begin(), xValues.end(), 0);
 
-        performLinearRegression(xValues, m_dailyTrend.values,
-                               m_wastePredictionModel.intercept,
-                               m_wastePredictionModel.slope,
-                               m_wastePredictionModel.rSquared);
+        performLinearRegression(xValues, dailyTrend.values, model.intercept, model.slope, model.rSquared);
+    }
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_currentStats = std::move(stats);
+    if (!dailyTrend.values.empty()) {
+        m_wastePredictionModel = model;
+    }
+    m_dailyTrend = std::move(dailyTrend);
+
+    // Mark insights as dirty (need to be recalculated)
+    m_insightsDirty = true;
+}
+
+void StatsAnalyzer::requestUpdate() {
+    std::lock_guard<std::mutex> lock(m_updateMutex);
+    if (m_updateScheduled) {
+        m_updateRequested = true;
+        return;
+    }
+
+    m_updateScheduled = true;
+    Utils::TaskScheduler::instance().submit(Utils::TaskClass::ANALYTICS, [this]() { runRequestedUpdates(); });
+}
+
+void StatsAnalyzer::runRequestedUpdates() {
+    static auto& refreshTime = Utils::MetricsRegistry::instance().histogram(
+        "stats_refresh_seconds", "Refreshing waste statistics");
+
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(m_updateMutex);
+            m_updateRequested = false;
+        }
+
+        try {
+            Utils::ScopedTimer timer(refreshTime);
+            updateStats();
+        }
+        catch (const std::exception& e) {
+            Utils::logError("analytics", "Error updating statistics: %s", e.what());
+        }
+
+        // Detections that arrived during the update need another pass
+        std::lock_guard<std::mutex> lock(m_updateMutex);
+        if (!m_updateRequested) {
+            m_updateScheduled = false;
+            m_updateCondition.notify_all();
+            return;
+        }
     }
 }
 
@@ -113,6 +171,7 @@ TrendData StatsAnalyzer::analyzeFoodTypeTrend(const std::string& foodType, int d
     trend.increasing = trend.changePercentage > 0;
 
     // Cache the result
+    std::lock_guard<std::mutex> lock(m_statsMutex);
     m_foodTypeTrends[foodType] = trend;
 
     return trend;
@@ -159,6 +218,7 @@ TrendData StatsAnalyzer::analyzeMealPeriodTrend(const std::string& mealPeriod, i
     trend.increasing = trend.changePercentage > 0;
 
     // Cache the result
+    std::lock_guard<std::mutex> lock(m_statsMutex);
     m_mealPeriodTrends[mealPeriod] = trend;
 
     return trend;
@@ -267,11 +327,18 @@ float StatsAnalyzer::predictFutureWaste(int daysInFuture) {
     }
 
     // Use the cached prediction model
-    if (std::abs(m_wastePredictionModel.rSquared) < 0.1f) {
+    bool poorFit;
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        poorFit = std::abs(m_wastePredictionModel.rSquared) < 0.1f;
+    }
+    if (poorFit) {
         // If model has poor fit, update it
         updateStats();
     }
 
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+
     // Calculate predicted value using linear model
     // y = intercept + slope * x
     // where x is the day in the future (current day + daysInFuture)
@@ -339,82 +406,91 @@ std::vector<WasteRecommendation> StatsAnalyzer::generateRecommendations(int limi
 }
 
 std::vector<std::string> StatsAnalyzer::getInsights() {
-    // Regenerate insights if needed
-    if (m_insightsDirty || m_insights.empty()) {
-        m_insights.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        if (!m_insightsDirty && !m_insights.empty()) {
+            return m_insights;
+        }
+    }
 
-        // Get current statistics
-        auto stats = m_currentStats;
+    // Taken before the lock, since a poor fit refreshes the stats
+    float nextWeekPrediction = predictFutureWaste(7);
 
-        // Add basic insights about total waste
-        std::stringstream ss;
-        ss << "Total food waste recorded: " << std::fixed << std::setprecision(1)
-           << stats.totalWeight << "g across " << stats.totalItems << " items.";
-        m_insights.push_back(ss.str());
+    // Regenerate insights
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    m_insights.clear();
 
-        // Add insights about top wasted foods
-        if (!stats.topWastedFoods.empty()) {
-            ss.str("");
-            ss << "The most wasted food is " << stats.topWastedFoods[0] << " at "
-               << std::fixed << std::setprecision(1) << stats.weightByType[stats.topWastedFoods[0]] << "g.";
-            m_insights.push_back(ss.str());
-        }
+    // Get current statistics
+    auto stats = m_currentStats;
 
-        // Add trend insight
-        if (!m_dailyTrend.values.empty() && m_dailyTrend.values.size() > 1) {
-            ss.str("");
-            ss << "Waste is " << (m_dailyTrend.increasing ? "increasing" : "decreasing")
-               << " by " << std::abs(m_dailyTrend.changePercentage) << "% over the last "
-               << m_dailyTrend.values.size() << " days.";
-            m_insights.push_back(ss.str());
-        }
+    // Add basic insights about total waste
+    std::stringstream ss;
+    ss << "Total food waste recorded: " << std::fixed << std::setprecision(1)
+       << stats.totalWeight << "g across " << stats.totalItems << " items.";
+    m_insights.push_back(ss.str());
 
-        // Add meal period insight
-        if (!stats.weightByMeal.empty()) {
-            // Find meal with highest waste
-            auto maxMeal = std::max_element(stats.weightByMeal.begin(), stats.weightByMeal.end(),
-                                          [](const auto& a, const auto& b) { return a.second < b.second; });
+    // Add insights about top wasted foods
+    if (!stats.topWastedFoods.empty()) {
+        ss.str("");
+        ss << "The most wasted food is " << stats.topWastedFoods[0] << " at "
+           << std::fixed << std::setprecision(1) << stats.weightByType[stats.topWastedFoods[0]] << "g.";
+        m_insights.push_back(ss.str());
+    }
 
-            ss.str("");
-            ss << "The meal period with highest waste is " << maxMeal->first << " at "
-               << std::fixed << std::setprecision(1) << maxMeal->second << "g.";
-            m_insights.push_back(ss.str());
-        }
+    // Add trend insight
+    if (!m_dailyTrend.values.empty() && m_dailyTrend.values.size() > 1) {
+        ss.str("");
+        ss << "Waste is " << (m_dailyTrend.increasing ? "increasing" : "decreasing")
+           << " by " << std::abs(m_dailyTrend.changePercentage) << "% over the last "
+           << m_dailyTrend.values.size() << " days.";
+        m_insights.push_back(ss.str());
+    }
 
-        // Add day of week insight
-        if (!stats.weightByDay.empty()) {
-            // Find day with highest waste
-            auto maxDay = std::max_element(stats.weightByDay.begin(), stats.weightByDay.end(),
-                                         [](const auto& a, const auto& b) { return a.second < b.second; });
+    // Add meal period insight
+    if (!stats.weightByMeal.empty()) {
+        // Find meal with highest waste
+        auto maxMeal = std::max_element(stats.weightByMeal.begin(), stats.weightByMeal.end(),
+                                      [](const auto& a, const auto& b) { return a.second < b.second; });
 
-            ss.str("");
-            ss << "The day with highest waste is " << maxDay->first << " at "
-               << std::fixed << std::setprecision(1) << maxDay->second << "g.";
-            m_insights.push_back(ss.str());
-        }
+        ss.str("");
+        ss << "The meal period with highest waste is " << maxMeal->first << " at "
+           << std::fixed << std::setprecision(1) << maxMeal->second << "g.";
+        m_insights.push_back(ss.str());
+    }
 
-        // Add waste reduction insight
-        if (stats.wasteSavedTotal > 0) {
-            ss.str("");
-            ss << "Waste has been reduced by " << std::fixed << std::setprecision(1)
-               << stats.wasteSavedTotal << "g (" << stats.wasteSavedPercentage << "%) compared to the previous period.";
-            m_insights.push_back(ss.str());
-        }
+    // Add day of week insight
+    if (!stats.weightByDay.empty()) {
+        // Find day with highest waste
+        auto maxDay = std::max_element(stats.weightByDay.begin(), stats.weightByDay.end(),
+                                     [](const auto& a, const auto& b) { return a.second < b.second; });
 
-        // Add prediction insight
-        float nextWeekPrediction = predictFutureWaste(7);
         ss.str("");
-        ss << "Predicted waste for next week: " << std::fixed << std::setprecision(1) << nextWeekPrediction << "g.";
+        ss << "The day with highest waste is " << maxDay->first << " at "
+           << std::fixed << std::setprecision(1) << maxDay->second << "g.";
         m_insights.push_back(ss.str());
+    }
 
-        m_insightsDirty = false;
+    // Add waste reduction insight
+    if (stats.wasteSavedTotal > 0) {
+        ss.str("");
+        ss << "Waste has been reduced by " << std::fixed << std::setprecision(1)
+           << stats.wasteSavedTotal << "g (" << stats.wasteSavedPercentage << "%) compared to the previous period.";
+        m_insights.push_back(ss.str());
     }
 
+    // Add prediction insight
+    ss.str("");
+    ss << "Predicted waste for next week: " << std::fixed << std::setprecision(1) << nextWeekPrediction << "g.";
+    m_insights.push_back(ss.str());
+
+    m_insightsDirty = false;
+
     return m_insights;
 }
 
 float StatsAnalyzer::calculateWasteCost(float pricePerKg) {
     // Convert grams to kg and multiply by price
+    std::lock_guard<std::mutex> lock(m_statsMutex);
     return (m_currentStats.totalWeight / 1000.0f) * pricePerKg;
 }
 
@@ -431,11 +507,13 @@ float StatsAnalyzer::calculatePotentialSavings(int days, float pricePerKg) {
 
 float StatsAnalyzer::calculateCO2Impact(float kgCO2PerKgFood) {
     // Convert grams to kg and multiply by CO2 impact factor
+    std::lock_guard<std::mutex> lock(m_statsMutex);
     return (m_currentStats.totalWeight / 1000.0f) * kgCO2PerKgFood;
 }
 
 float StatsAnalyzer::calculateWaterImpact(float litersPerKgFood) {
     // Convert grams to kg and multiply by water impact factor
+    std::lock_guard<std::mutex> lock(m_statsMutex);
     return (m_currentStats.totalWeight / 1000.0f) * litersPerKgFood;
 }
 
@@ -484,7 +562,11 @@ std::vector<std::string> StatsAnalyzer::findCorrelations() {
     auto dayPattern = calculateDayOfWeekPattern();
 
     // Get meal period pattern
-    auto mealPattern = m_currentStats.weightByMeal;
+    std::map<std::string, float> mealPattern;
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        mealPattern = m_currentStats.weightByMeal;
+    }
 
     // Find days with significantly higher waste
     auto dayOutliers = identifyOutliers(dayPattern);
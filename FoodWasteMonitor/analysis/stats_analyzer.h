@@ -11,6 +11,8 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <condition_variable>
 #include "../data/waste_database.h"
 
 namespace Analysis {
@@ -47,10 +49,15 @@ struct WasteRecommendation {
 class StatsAnalyzer {
 public:
     explicit StatsAnalyzer(std::shared_ptr<Data::WasteDatabase> database);
+    ~StatsAnalyzer();
 
     // Core analysis functions
     void updateStats();
 
+    // Run updateStats() as an analytics task on the shared scheduler.
+    // Requests made while one is pending are merged into it.
+    void requestUpdate();
+
     // Trend analysis
     TrendData analyzeDailyTrend(int days = 30);
     TrendData analyzeFoodTypeTrend(const std::string& foodType, int days = 30);
@@ -89,6 +96,9 @@ private:
     std::map<std::string, float> calculateDayOfWeekPattern();
     std::map<std::string, float> calculateMonthlyPattern();
 
+    // Body of the task started by requestUpdate()
+    void runRequestedUpdates();
+
     // Database reference
     std::shared_ptr<Data::WasteDatabase> m_database;
 
@@ -106,6 +116,17 @@ private:
     // Insights cache
     std::vector<std::string> m_insights;
     bool m_insightsDirty;
+
+    // Guards the cached results above; updates run on a scheduler worker
+    // while the UI reads them
+    mutable std::mutex m_statsMutex;
+
+    // An update task is queued or running, and whether another was asked
+    // for since it last read the database
+    std::mutex m_updateMutex;
+    std::condition_variable m_updateCondition;
+    bool m_updateScheduled;
+    bool m_updateRequested;
 };
 
 } // namespace Analysis
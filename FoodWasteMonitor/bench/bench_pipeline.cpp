@@ -0,0 +1,459 @@
+/**
+ * Pipeline Benchmark
+ *
+ * Replays recorded footage (a video file or a directory of images) through
+ * the detector, database and analyzer as fast as possible, without the UI,
+ * and reports throughput, per-stage latency and resource use as JSON.
+ * Given a baseline report it fails when a metric regresses too far.
+ *
+ *   bench_pipeline --input clips/lunch.mp4 --output bench.json
+ *   bench_pipeline --input clips/lunch.mp4 --baseline bench.json --max-regression 5
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+#include <filesystem>
+#include <opencv2/opencv.hpp>
+#include <nlohmann/json.hpp>
+
+#ifdef __unix__
+#include <sys/resource.h>
+#endif
+
+#include "detection/food_detector.h"
+#include "data/waste_database.h"
+#include "analysis/stats_analyzer.h"
+#include "training/model_registry.h"
+#include "utils/config_loader.h"
+#include "utils/metrics.h"
+#include "utils/logger.h"
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Heap allocations through operator new, counted to report allocations per frame.
+// OpenCV image buffers use their own allocator and are not included.
+std::atomic<uint64_t> g_allocations(0);
+
+void* countedAllocate(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (void* memory = countedAllocate(size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    std::free(memory);
+}
+
+namespace {
+
+// Exit codes
+const int EXIT_OK = 0;
+const int EXIT_REGRESSION = 1;
+const int EXIT_ERROR = 2;
+
+struct BenchOptions {
+    std::string configPath;
+    std::string inputPath;
+    std::string modelPath;          // Empty = the live registry version or the configured model
+    std::string outputPath;         // Empty = stdout
+    std::string baselinePath;       // Compare against this report when set
+    int maxFrames;                  // Measured frames (0 = the whole input)
+    int warmupFrames;
+    int loops;                      // Times the input is replayed
+    double maxRegressionPercent;
+
+    BenchOptions()
+        : configPath("config.json"),
+          maxFrames(0),
+          warmupFrames(10),
+          loops(1),
+          maxRegressionPercent(10.0) {
+    }
+};
+
+// Frames from a video file or from the images in a directory, in name order
+class FrameSource {
+public:
+    bool open(const std::string& path) {
+        m_path = path;
+        m_imagePaths.clear();
+        m_nextImage = 0;
+
+        if (fs::is_directory(path)) {
+            for (const auto& entry : fs::directory_iterator(path)) {
+                std::string extension = entry.path().extension().string();
+                std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+                if (extension == ".jpg" || extension == ".jpeg" || extension == ".png" || extension == ".bmp") {
+                    m_imagePaths.push_back(entry.path().string());
+                }
+            }
+            std::sort(m_imagePaths.begin(), m_imagePaths.end());
+            return !m_imagePaths.empty();
+        }
+
+        return m_video.open(path);
+    }
+
+    bool rewind() {
+        if (!m_imagePaths.empty()) {
+            m_nextImage = 0;
+            return true;
+        }
+        m_video.release();
+        return m_video.open(m_path);
+    }
+
+    bool next(cv::Mat& frame) {
+        if (m_imagePaths.empty()) {
+            return m_video.read(frame) && !frame.empty();
+        }
+
+        while (m_nextImage < m_imagePaths.size()) {
+            frame = cv::imread(m_imagePaths[m_nextImage++]);
+            if (!frame.empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::string m_path;
+    cv::VideoCapture m_video;
+    std::vector<std::string> m_imagePaths;
+    size_t m_nextImage = 0;
+};
+
+// CPU time consumed by the process so far, in seconds
+double processCpuSeconds() {
+#ifdef __unix__
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+#else
+    return 0.0;
+#endif
+}
+
+double peakRssMegabytes() {
+#ifdef __unix__
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;  // Kilobytes on Linux
+#else
+    return 0.0;
+#endif
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " --input <video|image dir> [options]\n"
+              << "  --config <path>          Application config (default config.json)\n"
+              << "  --model <path>           Model to benchmark instead of the live version\n"
+              << "  --frames <n>             Measured frames, 0 for the whole input (default 0)\n"
+              << "  --warmup <n>             Frames run before measuring (default 10)\n"
+              << "  --loops <n>              Times to replay the input (default 1)\n"
+              << "  --output <path>          Write the JSON report here instead of stdout\n"
+              << "  --baseline <path>        Compare against a saved report\n"
+              << "  --max-regression <pct>   Allowed regression per metric (default 10)\n";
+}
+
+bool parseArguments(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << argument << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+
+        try {
+            if (argument == "--input") options.inputPath = value;
+            else if (argument == "--config") options.configPath = value;
+            else if (argument == "--model") options.modelPath = value;
+            else if (argument == "--frames") options.maxFrames = std::stoi(value);
+            else if (argument == "--warmup") options.warmupFrames = std::stoi(value);
+            else if (argument == "--loops") options.loops = std::max(1, std::stoi(value));
+            else if (argument == "--output") options.outputPath = value;
+            else if (argument == "--baseline") options.baselinePath = value;
+            else if (argument == "--max-regression") options.maxRegressionPercent = std::stod(value);
+            else {
+                std::cerr << "Unknown option: " << argument << std::endl;
+                return false;
+            }
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid value for " << argument << ": " << value << std::endl;
+            return false;
+        }
+    }
+
+    return !options.inputPath.empty();
+}
+
+std::string resolveModelPath(const BenchOptions& options, const Utils::ConfigLoader& config) {
+    if (!options.modelPath.empty()) {
+        return options.modelPath;
+    }
+
+    Training::ModelRegistry registry(config.getModelRegistryPath());
+    Training::ModelVersion liveVersion;
+    if (registry.getVersion(registry.getCurrentVersion(), liveVersion)) {
+        return liveVersion.modelPath;
+    }
+    return config.getModelPath();
+}
+
+// Percentage by which current is worse than baseline; negative when better
+double regressionPercent(double baseline, double current, bool higherIsBetter) {
+    if (baseline <= 0.0) {
+        return 0.0;
+    }
+    double change = (current - baseline) / baseline * 100.0;
+    return higherIsBetter ? -change : change;
+}
+
+// Print each compared metric and return the number that regressed too far
+int compareWithBaseline(const json& baseline, const json& report, double maxRegressionPercent) {
+    int regressions = 0;
+
+    auto check = [&](const std::string& name, double base, double current, bool higherIsBetter) {
+        double regression = regressionPercent(base, current, higherIsBetter);
+        bool failed = regression > maxRegressionPercent;
+        if (failed) {
+            regressions++;
+        }
+
+        std::cerr << (failed ? "REGRESSED " : "ok        ") << name << ": "
+                  << base << " -> " << current << " (" << (regression > 0 ? "+" : "")
+                  << regression << "% worse)" << std::endl;
+    };
+
+    check("fps", baseline.value("fps", 0.0), report.value("fps", 0.0), true);
+    check("cpu_percent", baseline.value("cpu_percent", 0.0), report.value("cpu_percent", 0.0), false);
+    check("peak_rss_mb", baseline.value("peak_rss_mb", 0.0), report.value("peak_rss_mb", 0.0), false);
+    check("allocations_per_frame", baseline.value("allocations_per_frame", 0.0),
+          report.value("allocations_per_frame", 0.0), false);
+
+    // p999 is reported but too noisy on short runs to gate on
+    if (baseline.contains("stages")) {
+        for (const auto& [stage, stats] : report["stages"].items()) {
+            if (!baseline["stages"].contains(stage)) {
+                continue;
+            }
+            const json& baseStats = baseline["stages"][stage];
+            check(stage + ".p50_ms", baseStats.value("p50_ms", 0.0), stats.value("p50_ms", 0.0), false);
+            check(stage + ".p99_ms", baseStats.value("p99_ms", 0.0), stats.value("p99_ms", 0.0), false);
+        }
+    }
+
+    return regressions;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage(argv[0]);
+        return EXIT_ERROR;
+    }
+
+    // A report on stdout must be the only thing there. Info lines from the
+    // pipeline go to stdout, so keep just warnings and errors, on stderr.
+    if (options.outputPath.empty()) {
+        Utils::LoggerConfig loggerConfig;
+        loggerConfig.minLevel = Utils::LogLevel::WARNING;
+        Utils::Logger::instance().configure(loggerConfig);
+    }
+
+    try {
+        Utils::ConfigLoader config(options.configPath);
+
+        FrameSource source;
+        if (!source.open(options.inputPath)) {
+            std::cerr << "Failed to open input: " << options.inputPath << std::endl;
+            return EXIT_ERROR;
+        }
+
+        // A scratch database so benchmark detections never reach the real one
+        fs::path scratchDir = fs::temp_directory_path() / "food_waste_bench";
+        fs::remove_all(scratchDir);
+        fs::create_directories(scratchDir);
+
+        auto detector = std::make_shared<Detection::FoodDetector>(
+            resolveModelPath(options, config),
+            config.getClassesPath(),
+            config.getConfidenceThreshold()
+        );
+        detector->setMetricsEnabled(true);
+        auto database = std::make_shared<Data::WasteDatabase>((scratchDir / "waste_database.csv").string());
+        auto analyzer = std::make_shared<Analysis::StatsAnalyzer>(database);
+
+        auto& metrics = Utils::MetricsRegistry::instance();
+        auto& frameTime = metrics.histogram("frame_seconds", "Processing one camera frame end to end");
+        auto& statsRefreshTime = metrics.histogram("stats_refresh_seconds", "Refreshing waste statistics");
+
+        auto processFrame = [&](const cv::Mat& frame) {
+            Utils::ScopedTimer frameTimer(frameTime);
+            auto detections = detector->detectFoodWaste(frame);
+            if (!detections.empty()) {
+                database->addDetections(detections);
+
+                Utils::ScopedTimer statsTimer(statsRefreshTime);
+                analyzer->updateStats();
+            }
+            return detections.size();
+        };
+
+        // Warm up caches, lazy initialisation and the network, then measure from zero
+        cv::Mat frame;
+        for (int i = 0; i < options.warmupFrames && source.next(frame); i++) {
+            processFrame(frame);
+        }
+        source.rewind();
+        metrics.reset();
+
+        int frames = 0;
+        size_t detections = 0;
+        std::chrono::steady_clock::duration pipelineTime(0);
+        double cpuStart = processCpuSeconds();
+        uint64_t allocationsStart = g_allocations.load(std::memory_order_relaxed);
+        auto wallStart = std::chrono::steady_clock::now();
+
+        for (int loop = 0; loop < options.loops; loop++) {
+            if (loop > 0 && !source.rewind()) {
+                break;
+            }
+
+            // Decoding stands in for the camera and is kept out of the pipeline time
+            while ((options.maxFrames <= 0 || frames < options.maxFrames) && source.next(frame)) {
+                auto start = std::chrono::steady_clock::now();
+                detections += processFrame(frame);
+                pipelineTime += std::chrono::steady_clock::now() - start;
+                frames++;
+            }
+        }
+
+        double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        double cpuSeconds = processCpuSeconds() - cpuStart;
+        uint64_t allocations = g_allocations.load(std::memory_order_relaxed) - allocationsStart;
+        double pipelineSeconds = std::chrono::duration<double>(pipelineTime).count();
+
+        if (frames == 0) {
+            std::cerr << "No frames could be read from " << options.inputPath << std::endl;
+            return EXIT_ERROR;
+        }
+
+        json report;
+        report["input"] = options.inputPath;
+        report["frames"] = frames;
+        report["detections"] = detections;
+        report["pipeline_seconds"] = pipelineSeconds;
+        report["fps"] = pipelineSeconds > 0.0 ? frames / pipelineSeconds : 0.0;
+        report["cpu_percent"] = wallSeconds > 0.0 ? cpuSeconds / wallSeconds * 100.0 : 0.0;
+        report["peak_rss_mb"] = peakRssMegabytes();
+        report["allocations_per_frame"] = static_cast<double>(allocations) / frames;
+
+        json stages = json::object();
+        metrics.forEachHistogram([&stages](const std::string& name, const Utils::Histogram& histogram) {
+            if (histogram.count() == 0) {
+                return;
+            }
+            stages[name] = {
+                {"count", histogram.count()},
+                {"p50_ms", histogram.quantileSeconds(0.50) * 1000.0},
+                {"p99_ms", histogram.quantileSeconds(0.99) * 1000.0},
+                {"p999_ms", histogram.quantileSeconds(0.999) * 1000.0},
+                {"max_ms", histogram.maxSeconds() * 1000.0}
+            };
+        });
+        report["stages"] = stages;
+
+        if (options.outputPath.empty()) {
+            std::cout << report.dump(2) << std::endl;
+        } else {
+            std::ofstream output(options.outputPath);
+            if (!output.is_open()) {
+                std::cerr << "Failed to write report to " << options.outputPath << std::endl;
+                return EXIT_ERROR;
+            }
+            output << report.dump(2) << std::endl;
+        }
+
+        if (!options.baselinePath.empty()) {
+            std::ifstream baselineFile(options.baselinePath);
+            if (!baselineFile.is_open()) {
+                std::cerr << "Failed to open baseline: " << options.baselinePath << std::endl;
+                return EXIT_ERROR;
+            }
+
+            json baseline;
+            baselineFile >> baseline;
+
+            int regressions = compareWithBaseline(baseline, report, options.maxRegressionPercent);
+            if (regressions > 0) {
+                std::cerr << regressions << " metric(s) regressed more than "
+                          << options.maxRegressionPercent << "%" << std::endl;
+                return EXIT_REGRESSION;
+            }
+        }
+
+        return EXIT_OK;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_ERROR;
+    }
+}
@@ -0,0 +1,406 @@
+/**
+ * Query Service Benchmark
+ *
+ * Fills a scratch database with synthetic entries, starts the query service
+ * on it and drives it from concurrent clients that pipeline a mix of stats,
+ * trend, top-N, range and ping requests, while a subscriber follows entries
+ * added during the run. Reports queries/sec and per-request latency as JSON.
+ *
+ *   bench_query --entries 200000 --clients 16 --pipeline 8 --output query.json
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "data/waste_database.h"
+#include "data/query_service.h"
+#include "utils/metrics.h"
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Exit codes
+const int EXIT_OK = 0;
+const int EXIT_ERROR = 2;
+
+struct BenchOptions {
+    int entries;                    // Synthetic entries loaded before the run
+    int days;                       // Days the entries are spread over, ending today
+    int clients;
+    int requests;                   // Per client
+    int pipeline;                   // Requests a client sends before reading the answers
+    int feedRate;                   // Entries added per second during the run
+    std::string outputPath;         // Empty = stdout
+
+    BenchOptions()
+        : entries(100000),
+          days(365),
+          clients(8),
+          requests(20000),
+          pipeline(16),
+          feedRate(100) {
+    }
+};
+
+const char* const FOOD_TYPES[] = {
+    "apple", "banana", "bread", "burger", "cake", "carrot", "chicken", "cookie",
+    "fries", "pasta", "pizza", "rice", "salad", "sandwich", "vegetable"
+};
+const char* const MEAL_PERIODS[] = {"Breakfast", "Lunch", "Dinner", "Snack"};
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --entries <n>            Entries in the scratch database (default 100000)\n"
+              << "  --days <n>               Days the entries span (default 365)\n"
+              << "  --clients <n>            Concurrent clients (default 8)\n"
+              << "  --requests <n>           Requests per client (default 20000)\n"
+              << "  --pipeline <n>           Requests in flight per client (default 16)\n"
+              << "  --feed-rate <n>          Entries added per second during the run (default 100)\n"
+              << "  --output <path>          Write the JSON report here instead of stdout\n";
+}
+
+bool parseArguments(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << argument << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+
+        try {
+            if (argument == "--entries") options.entries = std::max(0, std::stoi(value));
+            else if (argument == "--days") options.days = std::max(1, std::stoi(value));
+            else if (argument == "--clients") options.clients = std::max(1, std::stoi(value));
+            else if (argument == "--requests") options.requests = std::max(1, std::stoi(value));
+            else if (argument == "--pipeline") options.pipeline = std::max(1, std::stoi(value));
+            else if (argument == "--feed-rate") options.feedRate = std::max(0, std::stoi(value));
+            else if (argument == "--output") options.outputPath = value;
+            else {
+                std::cerr << "Unknown option: " << argument << std::endl;
+                return false;
+            }
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid value for " << argument << ": " << value << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string formatLocalTime(std::time_t time) {
+    std::tm local = {};
+    localtime_r(&time, &local);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local);
+    return buffer;
+}
+
+Data::WasteEntry makeEntry(std::mt19937& random, std::time_t timestamp) {
+    Data::WasteEntry entry;
+    entry.foodType = FOOD_TYPES[random() % (sizeof(FOOD_TYPES) / sizeof(FOOD_TYPES[0]))];
+    entry.weight = 20.0f + static_cast<float>(random() % 480);
+    entry.timestamp = formatLocalTime(timestamp);
+    entry.confidence = 0.5f + static_cast<float>(random() % 50) / 100.0f;
+    entry.mealPeriod = MEAL_PERIODS[random() % 4];
+    return entry;
+}
+
+// The request mix a dashboard refresh produces, roughly
+std::string makeRequest(std::mt19937& random, int id) {
+    static const char* const PERIODS[] = {"day", "week", "month", "year", "all"};
+    json request;
+    request["id"] = id;
+
+    int kind = static_cast<int>(random() % 10);
+    if (kind < 3) {
+        request["op"] = "stats";
+        request["period"] = PERIODS[random() % 5];
+    } else if (kind < 5) {
+        request["op"] = "top";
+        request["period"] = PERIODS[random() % 5];
+        request["limit"] = 5;
+    } else if (kind < 7) {
+        request["op"] = "trend";
+        request["days"] = 30;
+    } else if (kind < 9) {
+        request["op"] = "range";
+        request["start"] = formatLocalTime(std::time(nullptr) - 3600 * static_cast<int>(1 + random() % 48)).substr(0, 13);
+        request["limit"] = 50;
+    } else {
+        request["op"] = "ping";
+    }
+    return request.dump() + "\n";
+}
+
+int connectTo(const std::string& path) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Reads newline-terminated messages from a blocking socket
+class LineReader {
+public:
+    explicit LineReader(int fd) : m_fd(fd) {}
+
+    bool next(std::string& line) {
+        while (true) {
+            size_t newline = m_buffer.find('\n', m_offset);
+            if (newline != std::string::npos) {
+                line.assign(m_buffer, m_offset, newline - m_offset);
+                m_offset = newline + 1;
+                return true;
+            }
+
+            m_buffer.erase(0, m_offset);
+            m_offset = 0;
+            char chunk[65536];
+            ssize_t received = recv(m_fd, chunk, sizeof(chunk), 0);
+            if (received <= 0) {
+                return false;
+            }
+            m_buffer.append(chunk, static_cast<size_t>(received));
+        }
+    }
+
+private:
+    int m_fd;
+    std::string m_buffer;
+    size_t m_offset = 0;
+};
+
+struct ClientResult {
+    uint64_t responses = 0;
+    uint64_t errors = 0;
+    bool connected = false;
+};
+
+void runClient(const std::string& socketPath, const BenchOptions& options, unsigned seed,
+               Utils::Histogram& latency, ClientResult& result) {
+    int fd = connectTo(socketPath);
+    if (fd < 0) {
+        return;
+    }
+    result.connected = true;
+
+    std::mt19937 random(seed);
+    LineReader reader(fd);
+    std::string batch;
+    std::string line;
+
+    for (int sent = 0; sent < options.requests; ) {
+        int count = std::min(options.pipeline, options.requests - sent);
+        batch.clear();
+        for (int i = 0; i < count; i++) {
+            batch += makeRequest(random, sent + i);
+        }
+
+        // Latency of each request runs from the batch being sent to its answer
+        auto batchStart = std::chrono::steady_clock::now();
+        if (!sendAll(fd, batch)) {
+            break;
+        }
+        for (int i = 0; i < count && reader.next(line); i++) {
+            latency.record(std::chrono::steady_clock::now() - batchStart);
+            result.responses++;
+            if (line.find("\"ok\":true") == std::string::npos) {
+                result.errors++;
+            }
+        }
+        sent += count;
+    }
+
+    close(fd);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage(argv[0]);
+        return EXIT_ERROR;
+    }
+
+    try {
+        // A scratch database and socket so the benchmark never touches the real ones
+        fs::path scratchDir = fs::temp_directory_path() / "food_waste_bench_query";
+        fs::remove_all(scratchDir);
+        fs::create_directories(scratchDir);
+
+        auto database = std::make_shared<Data::WasteDatabase>((scratchDir / "waste_database.csv").string());
+
+        std::mt19937 random(42);
+        std::time_t now = std::time(nullptr);
+        std::time_t span = static_cast<std::time_t>(options.days) * 24 * 3600;
+        std::vector<std::time_t> timestamps;
+        for (int i = 0; i < options.entries; i++) {
+            timestamps.push_back(now - static_cast<std::time_t>(random() % span));
+        }
+        std::sort(timestamps.begin(), timestamps.end());
+        for (std::time_t timestamp : timestamps) {
+            database->addEntry(makeEntry(random, timestamp));
+        }
+
+        Data::QueryServiceConfig serviceConfig;
+        serviceConfig.socketPath = (scratchDir / "query.sock").string();
+        serviceConfig.maxClients = options.clients + 8;
+        Data::QueryService service(database, serviceConfig);
+
+        auto loadStart = std::chrono::steady_clock::now();
+        if (!service.start()) {
+            std::cerr << "Failed to start the query service" << std::endl;
+            return EXIT_ERROR;
+        }
+        double snapshotSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+
+        // The subscriber counts feed events until the last one it expects
+        std::atomic<uint64_t> feedEvents(0);
+        int subscriberFd = connectTo(serviceConfig.socketPath);
+        if (subscriberFd < 0 || !sendAll(subscriberFd, "{\"id\":0,\"op\":\"subscribe\"}\n")) {
+            std::cerr << "Failed to subscribe to the change feed" << std::endl;
+            return EXIT_ERROR;
+        }
+        std::thread subscriber([subscriberFd, &feedEvents]() {
+            LineReader reader(subscriberFd);
+            std::string line;
+            while (reader.next(line)) {
+                if (line.find("\"event\":\"entry\"") != std::string::npos) {
+                    feedEvents.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+
+        Utils::Histogram latency;
+        std::vector<ClientResult> results(options.clients);
+        std::vector<std::thread> clients;
+        std::atomic<bool> clientsDone(false);
+
+        auto wallStart = std::chrono::steady_clock::now();
+        for (int i = 0; i < options.clients; i++) {
+            clients.emplace_back(runClient, serviceConfig.socketPath, std::cref(options),
+                                 static_cast<unsigned>(i + 1), std::ref(latency), std::ref(results[i]));
+        }
+
+        // Live entries while the clients run, as the camera loop would add them
+        uint64_t feedAdded = 0;
+        std::thread feeder([&]() {
+            if (options.feedRate <= 0) {
+                return;
+            }
+            std::mt19937 feedRandom(7);
+            auto interval = std::chrono::microseconds(1000000 / options.feedRate);
+            auto next = std::chrono::steady_clock::now();
+            while (!clientsDone) {
+                database->addEntry(makeEntry(feedRandom, std::time(nullptr)));
+                feedAdded++;
+                next += interval;
+                std::this_thread::sleep_until(next);
+            }
+        });
+
+        for (auto& client : clients) {
+            client.join();
+        }
+        double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+        clientsDone = true;
+        feeder.join();
+
+        // Give the feed a moment to deliver the last entries
+        auto feedDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        while (feedEvents.load() < feedAdded && std::chrono::steady_clock::now() < feedDeadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        shutdown(subscriberFd, SHUT_RDWR);
+        subscriber.join();
+        close(subscriberFd);
+        service.stop();
+
+        uint64_t responses = 0;
+        uint64_t errors = 0;
+        int connected = 0;
+        for (const auto& result : results) {
+            responses += result.responses;
+            errors += result.errors;
+            connected += result.connected ? 1 : 0;
+        }
+        if (connected < options.clients) {
+            std::cerr << options.clients - connected << " client(s) could not connect" << std::endl;
+            return EXIT_ERROR;
+        }
+
+        json report;
+        report["entries"] = options.entries;
+        report["clients"] = options.clients;
+        report["pipeline"] = options.pipeline;
+        report["snapshot_seconds"] = snapshotSeconds;
+        report["requests"] = responses;
+        report["errors"] = errors;
+        report["seconds"] = wallSeconds;
+        report["queries_per_second"] = wallSeconds > 0.0 ? responses / wallSeconds : 0.0;
+        report["latency"] = {
+            {"p50_ms", latency.quantileSeconds(0.50) * 1000.0},
+            {"p99_ms", latency.quantileSeconds(0.99) * 1000.0},
+            {"p999_ms", latency.quantileSeconds(0.999) * 1000.0},
+            {"max_ms", latency.maxSeconds() * 1000.0}
+        };
+        report["feed_entries_added"] = feedAdded;
+        report["feed_events_received"] = feedEvents.load();
+
+        if (options.outputPath.empty()) {
+            std::cout << report.dump(2) << std::endl;
+        } else {
+            std::ofstream output(options.outputPath);
+            if (!output.is_open()) {
+                std::cerr << "Failed to write report to " << options.outputPath << std::endl;
+                return EXIT_ERROR;
+            }
+            output << report.dump(2) << std::endl;
+        }
+
+        return errors == 0 && feedEvents.load() == feedAdded ? EXIT_OK : EXIT_ERROR;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_ERROR;
+    }
+}
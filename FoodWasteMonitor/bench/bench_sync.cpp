@@ -0,0 +1,332 @@
+/**
+ * Campus Sync Benchmark
+ *
+ * Runs a collector and several simulated dining hall sites on localhost.
+ * Each site writes synthetic entries to its own write-ahead log while its
+ * shipper pushes them to the collector; halfway through, the collector is
+ * restarted so every site has to resume from its acknowledged offset. The
+ * collector's store is then checked against what the sites wrote, and
+ * throughput and compression are reported as JSON. Exits non-zero if any
+ * entry was lost or duplicated.
+ *
+ *   bench_sync --sites 8 --entries 50000 --output sync.json
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+
+#include "sync/collector_server.h"
+#include "sync/entry_shipper.h"
+#include "sync/sync_protocol.h"
+#include "utils/append_log.h"
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Exit codes
+const int EXIT_OK = 0;
+const int EXIT_MISMATCH = 1;
+const int EXIT_ERROR = 2;
+
+struct BenchOptions {
+    int sites;
+    int entries;                    // Per site
+    int rate;                       // Entries per second per site (0 = as fast as possible)
+    int batchEntries;
+    bool restartCollector;
+    int timeoutSeconds;             // For the sites to drain after writing
+    std::string outputPath;         // Empty = stdout
+
+    BenchOptions()
+        : sites(4),
+          entries(20000),
+          rate(0),
+          batchEntries(500),
+          restartCollector(true),
+          timeoutSeconds(60) {
+    }
+};
+
+const char* const FOOD_TYPES[] = {
+    "apple", "banana", "bread", "burger", "cake", "carrot", "chicken", "cookie",
+    "fries", "pasta", "pizza", "rice", "salad", "sandwich", "vegetable"
+};
+const char* const MEAL_PERIODS[] = {"Breakfast", "Lunch", "Dinner", "Snack"};
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --sites <n>              Simulated dining halls (default 4)\n"
+              << "  --entries <n>            Entries written per site (default 20000)\n"
+              << "  --rate <n>               Entries per second per site, 0 for unthrottled (default 0)\n"
+              << "  --batch <n>              Entries per shipped batch (default 500)\n"
+              << "  --restart <0|1>          Restart the collector halfway (default 1)\n"
+              << "  --timeout <s>            Time allowed to drain after writing (default 60)\n"
+              << "  --output <path>          Write the JSON report here instead of stdout\n";
+}
+
+bool parseArguments(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << argument << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+
+        try {
+            if (argument == "--sites") options.sites = std::max(1, std::stoi(value));
+            else if (argument == "--entries") options.entries = std::max(1, std::stoi(value));
+            else if (argument == "--rate") options.rate = std::max(0, std::stoi(value));
+            else if (argument == "--batch") options.batchEntries = std::max(1, std::stoi(value));
+            else if (argument == "--restart") options.restartCollector = std::stoi(value) != 0;
+            else if (argument == "--timeout") options.timeoutSeconds = std::max(1, std::stoi(value));
+            else if (argument == "--output") options.outputPath = value;
+            else {
+                std::cerr << "Unknown option: " << argument << std::endl;
+                return false;
+            }
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid value for " << argument << ": " << value << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+struct SimulatedSite {
+    std::string id;
+    std::shared_ptr<Utils::AppendLog> log;
+    std::unique_ptr<Sync::EntryShipper> shipper;
+    std::thread writer;
+    double weightWritten = 0.0;
+    std::atomic<int> entriesWritten{0};
+};
+
+// Entries as a hall's camera would produce them, spread over the last week
+void writeEntries(SimulatedSite& site, const BenchOptions& options, unsigned seed) {
+    std::mt19937 random(seed);
+    auto interval = options.rate > 0 ? std::chrono::microseconds(1000000 / options.rate) : std::chrono::microseconds(0);
+    auto next = std::chrono::steady_clock::now();
+    std::time_t now = std::time(nullptr);
+
+    for (int i = 0; i < options.entries; i++) {
+        std::time_t when = now - static_cast<std::time_t>(7 * 24 * 3600) + i * (7 * 24 * 3600) / options.entries;
+        std::tm local = {};
+        localtime_r(&when, &local);
+        char timestamp[32];
+        std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", &local);
+
+        Data::WasteEntry entry;
+        entry.foodType = FOOD_TYPES[random() % (sizeof(FOOD_TYPES) / sizeof(FOOD_TYPES[0]))];
+        entry.weight = 20.0f + static_cast<float>(random() % 480);
+        entry.timestamp = timestamp;
+        entry.confidence = 0.5f + static_cast<float>(random() % 50) / 100.0f;
+        entry.mealPeriod = MEAL_PERIODS[random() % 4];
+
+        if (!site.log->append(Sync::encodeEntry(entry))) {
+            std::cerr << "Append failed for " << site.id << std::endl;
+            return;
+        }
+        site.weightWritten += entry.weight;
+        site.entriesWritten++;
+        site.shipper->notify();
+
+        if (options.rate > 0) {
+            next += interval;
+            std::this_thread::sleep_until(next);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage(argv[0]);
+        return EXIT_ERROR;
+    }
+
+    try {
+        fs::path scratchDir = fs::temp_directory_path() / "food_waste_bench_sync";
+        fs::remove_all(scratchDir);
+        fs::create_directories(scratchDir);
+
+        Sync::CollectorConfig collectorConfig;
+        collectorConfig.bindAddress = "127.0.0.1";
+        collectorConfig.port = 0;
+        collectorConfig.storePath = (scratchDir / "collector").string();
+        collectorConfig.rollupIntervalMs = 0;
+
+        auto collector = std::make_unique<Sync::CollectorServer>(collectorConfig);
+        if (!collector->start()) {
+            std::cerr << "Failed to start the collector" << std::endl;
+            return EXIT_ERROR;
+        }
+        collectorConfig.port = collector->getPort();     // Restarts reuse the port
+
+        std::vector<std::unique_ptr<SimulatedSite>> sites;
+        for (int i = 0; i < options.sites; i++) {
+            auto site = std::make_unique<SimulatedSite>();
+            site->id = "hall-" + std::to_string(i);
+            site->log = std::make_shared<Utils::AppendLog>();
+
+            // Small segments so acknowledged ones are deleted during the run
+            if (!site->log->open((scratchDir / "sites" / site->id / "wal").string(), 1024 * 1024)) {
+                return EXIT_ERROR;
+            }
+
+            Sync::ShipperConfig shipperConfig;
+            shipperConfig.collectorHost = "127.0.0.1";
+            shipperConfig.collectorPort = collectorConfig.port;
+            shipperConfig.siteId = site->id;
+            shipperConfig.batchEntries = options.batchEntries;
+            shipperConfig.batchDelayMs = 50;
+            site->shipper = std::make_unique<Sync::EntryShipper>(site->log, shipperConfig);
+            site->shipper->start();
+            sites.push_back(std::move(site));
+        }
+
+        auto wallStart = std::chrono::steady_clock::now();
+        for (int i = 0; i < options.sites; i++) {
+            sites[i]->writer = std::thread(writeEntries, std::ref(*sites[i]), std::cref(options),
+                                           static_cast<unsigned>(i + 1));
+        }
+
+        // Restart the collector once the sites are about halfway
+        bool restarted = false;
+        if (options.restartCollector) {
+            int target = options.sites * options.entries / 2;
+            while (true) {
+                int written = 0;
+                for (const auto& site : sites) {
+                    written += site->entriesWritten.load();
+                }
+                if (written >= target) {
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+
+            collector->stop();
+            collector.reset();
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            collector = std::make_unique<Sync::CollectorServer>(collectorConfig);
+            if (!collector->start()) {
+                std::cerr << "Failed to restart the collector" << std::endl;
+                return EXIT_ERROR;
+            }
+            restarted = true;
+        }
+
+        for (const auto& site : sites) {
+            site->writer.join();
+        }
+
+        // Drained once every site's log is acknowledged to its end
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(options.timeoutSeconds);
+        bool drained = false;
+        while (!drained && std::chrono::steady_clock::now() < deadline) {
+            drained = std::all_of(sites.begin(), sites.end(), [](const std::unique_ptr<SimulatedSite>& site) {
+                return site->shipper->getStats().acknowledgedOffset == site->log->endOffset();
+            });
+            if (!drained) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+        }
+        double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+        // The collector's view of each site must match what the site wrote
+        json siteReports = json::array();
+        uint64_t wireBytes = 0;
+        uint64_t rawBytes = 0;
+        uint64_t reconnects = 0;
+        uint64_t batches = 0;
+        bool consistent = drained;
+        for (const auto& site : sites) {
+            site->shipper->stop();
+            Sync::ShipperStats stats = site->shipper->getStats();
+            wireBytes += stats.wireBytes;
+            rawBytes += stats.rawBytes;
+            reconnects += stats.reconnects;
+            batches += stats.batchesShipped;
+
+            std::vector<Data::WasteEntry> stored;
+            collector->readSiteEntries(site->id, stored);
+            double storedWeight = 0.0;
+            for (const auto& entry : stored) {
+                storedWeight += entry.weight;
+            }
+
+            bool match = static_cast<int>(stored.size()) == site->entriesWritten.load() &&
+                         std::fabs(storedWeight - site->weightWritten) < 0.5;
+            consistent = consistent && match;
+            siteReports.push_back({
+                {"site", site->id},
+                {"written", site->entriesWritten.load()},
+                {"stored", stored.size()},
+                {"match", match}
+            });
+        }
+
+        json rollup = json::parse(collector->renderRollup());
+        double rollupWeight = 0.0;
+        for (const auto& day : rollup["campus"].items()) {
+            rollupWeight += day.value()["total_weight"].get<double>();
+        }
+        double writtenWeight = 0.0;
+        for (const auto& site : sites) {
+            writtenWeight += site->weightWritten;
+        }
+        bool rollupMatches = std::fabs(rollupWeight - writtenWeight) < 1.0;
+        collector->stop();
+
+        uint64_t totalEntries = static_cast<uint64_t>(options.sites) * options.entries;
+        json report;
+        report["sites"] = options.sites;
+        report["entries"] = totalEntries;
+        report["batch_entries"] = options.batchEntries;
+        report["collector_restarted"] = restarted;
+        report["seconds"] = wallSeconds;
+        report["entries_per_second"] = wallSeconds > 0.0 ? totalEntries / wallSeconds : 0.0;
+        report["batches"] = batches;
+        report["wire_bytes"] = wireBytes;
+        report["raw_bytes"] = rawBytes;
+        report["compression_ratio"] = wireBytes > 0 ? static_cast<double>(rawBytes) / wireBytes : 0.0;
+        report["reconnects"] = reconnects;
+        report["drained"] = drained;
+        report["rollup_matches"] = rollupMatches;
+        report["site_reports"] = siteReports;
+
+        if (options.outputPath.empty()) {
+            std::cout << report.dump(2) << std::endl;
+        } else {
+            std::ofstream output(options.outputPath);
+            if (!output.is_open()) {
+                std::cerr << "Failed to write report to " << options.outputPath << std::endl;
+                return EXIT_ERROR;
+            }
+            output << report.dump(2) << std::endl;
+        }
+
+        return consistent && rollupMatches ? EXIT_OK : EXIT_MISMATCH;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_ERROR;
+    }
+}
@@ -3,7 +3,10 @@
  */
 
 #include "camera_manager.h"
-#include <iostream>
+#include "../utils/metrics.h"
+#include "../utils/trace.h"
+#include "../utils/logger.h"
+#include "../utils/thread_placement.h"
 
 namespace Camera {
 
@@ -13,7 +16,8 @@ CameraManager::CameraManager(int cameraIndex)
       m_newFrameAvailable(false),
       m_width(1280),
       m_height(720),
-      m_fps(30.0) {
+      m_fps(30.0),
+      m_frameRateChanged(false) {
 }
 
 CameraManager::~CameraManager() {
@@ -27,18 +31,18 @@ bool CameraManager::start() {
 
     // Open the camera
     if (!m_camera.open(m_cameraIndex)) {
-        std::cerr << "Error: Could not open camera with index " << m_cameraIndex << std::endl;
+        Utils::logError("camera", "Could not open camera with index %d", m_cameraIndex);
         return false;
     }
 
     // Set camera properties
     m_camera.set(cv::CAP_PROP_FRAME_WIDTH, m_width);
     m_camera.set(cv::CAP_PROP_FRAME_HEIGHT, m_height);
-    m_camera.set(cv::CAP_PROP_FPS, m_fps);
+    m_camera.set(cv::CAP_PROP_FPS, m_fps.load());
 
     // Check if camera is opened successfully
     if (!m_camera.isOpened()) {
-        std::cerr << "Error: Camera failed to initialize properly." << std::endl;
+        Utils::logError("camera", "Camera failed to initialize properly");
         return false;
     }
 
@@ -46,8 +50,7 @@ bool CameraManager::start() {
     m_running = true;
     m_captureThread = std::thread(&CameraManager::captureThread, this);
 
-    std::cout << "Camera started successfully at " << m_width << "x" << m_height
-              << " @ " << m_fps << " fps" << std::endl;
+    Utils::logInfo("camera", "Camera started successfully at %dx%d @ %.1f fps", m_width, m_height, m_fps.load());
     return true;
 }
 
@@ -59,9 +62,6 @@ void CameraManager::stop() {
     // Signal thread to stop and wait for it
     m_running = false;
 
-    // Notify waiting threads
-    m_queueCondition.notify_all();
-
     if (m_captureThread.joinable()) {
         m_captureThread.join();
     }
@@ -69,7 +69,7 @@ void CameraManager::stop() {
     // Release camera resources
     m_camera.release();
 
-    std::cout << "Camera stopped." << std::endl;
+    Utils::logInfo("camera", "Camera stopped");
 }
 
 bool CameraManager::isRunning() const {
@@ -87,35 +87,92 @@ cv::Mat CameraManager::getLatestFrame() {
 }
 
 void CameraManager::captureThread() {
+    auto& registry = Utils::MetricsRegistry::instance();
+    auto& captureInterval = registry.histogram("camera_capture_interval_seconds",
+                                               "Time between consecutive camera frames");
+    auto& framesCaptured = registry.counter("camera_frames_captured_total",
+                                            "Frames read from the camera");
+    auto& framesDropped = registry.counter("camera_frames_dropped_total",
+                                           "Frames replaced before the pipeline picked them up");
+    auto& readFailures = registry.counter("camera_read_failures_total",
+                                          "Failed camera reads");
+
+    Utils::Tracer::instance().setThreadName("camera");
+
+    // Pin before the first read so the driver's and our frame buffers are
+    // first touched, and therefore allocated, on this thread's node
+    auto& placement = Utils::ThreadPlacement::instance();
+    placement.bindCurrentThread(placement.getCaptureCpus(m_cameraIndex),
+                                "camera-" + std::to_string(m_cameraIndex));
+
+    // A disconnected camera fails every read; report it once a second at most
+    Utils::RateLimit readFailureLog(1, std::chrono::seconds(1));
+
     cv::Mat frame;
+    auto lastFrameTime = std::chrono::steady_clock::now();
+    bool hasLastFrame = false;
 
     while (m_running) {
+        if (m_frameRateChanged.exchange(false)) {
+            double fps = m_fps;
+            if (m_camera.set(cv::CAP_PROP_FPS, fps)) {
+                Utils::logInfo("camera", "Frame rate changed to %.1f fps", fps);
+            } else {
+                Utils::logWarning("camera", "Camera did not accept %.1f fps", fps);
+            }
+        }
+
         // Capture a new frame
-        bool success = m_camera.read(frame);
+        bool success;
+        {
+            Utils::TraceSpan trace("CameraManager::read");
+            success = m_camera.read(frame);
+        }
 
         if (!success) {
-            std::cerr << "Warning: Failed to read frame from camera" << std::endl;
+            readFailures.increment();
+            Utils::logRateLimited(readFailureLog, Utils::LogLevel::WARNING, "camera", "Failed to read frame from camera");
             // Small delay to prevent CPU hogging in case of failure
             std::this_thread::sleep_for(std::chrono::milliseconds(30));
             continue;
         }
 
+        auto now = std::chrono::steady_clock::now();
+        if (hasLastFrame) {
+            captureInterval.record(now - lastFrameTime);
+        }
+        lastFrameTime = now;
+        hasLastFrame = true;
+        framesCaptured.increment();
+
+        Utils::TraceSpan trace("CameraManager::publish");
+
         // Pre-process the frame if needed
         processFrame(frame);
 
+        if (m_frameSink) {
+            m_frameSink(frame);
+            continue;
+        }
+
         // Update the latest frame
         {
             std::lock_guard<std::mutex> lock(m_frameMutex);
-            m_latestFrame = frame.clone();
-            m_newFrameAvailable = true;
+            publishFrame(frame);
+            if (m_newFrameAvailable.exchange(true)) {
+                framesDropped.increment();
+            }
         }
+    }
+}
 
-        // Add to processing queue
-        {
-            std::lock_guard<std::mutex> lock(m_queueMutex);
-            m_frameQueue.push(frame.clone());
-        }
-        m_queueCondition.notify_one();
+void CameraManager::publishFrame(const cv::Mat& frame) {
+    // getLatestFrame() hands out copies, so the buffer is never shared and
+    // copyTo() only reallocates when the frame size or type changes
+    const void* previousBuffer = m_latestFrame.data;
+    frame.copyTo(m_latestFrame);
+    if (m_latestFrame.data != previousBuffer) {
+        Utils::placeOnLocalNode(m_latestFrame.data, m_latestFrame.total() * m_latestFrame.elemSize());
     }
 }
 
@@ -132,6 +189,10 @@ void CameraManager::processFrame(cv::Mat& frame) {
     // cv::GaussianBlur(frame, frame, cv::Size(5, 5), 0);
 }
 
+void CameraManager::setFrameSink(FrameSink sink) {
+    m_frameSink = sink;
+}
+
 bool CameraManager::setResolution(int width, int height) {
     if (!m_camera.isOpened()) {
         m_width = width;
@@ -155,8 +216,13 @@ bool CameraManager::setResolution(int width, int height) {
 
 bool CameraManager::setFrameRate(int fps) {
     m_fps = static_cast<double>(fps);
+    if (m_running) {
+        // The capture thread owns the device while running and applies it before its next read
+        m_frameRateChanged = true;
+        return true;
+    }
     if (m_camera.isOpened()) {
-        return m_camera.set(cv::CAP_PROP_FPS, m_fps);
+        return m_camera.set(cv::CAP_PROP_FPS, m_fps.load());
     }
     return true;
 }
@@ -11,8 +11,7 @@
 #include <mutex>
 #include <thread>
 #include <atomic>
-#include <queue>
-#include <condition_variable>
+#include <functional>
 
 namespace Camera {
 
@@ -42,10 +41,20 @@ namespace Camera {
         cv::Size getResolution() const;
         double getFrameRate() const;
 
+        // Hand every captured frame to the sink on the capture thread instead
+        // of keeping it for getLatestFrame(). Set before start().
+        using FrameSink = std::function<void(const cv::Mat& frame)>;
+        void setFrameSink(FrameSink sink);
+
     private:
         void captureThread();
         void processFrame(cv::Mat& frame);
 
+        // Copy a captured frame into m_latestFrame. The buffer is reused
+        // between frames and kept on the capture thread's NUMA node.
+        // Called with m_frameMutex held.
+        void publishFrame(const cv::Mat& frame);
+
         cv::VideoCapture m_camera;
         int m_cameraIndex;
         cv::Mat m_latestFrame;
@@ -55,16 +64,13 @@ namespace Camera {
 
         std::thread m_captureThread;
         std::mutex m_frameMutex;
-
-        // Frame buffer for processing
-        std::queue<cv::Mat> m_frameQueue;
-        std::mutex m_queueMutex;
-        std::condition_variable m_queueCondition;
+        FrameSink m_frameSink;
 
         // Camera properties
         int m_width;
         int m_height;
-        double m_fps;
+        std::atomic<double> m_fps;
+        std::atomic<bool> m_frameRateChanged;       // Set while running, applied by the capture thread
     };
 
 } // namespace Camera
@@ -0,0 +1,157 @@
+/**
+ * Campus Waste Collector
+ *
+ * Receives waste entries from the dining hall monitors (sync_collector_address
+ * in their config) and keeps them, per site, under the store directory along
+ * with campus_rollup.json, the per-day totals of every site and the campus.
+ *
+ *   waste_collector --port 7070 --store /var/lib/food_waste/collector
+ *   waste_collector --store /var/lib/food_waste/collector --export north-hall --output north.csv
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+#include "sync/collector_server.h"
+#include "data/waste_database.h"
+#include "ipc/process_supervisor.h"
+#include "utils/logger.h"
+
+namespace {
+
+const int EXIT_OK = 0;
+const int EXIT_ERROR = 2;
+
+// How often the site table is logged while running
+const std::chrono::minutes STATUS_INTERVAL(5);
+
+struct CollectorOptions {
+    Sync::CollectorConfig config;
+    std::string exportSite;         // Write this site's entries to outputPath and exit
+    std::string outputPath;
+};
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --port <n>               TCP port to listen on (default 7070)\n"
+              << "  --bind <address>         Address to listen on (default 0.0.0.0)\n"
+              << "  --store <path>           Store directory (default collector)\n"
+              << "  --max-connections <n>    Concurrent site connections (default 256)\n"
+              << "  --idle-timeout <ms>      Drop sites silent this long (default 60000)\n"
+              << "  --rollup-interval <ms>   How often campus_rollup.json is rewritten (default 10000)\n"
+              << "  --export <site>          Write a site's entries as a database CSV and exit\n"
+              << "  --output <path>          Destination of --export\n";
+}
+
+bool parseArguments(int argc, char* argv[], CollectorOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << argument << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+
+        try {
+            if (argument == "--port") options.config.port = std::stoi(value);
+            else if (argument == "--bind") options.config.bindAddress = value;
+            else if (argument == "--store") options.config.storePath = value;
+            else if (argument == "--max-connections") options.config.maxConnections = std::stoi(value);
+            else if (argument == "--idle-timeout") options.config.idleTimeoutMs = std::stoi(value);
+            else if (argument == "--rollup-interval") options.config.rollupIntervalMs = std::stoi(value);
+            else if (argument == "--export") options.exportSite = value;
+            else if (argument == "--output") options.outputPath = value;
+            else {
+                std::cerr << "Unknown option: " << argument << std::endl;
+                return false;
+            }
+        }
+        catch (const std::exception&) {
+            std::cerr << "Invalid value for " << argument << ": " << value << std::endl;
+            return false;
+        }
+    }
+
+    return options.exportSite.empty() || !options.outputPath.empty();
+}
+
+// Entries are added to whatever the output already holds, so several sites
+// can be merged into one file
+int exportSite(const CollectorOptions& options) {
+    Sync::CollectorServer collector(options.config);
+    collector.start();
+
+    std::vector<Data::WasteEntry> entries;
+    bool found = collector.readSiteEntries(options.exportSite, entries);
+    collector.stop();
+    if (!found) {
+        std::cerr << "No site " << options.exportSite << " in " << options.config.storePath << std::endl;
+        return EXIT_ERROR;
+    }
+
+    Data::WasteDatabase output(options.outputPath);
+    for (const auto& entry : entries) {
+        output.addEntry(entry);
+    }
+    if (!output.saveToFile()) {
+        return EXIT_ERROR;
+    }
+
+    std::cout << "Exported " << entries.size() << " entries of " << options.exportSite
+              << " to " << options.outputPath << std::endl;
+    return EXIT_OK;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    CollectorOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage(argv[0]);
+        return EXIT_ERROR;
+    }
+
+    try {
+        if (!options.exportSite.empty()) {
+            // Reading the store only; listen where nothing else does
+            options.config.port = 0;
+            options.config.bindAddress = "127.0.0.1";
+            options.config.rollupIntervalMs = 0;
+            return exportSite(options);
+        }
+
+        IPC::installStopHandler();
+
+        Sync::CollectorServer collector(options.config);
+        if (!collector.start()) {
+            return EXIT_ERROR;
+        }
+
+        auto lastStatus = std::chrono::steady_clock::now();
+        while (!IPC::stopRequested()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+            if (std::chrono::steady_clock::now() - lastStatus >= STATUS_INTERVAL) {
+                for (const auto& site : collector.getSites()) {
+                    Utils::logInfo("collector", "%s: %llu entries, offset %llu, %s", site.siteId.c_str(),
+                                   static_cast<unsigned long long>(site.entries),
+                                   static_cast<unsigned long long>(site.committedOffset),
+                                   site.connected ? "connected" : "disconnected");
+                }
+                lastStatus = std::chrono::steady_clock::now();
+            }
+        }
+
+        collector.stop();
+        Utils::Logger::instance().flush();
+        return EXIT_OK;
+    }
+    catch (const std::exception& e) {
+        Utils::Logger::instance().flush();
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_ERROR;
+    }
+}
@@ -0,0 +1,592 @@
+/**
+ * Query Service Implementation
+ */
+
+#include "query_service.h"
+#include "../utils/logger.h"
+#include "../utils/metrics.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <stdexcept>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace Data {
+
+struct QueryService::EntryFeed {
+    std::mutex mutex;
+    std::vector<WasteEntry> entries;
+    int wakeFd = -1;
+    bool active = false;
+};
+
+namespace {
+
+const size_t MAX_REQUEST_BYTES = 64 * 1024;
+const size_t READ_CHUNK_BYTES = 64 * 1024;
+const int MAX_EVENTS = 64;
+const int MAX_TREND_DAYS = 366;
+const int MAX_TOP_LIMIT = 100;
+
+// Local date "YYYY-MM-DD", daysAgo days before today
+std::string localDate(int daysAgo) {
+    std::time_t now = std::time(nullptr);
+    std::tm date = {};
+    localtime_r(&now, &date);
+
+    // Midday keeps daylight-saving changes from moving the date
+    date.tm_mday -= daysAgo;
+    date.tm_hour = 12;
+    date.tm_isdst = -1;
+    std::mktime(&date);
+
+    char buffer[16];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d", &date);
+    return buffer;
+}
+
+// First date of a period, with the same cut-offs as WasteDatabase::getStatistics
+std::string periodStartDate(const std::string& period) {
+    if (period == "day") return localDate(1);
+    if (period == "week") return localDate(7);
+    if (period == "month") return localDate(30);
+    if (period == "year") return localDate(365);
+    if (period == "all") return "";
+    throw std::invalid_argument("unknown period: " + period);
+}
+
+json totalsToJson(const RollupTotals& totals) {
+    return {{"weight", totals.weight}, {"items", totals.items}};
+}
+
+json summaryToJson(const RollupSummary& summary) {
+    json byType = json::object();
+    for (const auto& type : summary.byType) {
+        byType[type.first] = totalsToJson(type.second);
+    }
+    json byMeal = json::object();
+    for (const auto& meal : summary.byMeal) {
+        byMeal[meal.first] = totalsToJson(meal.second);
+    }
+
+    return {
+        {"total_weight", summary.total.weight},
+        {"total_items", summary.total.items},
+        {"by_type", byType},
+        {"by_meal", byMeal}
+    };
+}
+
+json entryToJson(const WasteEntry& entry) {
+    return {
+        {"food_type", entry.foodType},
+        {"weight", entry.weight},
+        {"timestamp", entry.timestamp},
+        {"confidence", entry.confidence},
+        {"meal_period", entry.mealPeriod},
+        {"image", entry.imageFilename}
+    };
+}
+
+} // namespace
+
+QueryService::QueryService(std::shared_ptr<WasteDatabase> database, const QueryServiceConfig& config)
+    : m_database(database),
+      m_config(config),
+      m_listenFd(-1),
+      m_epollFd(-1),
+      m_wakeFd(-1),
+      m_running(false),
+      m_feed(std::make_shared<EntryFeed>()) {
+
+    // The database cannot unregister callbacks, so the callback holds the
+    // feed rather than the service and does nothing while it is inactive
+    std::shared_ptr<EntryFeed> feed = m_feed;
+    m_database->registerEntryCallback([feed](const WasteEntry& entry) {
+        std::lock_guard<std::mutex> lock(feed->mutex);
+        if (!feed->active) {
+            return;
+        }
+
+        // Wake the loop once per batch; it drains everything queued since
+        bool wasEmpty = feed->entries.empty();
+        feed->entries.push_back(entry);
+#ifdef __linux__
+        if (wasEmpty) {
+            uint64_t one = 1;
+            ssize_t written = write(feed->wakeFd, &one, sizeof(one));
+            (void)written;
+        }
+#else
+        (void)wasEmpty;
+#endif
+    });
+}
+
+QueryService::~QueryService() {
+    stop();
+}
+
+std::string QueryService::handleRequest(const std::string& line, Client& client) {
+    static auto& requestCount = Utils::MetricsRegistry::instance().counter(
+        "query_requests_total", "Requests answered by the query service");
+    static auto& queryTime = Utils::MetricsRegistry::instance().histogram(
+        "query_seconds", "Answering one query service request");
+    Utils::ScopedTimer timer(queryTime);
+    requestCount.increment();
+
+    json response;
+    json request = json::parse(line, nullptr, false);
+    if (request.is_discarded() || !request.is_object()) {
+        response["ok"] = false;
+        response["error"] = "request is not a JSON object";
+        return response.dump() + "\n";
+    }
+    if (request.contains("id")) {
+        response["id"] = request["id"];
+    }
+
+    try {
+        std::string op = request.value("op", "");
+        json result = json::object();
+
+        if (op == "stats") {
+            std::string period = request.value("period", "all");
+            std::string startDate = periodStartDate(period);
+            result = summaryToJson(m_rollup.summarize(startDate));
+            result["period"] = period;
+            result["start_date"] = startDate;
+        } else if (op == "trend") {
+            int days = std::max(1, std::min(request.value("days", 30), MAX_TREND_DAYS));
+            std::string foodType = request.value("food_type", "");
+
+            json trend = json::array();
+            for (int daysAgo = days - 1; daysAgo >= 0; daysAgo--) {
+                std::string date = localDate(daysAgo);
+                json day = totalsToJson(m_rollup.dayTotals(date, foodType));
+                day["date"] = date;
+                trend.push_back(day);
+            }
+            result["days"] = trend;
+        } else if (op == "top") {
+            std::string period = request.value("period", "all");
+            int limit = std::max(1, std::min(request.value("limit", 5), MAX_TOP_LIMIT));
+
+            json foods = json::array();
+            for (const auto& food : m_rollup.top(periodStartDate(period), static_cast<size_t>(limit))) {
+                json item = totalsToJson(food.second);
+                item["food_type"] = food.first;
+                foods.push_back(item);
+            }
+            result["period"] = period;
+            result["foods"] = foods;
+        } else if (op == "range") {
+            size_t limit = m_config.maxRangeResults;
+            if (request.contains("limit")) {
+                limit = std::min(static_cast<size_t>(std::max(0, request["limit"].get<int>())), limit);
+            }
+
+            bool truncated = false;
+            json entries = json::array();
+            for (const auto& entry : m_rollup.range(request.value("start", ""), request.value("end", ""),
+                                                    request.value("food_type", ""), limit, truncated)) {
+                entries.push_back(entryToJson(entry));
+            }
+            result["entries"] = entries;
+            result["truncated"] = truncated;
+        } else if (op == "subscribe" || op == "unsubscribe") {
+            client.subscribed = op == "subscribe";
+            result["subscribed"] = client.subscribed;
+        } else if (op == "ping") {
+            result["entries"] = m_rollup.entryCount();
+            result["clients"] = m_clients.size();
+        } else {
+            throw std::invalid_argument("unknown op: " + op);
+        }
+
+        response["ok"] = true;
+        response["result"] = result;
+    }
+    catch (const std::exception& e) {
+        response["ok"] = false;
+        response["error"] = e.what();
+    }
+
+    return response.dump() + "\n";
+}
+
+#ifdef __linux__
+
+bool QueryService::start() {
+    if (m_running) {
+        return true;
+    }
+    if (m_config.socketPath.empty()) {
+        return false;
+    }
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (m_config.socketPath.size() >= sizeof(address.sun_path)) {
+        Utils::logError("query", "Socket path is too long: %s", m_config.socketPath.c_str());
+        return false;
+    }
+    std::strncpy(address.sun_path, m_config.socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    try {
+        fs::path directory = fs::path(m_config.socketPath).parent_path();
+        if (!directory.empty()) {
+            fs::create_directories(directory);
+        }
+    }
+    catch (const std::exception& e) {
+        Utils::logError("query", "Cannot create the socket directory: %s", e.what());
+        return false;
+    }
+
+    // A socket left by a crashed monitor is replaced; one still answering is not
+    struct stat existing;
+    if (lstat(m_config.socketPath.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            Utils::logError("query", "%s exists and is not a socket", m_config.socketPath.c_str());
+            return false;
+        }
+
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool inUse = probe >= 0 && connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        if (probe >= 0) {
+            close(probe);
+        }
+        if (inUse) {
+            Utils::logError("query", "Another process is serving %s", m_config.socketPath.c_str());
+            return false;
+        }
+        unlink(m_config.socketPath.c_str());
+    }
+
+    m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    bool ok = m_listenFd >= 0 && m_epollFd >= 0 && m_wakeFd >= 0 &&
+              bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 &&
+              listen(m_listenFd, SOMAXCONN) == 0;
+    if (ok) {
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = m_listenFd;
+        ok = epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_listenFd, &event) == 0;
+        event.data.fd = m_wakeFd;
+        ok = ok && epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &event) == 0;
+    }
+    if (!ok) {
+        Utils::logError("query", "Failed to listen on %s: %s", m_config.socketPath.c_str(), strerror(errno));
+        closeAll();
+        return false;
+    }
+
+    // Snapshot the database, then follow it through the entry callback
+    m_rollup.clear();
+    for (const auto& entry : m_database->getEntries()) {
+        m_rollup.add(entry);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_feed->mutex);
+        m_feed->entries.clear();
+        m_feed->wakeFd = m_wakeFd;
+        m_feed->active = true;
+    }
+
+    m_running = true;
+    m_thread = std::thread(&QueryService::eventLoop, this);
+
+    Utils::logInfo("query", "Serving queries on %s (%zu entries)",
+                   m_config.socketPath.c_str(), m_rollup.entryCount());
+    return true;
+}
+
+void QueryService::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_feed->mutex);
+        m_feed->active = false;
+        m_feed->wakeFd = -1;
+    }
+
+    m_running = false;
+    if (m_thread.joinable()) {
+        uint64_t one = 1;
+        ssize_t written = write(m_wakeFd, &one, sizeof(one));
+        (void)written;
+        m_thread.join();
+    }
+
+    bool listening = m_listenFd >= 0;
+    closeAll();
+    if (listening) {
+        unlink(m_config.socketPath.c_str());
+    }
+}
+
+void QueryService::closeAll() {
+    for (const auto& client : m_clients) {
+        close(client.first);
+    }
+    m_clients.clear();
+
+    for (int* fd : {&m_listenFd, &m_epollFd, &m_wakeFd}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+void QueryService::eventLoop() {
+    epoll_event events[MAX_EVENTS];
+
+    while (m_running) {
+        int count = epoll_wait(m_epollFd, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            Utils::logError("query", "Event loop failed: %s", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < count && m_running; i++) {
+            int fd = events[i].data.fd;
+            if (fd == m_listenFd) {
+                acceptClients();
+                continue;
+            }
+            if (fd == m_wakeFd) {
+                uint64_t wakeups = 0;
+                ssize_t drained = read(m_wakeFd, &wakeups, sizeof(wakeups));
+                (void)drained;
+                publishPendingEntries();
+                continue;
+            }
+
+            auto client = m_clients.find(fd);
+            if (client == m_clients.end()) {
+                continue;   // Closed earlier in this batch
+            }
+            if (events[i].events & EPOLLERR) {
+                closeClient(fd);
+                continue;
+            }
+            if ((events[i].events & (EPOLLIN | EPOLLHUP)) && !readClient(fd, client->second)) {
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                flushClient(fd, client->second);
+            }
+        }
+    }
+}
+
+void QueryService::acceptClients() {
+    static Utils::RateLimit rejectLog(1, std::chrono::seconds(10));
+
+    while (true) {
+        int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;     // EAGAIN once the backlog is empty
+        }
+
+        if (static_cast<int>(m_clients.size()) >= m_config.maxClients) {
+            Utils::logRateLimited(rejectLog, Utils::LogLevel::WARNING, "query",
+                                  "Rejecting client: %d clients connected", m_config.maxClients);
+            close(fd);
+            continue;
+        }
+
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            continue;
+        }
+        m_clients.emplace(fd, Client());
+    }
+}
+
+bool QueryService::readClient(int fd, Client& client) {
+    // One read per wakeup keeps a client that pipelines heavily from
+    // starving the others; level-triggered epoll brings us back for the rest
+    char buffer[READ_CHUNK_BYTES];
+    ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+    if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        closeClient(fd);
+        return false;
+    }
+    if (received < 0) {
+        return true;
+    }
+    client.input.append(buffer, static_cast<size_t>(received));
+
+    size_t lineStart = 0;
+    size_t lineEnd;
+    while ((lineEnd = client.input.find('\n', lineStart)) != std::string::npos) {
+        size_t length = lineEnd - lineStart;
+        if (length > 0 && client.input[lineEnd - 1] == '\r') {
+            length--;
+        }
+        if (length > 0) {
+            client.output += handleRequest(client.input.substr(lineStart, length), client);
+        }
+        lineStart = lineEnd + 1;
+    }
+    client.input.erase(0, lineStart);
+
+    if (client.input.size() > MAX_REQUEST_BYTES) {
+        Utils::logWarning("query", "Closing client that sent a request over %zu bytes", MAX_REQUEST_BYTES);
+        closeClient(fd);
+        return false;
+    }
+
+    return flushClient(fd, client);
+}
+
+bool QueryService::flushClient(int fd, Client& client) {
+    static Utils::RateLimit slowClientLog(1, std::chrono::seconds(10));
+
+    while (client.outputOffset < client.output.size()) {
+        ssize_t sent = send(fd, client.output.data() + client.outputOffset,
+                            client.output.size() - client.outputOffset, MSG_NOSIGNAL);
+        if (sent > 0) {
+            client.outputOffset += static_cast<size_t>(sent);
+        } else if (sent < 0 && errno == EINTR) {
+            continue;
+        } else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            closeClient(fd);
+            return false;
+        }
+    }
+
+    if (client.outputOffset == client.output.size()) {
+        client.output.clear();
+        client.outputOffset = 0;
+    } else if (client.outputOffset >= READ_CHUNK_BYTES) {
+        client.output.erase(0, client.outputOffset);
+        client.outputOffset = 0;
+    }
+
+    size_t pending = client.output.size() - client.outputOffset;
+    if (pending > m_config.maxPendingBytes) {
+        Utils::logRateLimited(slowClientLog, Utils::LogLevel::WARNING, "query",
+                              "Dropping a client %zu bytes behind", pending);
+        closeClient(fd);
+        return false;
+    }
+
+    bool wantWrite = pending > 0;
+    if (wantWrite != client.writeWatched) {
+        epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = wantWrite ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(m_epollFd, EPOLL_CTL_MOD, fd, &event);
+        client.writeWatched = wantWrite;
+    }
+    return true;
+}
+
+void QueryService::closeClient(int fd) {
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    m_clients.erase(fd);
+}
+
+void QueryService::publishPendingEntries() {
+    std::vector<WasteEntry> entries;
+    {
+        std::lock_guard<std::mutex> lock(m_feed->mutex);
+        entries.swap(m_feed->entries);
+    }
+
+    std::vector<int> subscribers;
+    for (const auto& client : m_clients) {
+        if (client.second.subscribed) {
+            subscribers.push_back(client.first);
+        }
+    }
+
+    for (const auto& entry : entries) {
+        m_rollup.add(entry);
+        if (subscribers.empty()) {
+            continue;
+        }
+
+        std::string event = json{{"event", "entry"}, {"entry", entryToJson(entry)}}.dump() + "\n";
+        for (int fd : subscribers) {
+            m_clients[fd].output += event;
+        }
+    }
+
+    for (int fd : subscribers) {
+        auto client = m_clients.find(fd);
+        if (client != m_clients.end()) {
+            flushClient(fd, client->second);
+        }
+    }
+}
+
+#else
+
+bool QueryService::start() {
+    Utils::logError("query", "The query service is not supported on this platform");
+    return false;
+}
+
+void QueryService::stop() {
+}
+
+void QueryService::closeAll() {
+}
+
+void QueryService::eventLoop() {
+}
+
+void QueryService::acceptClients() {
+}
+
+bool QueryService::readClient(int, Client&) {
+    return false;
+}
+
+bool QueryService::flushClient(int, Client&) {
+    return false;
+}
+
+void QueryService::closeClient(int) {
+}
+
+void QueryService::publishPendingEntries() {
+}
+
+#endif
+
+} // namespace Data
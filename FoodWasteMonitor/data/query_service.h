@@ -0,0 +1,113 @@
+/**
+ * Query Service Header
+ *
+ * Answers statistics, trend, top-N and range queries from dashboards and
+ * reporting scripts over a local Unix domain socket, and streams new waste
+ * entries to subscribers, so nothing outside the monitor has to read the
+ * database file while it is being rewritten
+ */
+
+#ifndef QUERY_SERVICE_H
+#define QUERY_SERVICE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <cstddef>
+#include "waste_database.h"
+#include "waste_rollup.h"
+
+namespace Data {
+
+struct QueryServiceConfig {
+    std::string socketPath;
+    int maxClients;
+    size_t maxPendingBytes;     // A client further behind than this is disconnected
+    size_t maxRangeResults;     // Cap on the entries one range query returns
+
+    QueryServiceConfig()
+        : socketPath("data/query.sock"),
+          maxClients(256),
+          maxPendingBytes(4 * 1024 * 1024),
+          maxRangeResults(10000) {
+    }
+};
+
+// Newline-delimited JSON. Each request is one object on one line:
+//
+//   {"id": 1, "op": "stats", "period": "week"}
+//   {"id": 2, "op": "trend", "days": 30, "food_type": "rice"}
+//   {"id": 3, "op": "top", "period": "month", "limit": 5}
+//   {"id": 4, "op": "range", "start": "2024-05-01", "end": "2024-05-07", "limit": 100}
+//   {"id": 5, "op": "subscribe"}            (also "unsubscribe" and "ping")
+//
+// and is answered in order with {"id": ..., "ok": true, "result": {...}} or
+// {"id": ..., "ok": false, "error": "..."}. Subscribers also receive
+// {"event": "entry", "entry": {...}} for every entry added to the database.
+//
+// One event-loop thread serves every client. It owns the rollup, which is
+// built from the database at start and then kept current from the
+// database's entry callback, so queries never take the database lock.
+class QueryService {
+public:
+    QueryService(std::shared_ptr<WasteDatabase> database, const QueryServiceConfig& config = QueryServiceConfig());
+    ~QueryService();
+
+    QueryService(const QueryService&) = delete;
+    QueryService& operator=(const QueryService&) = delete;
+
+    // Start before detections are added; entries added while the snapshot
+    // is being taken may be counted twice or missed
+    bool start();
+    void stop();
+    bool isRunning() const { return m_running; }
+
+private:
+    struct Client {
+        std::string input;
+        std::string output;
+        size_t outputOffset;        // Bytes of output already sent
+        bool subscribed;
+        bool writeWatched;          // Registered for EPOLLOUT
+
+        Client() : outputOffset(0), subscribed(false), writeWatched(false) {}
+    };
+
+    // Entries handed from the database callback to the loop thread. Shared
+    // with the callback, which the database keeps after the service is gone.
+    struct EntryFeed;
+
+    void eventLoop();
+    void acceptClients();
+
+    // These return false when they closed the client
+    bool readClient(int fd, Client& client);
+    bool flushClient(int fd, Client& client);
+
+    void closeClient(int fd);
+    void closeAll();
+    void publishPendingEntries();
+
+    // Answer one request line; the loop thread only
+    std::string handleRequest(const std::string& line, Client& client);
+
+    std::shared_ptr<WasteDatabase> m_database;
+    QueryServiceConfig m_config;
+
+    int m_listenFd;
+    int m_epollFd;
+    int m_wakeFd;
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+
+    std::map<int, Client> m_clients;
+    WasteRollup m_rollup;
+    std::shared_ptr<EntryFeed> m_feed;
+};
+
+} // namespace Data
+
+#endif // QUERY_SERVICE_H
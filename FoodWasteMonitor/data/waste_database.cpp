@@ -3,8 +3,11 @@
  */
 
 #include "waste_database.h"
+#include "../utils/metrics.h"
+#include "../utils/trace.h"
+#include "../utils/logger.h"
+#include "../utils/task_scheduler.h"
 #include <fstream>
-#include <iostream>
 #include <algorithm>
 #include <chrono>
 #include <ctime>
@@ -51,11 +54,11 @@ bool WasteDatabase::initialize() {
             m_statisticsDirty = true;
         }
 
-        std::cout << "Initialized new database at " << m_databasePath << std::endl;
+        Utils::logInfo("database", "Initialized new database at %s", m_databasePath.c_str());
         return true;
     }
     catch (const std::exception& e) {
-        std::cerr << "Error initializing database: " << e.what() << std::endl;
+        Utils::logError("database", "Error initializing database: %s", e.what());
         return false;
     }
 }
@@ -117,6 +120,10 @@ MealPeriod WasteDatabase::getCurrentMealPeriod() const {
     return m_currentMealPeriod;
 }
 
+std::map<MealPeriod, TimeRange> WasteDatabase::getMealTimeRanges() const {
+    return m_mealTimeRanges;
+}
+
 std::string WasteDatabase::getMealPeriodString() const {
     switch (m_currentMealPeriod) {
         case MealPeriod::BREAKFAST: return "Breakfast";
@@ -140,6 +147,11 @@ void WasteDatabase::addDetection(const Detection::FoodItem& item) {
 }
 
 void WasteDatabase::addDetections(const Detection::DetectionResult& detections) {
+    static auto& insertTime = Utils::MetricsRegistry::instance().histogram(
+        "database_insert_seconds", "Adding a frame's detections to the database, including observers");
+    Utils::ScopedTimer timer(insertTime);
+    Utils::TraceSpan trace("WasteDatabase::addDetections");
+
     for (const auto& item : detections) {
         addDetection(item);
     }
@@ -147,12 +159,15 @@ void WasteDatabase::addDetections(const Detection::DetectionResult& detections)
 
 void WasteDatabase::addEntry(const WasteEntry& entry) {
     {
-        std::lock_guard<std::mutex> lock(m_databaseMutex);
+        auto lock = Utils::traceLock(m_databaseMutex, "WasteDatabase::waitForLock");
         m_entries.push_back(entry);
         m_statisticsDirty = true;
     }
 
     // Notify observers
+    for (const auto& callback : m_entryCallbacks) {
+        callback(entry);
+    }
     notifyDatabaseChanged();
 }
 
@@ -161,7 +176,8 @@ std::vector<WasteEntry> WasteDatabase::getEntries(
     const std::string& startDate,
     const std::string& endDate) {
 
-    std::lock_guard<std::mutex> lock(m_databaseMutex);
+    auto lock = Utils::traceLock(m_databaseMutex, "WasteDatabase::waitForLock");
+    Utils::TraceSpan trace("WasteDatabase::getEntries");
 
     // Filter by food type if specified
     std::vector<WasteEntry> filteredEntries;
@@ -246,7 +262,8 @@ std::vector<WasteEntry> WasteDatabase::filterEntriesByDate(
 }
 
 WasteStatistics WasteDatabase::getStatistics(TimePeriod period) {
-    std::lock_guard<std::mutex> lock(m_databaseMutex);
+    auto lock = Utils::traceLock(m_databaseMutex, "WasteDatabase::waitForLock");
+    Utils::TraceSpan trace("WasteDatabase::getStatistics");
 
     // If statistics are dirty or a specific period is requested, recalculate
     if (m_statisticsDirty || period != TimePeriod::ALL_TIME) {
@@ -644,12 +661,13 @@ std::map<std::string, float> WasteDatabase::getWasteTrend(TimePeriod period) {
 }
 
 bool WasteDatabase::saveToFile() {
-    std::lock_guard<std::mutex> lock(m_databaseMutex);
+    auto lock = Utils::traceLock(m_databaseMutex, "WasteDatabase::waitForLock");
+    Utils::TraceSpan trace("WasteDatabase::saveToFile");
 
     try {
         std::ofstream file(m_databasePath);
         if (!file.is_open()) {
-            std::cerr << "Failed to open database file for writing: " << m_databasePath << std::endl;
+            Utils::logError("database", "Failed to open database file for writing: %s", m_databasePath.c_str());
             return false;
         }
 
@@ -667,11 +685,11 @@ bool WasteDatabase::saveToFile() {
         }
 
         file.close();
-        std::cout << "Database saved to " << m_databasePath << " with " << m_entries.size() << " entries" << std::endl;
+        Utils::logInfo("database", "Database saved to %s with %zu entries", m_databasePath.c_str(), m_entries.size());
         return true;
     }
     catch (const std::exception& e) {
-        std::cerr << "Error saving database: " << e.what() << std::endl;
+        Utils::logError("database", "Error saving database: %s", e.what());
         return false;
     }
 }
@@ -682,7 +700,7 @@ bool WasteDatabase::loadFromFile() {
     try {
         std::ifstream file(m_databasePath);
         if (!file.is_open()) {
-            std::cerr << "Failed to open database file for reading: " << m_databasePath << std::endl;
+            Utils::logError("database", "Failed to open database file for reading: %s", m_databasePath.c_str());
             return false;
         }
 
@@ -712,22 +730,23 @@ bool WasteDatabase::loadFromFile() {
         file.close();
         m_statisticsDirty = true;
 
-        std::cout << "Loaded " << m_entries.size() << " entries from database" << std::endl;
+        Utils::logInfo("database", "Loaded %zu entries from database", m_entries.size());
         return true;
     }
     catch (const std::exception& e) {
-        std::cerr << "Error loading database: " << e.what() << std::endl;
+        Utils::logError("database", "Error loading database: %s", e.what());
         return false;
     }
 }
 
 bool WasteDatabase::exportToCSV(const std::string& filePath) {
-    std::lock_guard<std::mutex> lock(m_databaseMutex);
+    auto lock = Utils::traceLock(m_databaseMutex, "WasteDatabase::waitForLock");
+    Utils::TraceSpan trace("WasteDatabase::exportToCSV");
 
     try {
         std::ofstream file(filePath);
         if (!file.is_open()) {
-            std::cerr << "Failed to open export file for writing: " << filePath << std::endl;
+            Utils::logError("database", "Failed to open export file for writing: %s", filePath.c_str());
             return false;
         }
 
@@ -763,22 +782,23 @@ bool WasteDatabase::exportToCSV(const std::string& filePath) {
         }
 
         file.close();
-        std::cout << "Data exported to CSV: " << filePath << std::endl;
+        Utils::logInfo("database", "Data exported to CSV: %s", filePath.c_str());
         return true;
     }
     catch (const std::exception& e) {
-        std::cerr << "Error exporting data: " << e.what() << std::endl;
+        Utils::logError("database", "Error exporting data: %s", e.what());
         return false;
     }
 }
 
 bool WasteDatabase::exportToJSON(const std::string& filePath) {
-    std::lock_guard<std::mutex> lock(m_databaseMutex);
+    auto lock = Utils::traceLock(m_databaseMutex, "WasteDatabase::waitForLock");
+    Utils::TraceSpan trace("WasteDatabase::exportToJSON");
 
     try {
         std::ofstream file(filePath);
         if (!file.is_open()) {
-            std::cerr << "Failed to open JSON file for writing: " << filePath << std::endl;
+            Utils::logError("database", "Failed to open JSON file for writing: %s", filePath.c_str());
             return false;
         }
 
@@ -885,11 +905,11 @@ bool WasteDatabase::exportToJSON(const std::string& filePath) {
         file << "}\n";
 
         file.close();
-        std::cout << "Data exported to JSON: " << filePath << std::endl;
+        Utils::logInfo("database", "Data exported to JSON: %s", filePath.c_str());
         return true;
     }
     catch (const std::exception& e) {
-        std::cerr << "Error exporting to JSON: " << e.what() << std::endl;
+        Utils::logError("database", "Error exporting to JSON: %s", e.what());
         return false;
     }
 }
@@ -924,20 +944,29 @@ void WasteDatabase::saveDetectionImage(const cv::Mat& frame, const Detection::Fo
         box.height = std::min(box.height, frame.rows - box.y);
 
         if (box.width <= 0 || box.height <= 0) {
-            std::cerr << "Invalid bounding box for image saving" << std::endl;
+            Utils::logWarning("database", "Invalid bounding box for image saving");
             outputPath = "";
             return;
         }
 
-        // Extract the region and save it
-        cv::Mat roi = frame(box);
-        cv::imwrite(imagePath.string(), roi);
-
+        // Copy the region out of the frame, which the caller reuses, and
+        // encode it off the calling thread
+        cv::Mat roi = frame(box).clone();
         outputPath = imagePath.string();
-        std::cout << "Saved detection image to " << outputPath << std::endl;
+        Utils::TaskScheduler::instance().submit(Utils::TaskClass::INGEST, [roi, path = outputPath]() {
+            static auto& encodeTime = Utils::MetricsRegistry::instance().histogram(
+                "image_encode_seconds", "Encoding and writing a detection image");
+            Utils::ScopedTimer timer(encodeTime);
+            Utils::TraceSpan trace("WasteDatabase::encodeImage");
+            if (cv::imwrite(path, roi)) {
+                Utils::logDebug("database", "Saved detection image to %s", path.c_str());
+            } else {
+                Utils::logError("database", "Failed to write detection image %s", path.c_str());
+            }
+        });
     }
     catch (const std::exception& e) {
-        std::cerr << "Error saving detection image: " << e.what() << std::endl;
+        Utils::logError("database", "Error saving detection image: %s", e.what());
         outputPath = "";
     }
 }
@@ -946,6 +975,10 @@ void WasteDatabase::registerChangeCallback(DatabaseChangeCallback callback) {
     m_changeCallbacks.push_back(callback);
 }
 
+void WasteDatabase::registerEntryCallback(EntryAddedCallback callback) {
+    m_entryCallbacks.push_back(callback);
+}
+
 void WasteDatabase::notifyDatabaseChanged() {
     for (const auto& callback : m_changeCallbacks) {
         callback();
@@ -958,4 +991,6 @@ std::string WasteDatabase::getCurrentTimestamp() const {
     std::stringstream ss;
     ss << std::put_time(std::localtime(&timeT), "%Y-%m-%d %H:%M:%S");
     return ss.str();
-}
\ No newline at end of file
+}
+
+} // namespace Data
\ No newline at end of file
@@ -76,6 +76,14 @@ struct WasteStatistics {
     WasteStatistics() : totalWeight(0.0f), totalItems(0), wasteSavedTotal(0.0f), wasteSavedPercentage(0.0f) {}
 };
 
+// Time of day range (24-hour format)
+struct TimeRange {
+    int startHour;
+    int startMinute;
+    int endHour;
+    int endMinute;
+};
+
 class WasteDatabase {
 public:
     explicit WasteDatabase(const std::string& databasePath);
@@ -117,18 +125,28 @@ public:
     void setMealPeriod(MealPeriod period);
     MealPeriod getCurrentMealPeriod() const;
     std::string getMealPeriodString() const;
+    std::map<MealPeriod, TimeRange> getMealTimeRanges() const;
+
+    // Save the item's crop next to the database. outputPath is set right
+    // away; the JPEG is encoded and written by an ingest task.
     void saveDetectionImage(const cv::Mat& frame, const Detection::FoodItem& item, std::string& outputPath);
 
     // Observer pattern for database changes
     using DatabaseChangeCallback = std::function<void()>;
     void registerChangeCallback(DatabaseChangeCallback callback);
 
+    // Called with each entry after it is added, outside the database lock.
+    // Register during setup, before entries are added from other threads.
+    using EntryAddedCallback = std::function<void(const WasteEntry&)>;
+    void registerEntryCallback(EntryAddedCallback callback);
+
 private:
     // Initialize meal periods
     void initializeMealPeriods();
 
     // Determine meal period from time
     MealPeriod determineMealPeriod(const std::string& timestamp) const;
+    MealPeriod determineMealPeriod(int hour, int minute) const;
 
     // Filter entries by date range
     std::vector<WasteEntry> filterEntriesByDate(
@@ -149,13 +167,7 @@ private:
     // Current application state
     MealPeriod m_currentMealPeriod;
 
-    // Meal time ranges (24-hour format)
-    struct TimeRange {
-        int startHour;
-        int startMinute;
-        int endHour;
-        int endMinute;
-    };
+    // Meal time ranges
     std::map<MealPeriod, TimeRange> m_mealTimeRanges;
 
     // Thread safety
@@ -163,7 +175,15 @@ private:
 
     // Observer pattern
     std::vector<DatabaseChangeCallback> m_changeCallbacks;
+    std::vector<EntryAddedCallback> m_entryCallbacks;
 
     // Notification of changes
     void notifyDatabaseChanged();
-};
\ No newline at end of file
+
+    // Current local time as "YYYY-MM-DD HH:MM:SS"
+    std::string getCurrentTimestamp() const;
+};
+
+} // namespace Data
+
+#endif // WASTE_DATABASE_H
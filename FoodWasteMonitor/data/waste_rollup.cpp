@@ -0,0 +1,156 @@
+/**
+ * Waste Rollup Implementation
+ */
+
+#include "waste_rollup.h"
+#include <algorithm>
+#include <cctype>
+
+namespace Data {
+
+namespace {
+
+// Start dates move once a day, so only a handful are ever live
+const size_t MAX_CACHED_PERIODS = 16;
+
+// The "YYYY-MM-DD" prefix of a "YYYY-MM-DD HH:MM:SS" timestamp, or empty
+std::string dateOf(const std::string& timestamp) {
+    if (timestamp.size() < 10 || timestamp[4] != '-' || timestamp[7] != '-') {
+        return "";
+    }
+    for (int i : {0, 1, 2, 3, 5, 6, 8, 9}) {
+        if (!std::isdigit(static_cast<unsigned char>(timestamp[i]))) {
+            return "";
+        }
+    }
+    return timestamp.substr(0, 10);
+}
+
+bool timestampBefore(const WasteEntry& entry, const std::string& timestamp) {
+    return entry.timestamp < timestamp;
+}
+
+// True when the entry lies past the bound, comparing only as much of the
+// timestamp as the bound gives so that a bare date includes the whole day
+bool timestampAfter(const std::string& bound, const WasteEntry& entry) {
+    return entry.timestamp.compare(0, bound.size(), bound) > 0;
+}
+
+} // namespace
+
+void RollupSummary::merge(const RollupSummary& other) {
+    total.add(other.total.weight, other.total.items);
+    for (const auto& type : other.byType) {
+        byType[type.first].add(type.second.weight, type.second.items);
+    }
+    for (const auto& meal : other.byMeal) {
+        byMeal[meal.first].add(meal.second.weight, meal.second.items);
+    }
+}
+
+void WasteRollup::clear() {
+    m_days.clear();
+    m_allTime = RollupSummary();
+    m_entries.clear();
+    m_periodCache.clear();
+}
+
+void WasteRollup::add(const WasteEntry& entry) {
+    std::vector<RollupSummary*> targets = {&m_allTime};
+
+    std::string date = dateOf(entry.timestamp);
+    if (!date.empty()) {
+        targets.push_back(&m_days[date]);
+        for (auto& cached : m_periodCache) {
+            if (date >= cached.first) {
+                targets.push_back(&cached.second);
+            }
+        }
+    }
+
+    for (RollupSummary* summary : targets) {
+        summary->total.add(entry.weight);
+        summary->byType[entry.foodType].add(entry.weight);
+        summary->byMeal[entry.mealPeriod].add(entry.weight);
+    }
+
+    // Entries arrive in time order, so this is almost always an append
+    if (m_entries.empty() || !(entry.timestamp < m_entries.back().timestamp)) {
+        m_entries.push_back(entry);
+    } else {
+        auto position = std::upper_bound(m_entries.begin(), m_entries.end(), entry,
+            [](const WasteEntry& a, const WasteEntry& b) { return a.timestamp < b.timestamp; });
+        m_entries.insert(position, entry);
+    }
+}
+
+RollupSummary WasteRollup::summarize(const std::string& startDate) const {
+    if (startDate.empty()) {
+        return m_allTime;
+    }
+
+    auto cached = m_periodCache.find(startDate);
+    if (cached != m_periodCache.end()) {
+        return cached->second;
+    }
+
+    RollupSummary summary;
+    for (auto day = m_days.lower_bound(startDate); day != m_days.end(); ++day) {
+        summary.merge(day->second);
+    }
+
+    if (m_periodCache.size() >= MAX_CACHED_PERIODS) {
+        m_periodCache.erase(m_periodCache.begin());     // The oldest start date
+    }
+    m_periodCache[startDate] = summary;
+    return summary;
+}
+
+RollupTotals WasteRollup::dayTotals(const std::string& date, const std::string& foodType) const {
+    auto day = m_days.find(date);
+    if (day == m_days.end()) {
+        return RollupTotals();
+    }
+    if (foodType.empty()) {
+        return day->second.total;
+    }
+
+    auto type = day->second.byType.find(foodType);
+    return type != day->second.byType.end() ? type->second : RollupTotals();
+}
+
+std::vector<std::pair<std::string, RollupTotals>> WasteRollup::top(const std::string& startDate, size_t limit) const {
+    RollupSummary summary = summarize(startDate);
+
+    std::vector<std::pair<std::string, RollupTotals>> foods(summary.byType.begin(), summary.byType.end());
+    std::sort(foods.begin(), foods.end(),
+              [](const auto& a, const auto& b) { return a.second.weight > b.second.weight; });
+    if (foods.size() > limit) {
+        foods.resize(limit);
+    }
+    return foods;
+}
+
+std::vector<WasteEntry> WasteRollup::range(const std::string& start, const std::string& end,
+                                           const std::string& foodType, size_t limit, bool& truncated) const {
+    auto first = start.empty() ? m_entries.begin() :
+        std::lower_bound(m_entries.begin(), m_entries.end(), start, timestampBefore);
+    auto last = end.empty() ? m_entries.end() :
+        std::upper_bound(first, m_entries.end(), end, timestampAfter);
+
+    std::vector<WasteEntry> result;
+    truncated = false;
+    for (auto entry = first; entry != last; ++entry) {
+        if (!foodType.empty() && entry->foodType != foodType) {
+            continue;
+        }
+        if (result.size() == limit) {
+            truncated = true;
+            break;
+        }
+        result.push_back(*entry);
+    }
+    return result;
+}
+
+} // namespace Data
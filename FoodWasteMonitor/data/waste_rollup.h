@@ -0,0 +1,75 @@
+/**
+ * Waste Rollup Header
+ *
+ * In-memory per-day aggregates and a time-ordered snapshot of the waste
+ * entries, so period statistics, trends and range queries are answered
+ * without scanning or re-reading the database
+ */
+
+#ifndef WASTE_ROLLUP_H
+#define WASTE_ROLLUP_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <utility>
+#include "waste_database.h"
+
+namespace Data {
+
+struct RollupTotals {
+    double weight;
+    int items;
+
+    RollupTotals() : weight(0.0), items(0) {}
+
+    void add(double entryWeight, int entryItems = 1) {
+        weight += entryWeight;
+        items += entryItems;
+    }
+};
+
+struct RollupSummary {
+    RollupTotals total;
+    std::map<std::string, RollupTotals> byType;
+    std::map<std::string, RollupTotals> byMeal;
+
+    void merge(const RollupSummary& other);
+};
+
+// Not thread-safe; owned by a single thread
+class WasteRollup {
+public:
+    void clear();
+    void add(const WasteEntry& entry);
+
+    // Entries dated on or after startDate ("YYYY-MM-DD"); empty = all time
+    RollupSummary summarize(const std::string& startDate) const;
+
+    // Totals for a single day, optionally for one food type
+    RollupTotals dayTotals(const std::string& date, const std::string& foodType = "") const;
+
+    // Food types by weight, heaviest first
+    std::vector<std::pair<std::string, RollupTotals>> top(const std::string& startDate, size_t limit) const;
+
+    // Entries whose timestamps fall between start and end (dates or full
+    // timestamps, both inclusive; empty = open), oldest first. Sets
+    // truncated when more than limit entries matched.
+    std::vector<WasteEntry> range(const std::string& start, const std::string& end,
+                                  const std::string& foodType, size_t limit, bool& truncated) const;
+
+    size_t entryCount() const { return m_entries.size(); }
+
+private:
+    std::map<std::string, RollupSummary> m_days;    // Keyed by "YYYY-MM-DD"
+    RollupSummary m_allTime;                        // Includes entries without a valid timestamp
+    std::vector<WasteEntry> m_entries;              // Ordered by timestamp
+
+    // Summaries already merged for recent start dates, kept current by add().
+    // Dashboards ask for the same few periods over and over.
+    mutable std::map<std::string, RollupSummary> m_periodCache;
+};
+
+} // namespace Data
+
+#endif // WASTE_ROLLUP_H
@@ -3,8 +3,10 @@
  */
 
 #include "food_detector.h"
+#include "../utils/mapped_file.h"
+#include "../utils/logger.h"
 #include <fstream>
-#include <iostream>
+#include <filesystem>
 #include <chrono>
 #include <ctime>
 #include <iomanip>
@@ -12,6 +14,29 @@
 
 namespace Detection {
 
+namespace {
+
+// Parse the network straight from a read-only mapping of the file where the
+// format has a buffer loader; other formats go through the path loader
+cv::dnn::Net readNetMapped(const std::string& modelPath) {
+    std::string extension = std::filesystem::path(modelPath).extension().string();
+    if (extension != ".onnx" && extension != ".pb") {
+        return cv::dnn::readNet(modelPath);
+    }
+
+    Utils::MappedFile file;
+    if (!file.open(modelPath)) {
+        return cv::dnn::readNet(modelPath);
+    }
+
+    const char* data = reinterpret_cast<const char*>(file.data());
+    return extension == ".onnx" ?
+        cv::dnn::readNetFromONNX(data, file.size()) :
+        cv::dnn::readNetFromTensorflow(data, file.size());
+}
+
+} // namespace
+
 FoodDetector::FoodDetector(const std::string& modelPath,
                            const std::string& classesPath,
                            float confidenceThreshold)
@@ -19,7 +44,8 @@ FoodDetector::FoodDetector(const std::string& modelPath,
       m_nmsThreshold(0.4f),
       m_inputSize(416, 416),
       m_scale(1/255.0f),
-      m_mean(0, 0, 0) {
+      m_mean(0, 0, 0),
+      m_taskClass(Utils::TaskClass::REALTIME) {
 
     // Load the model and classes
     if (!loadModel(modelPath)) {
@@ -50,26 +76,18 @@ FoodDetector::FoodDetector(const std::string& modelPath,
         {"vegetable", 80.0f}
     };
 
-    std::cout << "Food detector initialized with " << m_classNames.size() << " classes" << std::endl;
+    Utils::logInfo("detector", "Food detector initialized with %zu classes", m_classNames.size());
 }
 
 DetectionResult FoodDetector::detectFoodWaste(const cv::Mat& frame) {
+    Utils::TraceSpan trace("FoodDetector::detectFoodWaste");
+
     if (frame.empty()) {
         return DetectionResult();
     }
 
-    // Pre-process the frame
-    cv::Mat blob = preProcessFrame(frame);
-
-    // Set the input to the network
-    m_net.setInput(blob);
-
-    // Forward pass - run the network
-    std::vector<cv::Mat> outputs;
-    m_net.forward(outputs, m_outputLayerNames);
-
     // Process the network outputs
-    DetectionResult result = processDetections(outputs, frame);
+    DetectionResult result = processDetections(runNetwork(frame), frame, m_confidenceThreshold, true);
 
     // Add timestamp to each detection
     auto now = std::chrono::system_clock::now();
@@ -85,6 +103,38 @@ DetectionResult FoodDetector::detectFoodWaste(const cv::Mat& frame) {
     return result;
 }
 
+DetectionResult FoodDetector::detectObjects(const cv::Mat& frame, float confidenceThreshold) {
+    if (frame.empty()) {
+        return DetectionResult();
+    }
+
+    return processDetections(runNetwork(frame), frame, confidenceThreshold, false);
+}
+
+std::vector<cv::Mat> FoodDetector::runNetwork(const cv::Mat& frame) {
+    Utils::ThreadPlacement::instance().bindCurrentThread(m_cpuSet, "inference");
+
+    // Pre-process the frame
+    cv::Mat blob;
+    {
+        Utils::TraceSpan trace("FoodDetector::preprocess");
+        Utils::ScopedTimer timer(m_metrics.preprocess);
+        blob = preProcessFrame(frame);
+    }
+
+    auto lock = Utils::traceLock(m_netMutex, "FoodDetector::waitForNet");
+    Utils::TraceSpan trace("FoodDetector::forward");
+    Utils::ScopedTimer timer(m_metrics.forward);
+
+    // Set the input to the network
+    m_net.setInput(blob);
+
+    // Forward pass - run the network
+    std::vector<cv::Mat> outputs;
+    m_net.forward(outputs, m_outputLayerNames);
+    return outputs;
+}
+
 cv::Mat FoodDetector::preProcessFrame(const cv::Mat& frame) {
     // Create a blob from the image
     cv::Mat blob = cv::dnn::blobFromImage(
@@ -99,41 +149,72 @@ cv::Mat FoodDetector::preProcessFrame(const cv::Mat& frame) {
     return blob;
 }
 
-DetectionResult FoodDetector::processDetections(const std::vector<cv::Mat>& outputs, const cv::Mat& frame) {
+DetectionResult FoodDetector::processDetections(const std::vector<cv::Mat>& outputs, const cv::Mat& frame,
+                                                float confidenceThreshold, bool wasteOnly) {
     DetectionResult results;
     std::vector<int> classIds;
     std::vector<float> confidences;
     std::vector<cv::Rect> boxes;
 
-    // Process each detection output
-    for (const auto& output : outputs) {
-        // Each row is a detection with classes scores
-        for (int i = 0; i < output.rows; i++) {
-            // Find the class with maximum score
-            cv::Mat scores = output.row(i).colRange(5, output.cols);
-            cv::Point classIdPoint;
-            double confidence;
-            cv::minMaxLoc(scores, nullptr, &confidence, nullptr, &classIdPoint);
-
-            if (confidence > m_confidenceThreshold) {
-                // Get the bounding box
-                int centerX = static_cast<int>(output.at<float>(i, 0) * frame.cols);
-                int centerY = static_cast<int>(output.at<float>(i, 1) * frame.rows);
-                int width = static_cast<int>(output.at<float>(i, 2) * frame.cols);
-                int height = static_cast<int>(output.at<float>(i, 3) * frame.rows);
-                int left = centerX - width / 2;
-                int top = centerY - height / 2;
-
-                classIds.push_back(classIdPoint.x);
-                confidences.push_back(static_cast<float>(confidence));
-                boxes.push_back(cv::Rect(left, top, width, height));
+    {
+        Utils::TraceSpan trace("FoodDetector::decode");
+        Utils::ScopedTimer timer(m_metrics.decode);
+
+        // Output layers decode independently on the scheduler; each fills
+        // its own lists, merged in layer order so NMS sees the same input
+        struct Candidates {
+            std::vector<int> classIds;
+            std::vector<float> confidences;
+            std::vector<cv::Rect> boxes;
+        };
+        std::vector<Candidates> perOutput(outputs.size());
+
+        Utils::TaskScheduler::instance().parallelFor(m_taskClass, outputs.size(), [&](size_t o) {
+            const cv::Mat& output = outputs[o];
+            Candidates& found = perOutput[o];
+
+            // Each row is a detection with classes scores
+            for (int i = 0; i < output.rows; i++) {
+                // Find the class with maximum score
+                cv::Mat scores = output.row(i).colRange(5, output.cols);
+                cv::Point classIdPoint;
+                double confidence;
+                cv::minMaxLoc(scores, nullptr, &confidence, nullptr, &classIdPoint);
+
+                if (confidence > confidenceThreshold) {
+                    // Get the bounding box
+                    int centerX = static_cast<int>(output.at<float>(i, 0) * frame.cols);
+                    int centerY = static_cast<int>(output.at<float>(i, 1) * frame.rows);
+                    int width = static_cast<int>(output.at<float>(i, 2) * frame.cols);
+                    int height = static_cast<int>(output.at<float>(i, 3) * frame.rows);
+                    int left = centerX - width / 2;
+                    int top = centerY - height / 2;
+
+                    found.classIds.push_back(classIdPoint.x);
+                    found.confidences.push_back(static_cast<float>(confidence));
+                    found.boxes.push_back(cv::Rect(left, top, width, height));
+                }
             }
+        });
+
+        for (const auto& found : perOutput) {
+            classIds.insert(classIds.end(), found.classIds.begin(), found.classIds.end());
+            confidences.insert(confidences.end(), found.confidences.begin(), found.confidences.end());
+            boxes.insert(boxes.end(), found.boxes.begin(), found.boxes.end());
         }
     }
 
     // Apply non-maximum suppression to remove overlapping boxes
     std::vector<int> indices;
-    cv::dnn::NMSBoxes(boxes, confidences, m_confidenceThreshold, m_nmsThreshold, indices);
+    {
+        Utils::TraceSpan trace("FoodDetector::nms");
+        Utils::ScopedTimer timer(m_metrics.nms);
+        cv::dnn::NMSBoxes(boxes, confidences, confidenceThreshold, m_nmsThreshold, indices);
+    }
+
+    // Waste classification and weight estimation, timed as one stage per frame
+    Utils::TraceSpan classificationTrace("FoodDetector::classifyWaste");
+    Utils::ScopedTimer classificationTimer(wasteOnly ? m_metrics.wasteClassification : nullptr);
 
     // Process the final detections
     for (size_t i = 0; i < indices.size(); i++) {
@@ -153,6 +234,11 @@ DetectionResult FoodDetector::processDetections(const std::vector<cv::Mat>& outp
             item.confidence = confidences[idx];
             item.boundingBox = box;
 
+            if (!wasteOnly) {
+                results.push_back(item);
+                continue;
+            }
+
             // Extract the ROI for waste classification
             cv::Mat roi = frame(box);
             item.isWaste = isWasteItem(roi, item.className);
@@ -169,6 +255,33 @@ DetectionResult FoodDetector::processDetections(const std::vector<cv::Mat>& outp
     return results;
 }
 
+void FoodDetector::setMetricsEnabled(bool enabled) {
+    if (!enabled) {
+        m_metrics = StageMetrics();
+        return;
+    }
+
+    auto& registry = Utils::MetricsRegistry::instance();
+    m_metrics.preprocess = &registry.histogram("detection_preprocess_seconds",
+                                               "Frame to network input blob conversion");
+    m_metrics.forward = &registry.histogram("detection_forward_seconds",
+                                            "Network forward pass");
+    m_metrics.decode = &registry.histogram("detection_decode_seconds",
+                                           "Decoding network outputs into candidate boxes");
+    m_metrics.nms = &registry.histogram("detection_nms_seconds",
+                                        "Non-maximum suppression");
+    m_metrics.wasteClassification = &registry.histogram("detection_waste_classification_seconds",
+                                                        "Waste classification and weight estimation per frame");
+}
+
+void FoodDetector::setCpuSet(const Utils::CpuSet& cpus) {
+    m_cpuSet = cpus;
+}
+
+void FoodDetector::setTaskClass(Utils::TaskClass taskClass) {
+    m_taskClass = taskClass;
+}
+
 bool FoodDetector::isWasteItem(const cv::Mat& foodROI, const std::string& foodClass) const {
     // This is a simplified implementation
     // In a real-world scenario, you would use another classifier here
@@ -221,43 +334,59 @@ float FoodDetector::estimateWeight(const cv::Rect& bbox, const std::string& food
 
 bool FoodDetector::loadModel(const std::string& modelPath) {
     try {
-        // Load the network
-        m_net = cv::dnn::readNet(modelPath);
+        // Load the network outside the lock so running detection is not held up
+        cv::dnn::Net net = readNetMapped(modelPath);
 
         // Check if using CUDA is possible
         if (cv::cuda::getCudaEnabledDeviceCount() > 0) {
-            m_net.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
-            m_net.setPreferableTarget(cv::dnn::DNN_TARGET_CUDA);
-            std::cout << "Using CUDA for inference" << std::endl;
+            net.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
+            net.setPreferableTarget(cv::dnn::DNN_TARGET_CUDA);
+            Utils::logInfo("detector", "Using CUDA for inference");
         } else {
-            m_net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
-            m_net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
-            std::cout << "Using CPU for inference" << std::endl;
+            net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+            net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+            Utils::logInfo("detector", "Using CPU for inference");
         }
 
         // Get output layer names
-        m_outputLayerNames = m_net.getUnconnectedOutLayersNames();
+        std::vector<std::string> outputLayerNames = net.getUnconnectedOutLayersNames();
+
+        std::lock_guard<std::mutex> lock(m_netMutex);
+        m_net = net;
+        m_outputLayerNames = outputLayerNames;
+        m_modelPath = modelPath;
 
         return true;
     } catch (const cv::Exception& e) {
-        std::cerr << "Error loading model: " << e.what() << std::endl;
+        Utils::logError("detector", "Error loading model: %s", e.what());
         return false;
     }
 }
 
+std::string FoodDetector::getModelPath() const {
+    std::lock_guard<std::mutex> lock(m_netMutex);
+    return m_modelPath;
+}
+
+std::string FoodDetector::getClassesPath() const {
+    return m_classesPath;
+}
+
 bool FoodDetector::saveModel(const std::string& modelPath) {
     try {
         // For models that support serialization
+        std::lock_guard<std::mutex> lock(m_netMutex);
         m_net.save(modelPath);
-        std::cout << "Model saved to " << modelPath << std::endl;
+        Utils::logInfo("detector", "Model saved to %s", modelPath.c_str());
         return true;
     } catch (const cv::Exception& e) {
-        std::cerr << "Error saving model: " << e.what() << std::endl;
+        Utils::logError("detector", "Error saving model: %s", e.what());
         return false;
     }
 }
 
 void FoodDetector::updateModel(const cv::dnn::Net& newModel) {
+    std::lock_guard<std::mutex> lock(m_netMutex);
     m_net = newModel;
     m_outputLayerNames = m_net.getUnconnectedOutLayersNames();
 }
@@ -265,7 +394,7 @@ void FoodDetector::updateModel(const cv::dnn::Net& newModel) {
 bool FoodDetector::loadClasses(const std::string& classesPath) {
     std::ifstream file(classesPath);
     if (!file.is_open()) {
-        std::cerr << "Failed to open classes file: " << classesPath << std::endl;
+        Utils::logError("detector", "Failed to open classes file: %s", classesPath.c_str());
         return false;
     }
 
@@ -281,6 +410,7 @@ bool FoodDetector::loadClasses(const std::string& classesPath) {
         }
     }
 
+    m_classesPath = classesPath;
     return !m_classNames.empty();
 }
 
@@ -13,6 +13,11 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <mutex>
+#include "../utils/metrics.h"
+#include "../utils/trace.h"
+#include "../utils/thread_placement.h"
+#include "../utils/task_scheduler.h"
 
 namespace Detection {
 
@@ -40,8 +45,14 @@ public:
     // Core detection functions
     DetectionResult detectFoodWaste(const cv::Mat& frame);
 
+    // All detections above the given confidence, without the waste filter
+    // or weight estimate. Used for evaluating the model itself.
+    DetectionResult detectObjects(const cv::Mat& frame, float confidenceThreshold);
+
     // Model management
     bool loadModel(const std::string& modelPath);
+    std::string getModelPath() const;
+    std::string getClassesPath() const;
     bool saveModel(const std::string& modelPath);
     void updateModel(const cv::dnn::Net& newModel);
 
@@ -57,12 +68,37 @@ public:
     // Food waste estimation
     float estimateWeight(const cv::Rect& bbox, const std::string& foodClass) const;
 
+    // Record per-stage latency into the process metrics. Off by default so
+    // evaluation detectors don't mix into the live pipeline's numbers.
+    void setMetricsEnabled(bool enabled);
+
+    // Run inference on these CPUs: the calling thread is pinned on its next
+    // detection, and OpenCV threads it starts inherit the set. Empty = unpinned.
+    void setCpuSet(const Utils::CpuSet& cpus);
+
+    // Scheduler class the output decoding runs in: REALTIME by default,
+    // BACKGROUND for detectors that evaluate models off the frame loop
+    void setTaskClass(Utils::TaskClass taskClass);
+
 private:
+    // Latency histograms per pipeline stage; null while metrics are off
+    struct StageMetrics {
+        Utils::Histogram* preprocess = nullptr;
+        Utils::Histogram* forward = nullptr;
+        Utils::Histogram* decode = nullptr;
+        Utils::Histogram* nms = nullptr;
+        Utils::Histogram* wasteClassification = nullptr;
+    };
+
     // Pre-processing for detection
     cv::Mat preProcessFrame(const cv::Mat& frame);
 
+    // Run the network and return its raw output blobs
+    std::vector<cv::Mat> runNetwork(const cv::Mat& frame);
+
     // Post-processing of network outputs
-    DetectionResult processDetections(const std::vector<cv::Mat>& outputs, const cv::Mat& frame);
+    DetectionResult processDetections(const std::vector<cv::Mat>& outputs, const cv::Mat& frame,
+                                      float confidenceThreshold, bool wasteOnly);
 
     // Classification functions
     bool isWasteItem(const cv::Mat& foodROI, const std::string& foodClass) const;
@@ -70,8 +106,12 @@ private:
     // Load class names from file
     bool loadClasses(const std::string& classesPath);
 
-    // Deep neural network
+    // Deep neural network. The mutex lets another thread swap the model
+    // while detection is running.
     cv::dnn::Net m_net;
+    mutable std::mutex m_netMutex;
+    std::string m_modelPath;
+    std::string m_classesPath;
 
     // Detection parameters
     float m_confidenceThreshold;
@@ -90,6 +130,10 @@ private:
 
     // Output layer names
     std::vector<std::string> m_outputLayerNames;
+
+    StageMetrics m_metrics;
+    Utils::CpuSet m_cpuSet;
+    Utils::TaskClass m_taskClass;
 };
 
 } // namespace Detection
@@ -0,0 +1,204 @@
+/**
+ * Process Supervisor Implementation
+ */
+
+#include "process_supervisor.h"
+#include "../utils/logger.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <thread>
+
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+extern char** environ;
+
+namespace IPC {
+
+namespace {
+
+const std::chrono::milliseconds INITIAL_BACKOFF(500);
+const std::chrono::milliseconds MAX_BACKOFF(30000);
+
+// A child that ran this long before crashing is restarted without delay
+const std::chrono::seconds STABLE_RUN_TIME(60);
+
+const std::chrono::seconds STOP_GRACE_PERIOD(5);
+
+volatile std::sig_atomic_t s_stopRequested = 0;
+
+void onStopSignal(int) {
+    s_stopRequested = 1;
+}
+
+std::string currentExecutable() {
+#ifdef __linux__
+    char path[4096];
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length > 0) {
+        path[length] = '\0';
+        return path;
+    }
+#endif
+    return "food_waste_monitor";
+}
+
+std::string describeExit(int status) {
+    if (WIFEXITED(status)) {
+        return "exited with status " + std::to_string(WEXITSTATUS(status));
+    }
+    if (WIFSIGNALED(status)) {
+        return std::string("killed by ") + strsignal(WTERMSIG(status));
+    }
+    return "stopped";
+}
+
+} // namespace
+
+ProcessSupervisor::ProcessSupervisor()
+    : m_executable(currentExecutable()),
+      m_sessionEnded(false) {
+}
+
+ProcessSupervisor::~ProcessSupervisor() {
+    stop();
+}
+
+void ProcessSupervisor::addChild(const std::string& name, const std::vector<std::string>& arguments,
+                                 bool endsSession) {
+    Child child;
+    child.name = name;
+    child.arguments = arguments;
+    child.endsSession = endsSession;
+    child.pid = 0;
+    child.backoff = INITIAL_BACKOFF;
+    m_children.push_back(child);
+}
+
+bool ProcessSupervisor::start() {
+    bool ok = true;
+    for (Child& child : m_children) {
+        ok = spawn(child) && ok;
+    }
+    return ok;
+}
+
+bool ProcessSupervisor::spawn(Child& child) {
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(m_executable.c_str()));
+    for (const std::string& argument : child.arguments) {
+        argv.push_back(const_cast<char*>(argument.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = 0;
+    int result = posix_spawn(&pid, m_executable.c_str(), nullptr, nullptr, argv.data(), environ);
+    if (result != 0) {
+        Utils::logError("supervisor", "Could not start %s: %s", child.name.c_str(), strerror(result));
+        child.pid = 0;
+        child.restartAt = std::chrono::steady_clock::now() + child.backoff;
+        return false;
+    }
+
+    child.pid = pid;
+    child.startedAt = std::chrono::steady_clock::now();
+    Utils::logInfo("supervisor", "Started %s (pid %d)", child.name.c_str(), pid);
+    return true;
+}
+
+bool ProcessSupervisor::poll() {
+    if (m_sessionEnded) {
+        return false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    for (Child& child : m_children) {
+        if (child.pid > 0) {
+            int status = 0;
+            if (waitpid(child.pid, &status, WNOHANG) != child.pid) {
+                continue;   // Still running
+            }
+
+            if (child.endsSession && WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+                Utils::logInfo("supervisor", "%s exited, ending the session", child.name.c_str());
+                child.pid = 0;
+                m_sessionEnded = true;
+                return false;
+            }
+
+            // Crash loops back off; a child that ran for a while starts over
+            child.backoff = now - child.startedAt >= STABLE_RUN_TIME ?
+                INITIAL_BACKOFF : std::min(child.backoff * 2, MAX_BACKOFF);
+            child.restartAt = now + child.backoff;
+            Utils::logWarning("supervisor", "%s (pid %d) %s; restarting in %lld ms",
+                              child.name.c_str(), child.pid, describeExit(status).c_str(),
+                              static_cast<long long>(child.backoff.count()));
+            child.pid = 0;
+        }
+
+        if (child.pid == 0 && now >= child.restartAt) {
+            spawn(child);
+        }
+    }
+    return true;
+}
+
+void ProcessSupervisor::stop() {
+    for (Child& child : m_children) {
+        if (child.pid > 0) {
+            kill(child.pid, SIGTERM);
+        }
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + STOP_GRACE_PERIOD;
+    for (Child& child : m_children) {
+        while (child.pid > 0) {
+            pid_t reaped = waitpid(child.pid, nullptr, WNOHANG);
+            if (reaped == child.pid || (reaped < 0 && errno == ECHILD)) {
+                child.pid = 0;
+            } else if (std::chrono::steady_clock::now() >= deadline) {
+                Utils::logWarning("supervisor", "%s did not stop, killing it", child.name.c_str());
+                kill(child.pid, SIGKILL);
+                waitpid(child.pid, nullptr, 0);
+                child.pid = 0;
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+        }
+    }
+}
+
+void exitWithParent() {
+#ifdef __linux__
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+
+    // The parent may already have gone before the request took effect
+    if (getppid() == 1) {
+        raise(SIGTERM);
+    }
+#endif
+}
+
+void installStopHandler() {
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = onStopSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+}
+
+bool stopRequested() {
+    return s_stopRequested != 0;
+}
+
+} // namespace IPC
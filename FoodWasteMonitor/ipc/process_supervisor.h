@@ -0,0 +1,67 @@
+/**
+ * Process Supervisor Header
+ *
+ * Starts the inference workers and the aggregator as child processes of
+ * the capture process and restarts any that crash
+ */
+
+#ifndef PROCESS_SUPERVISOR_H
+#define PROCESS_SUPERVISOR_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+namespace IPC {
+
+class ProcessSupervisor {
+public:
+    ProcessSupervisor();
+    ~ProcessSupervisor();
+
+    ProcessSupervisor(const ProcessSupervisor&) = delete;
+    ProcessSupervisor& operator=(const ProcessSupervisor&) = delete;
+
+    // Run this executable again with the given arguments. A child marked
+    // endsSession stops the whole session when it exits cleanly (the UI
+    // being closed); any other exit is a crash and the child is restarted.
+    void addChild(const std::string& name, const std::vector<std::string>& arguments,
+                  bool endsSession = false);
+
+    bool start();
+
+    // Reap exited children and restart crashed ones, backing off when a
+    // child keeps crashing. Returns false once the session has ended.
+    bool poll();
+
+    // SIGTERM every child, then SIGKILL those still running after the grace period
+    void stop();
+
+private:
+    struct Child {
+        std::string name;
+        std::vector<std::string> arguments;
+        bool endsSession;
+        int pid;
+        std::chrono::milliseconds backoff;
+        std::chrono::steady_clock::time_point startedAt;
+        std::chrono::steady_clock::time_point restartAt;
+    };
+
+    bool spawn(Child& child);
+
+    std::string m_executable;
+    std::vector<Child> m_children;
+    bool m_sessionEnded;
+};
+
+// Child side: exit when the supervising process dies (Linux only)
+void exitWithParent();
+
+// SIGINT and SIGTERM request a clean shutdown instead of killing the process
+void installStopHandler();
+bool stopRequested();
+
+} // namespace IPC
+
+#endif // PROCESS_SUPERVISOR_H
@@ -0,0 +1,565 @@
+/**
+ * Shared Frame Ring Implementation
+ */
+
+#include "shared_frame_ring.h"
+#include "../utils/logger.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <cerrno>
+#include <fstream>
+#include <new>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace IPC {
+
+namespace {
+
+const uint32_t RING_MAGIC = 0x46574652;     // "FWFR"
+const uint32_t RING_VERSION = 1;
+
+// Slot states
+const uint32_t SLOT_FREE = 0;
+const uint32_t SLOT_WRITING = 1;
+const uint32_t SLOT_READY = 2;
+const uint32_t SLOT_PROCESSING = 3;
+const uint32_t SLOT_DONE = 4;
+const uint32_t SLOT_CONSUMING = 5;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+              std::atomic<uint32_t>::is_always_lock_free &&
+              std::atomic<int32_t>::is_always_lock_free,
+              "The ring is shared between processes and needs address-free atomics");
+
+size_t roundUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+int64_t steadyNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Exited but not yet reaped processes count as dead
+bool processAlive(int32_t pid) {
+    if (pid <= 0 || (kill(pid, 0) != 0 && errno == ESRCH)) {
+        return false;
+    }
+
+    std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+    std::string line;
+    if (!std::getline(stat, line)) {
+        return true;
+    }
+    size_t paren = line.rfind(')');
+    return paren == std::string::npos || paren + 2 >= line.size() || line[paren + 2] != 'Z';
+}
+
+} // namespace
+
+// Bounded multi-producer multi-consumer queue of slot indices (Vyukov).
+// Every slot is in at most one queue, so a queue never fills up.
+struct DescriptorQueue {
+    static constexpr uint64_t CAPACITY = SharedFrameRing::MAX_SLOTS;
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "Capacity must be a power of two");
+
+    struct Cell {
+        std::atomic<uint64_t> sequence;
+        uint32_t slot;
+    };
+
+    alignas(64) std::atomic<uint64_t> enqueuePosition;
+    alignas(64) std::atomic<uint64_t> dequeuePosition;
+    alignas(64) Cell cells[CAPACITY];
+
+    void init() {
+        for (uint64_t i = 0; i < CAPACITY; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        enqueuePosition.store(0, std::memory_order_relaxed);
+        dequeuePosition.store(0, std::memory_order_relaxed);
+    }
+
+    bool push(uint32_t slot) {
+        uint64_t position = enqueuePosition.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[position & (CAPACITY - 1)];
+            uint64_t sequence = cell.sequence.load(std::memory_order_acquire);
+            int64_t difference = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+            if (difference == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.slot = slot;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(uint32_t& slot) {
+        uint64_t position = dequeuePosition.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[position & (CAPACITY - 1)];
+            uint64_t sequence = cell.sequence.load(std::memory_order_acquire);
+            int64_t difference = static_cast<int64_t>(sequence) - static_cast<int64_t>(position + 1);
+            if (difference == 0) {
+                if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot = cell.slot;
+                    cell.sequence.store(position + CAPACITY, std::memory_order_release);
+                    return true;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+struct SlotDetection {
+    char className[32];
+    float confidence;
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+    float estimatedWeight;
+    uint8_t isWaste;
+};
+
+struct SlotHeader {
+    std::atomic<uint32_t> state;
+    std::atomic<int32_t> ownerPid;
+
+    // Written by whoever holds the slot
+    uint64_t frameId;
+    int64_t captureTimeNs;
+    int32_t rows;
+    int32_t cols;
+    int32_t type;
+    uint64_t step;
+    double inferenceMs;
+    int32_t workerPid;
+    int32_t detectionCount;
+    SlotDetection detections[SharedFrameRing::MAX_DETECTIONS];
+};
+
+// Lives at the start of the shared memory; slot pixels follow at dataOffset
+struct RingHeader {
+    std::atomic<uint32_t> magic;    // Set last, once everything else is initialised
+    uint32_t version;
+    uint32_t slotCount;
+    int32_t ownerPid;
+    uint64_t slotBytes;
+    uint64_t dataOffset;
+    uint64_t totalBytes;
+
+    std::atomic<uint64_t> framesWritten;
+    std::atomic<uint64_t> framesDropped;
+    std::atomic<uint64_t> resultsDropped;
+    std::atomic<uint64_t> slotsReclaimed;
+
+    // Counts of queued frames and results, for waiting without spinning.
+    // They can run ahead of the queues when the capture process reuses a
+    // queued slot; waiters simply find the queue empty and wait again.
+    sem_t framesQueued;
+    sem_t resultsQueued;
+
+    DescriptorQueue freeSlots;
+    DescriptorQueue readySlots;
+    DescriptorQueue doneSlots;
+
+    SlotHeader slots[SharedFrameRing::MAX_SLOTS];
+};
+
+SharedFrameRing::SharedFrameRing()
+    : m_header(nullptr),
+      m_mappedBytes(0),
+      m_owner(false),
+      m_oversizedFrames(0) {
+}
+
+SharedFrameRing::~SharedFrameRing() {
+    close();
+}
+
+bool SharedFrameRing::create(const std::string& name, int slotCount, size_t maxFrameBytes) {
+    close();
+
+    slotCount = std::max(2, std::min(slotCount, MAX_SLOTS));
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t slotBytes = roundUp(std::max<size_t>(maxFrameBytes, 1), pageSize);
+    size_t dataOffset = roundUp(sizeof(RingHeader), pageSize);
+    size_t totalBytes = dataOffset + slotBytes * static_cast<size_t>(slotCount);
+
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        // Left behind by a previous capture process, unless that one is still running
+        SharedFrameRing previous;
+        if (previous.attach(name) && processAlive(previous.m_header->ownerPid)) {
+            Utils::logError("ipc", "Frame ring %s is in use by process %d",
+                            name.c_str(), previous.m_header->ownerPid);
+            return false;
+        }
+        previous.close();
+
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    }
+    if (fd < 0) {
+        Utils::logError("ipc", "Could not create frame ring %s: %s", name.c_str(), strerror(errno));
+        return false;
+    }
+
+    if (ftruncate(fd, static_cast<off_t>(totalBytes)) != 0 || !map(fd, totalBytes)) {
+        Utils::logError("ipc", "Could not size frame ring %s to %zu bytes", name.c_str(), totalBytes);
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    ::close(fd);
+
+    m_name = name;
+    m_owner = true;
+
+    RingHeader* header = new (m_header) RingHeader();
+    header->version = RING_VERSION;
+    header->slotCount = static_cast<uint32_t>(slotCount);
+    header->ownerPid = static_cast<int32_t>(getpid());
+    header->slotBytes = slotBytes;
+    header->dataOffset = dataOffset;
+    header->totalBytes = totalBytes;
+    header->framesWritten.store(0, std::memory_order_relaxed);
+    header->framesDropped.store(0, std::memory_order_relaxed);
+    header->resultsDropped.store(0, std::memory_order_relaxed);
+    header->slotsReclaimed.store(0, std::memory_order_relaxed);
+    sem_init(&header->framesQueued, 1, 0);
+    sem_init(&header->resultsQueued, 1, 0);
+
+    header->freeSlots.init();
+    header->readySlots.init();
+    header->doneSlots.init();
+    for (int i = 0; i < slotCount; i++) {
+        header->slots[i].state.store(SLOT_FREE, std::memory_order_relaxed);
+        header->slots[i].ownerPid.store(0, std::memory_order_relaxed);
+        header->freeSlots.push(static_cast<uint32_t>(i));
+    }
+
+    header->magic.store(RING_MAGIC, std::memory_order_release);
+
+    Utils::logInfo("ipc", "Created frame ring %s: %d slots of %zu KB",
+                   name.c_str(), slotCount, slotBytes / 1024);
+    return true;
+}
+
+bool SharedFrameRing::attach(const std::string& name) {
+    close();
+
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(RingHeader) ||
+        !map(fd, static_cast<size_t>(info.st_size))) {
+        ::close(fd);
+        return false;
+    }
+    ::close(fd);
+
+    // A ring still being initialised by its owner is not ready yet
+    if (m_header->magic.load(std::memory_order_acquire) != RING_MAGIC ||
+        m_header->version != RING_VERSION || m_header->totalBytes > m_mappedBytes) {
+        close();
+        return false;
+    }
+
+    m_name = name;
+    return true;
+}
+
+void SharedFrameRing::close() {
+    if (m_header == nullptr) {
+        return;
+    }
+
+    munmap(m_header, m_mappedBytes);
+    if (m_owner) {
+        shm_unlink(m_name.c_str());
+    }
+
+    m_header = nullptr;
+    m_mappedBytes = 0;
+    m_owner = false;
+}
+
+bool SharedFrameRing::map(int fd, size_t size) {
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    m_header = static_cast<RingHeader*>(mapping);
+    m_mappedBytes = size;
+    return true;
+}
+
+uint8_t* SharedFrameRing::slotData(int index) const {
+    return reinterpret_cast<uint8_t*>(m_header) + m_header->dataOffset +
+           static_cast<size_t>(index) * m_header->slotBytes;
+}
+
+bool SharedFrameRing::writeFrame(const cv::Mat& frame, int64_t captureTimeNs) {
+    if (m_header == nullptr || frame.empty()) {
+        return false;
+    }
+
+    size_t frameBytes = frame.total() * frame.elemSize();
+    if (frameBytes > m_header->slotBytes) {
+        if (m_oversizedFrames++ == 0) {
+            Utils::logWarning("ipc", "Frame of %zu bytes does not fit the %zu byte ring slots",
+                              frameBytes, static_cast<size_t>(m_header->slotBytes));
+        }
+        return false;
+    }
+
+    // Prefer a free slot; otherwise drop the oldest frame no worker has taken,
+    // then the oldest result the aggregator has not taken
+    uint32_t index = 0;
+    if (!m_header->freeSlots.pop(index)) {
+        if (m_header->readySlots.pop(index)) {
+            m_header->framesDropped.fetch_add(1, std::memory_order_relaxed);
+        } else if (m_header->doneSlots.pop(index)) {
+            m_header->resultsDropped.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            m_header->framesDropped.fetch_add(1, std::memory_order_relaxed);
+            return false;   // Every slot is being processed or displayed
+        }
+    }
+
+    SlotHeader& slot = m_header->slots[index];
+    slot.state.store(SLOT_WRITING, std::memory_order_relaxed);
+    slot.ownerPid.store(static_cast<int32_t>(getpid()), std::memory_order_relaxed);
+
+    cv::Mat view(frame.rows, frame.cols, frame.type(), slotData(static_cast<int>(index)));
+    frame.copyTo(view);
+
+    slot.frameId = m_header->framesWritten.fetch_add(1, std::memory_order_relaxed) + 1;
+    slot.captureTimeNs = captureTimeNs;
+    slot.rows = frame.rows;
+    slot.cols = frame.cols;
+    slot.type = frame.type();
+    slot.step = view.step;
+    slot.inferenceMs = 0.0;
+    slot.workerPid = 0;
+    slot.detectionCount = 0;
+
+    slot.ownerPid.store(0, std::memory_order_relaxed);
+    slot.state.store(SLOT_READY, std::memory_order_release);
+    m_header->readySlots.push(index);
+    sem_post(&m_header->framesQueued);
+    return true;
+}
+
+size_t SharedFrameRing::reclaimAbandonedSlots() {
+    if (m_header == nullptr) {
+        return 0;
+    }
+
+    // Only slots marked with an owner can be reclaimed. A process killed in
+    // the few instructions between taking a slot index off a queue and
+    // marking the slot leaks that slot until the ring is recreated.
+    size_t reclaimed = 0;
+    for (uint32_t i = 0; i < m_header->slotCount; i++) {
+        SlotHeader& slot = m_header->slots[i];
+        uint32_t state = slot.state.load(std::memory_order_acquire);
+
+        // Without a recorded owner there is nothing to tell a dead process by
+        int32_t owner = slot.ownerPid.load(std::memory_order_relaxed);
+        bool abandoned = (state == SLOT_PROCESSING || state == SLOT_CONSUMING) &&
+                         owner != 0 && !processAlive(owner);
+        if (abandoned && slot.state.compare_exchange_strong(state, SLOT_FREE, std::memory_order_acq_rel)) {
+            slot.ownerPid.store(0, std::memory_order_relaxed);
+            m_header->freeSlots.push(i);
+            reclaimed++;
+        }
+    }
+
+    if (reclaimed > 0) {
+        m_header->slotsReclaimed.fetch_add(reclaimed, std::memory_order_relaxed);
+        Utils::logWarning("ipc", "Reclaimed %zu frame slots from exited processes", reclaimed);
+    }
+    return reclaimed;
+}
+
+bool SharedFrameRing::waitForSlot(void* semaphore, int timeoutMs) const {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeoutMs / 1000;
+    deadline.tv_nsec += static_cast<long>(timeoutMs % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    while (sem_timedwait(static_cast<sem_t*>(semaphore), &deadline) != 0) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SharedFrameRing::takeFrame(FrameSlot& slot, int timeoutMs) {
+    if (m_header == nullptr) {
+        return false;
+    }
+
+    int64_t deadline = steadyNanoseconds() + static_cast<int64_t>(timeoutMs) * 1000000;
+    uint32_t index = 0;
+    while (!m_header->readySlots.pop(index)) {
+        int remainingMs = static_cast<int>((deadline - steadyNanoseconds()) / 1000000);
+        if (remainingMs <= 0 || !waitForSlot(&m_header->framesQueued, remainingMs)) {
+            return false;
+        }
+    }
+
+    SlotHeader& header = m_header->slots[index];
+    header.ownerPid.store(static_cast<int32_t>(getpid()), std::memory_order_relaxed);
+    header.state.store(SLOT_PROCESSING, std::memory_order_release);
+
+    slot.index = static_cast<int>(index);
+    slot.frame = cv::Mat(header.rows, header.cols, header.type, slotData(slot.index), header.step);
+    slot.frameId = header.frameId;
+    slot.captureTimeNs = header.captureTimeNs;
+    slot.inferenceMs = 0.0;
+    slot.workerPid = 0;
+    return true;
+}
+
+void SharedFrameRing::completeFrame(FrameSlot& slot, const Detection::DetectionResult& detections,
+                                    double inferenceMs) {
+    if (m_header == nullptr || slot.index < 0) {
+        return;
+    }
+
+    SlotHeader& header = m_header->slots[slot.index];
+    int count = std::min(static_cast<int>(detections.size()), MAX_DETECTIONS);
+    for (int i = 0; i < count; i++) {
+        const Detection::FoodItem& item = detections[i];
+        SlotDetection& encoded = header.detections[i];
+        std::strncpy(encoded.className, item.className.c_str(), sizeof(encoded.className) - 1);
+        encoded.className[sizeof(encoded.className) - 1] = '\0';
+        encoded.confidence = item.confidence;
+        encoded.x = item.boundingBox.x;
+        encoded.y = item.boundingBox.y;
+        encoded.width = item.boundingBox.width;
+        encoded.height = item.boundingBox.height;
+        encoded.estimatedWeight = item.estimatedWeight;
+        encoded.isWaste = item.isWaste ? 1 : 0;
+    }
+    header.detectionCount = count;
+    header.inferenceMs = inferenceMs;
+    header.workerPid = static_cast<int32_t>(getpid());
+
+    // The owner stays recorded until the state moves on, so the supervisor
+    // never sees a PROCESSING slot without one. A failed exchange means the
+    // slot was already reclaimed and queued again.
+    uint32_t expected = SLOT_PROCESSING;
+    if (!header.state.compare_exchange_strong(expected, SLOT_DONE, std::memory_order_acq_rel)) {
+        Utils::logWarning("ipc", "Frame slot %d was reclaimed while being processed", slot.index);
+        slot = FrameSlot();
+        return;
+    }
+    header.ownerPid.store(0, std::memory_order_relaxed);
+    m_header->doneSlots.push(static_cast<uint32_t>(slot.index));
+    sem_post(&m_header->resultsQueued);
+
+    slot = FrameSlot();
+}
+
+bool SharedFrameRing::takeResult(FrameSlot& slot, Detection::DetectionResult& detections, int timeoutMs) {
+    detections.clear();
+    if (m_header == nullptr) {
+        return false;
+    }
+
+    int64_t deadline = steadyNanoseconds() + static_cast<int64_t>(timeoutMs) * 1000000;
+    uint32_t index = 0;
+    while (!m_header->doneSlots.pop(index)) {
+        int remainingMs = static_cast<int>((deadline - steadyNanoseconds()) / 1000000);
+        if (remainingMs <= 0 || !waitForSlot(&m_header->resultsQueued, remainingMs)) {
+            return false;
+        }
+    }
+
+    SlotHeader& header = m_header->slots[index];
+    header.ownerPid.store(static_cast<int32_t>(getpid()), std::memory_order_relaxed);
+    header.state.store(SLOT_CONSUMING, std::memory_order_release);
+
+    slot.index = static_cast<int>(index);
+    slot.frame = cv::Mat(header.rows, header.cols, header.type, slotData(slot.index), header.step);
+    slot.frameId = header.frameId;
+    slot.captureTimeNs = header.captureTimeNs;
+    slot.inferenceMs = header.inferenceMs;
+    slot.workerPid = header.workerPid;
+
+    detections.reserve(header.detectionCount);
+    for (int i = 0; i < header.detectionCount; i++) {
+        const SlotDetection& encoded = header.detections[i];
+        Detection::FoodItem item;
+        item.className = encoded.className;
+        item.confidence = encoded.confidence;
+        item.boundingBox = cv::Rect(encoded.x, encoded.y, encoded.width, encoded.height);
+        item.estimatedWeight = encoded.estimatedWeight;
+        item.isWaste = encoded.isWaste != 0;
+        detections.push_back(item);
+    }
+    return true;
+}
+
+void SharedFrameRing::releaseSlot(FrameSlot& slot) {
+    if (m_header == nullptr || slot.index < 0) {
+        return;
+    }
+
+    SlotHeader& header = m_header->slots[slot.index];
+    uint32_t expected = SLOT_CONSUMING;
+    if (!header.state.compare_exchange_strong(expected, SLOT_FREE, std::memory_order_acq_rel)) {
+        Utils::logWarning("ipc", "Frame slot %d was reclaimed while being consumed", slot.index);
+        slot = FrameSlot();
+        return;
+    }
+    header.ownerPid.store(0, std::memory_order_relaxed);
+    m_header->freeSlots.push(static_cast<uint32_t>(slot.index));
+
+    slot = FrameSlot();
+}
+
+RingStats SharedFrameRing::getStats() const {
+    RingStats stats;
+    if (m_header != nullptr) {
+        stats.framesWritten = m_header->framesWritten.load(std::memory_order_relaxed);
+        stats.framesDropped = m_header->framesDropped.load(std::memory_order_relaxed);
+        stats.resultsDropped = m_header->resultsDropped.load(std::memory_order_relaxed);
+        stats.slotsReclaimed = m_header->slotsReclaimed.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+} // namespace IPC
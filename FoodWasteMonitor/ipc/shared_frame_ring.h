@@ -0,0 +1,116 @@
+/**
+ * Shared Frame Ring Header
+ *
+ * POSIX shared-memory ring of frame slots that carries camera frames from
+ * the capture process to inference workers and their detections on to the
+ * aggregator, without copying pixels between processes
+ */
+
+#ifndef SHARED_FRAME_RING_H
+#define SHARED_FRAME_RING_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+#include "../detection/food_detector.h"
+
+namespace IPC {
+
+struct RingHeader;
+
+// A frame slot held by the calling process. The frame is a view of the
+// shared memory and stays valid until the slot is handed on or released.
+struct FrameSlot {
+    int index;
+    cv::Mat frame;
+    uint64_t frameId;
+    int64_t captureTimeNs;      // System clock
+    double inferenceMs;         // Set once a worker has completed the frame
+    int workerPid;
+
+    FrameSlot()
+        : index(-1),
+          frameId(0),
+          captureTimeNs(0),
+          inferenceMs(0.0),
+          workerPid(0) {
+    }
+};
+
+struct RingStats {
+    uint64_t framesWritten;
+    uint64_t framesDropped;     // Overwritten before any worker took them
+    uint64_t resultsDropped;    // Completed but reused before the aggregator took them
+    uint64_t slotsReclaimed;    // Taken back from processes that died holding them
+
+    RingStats()
+        : framesWritten(0),
+          framesDropped(0),
+          resultsDropped(0),
+          slotsReclaimed(0) {
+    }
+};
+
+// Slots move FREE -> WRITING (capture) -> READY -> PROCESSING (worker) ->
+// DONE -> CONSUMING (aggregator) -> FREE, handed between processes through
+// lock-free descriptor queues of slot indices. The capture process never
+// waits: without a free slot it reuses the oldest unprocessed frame, then
+// the oldest unconsumed result.
+class SharedFrameRing {
+public:
+    static constexpr int MAX_SLOTS = 64;
+    static constexpr int MAX_DETECTIONS = 64;     // Per frame; further detections are dropped
+
+    SharedFrameRing();
+    ~SharedFrameRing();
+
+    SharedFrameRing(const SharedFrameRing&) = delete;
+    SharedFrameRing& operator=(const SharedFrameRing&) = delete;
+
+    // Create the ring as its owner (the capture process). A ring left
+    // behind by a crashed owner is replaced; one whose owner is alive is not.
+    bool create(const std::string& name, int slotCount, size_t maxFrameBytes);
+
+    // Map an existing ring (inference workers and the aggregator)
+    bool attach(const std::string& name);
+
+    // Unmap; the owner also removes the ring
+    void close();
+    bool isOpen() const { return m_header != nullptr; }
+
+    // Capture side. Copies the frame into a slot and queues it for the
+    // workers. Returns false if the frame does not fit or no slot is free.
+    bool writeFrame(const cv::Mat& frame, int64_t captureTimeNs);
+
+    // Capture side, from the writing thread: free slots held by processes
+    // that have exited, so a crashed worker or UI costs at most a frame
+    size_t reclaimAbandonedSlots();
+
+    // Worker side. Take the oldest queued frame, waiting up to timeoutMs.
+    bool takeFrame(FrameSlot& slot, int timeoutMs);
+    void completeFrame(FrameSlot& slot, const Detection::DetectionResult& detections, double inferenceMs);
+
+    // Aggregator side. Take the oldest completed frame with its detections.
+    bool takeResult(FrameSlot& slot, Detection::DetectionResult& detections, int timeoutMs);
+
+    // Return a taken slot to the capture process without passing it on
+    void releaseSlot(FrameSlot& slot);
+
+    RingStats getStats() const;
+
+private:
+    bool map(int fd, size_t size);
+    uint8_t* slotData(int index) const;
+    bool waitForSlot(void* semaphore, int timeoutMs) const;
+
+    std::string m_name;
+    RingHeader* m_header;
+    size_t m_mappedBytes;
+    bool m_owner;
+    uint64_t m_oversizedFrames;    // Frames that did not fit a slot, reported once
+};
+
+} // namespace IPC
+
+#endif // SHARED_FRAME_RING_H
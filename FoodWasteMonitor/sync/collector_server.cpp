@@ -0,0 +1,494 @@
+/**
+ * Collector Server Implementation
+ */
+
+#include "collector_server.h"
+#include "../utils/logger.h"
+#include "../utils/metrics.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace Sync {
+
+namespace {
+
+const int ACCEPT_POLL_MS = 250;
+const int HANDSHAKE_TIMEOUT_MS = 10000;
+const size_t MAX_SITE_ID_LENGTH = 64;
+
+json summaryToJson(const Data::RollupSummary& summary) {
+    json byType = json::object();
+    for (const auto& type : summary.byType) {
+        byType[type.first] = {{"weight", type.second.weight}, {"items", type.second.items}};
+    }
+    json byMeal = json::object();
+    for (const auto& meal : summary.byMeal) {
+        byMeal[meal.first] = {{"weight", meal.second.weight}, {"items", meal.second.items}};
+    }
+    return {
+        {"total_weight", summary.total.weight},
+        {"total_items", summary.total.items},
+        {"by_type", byType},
+        {"by_meal", byMeal}
+    };
+}
+
+std::string utcTimestamp() {
+    std::time_t now = std::time(nullptr);
+    std::tm utc = {};
+    gmtime_r(&now, &utc);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+    return buffer;
+}
+
+} // namespace
+
+CollectorServer::CollectorServer(const CollectorConfig& config)
+    : m_config(config),
+      m_listenFd(-1),
+      m_port(config.port),
+      m_running(false) {
+}
+
+CollectorServer::~CollectorServer() {
+    stop();
+}
+
+bool CollectorServer::isValidSiteId(const std::string& siteId) {
+    if (siteId.empty() || siteId.size() > MAX_SITE_ID_LENGTH || siteId[0] == '.') {
+        return false;
+    }
+    return std::all_of(siteId.begin(), siteId.end(), [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '_' || c == '-';
+    });
+}
+
+std::string CollectorServer::siteDirectory(const std::string& siteId) const {
+    return (fs::path(m_config.storePath) / "sites" / siteId).string();
+}
+
+bool CollectorServer::start() {
+    if (m_running) {
+        return true;
+    }
+
+    // Rebuild every site's state from its log
+    try {
+        fs::path sitesPath = fs::path(m_config.storePath) / "sites";
+        fs::create_directories(sitesPath);
+        for (const auto& entry : fs::directory_iterator(sitesPath)) {
+            std::string siteId = entry.path().filename().string();
+            if (entry.is_directory() && isValidSiteId(siteId) && !loadSite(siteId)) {
+                return false;
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        Utils::logError("collector", "Cannot read the store at %s: %s", m_config.storePath.c_str(), e.what());
+        return false;
+    }
+
+    m_listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_listenFd < 0) {
+        Utils::logError("collector", "Failed to create the listening socket: %s", strerror(errno));
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(m_config.port));
+    socklen_t addressLength = sizeof(address);
+    if (inet_pton(AF_INET, m_config.bindAddress.c_str(), &address.sin_addr) != 1 ||
+        bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(m_listenFd, SOMAXCONN) != 0 ||
+        getsockname(m_listenFd, reinterpret_cast<sockaddr*>(&address), &addressLength) != 0) {
+        Utils::logError("collector", "Failed to listen on %s:%d: %s", m_config.bindAddress.c_str(),
+                        m_config.port, strerror(errno));
+        close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+    m_port = ntohs(address.sin_port);
+
+    m_running = true;
+    m_acceptThread = std::thread(&CollectorServer::acceptLoop, this);
+
+    Utils::logInfo("collector", "Collecting on %s:%d into %s (%zu sites)", m_config.bindAddress.c_str(),
+                   m_port, m_config.storePath.c_str(), m_sites.size());
+    return true;
+}
+
+void CollectorServer::stop() {
+    if (!m_running && !m_acceptThread.joinable()) {
+        return;
+    }
+
+    m_running = false;
+    if (m_acceptThread.joinable()) {
+        m_acceptThread.join();
+    }
+
+    // Unblock connection threads waiting for their site's next message
+    for (const auto& connection : m_connections) {
+        shutdown(connection->fd, SHUT_RDWR);
+    }
+    reapConnections(true);
+
+    if (m_listenFd >= 0) {
+        close(m_listenFd);
+        m_listenFd = -1;
+    }
+
+    writeRollup();
+
+    std::lock_guard<std::mutex> lock(m_sitesMutex);
+    m_sites.clear();
+}
+
+bool CollectorServer::loadSite(const std::string& siteId) {
+    auto site = std::make_unique<Site>();
+    site->id = siteId;
+    if (!site->log.open(siteDirectory(siteId))) {
+        return false;
+    }
+
+    std::string payload;
+    uint64_t offset = site->log.startOffset();
+    uint64_t nextOffset = 0;
+    while (site->log.read(offset, payload, nextOffset)) {
+        Batch batch;
+        if (decodeBatch(payload, batch)) {
+            applyBatch(*site, batch);
+        } else {
+            Utils::logWarning("collector", "Skipping an unreadable batch of site %s", siteId.c_str());
+        }
+        offset = nextOffset;
+    }
+
+    Utils::logInfo("collector", "Loaded site %s: %llu entries up to offset %llu", siteId.c_str(),
+                   static_cast<unsigned long long>(site->entries),
+                   static_cast<unsigned long long>(site->committedOffset));
+
+    std::lock_guard<std::mutex> lock(m_sitesMutex);
+    m_sites[siteId] = std::move(site);
+    return true;
+}
+
+CollectorServer::Site* CollectorServer::claimSite(const std::string& siteId, std::string& error) {
+    if (!isValidSiteId(siteId)) {
+        error = "invalid site id";
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(m_sitesMutex);
+    auto existing = m_sites.find(siteId);
+    if (existing == m_sites.end()) {
+        auto site = std::make_unique<Site>();
+        site->id = siteId;
+        if (!site->log.open(siteDirectory(siteId))) {
+            error = "cannot create the site store";
+            return nullptr;
+        }
+        existing = m_sites.emplace(siteId, std::move(site)).first;
+        Utils::logInfo("collector", "New site %s", siteId.c_str());
+    }
+
+    // One connection per site keeps its batches in order
+    if (existing->second->connected) {
+        error = "site is already connected";
+        return nullptr;
+    }
+    existing->second->connected = true;
+    return existing->second.get();
+}
+
+void CollectorServer::releaseSite(Site* site) {
+    std::lock_guard<std::mutex> lock(m_sitesMutex);
+    site->connected = false;
+}
+
+void CollectorServer::acceptLoop() {
+    static Utils::RateLimit rejectLog(1, std::chrono::seconds(10));
+    auto lastRollup = std::chrono::steady_clock::now();
+
+    while (m_running) {
+        pollfd listener = {m_listenFd, POLLIN, 0};
+        if (poll(&listener, 1, ACCEPT_POLL_MS) > 0) {
+            int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0 && static_cast<int>(m_connections.size()) >= m_config.maxConnections) {
+                Utils::logRateLimited(rejectLog, Utils::LogLevel::WARNING, "collector",
+                                      "Refusing a connection: %d connections open", m_config.maxConnections);
+                close(fd);
+            } else if (fd >= 0) {
+                int noDelay = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+                auto connection = std::make_unique<Connection>();
+                connection->fd = fd;
+                Connection* started = connection.get();
+                m_connections.push_back(std::move(connection));
+                started->thread = std::thread(&CollectorServer::serveConnection, this, started);
+            }
+        }
+
+        reapConnections(false);
+
+        auto now = std::chrono::steady_clock::now();
+        if (m_config.rollupIntervalMs > 0 &&
+            now - lastRollup >= std::chrono::milliseconds(m_config.rollupIntervalMs)) {
+            writeRollup();
+            lastRollup = now;
+        }
+    }
+}
+
+void CollectorServer::reapConnections(bool all) {
+    for (auto connection = m_connections.begin(); connection != m_connections.end(); ) {
+        if (all || (*connection)->finished) {
+            if ((*connection)->thread.joinable()) {
+                (*connection)->thread.join();
+            }
+            close((*connection)->fd);
+            connection = m_connections.erase(connection);
+        } else {
+            ++connection;
+        }
+    }
+}
+
+void CollectorServer::serveConnection(Connection* connection) {
+    int fd = connection->fd;
+    MessageType type;
+    std::string payload;
+
+    setSocketTimeout(fd, HANDSHAKE_TIMEOUT_MS);
+    uint32_t version = 0;
+    std::string siteId;
+    if (!receiveMessage(fd, type, payload) || type != MessageType::HELLO) {
+        connection->finished = true;
+        return;
+    }
+
+    ByteReader hello(payload);
+    if (!hello.u32(version) || !hello.string(siteId) || version != PROTOCOL_VERSION) {
+        sendMessage(fd, MessageType::REJECT, "unsupported protocol version");
+        connection->finished = true;
+        return;
+    }
+
+    std::string error;
+    Site* site = claimSite(siteId, error);
+    if (!site) {
+        sendMessage(fd, MessageType::REJECT, error);
+        connection->finished = true;
+        return;
+    }
+
+    uint64_t committedOffset;
+    {
+        std::lock_guard<std::mutex> lock(site->mutex);
+        committedOffset = site->committedOffset;
+    }
+
+    setSocketTimeout(fd, m_config.idleTimeoutMs);
+    bool open = sendMessage(fd, MessageType::WELCOME, encodeOffset(committedOffset));
+    while (open && m_running && receiveMessage(fd, type, payload)) {
+        if (type == MessageType::BATCH) {
+            if (!storeBatch(*site, payload, error)) {
+                Utils::logWarning("collector", "Rejected a batch from %s: %s", siteId.c_str(), error.c_str());
+                sendMessage(fd, MessageType::REJECT, error);
+                break;
+            }
+        } else if (type != MessageType::PING) {
+            sendMessage(fd, MessageType::REJECT, "unexpected message");
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(site->mutex);
+            committedOffset = site->committedOffset;
+        }
+        open = sendMessage(fd, MessageType::ACK, encodeOffset(committedOffset));
+    }
+
+    releaseSite(site);
+    connection->finished = true;
+}
+
+bool CollectorServer::storeBatch(Site& site, const std::string& payload, std::string& error) {
+    static auto& storeTime = Utils::MetricsRegistry::instance().histogram(
+        "collector_store_seconds", "Storing one site batch durably before acknowledging it");
+    static auto& storedEntries = Utils::MetricsRegistry::instance().counter(
+        "collector_entries_stored_total", "Waste entries stored from all sites");
+    Utils::ScopedTimer timer(storeTime);
+
+    uint64_t startOffset = 0;
+    uint64_t endOffset = 0;
+    if (!decodeBatchRange(payload, startOffset, endOffset)) {
+        error = "malformed batch";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(site.mutex);
+
+    // Already stored, or overlapping what is: the acknowledgement tells the
+    // site where to resume
+    if (startOffset < site.committedOffset) {
+        return true;
+    }
+    if (startOffset > site.committedOffset) {
+        Utils::logWarning("collector", "Site %s skipped offsets %llu to %llu", site.id.c_str(),
+                          static_cast<unsigned long long>(site.committedOffset),
+                          static_cast<unsigned long long>(startOffset));
+    }
+
+    Batch batch;
+    if (!decodeBatch(payload, batch)) {
+        error = "corrupt batch";
+        return false;
+    }
+    if (!site.log.append(payload) || !site.log.sync()) {
+        error = "cannot write the site store";
+        return false;
+    }
+
+    applyBatch(site, batch);
+    storedEntries.increment(batch.entries.size());
+    return true;
+}
+
+void CollectorServer::applyBatch(Site& site, const Batch& batch) {
+    for (const auto& delta : batch.deltas) {
+        Data::RollupSummary& day = site.days[delta.date];
+        day.total.add(delta.totals.weight, delta.totals.items);
+        day.byType[delta.foodType].add(delta.totals.weight, delta.totals.items);
+        day.byMeal[delta.mealPeriod].add(delta.totals.weight, delta.totals.items);
+    }
+    site.entries += batch.entries.size();
+    site.batches++;
+    site.committedOffset = batch.endOffset;
+}
+
+std::vector<SiteStatus> CollectorServer::getSites() const {
+    std::lock_guard<std::mutex> sitesLock(m_sitesMutex);
+
+    std::vector<SiteStatus> sites;
+    for (const auto& entry : m_sites) {
+        const Site& site = *entry.second;
+        std::lock_guard<std::mutex> lock(site.mutex);
+
+        SiteStatus status;
+        status.siteId = site.id;
+        status.committedOffset = site.committedOffset;
+        status.entries = site.entries;
+        status.batches = site.batches;
+        status.connected = site.connected;
+        sites.push_back(status);
+    }
+    return sites;
+}
+
+std::string CollectorServer::renderRollup() const {
+    std::lock_guard<std::mutex> sitesLock(m_sitesMutex);
+
+    std::map<std::string, Data::RollupSummary> campus;
+    json sites = json::object();
+    for (const auto& entry : m_sites) {
+        const Site& site = *entry.second;
+        std::lock_guard<std::mutex> lock(site.mutex);
+
+        json days = json::object();
+        for (const auto& day : site.days) {
+            days[day.first] = summaryToJson(day.second);
+            campus[day.first].merge(day.second);
+        }
+        sites[site.id] = {
+            {"committed_offset", site.committedOffset},
+            {"entries", site.entries},
+            {"batches", site.batches},
+            {"connected", site.connected},
+            {"days", days}
+        };
+    }
+
+    json campusDays = json::object();
+    for (const auto& day : campus) {
+        campusDays[day.first] = summaryToJson(day.second);
+    }
+
+    json rollup;
+    rollup["generated_at"] = utcTimestamp();
+    rollup["sites"] = sites;
+    rollup["campus"] = campusDays;
+    return rollup.dump(2);
+}
+
+bool CollectorServer::writeRollup() const {
+    fs::path path = fs::path(m_config.storePath) / "campus_rollup.json";
+    std::string tempPath = path.string() + ".tmp";
+    try {
+        {
+            std::ofstream file(tempPath, std::ios::trunc);
+            if (!file.is_open()) {
+                return false;
+            }
+            file << renderRollup() << std::endl;
+            if (!file) {
+                return false;
+            }
+        }
+        fs::rename(tempPath, path);
+        return true;
+    }
+    catch (const std::exception& e) {
+        Utils::logError("collector", "Cannot write %s: %s", path.string().c_str(), e.what());
+        return false;
+    }
+}
+
+bool CollectorServer::readSiteEntries(const std::string& siteId, std::vector<Data::WasteEntry>& entries) const {
+    std::lock_guard<std::mutex> sitesLock(m_sitesMutex);
+    auto found = m_sites.find(siteId);
+    if (found == m_sites.end()) {
+        return false;
+    }
+
+    const Site& site = *found->second;
+    std::lock_guard<std::mutex> lock(site.mutex);
+
+    std::string payload;
+    uint64_t offset = site.log.startOffset();
+    uint64_t nextOffset = 0;
+    while (site.log.read(offset, payload, nextOffset)) {
+        Batch batch;
+        if (decodeBatch(payload, batch)) {
+            entries.insert(entries.end(), batch.entries.begin(), batch.entries.end());
+        }
+        offset = nextOffset;
+    }
+    return true;
+}
+
+} // namespace Sync
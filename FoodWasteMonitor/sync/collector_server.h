@@ -0,0 +1,130 @@
+/**
+ * Collector Server Header
+ *
+ * Campus side of sync: accepts entry batches from many dining hall
+ * monitors at once, stores each site's batches in its own append log
+ * before acknowledging them, and keeps campus-wide per-day rollups from
+ * the deltas that come with them
+ */
+
+#ifndef COLLECTOR_SERVER_H
+#define COLLECTOR_SERVER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include "sync_protocol.h"
+#include "../utils/append_log.h"
+
+namespace Sync {
+
+struct CollectorConfig {
+    std::string bindAddress;
+    int port;                       // 0 = any free port, see getPort()
+    std::string storePath;
+    int maxConnections;
+    int idleTimeoutMs;              // Sites ping well inside this
+    int rollupIntervalMs;           // How often campus_rollup.json is rewritten (0 = on stop only)
+
+    CollectorConfig()
+        : bindAddress("0.0.0.0"),
+          port(7070),
+          storePath("collector"),
+          maxConnections(256),
+          idleTimeoutMs(60000),
+          rollupIntervalMs(10000) {
+    }
+};
+
+struct SiteStatus {
+    std::string siteId;
+    uint64_t committedOffset;
+    uint64_t entries;
+    uint64_t batches;
+    bool connected;
+
+    SiteStatus() : committedOffset(0), entries(0), batches(0), connected(false) {}
+};
+
+class CollectorServer {
+public:
+    explicit CollectorServer(const CollectorConfig& config);
+    ~CollectorServer();
+
+    CollectorServer(const CollectorServer&) = delete;
+    CollectorServer& operator=(const CollectorServer&) = delete;
+
+    // Load the sites already in the store, then listen
+    bool start();
+    void stop();
+
+    int getPort() const { return m_port; }
+    std::vector<SiteStatus> getSites() const;
+
+    // Per-day totals by site and for the whole campus, as JSON
+    std::string renderRollup() const;
+    bool writeRollup() const;
+
+    // Every entry stored for a site, oldest first
+    bool readSiteEntries(const std::string& siteId, std::vector<Data::WasteEntry>& entries) const;
+
+    // Site ids name directories: letters, digits, '.', '_' and '-'
+    static bool isValidSiteId(const std::string& siteId);
+
+private:
+    struct Site {
+        std::string id;
+        Utils::AppendLog log;                       // One record per stored BATCH payload
+        uint64_t committedOffset;                   // End of the site's log stored so far
+        uint64_t entries;
+        uint64_t batches;
+        bool connected;                             // Guarded by m_sitesMutex
+        std::map<std::string, Data::RollupSummary> days;
+        mutable std::mutex mutex;
+
+        Site() : committedOffset(0), entries(0), batches(0), connected(false) {}
+    };
+
+    struct Connection {
+        int fd;
+        std::thread thread;
+        std::atomic<bool> finished;
+
+        Connection() : fd(-1), finished(false) {}
+    };
+
+    bool loadSite(const std::string& siteId);
+    Site* claimSite(const std::string& siteId, std::string& error);
+    void releaseSite(Site* site);
+
+    void acceptLoop();
+    void serveConnection(Connection* connection);
+    bool storeBatch(Site& site, const std::string& payload, std::string& error);
+    static void applyBatch(Site& site, const Batch& batch);
+
+    // Join finished connection threads, or all of them
+    void reapConnections(bool all);
+
+    std::string siteDirectory(const std::string& siteId) const;
+
+    CollectorConfig m_config;
+    int m_listenFd;
+    int m_port;
+    std::atomic<bool> m_running;
+    std::thread m_acceptThread;
+
+    mutable std::mutex m_sitesMutex;
+    std::map<std::string, std::unique_ptr<Site>> m_sites;
+
+    std::list<std::unique_ptr<Connection>> m_connections;     // Accept thread and stop() only
+};
+
+} // namespace Sync
+
+#endif // COLLECTOR_SERVER_H
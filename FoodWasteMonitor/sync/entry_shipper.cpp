@@ -0,0 +1,323 @@
+/**
+ * Entry Shipper Implementation
+ */
+
+#include "entry_shipper.h"
+#include "sync_protocol.h"
+#include "../utils/logger.h"
+#include "../utils/metrics.h"
+#include <algorithm>
+#include <cstring>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace Sync {
+
+namespace {
+
+const std::chrono::milliseconds INITIAL_BACKOFF(500);
+const std::chrono::milliseconds MAX_BACKOFF(30000);
+
+} // namespace
+
+EntryShipper::EntryShipper(std::shared_ptr<Utils::AppendLog> log, const ShipperConfig& config)
+    : m_log(log),
+      m_config(config),
+      m_running(false),
+      m_woken(false) {
+}
+
+EntryShipper::~EntryShipper() {
+    stop();
+}
+
+bool EntryShipper::start() {
+    if (m_running) {
+        return true;
+    }
+    if (!m_log || !m_log->isOpen() || m_config.collectorHost.empty() || m_config.siteId.empty()) {
+        Utils::logError("sync", "Shipping needs an open log, a collector address and a site id");
+        return false;
+    }
+
+    m_running = true;
+    m_thread = std::thread(&EntryShipper::run, this);
+    Utils::logInfo("sync", "Shipping entries of site %s to %s:%d", m_config.siteId.c_str(),
+                   m_config.collectorHost.c_str(), m_config.collectorPort);
+    return true;
+}
+
+void EntryShipper::stop() {
+    m_running = false;
+    notify();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void EntryShipper::notify() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_woken = true;
+    }
+    m_wakeCondition.notify_one();
+}
+
+ShipperStats EntryShipper::getStats() const {
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_stats;
+}
+
+void EntryShipper::waitUntil(std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    m_wakeCondition.wait_until(lock, deadline, [this]() { return m_woken || !m_running; });
+    m_woken = false;
+}
+
+void EntryShipper::run() {
+    static Utils::RateLimit connectFailureLog(1, std::chrono::seconds(60));
+    std::chrono::milliseconds backoff = INITIAL_BACKOFF;
+
+    while (m_running) {
+        uint64_t committedOffset = 0;
+        int fd = connectToCollector(committedOffset);
+        if (fd < 0) {
+            Utils::logRateLimited(connectFailureLog, Utils::LogLevel::WARNING, "sync",
+                                  "Collector %s:%d unavailable; retrying in %lld ms",
+                                  m_config.collectorHost.c_str(), m_config.collectorPort,
+                                  static_cast<long long>(backoff.count()));
+            waitUntil(std::chrono::steady_clock::now() + backoff);
+            backoff = std::min(backoff * 2, MAX_BACKOFF);
+            continue;
+        }
+
+        uint64_t startOffset = m_log->startOffset();
+        uint64_t endOffset = m_log->endOffset();
+        if (committedOffset > endOffset) {
+            // Shipping only synced records means this is another site's
+            // data under the same id, or a log that was deleted
+            Utils::logError("sync", "Collector holds %llu bytes for site %s but the log ends at %llu; not shipping",
+                            static_cast<unsigned long long>(committedOffset), m_config.siteId.c_str(),
+                            static_cast<unsigned long long>(endOffset));
+            close(fd);
+            waitUntil(std::chrono::steady_clock::now() + MAX_BACKOFF);
+            continue;
+        }
+        if (committedOffset < startOffset) {
+            Utils::logWarning("sync", "Entries up to offset %llu were deleted before the collector stored them",
+                              static_cast<unsigned long long>(startOffset));
+            committedOffset = startOffset;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            m_stats.connected = true;
+            m_stats.acknowledgedOffset = committedOffset;
+        }
+
+        bool ended = shipBatches(fd, committedOffset);
+        close(fd);
+
+        bool progressed;
+        {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            progressed = m_stats.acknowledgedOffset > committedOffset;
+            m_stats.connected = false;
+            m_stats.reconnects += ended ? 0 : 1;
+        }
+
+        // A session that stored nothing before failing is retried like a failed connect
+        if (!ended && !progressed) {
+            waitUntil(std::chrono::steady_clock::now() + backoff);
+            backoff = std::min(backoff * 2, MAX_BACKOFF);
+        } else {
+            backoff = INITIAL_BACKOFF;
+        }
+    }
+}
+
+int EntryShipper::connectToCollector(uint64_t& committedOffset) {
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* addresses = nullptr;
+    std::string port = std::to_string(m_config.collectorPort);
+    if (getaddrinfo(m_config.collectorHost.c_str(), port.c_str(), &hints, &addresses) != 0) {
+        return -1;
+    }
+
+    int fd = -1;
+    for (addrinfo* address = addresses; address && fd < 0; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+
+        // The send timeout also bounds connect()
+        setSocketTimeout(fd, m_config.timeoutMs);
+        if (connect(fd, address->ai_addr, address->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    if (fd < 0) {
+        return -1;
+    }
+
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+    ByteWriter hello;
+    hello.u32(PROTOCOL_VERSION);
+    hello.string(m_config.siteId);
+
+    MessageType type;
+    std::string reply;
+    if (!sendMessage(fd, MessageType::HELLO, hello.data()) || !receiveMessage(fd, type, reply)) {
+        close(fd);
+        return -1;
+    }
+    if (type == MessageType::REJECT) {
+        Utils::logWarning("sync", "Collector refused site %s: %s", m_config.siteId.c_str(), reply.c_str());
+        close(fd);
+        return -1;
+    }
+    if (type != MessageType::WELCOME || !decodeOffset(reply, committedOffset)) {
+        close(fd);
+        return -1;
+    }
+
+    Utils::logInfo("sync", "Connected to the collector, resuming at offset %llu",
+                   static_cast<unsigned long long>(committedOffset));
+    return fd;
+}
+
+bool EntryShipper::shipBatches(int fd, uint64_t offset) {
+    static auto& shipTime = Utils::MetricsRegistry::instance().histogram(
+        "sync_batch_seconds", "Shipping one batch to the collector until it is acknowledged");
+    static auto& shippedEntries = Utils::MetricsRegistry::instance().counter(
+        "sync_entries_shipped_total", "Waste entries acknowledged by the collector");
+
+    const auto batchDelay = std::chrono::milliseconds(m_config.batchDelayMs);
+    const auto pingInterval = std::chrono::milliseconds(m_config.pingIntervalMs);
+    const size_t batchEntries = static_cast<size_t>(std::max(1, m_config.batchEntries));
+
+    // The batch being assembled covers [offset, readOffset) of the log
+    Batch batch;
+    uint64_t readOffset = offset;
+    std::string record;
+    auto pendingSince = std::chrono::steady_clock::time_point::max();
+    auto lastExchange = std::chrono::steady_clock::now();
+
+    while (true) {
+        // Records below the end seen here are complete, so a failed read means corruption
+        uint64_t endOffset = m_log->endOffset();
+        uint64_t nextOffset = 0;
+        while (batch.entries.size() < batchEntries && readOffset < endOffset &&
+               m_log->read(readOffset, record, nextOffset)) {
+            Data::WasteEntry entry;
+            if (decodeEntry(record, entry)) {
+                batch.entries.push_back(entry);
+            } else {
+                Utils::logWarning("sync", "Skipping an undecodable log record at offset %llu",
+                                  static_cast<unsigned long long>(readOffset));
+            }
+            readOffset = nextOffset;
+        }
+        if (batch.entries.size() < batchEntries && readOffset < endOffset) {
+            Utils::logError("sync", "Cannot read the log at offset %llu", static_cast<unsigned long long>(readOffset));
+            return false;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (readOffset == offset) {
+            if (!m_running) {
+                return true;
+            }
+
+            // Idle: keep the connection known to be alive
+            if (now - lastExchange >= pingInterval) {
+                MessageType type;
+                std::string reply;
+                if (!sendMessage(fd, MessageType::PING, "") || !receiveMessage(fd, type, reply) ||
+                    type != MessageType::ACK) {
+                    return false;
+                }
+                lastExchange = now;
+            }
+            waitUntil(lastExchange + pingInterval);
+            continue;
+        }
+
+        // Ship a full batch at once, a partial one when its oldest entry has
+        // waited long enough, and whatever is left when stopping
+        if (pendingSince == std::chrono::steady_clock::time_point::max()) {
+            pendingSince = now;
+        }
+        if (batch.entries.size() < batchEntries && now < pendingSince + batchDelay && m_running) {
+            waitUntil(pendingSince + batchDelay);
+            continue;
+        }
+
+        // Never ship what a crash could still take back from the local log
+        m_log->sync();
+
+        Utils::ScopedTimer timer(shipTime);
+        batch.startOffset = offset;
+        batch.endOffset = readOffset;
+        batch.deltas = computeDeltas(batch.entries);
+        size_t rawBytes = 0;
+        std::string payload = encodeBatch(batch, &rawBytes);
+
+        MessageType type;
+        std::string reply;
+        if (!sendMessage(fd, MessageType::BATCH, payload) || !receiveMessage(fd, type, reply)) {
+            return false;
+        }
+        if (type == MessageType::REJECT) {
+            Utils::logWarning("sync", "Collector rejected a batch: %s", reply.c_str());
+            return false;
+        }
+        uint64_t committedOffset = 0;
+        if (type != MessageType::ACK || !decodeOffset(reply, committedOffset) ||
+            committedOffset < m_log->startOffset() || committedOffset > m_log->endOffset()) {
+            return false;
+        }
+        lastExchange = std::chrono::steady_clock::now();
+
+        if (committedOffset == batch.endOffset) {
+            std::lock_guard<std::mutex> lock(m_statsMutex);
+            m_stats.batchesShipped++;
+            m_stats.entriesShipped += batch.entries.size();
+            m_stats.rawBytes += rawBytes;
+            m_stats.wireBytes += payload.size();
+            m_stats.acknowledgedOffset = committedOffset;
+            shippedEntries.increment(batch.entries.size());
+        } else {
+            Utils::logWarning("sync", "Collector asked to resume at offset %llu",
+                              static_cast<unsigned long long>(committedOffset));
+        }
+
+        if (m_config.truncateAcknowledged) {
+            m_log->truncateBefore(committedOffset);
+        }
+
+        offset = committedOffset;
+        readOffset = committedOffset;
+        batch.entries.clear();
+        pendingSince = std::chrono::steady_clock::time_point::max();
+
+        if (!m_running) {
+            return true;
+        }
+    }
+}
+
+} // namespace Sync
@@ -0,0 +1,104 @@
+/**
+ * Entry Shipper Header
+ *
+ * Monitor side of campus sync: follows the write-ahead log of new waste
+ * entries and pushes it to the collector in compressed batches, resuming
+ * from the collector's acknowledged offset after every reconnect
+ */
+
+#ifndef ENTRY_SHIPPER_H
+#define ENTRY_SHIPPER_H
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include "../utils/append_log.h"
+
+namespace Sync {
+
+struct ShipperConfig {
+    std::string collectorHost;
+    int collectorPort;
+    std::string siteId;
+    int batchEntries;               // Ship once this many entries are waiting...
+    int batchDelayMs;               // ...or the oldest has waited this long
+    int timeoutMs;                  // Connect, send and acknowledgement timeout
+    int pingIntervalMs;             // Idle keep-alive, well inside the collector's idle timeout
+    bool truncateAcknowledged;      // Delete log segments the collector has stored
+
+    ShipperConfig()
+        : collectorPort(7070),
+          batchEntries(500),
+          batchDelayMs(1000),
+          timeoutMs(10000),
+          pingIntervalMs(15000),
+          truncateAcknowledged(true) {
+    }
+};
+
+struct ShipperStats {
+    uint64_t batchesShipped;
+    uint64_t entriesShipped;
+    uint64_t rawBytes;              // Batch contents before compression
+    uint64_t wireBytes;             // Batch payloads as sent
+    uint64_t acknowledgedOffset;
+    uint64_t reconnects;
+    bool connected;
+
+    ShipperStats()
+        : batchesShipped(0),
+          entriesShipped(0),
+          rawBytes(0),
+          wireBytes(0),
+          acknowledgedOffset(0),
+          reconnects(0),
+          connected(false) {
+    }
+};
+
+class EntryShipper {
+public:
+    // Records in the log are entries encoded with Sync::encodeEntry
+    EntryShipper(std::shared_ptr<Utils::AppendLog> log, const ShipperConfig& config);
+    ~EntryShipper();
+
+    EntryShipper(const EntryShipper&) = delete;
+    EntryShipper& operator=(const EntryShipper&) = delete;
+
+    bool start();
+    void stop();
+
+    // New records were appended; wakes the shipping thread
+    void notify();
+
+    ShipperStats getStats() const;
+
+private:
+    void run();
+    int connectToCollector(uint64_t& committedOffset);
+    bool shipBatches(int fd, uint64_t offset);
+
+    // Wait until woken, stopped or the deadline passes
+    void waitUntil(std::chrono::steady_clock::time_point deadline);
+
+    std::shared_ptr<Utils::AppendLog> m_log;
+    ShipperConfig m_config;
+
+    std::atomic<bool> m_running;
+    std::thread m_thread;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+    bool m_woken;
+
+    mutable std::mutex m_statsMutex;
+    ShipperStats m_stats;
+};
+
+} // namespace Sync
+
+#endif // ENTRY_SHIPPER_H
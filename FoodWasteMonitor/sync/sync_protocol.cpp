@@ -0,0 +1,267 @@
+/**
+ * Sync Protocol Implementation
+ */
+
+#include "sync_protocol.h"
+#include <map>
+#include <tuple>
+#include <cerrno>
+#include <cstring>
+#include <zlib.h>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+
+namespace Sync {
+
+namespace {
+
+const size_t FRAME_HEADER_BYTES = 5;
+const size_t BATCH_HEADER_BYTES = 20;
+const int COMPRESSION_LEVEL = 6;
+
+bool sendFully(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool receiveFully(int fd, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = recv(fd, data, size, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+void ByteWriter::string(const std::string& value) {
+    u32(static_cast<uint32_t>(value.size()));
+    raw(value.data(), value.size());
+}
+
+bool ByteReader::string(std::string& value) {
+    uint32_t size = 0;
+    if (!u32(size) || size > remaining()) {
+        m_position = m_size + 1;
+        return false;
+    }
+    value.assign(m_data + m_position, size);
+    m_position += size;
+    return true;
+}
+
+bool ByteReader::raw(void* out, size_t size) {
+    if (m_position > m_size || size > m_size - m_position) {
+        m_position = m_size + 1;
+        return false;
+    }
+    std::memcpy(out, m_data + m_position, size);
+    m_position += size;
+    return true;
+}
+
+void encodeEntry(ByteWriter& writer, const Data::WasteEntry& entry) {
+    writer.string(entry.foodType);
+    writer.f32(entry.weight);
+    writer.string(entry.timestamp);
+    writer.f32(entry.confidence);
+    writer.string(entry.mealPeriod);
+    writer.string(entry.imageFilename);
+}
+
+bool decodeEntry(ByteReader& reader, Data::WasteEntry& entry) {
+    return reader.string(entry.foodType) &&
+           reader.f32(entry.weight) &&
+           reader.string(entry.timestamp) &&
+           reader.f32(entry.confidence) &&
+           reader.string(entry.mealPeriod) &&
+           reader.string(entry.imageFilename);
+}
+
+std::string encodeEntry(const Data::WasteEntry& entry) {
+    ByteWriter writer;
+    encodeEntry(writer, entry);
+    return writer.data();
+}
+
+bool decodeEntry(const std::string& record, Data::WasteEntry& entry) {
+    ByteReader reader(record);
+    return decodeEntry(reader, entry) && reader.remaining() == 0;
+}
+
+std::vector<RollupDelta> computeDeltas(const std::vector<Data::WasteEntry>& entries) {
+    std::map<std::tuple<std::string, std::string, std::string>, Data::RollupTotals> totals;
+    for (const auto& entry : entries) {
+        if (entry.timestamp.size() < 10) {
+            continue;
+        }
+        totals[std::make_tuple(entry.timestamp.substr(0, 10), entry.foodType, entry.mealPeriod)].add(entry.weight);
+    }
+
+    std::vector<RollupDelta> deltas;
+    deltas.reserve(totals.size());
+    for (const auto& total : totals) {
+        RollupDelta delta;
+        std::tie(delta.date, delta.foodType, delta.mealPeriod) = total.first;
+        delta.totals = total.second;
+        deltas.push_back(delta);
+    }
+    return deltas;
+}
+
+std::string encodeBatch(const Batch& batch, size_t* rawBytes) {
+    ByteWriter body;
+    body.u32(static_cast<uint32_t>(batch.entries.size()));
+    for (const auto& entry : batch.entries) {
+        encodeEntry(body, entry);
+    }
+    body.u32(static_cast<uint32_t>(batch.deltas.size()));
+    for (const auto& delta : batch.deltas) {
+        body.string(delta.date);
+        body.string(delta.foodType);
+        body.string(delta.mealPeriod);
+        body.f64(delta.totals.weight);
+        body.u32(static_cast<uint32_t>(delta.totals.items));
+    }
+
+    const std::string& raw = body.data();
+    uLongf compressedBytes = compressBound(static_cast<uLong>(raw.size()));
+
+    ByteWriter payload;
+    payload.u64(batch.startOffset);
+    payload.u64(batch.endOffset);
+    payload.u32(static_cast<uint32_t>(raw.size()));
+    payload.data().resize(BATCH_HEADER_BYTES + compressedBytes);
+    compress2(reinterpret_cast<Bytef*>(&payload.data()[BATCH_HEADER_BYTES]), &compressedBytes,
+              reinterpret_cast<const Bytef*>(raw.data()), static_cast<uLong>(raw.size()), COMPRESSION_LEVEL);
+    payload.data().resize(BATCH_HEADER_BYTES + compressedBytes);
+
+    if (rawBytes) {
+        *rawBytes = raw.size();
+    }
+    return payload.data();
+}
+
+bool decodeBatchRange(const std::string& payload, uint64_t& startOffset, uint64_t& endOffset) {
+    ByteReader reader(payload);
+    return reader.u64(startOffset) && reader.u64(endOffset) && startOffset <= endOffset;
+}
+
+bool decodeBatch(const std::string& payload, Batch& batch) {
+    ByteReader header(payload);
+    uint32_t rawSize = 0;
+    if (!header.u64(batch.startOffset) || !header.u64(batch.endOffset) || !header.u32(rawSize) ||
+        rawSize > MAX_MESSAGE_BYTES * 4) {
+        return false;
+    }
+
+    std::string raw(rawSize, '\0');
+    uLongf inflatedBytes = rawSize;
+    if (uncompress(reinterpret_cast<Bytef*>(&raw[0]), &inflatedBytes,
+                   reinterpret_cast<const Bytef*>(header.current()), static_cast<uLong>(header.remaining())) != Z_OK ||
+        inflatedBytes != rawSize) {
+        return false;
+    }
+
+    ByteReader reader(raw);
+    uint32_t entryCount = 0;
+    if (!reader.u32(entryCount) || entryCount > rawSize) {
+        return false;
+    }
+    batch.entries.resize(entryCount);
+    for (auto& entry : batch.entries) {
+        if (!decodeEntry(reader, entry)) {
+            return false;
+        }
+    }
+
+    uint32_t deltaCount = 0;
+    if (!reader.u32(deltaCount) || deltaCount > rawSize) {
+        return false;
+    }
+    batch.deltas.resize(deltaCount);
+    for (auto& delta : batch.deltas) {
+        uint32_t items = 0;
+        if (!reader.string(delta.date) || !reader.string(delta.foodType) || !reader.string(delta.mealPeriod) ||
+            !reader.f64(delta.totals.weight) || !reader.u32(items)) {
+            return false;
+        }
+        delta.totals.items = static_cast<int>(items);
+    }
+    return reader.remaining() == 0;
+}
+
+std::string encodeOffset(uint64_t offset) {
+    ByteWriter writer;
+    writer.u64(offset);
+    return writer.data();
+}
+
+bool decodeOffset(const std::string& payload, uint64_t& offset) {
+    ByteReader reader(payload);
+    return reader.u64(offset);
+}
+
+bool sendMessage(int fd, MessageType type, const std::string& payload) {
+    if (payload.size() > MAX_MESSAGE_BYTES) {
+        return false;
+    }
+
+    char header[FRAME_HEADER_BYTES];
+    uint32_t size = static_cast<uint32_t>(payload.size());
+    std::memcpy(header, &size, sizeof(size));
+    header[4] = static_cast<char>(type);
+
+    // Small frames go out in one segment
+    if (payload.size() < 4096) {
+        std::string frame(header, sizeof(header));
+        frame += payload;
+        return sendFully(fd, frame.data(), frame.size());
+    }
+    return sendFully(fd, header, sizeof(header)) && sendFully(fd, payload.data(), payload.size());
+}
+
+bool receiveMessage(int fd, MessageType& type, std::string& payload) {
+    char header[FRAME_HEADER_BYTES];
+    if (!receiveFully(fd, header, sizeof(header))) {
+        return false;
+    }
+
+    uint32_t size = 0;
+    std::memcpy(&size, header, sizeof(size));
+    if (size > MAX_MESSAGE_BYTES) {
+        return false;
+    }
+
+    type = static_cast<MessageType>(header[4]);
+    payload.resize(size);
+    return size == 0 || receiveFully(fd, &payload[0], size);
+}
+
+void setSocketTimeout(int fd, int timeoutMs) {
+    timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+} // namespace Sync
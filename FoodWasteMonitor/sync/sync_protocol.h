@@ -0,0 +1,130 @@
+/**
+ * Sync Protocol Header
+ *
+ * Wire format between a dining hall's monitor and the campus collector.
+ * The monitor pushes batches of new waste entries, read from its
+ * write-ahead log, together with the per-day rollup deltas they add; the
+ * collector acknowledges the log offset it has stored, which is where the
+ * monitor resumes after a reconnect.
+ *
+ * Frame (native little-endian): payloadBytes u32, type u8, payload
+ *
+ *   HELLO    site -> collector   version u32, site id
+ *   WELCOME  collector -> site   committed offset u64
+ *   BATCH    site -> collector   start offset u64, end offset u64,
+ *                                raw bytes u32, deflated (entries, deltas)
+ *   ACK      collector -> site   committed offset u64
+ *   PING     site -> collector   empty; answered with an ACK
+ *   REJECT   collector -> site   reason; the site retries later
+ */
+
+#ifndef SYNC_PROTOCOL_H
+#define SYNC_PROTOCOL_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "../data/waste_database.h"
+#include "../data/waste_rollup.h"
+
+namespace Sync {
+
+const uint32_t PROTOCOL_VERSION = 1;
+const size_t MAX_MESSAGE_BYTES = 32 * 1024 * 1024;
+
+enum class MessageType : uint8_t {
+    HELLO = 1,
+    WELCOME = 2,
+    BATCH = 3,
+    ACK = 4,
+    PING = 5,
+    REJECT = 6
+};
+
+// Totals a batch adds to one day, food type and meal period
+struct RollupDelta {
+    std::string date;               // "YYYY-MM-DD"
+    std::string foodType;
+    std::string mealPeriod;
+    Data::RollupTotals totals;
+};
+
+// The entries stored at [startOffset, endOffset) of a site's log
+struct Batch {
+    uint64_t startOffset;
+    uint64_t endOffset;
+    std::vector<Data::WasteEntry> entries;
+    std::vector<RollupDelta> deltas;
+
+    Batch() : startOffset(0), endOffset(0) {}
+};
+
+class ByteWriter {
+public:
+    void u8(uint8_t value) { raw(&value, sizeof(value)); }
+    void u32(uint32_t value) { raw(&value, sizeof(value)); }
+    void u64(uint64_t value) { raw(&value, sizeof(value)); }
+    void f32(float value) { raw(&value, sizeof(value)); }
+    void f64(double value) { raw(&value, sizeof(value)); }
+    void string(const std::string& value);
+    void raw(const void* data, size_t size) { m_data.append(static_cast<const char*>(data), size); }
+
+    const std::string& data() const { return m_data; }
+    std::string& data() { return m_data; }
+
+private:
+    std::string m_data;
+};
+
+// Reads what ByteWriter wrote. Every read fails once one has run past the end.
+class ByteReader {
+public:
+    ByteReader(const char* data, size_t size) : m_data(data), m_size(size), m_position(0) {}
+    explicit ByteReader(const std::string& data) : ByteReader(data.data(), data.size()) {}
+
+    bool u8(uint8_t& value) { return raw(&value, sizeof(value)); }
+    bool u32(uint32_t& value) { return raw(&value, sizeof(value)); }
+    bool u64(uint64_t& value) { return raw(&value, sizeof(value)); }
+    bool f32(float& value) { return raw(&value, sizeof(value)); }
+    bool f64(double& value) { return raw(&value, sizeof(value)); }
+    bool string(std::string& value);
+    bool raw(void* out, size_t size);
+
+    size_t remaining() const { return m_size - m_position; }
+    const char* current() const { return m_data + m_position; }
+
+private:
+    const char* m_data;
+    size_t m_size;
+    size_t m_position;
+};
+
+// A write-ahead log record holds one encoded entry
+void encodeEntry(ByteWriter& writer, const Data::WasteEntry& entry);
+bool decodeEntry(ByteReader& reader, Data::WasteEntry& entry);
+std::string encodeEntry(const Data::WasteEntry& entry);
+bool decodeEntry(const std::string& record, Data::WasteEntry& entry);
+
+// Per (day, food type, meal period) totals of the entries; entries without
+// a valid timestamp are left out
+std::vector<RollupDelta> computeDeltas(const std::vector<Data::WasteEntry>& entries);
+
+// BATCH payload. rawBytes receives the size before compression.
+std::string encodeBatch(const Batch& batch, size_t* rawBytes = nullptr);
+bool decodeBatch(const std::string& payload, Batch& batch);
+
+// Only the offsets, without inflating the entries
+bool decodeBatchRange(const std::string& payload, uint64_t& startOffset, uint64_t& endOffset);
+
+std::string encodeOffset(uint64_t offset);
+bool decodeOffset(const std::string& payload, uint64_t& offset);
+
+// Blocking framed I/O; timeouts come from setSocketTimeout
+bool sendMessage(int fd, MessageType type, const std::string& payload);
+bool receiveMessage(int fd, MessageType& type, std::string& payload);
+void setSocketTimeout(int fd, int timeoutMs);
+
+} // namespace Sync
+
+#endif // SYNC_PROTOCOL_H
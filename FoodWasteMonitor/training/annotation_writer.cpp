@@ -0,0 +1,122 @@
+/**
+ * Annotation Writer Implementation
+ */
+
+#include "annotation_writer.h"
+#include <iostream>
+#include <cstdio>
+#include <charconv>
+
+namespace Training {
+
+namespace {
+
+// Longest line: prefix aside, an int and four fixed-point floats with separators
+const size_t MAX_LINE_CHARS = 96;
+
+// Decimal places for normalized coordinates; finer than a pixel at 4K
+const int COORDINATE_PRECISION = 6;
+
+char* appendFloat(char* cursor, char* end, float value) {
+    *cursor++ = ' ';
+    return std::to_chars(cursor, end, value, std::chars_format::fixed, COORDINATE_PRECISION).ptr;
+}
+
+// Write a buffer to path with a single write call
+bool writeWholeFile(const std::string& path, const std::string& contents) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Failed to open annotation file: " << path << std::endl;
+        return false;
+    }
+
+    // Unbuffered, so the whole buffer goes out in one write
+    std::setvbuf(file, nullptr, _IONBF, 0);
+    bool ok = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+    ok = std::fclose(file) == 0 && ok;
+
+    if (!ok) {
+        std::cerr << "Failed to write annotation file: " << path << std::endl;
+    }
+    return ok;
+}
+
+} // namespace
+
+AnnotationWriter::AnnotationWriter(ClassIdMap classIds)
+    : m_classIds(std::move(classIds)) {
+}
+
+AnnotationWriter::ClassIdMap AnnotationWriter::buildClassIdMap(const std::vector<std::string>& classNames) {
+    ClassIdMap classIds;
+    classIds.reserve(classNames.size());
+    for (size_t i = 0; i < classNames.size(); i++) {
+        classIds.emplace(classNames[i], static_cast<int>(i));
+    }
+    return classIds;
+}
+
+int AnnotationWriter::classIdOf(const std::string& className) const {
+    auto it = m_classIds.find(className);
+    return it != m_classIds.end() ? it->second : 0;
+}
+
+bool AnnotationWriter::format(const cv::Size& imageSize, const std::vector<Detection::FoodItem>& annotations,
+                              std::string& buffer, const std::string& linePrefix) const {
+    if (imageSize.width <= 0 || imageSize.height <= 0) {
+        return false;
+    }
+
+    float inverseWidth = 1.0f / imageSize.width;
+    float inverseHeight = 1.0f / imageSize.height;
+
+    char line[MAX_LINE_CHARS];
+    char* lineEnd = line + sizeof(line);
+
+    for (const auto& item : annotations) {
+        const cv::Rect& box = item.boundingBox;
+
+        char* cursor = std::to_chars(line, lineEnd, classIdOf(item.className)).ptr;
+        cursor = appendFloat(cursor, lineEnd, (box.x + box.width / 2.0f) * inverseWidth);
+        cursor = appendFloat(cursor, lineEnd, (box.y + box.height / 2.0f) * inverseHeight);
+        cursor = appendFloat(cursor, lineEnd, box.width * inverseWidth);
+        cursor = appendFloat(cursor, lineEnd, box.height * inverseHeight);
+        *cursor++ = '\n';
+
+        if (!linePrefix.empty()) {
+            buffer.append(linePrefix);
+            buffer.push_back(' ');
+        }
+        buffer.append(line, cursor);
+    }
+
+    return true;
+}
+
+bool AnnotationWriter::writeFile(const std::string& annotationPath, const cv::Size& imageSize,
+                                 const std::vector<Detection::FoodItem>& annotations) const {
+    std::string buffer;
+    buffer.reserve(annotations.size() * 48);
+    if (!format(imageSize, annotations, buffer)) {
+        std::cerr << "Invalid image size for annotations: " << annotationPath << std::endl;
+        return false;
+    }
+
+    return writeWholeFile(annotationPath, buffer);
+}
+
+bool AnnotationWriter::writeConsolidated(const std::string& annotationPath,
+                                         const std::vector<ImageAnnotations>& images) const {
+    std::string buffer;
+    buffer.reserve(images.size() * 80);
+
+    for (const auto& image : images) {
+        if (!format(image.imageSize, image.annotations, buffer, image.imageName)) {
+            std::cerr << "Invalid image size for annotations: " << image.imageName << std::endl;
+        }
+    }
+
+    return writeWholeFile(annotationPath, buffer);
+}
+
+} // namespace Training
@@ -0,0 +1,58 @@
+/**
+ * Annotation Writer Header
+ *
+ * Writes YOLO annotation files (<class_id> <center_x> <center_y> <width>
+ * <height>, normalized to [0, 1]). Lines are formatted into one buffer and
+ * each file is written with a single write.
+ */
+
+#ifndef ANNOTATION_WRITER_H
+#define ANNOTATION_WRITER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <opencv2/opencv.hpp>
+#include "../detection/food_detector.h"
+
+namespace Training {
+
+// Annotations of one image for a consolidated file
+struct ImageAnnotations {
+    std::string imageName;                          // File name of the image, without directory
+    cv::Size imageSize;
+    std::vector<Detection::FoodItem> annotations;
+};
+
+class AnnotationWriter {
+public:
+    using ClassIdMap = std::unordered_map<std::string, int>;
+
+    // Class ids are looked up in the given map; unknown classes map to 0
+    explicit AnnotationWriter(ClassIdMap classIds = ClassIdMap());
+
+    // Build the map from a class list, where the id is the position
+    static ClassIdMap buildClassIdMap(const std::vector<std::string>& classNames);
+
+    // Append the YOLO lines for one image to buffer. Each line is prefixed
+    // with linePrefix, if any. Returns false for an invalid image size.
+    bool format(const cv::Size& imageSize, const std::vector<Detection::FoodItem>& annotations,
+                std::string& buffer, const std::string& linePrefix = "") const;
+
+    // One annotation file per image
+    bool writeFile(const std::string& annotationPath, const cv::Size& imageSize,
+                   const std::vector<Detection::FoodItem>& annotations) const;
+
+    // Annotations of many images in one file, each line prefixed with the
+    // image name; read back with loadConsolidatedAnnotations
+    bool writeConsolidated(const std::string& annotationPath, const std::vector<ImageAnnotations>& images) const;
+
+private:
+    int classIdOf(const std::string& className) const;
+
+    ClassIdMap m_classIds;
+};
+
+} // namespace Training
+
+#endif // ANNOTATION_WRITER_H
@@ -0,0 +1,121 @@
+/**
+ * Augmentation Kernel Implementation
+ */
+
+#include "augmentation_kernel.h"
+#include <vector>
+#include <algorithm>
+
+namespace Training {
+
+namespace {
+
+// Integer hash with good avalanche (lowbias32); used as a stateless RNG
+inline uint32_t hashCounter(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return x;
+}
+
+inline uint8_t clampToByte(float value) {
+    return static_cast<uint8_t>(std::min(std::max(value, 0.0f), 255.0f) + 0.5f);
+}
+
+// Fallback for images that are not 8-bit: flip and contrast/brightness only
+void applyGeneric(const cv::Mat& source, cv::Mat& output, const AugmentationParams& params) {
+    if (params.flip) {
+        cv::flip(source, output, 1);
+    } else {
+        source.copyTo(output);
+    }
+
+    output.convertTo(output, -1, params.contrast, params.brightnessShift + 128.0f * (1.0f - params.contrast));
+}
+
+} // namespace
+
+void applyPixelAugmentation(const cv::Mat& source, cv::Mat& output, const AugmentationParams& params) {
+    if (source.empty()) {
+        output.release();
+        return;
+    }
+
+    if (source.depth() != CV_8U || source.channels() > 4) {
+        applyGeneric(source, output, params);
+        return;
+    }
+
+    // Each row is read (or mirrored into scratch) before it is written, so
+    // the kernel can also run in place
+    const cv::Mat& input = source;
+    output.create(input.size(), input.type());
+
+    const int channels = input.channels();
+    const int cols = input.cols;
+    const int rowLength = cols * channels;
+    const bool addNoise = params.noiseAmplitude >= 1.0f;
+
+    // Per-lane coefficients for one interleaved row:
+    // out = ((in - 128) * contrast + 128 + brightness) * channelGain + noise
+    thread_local std::vector<float> gain, offset, noiseScale, noise;
+    thread_local std::vector<uint8_t> mirrored;
+    gain.resize(rowLength);
+    offset.resize(rowLength);
+    noiseScale.resize(rowLength);
+    noise.assign(rowLength, 0.0f);
+    if (params.flip) {
+        mirrored.resize(rowLength);
+    }
+
+    for (int c = 0; c < channels; c++) {
+        bool isAlpha = (c == 3);
+        float jitter = isAlpha ? 1.0f : params.channelGain[std::min(c, 2)];
+        float laneGain = isAlpha ? 1.0f : params.contrast * jitter;
+        float laneOffset = isAlpha ? 0.0f : (128.0f * (1.0f - params.contrast) + params.brightnessShift) * jitter;
+        float laneNoise = (isAlpha || !addNoise) ? 0.0f : params.noiseAmplitude / 256.0f;
+
+        for (int j = c; j < rowLength; j += channels) {
+            gain[j] = laneGain;
+            offset[j] = laneOffset;
+            noiseScale[j] = laneNoise;
+        }
+    }
+
+    const uint32_t seedMix = hashCounter(params.noiseSeed);
+    float* gainRow = gain.data();
+    float* offsetRow = offset.data();
+    float* scaleRow = noiseScale.data();
+    float* noiseRow = noise.data();
+
+    for (int y = 0; y < input.rows; y++) {
+        const uint8_t* in = input.ptr<uint8_t>(y);
+        uint8_t* out = output.ptr<uint8_t>(y);
+
+        // Flipped rows are mirrored into scratch first, so both cases share
+        // the contiguous loop below
+        if (params.flip) {
+            cv::Mat mirroredRow(1, cols, input.type(), mirrored.data());
+            cv::flip(input.row(y), mirroredRow, 1);
+            in = mirrored.data();
+        }
+
+        // Noise from a hash of the element index: pure integer math the
+        // compiler vectorizes, with no generator state between pixels
+        if (addNoise) {
+            uint32_t rowBase = static_cast<uint32_t>(y) * static_cast<uint32_t>(rowLength);
+            for (int j = 0; j < rowLength; j++) {
+                uint32_t bits = hashCounter((rowBase + static_cast<uint32_t>(j)) ^ seedMix);
+                noiseRow[j] = static_cast<float>(bits >> 24) * scaleRow[j];
+            }
+        }
+
+        for (int j = 0; j < rowLength; j++) {
+            out[j] = clampToByte(in[j] * gainRow[j] + offsetRow[j] + noiseRow[j]);
+        }
+    }
+}
+
+} // namespace Training
@@ -0,0 +1,46 @@
+/**
+ * Augmentation Kernel Header
+ *
+ * Per-pixel training augmentations fused into a single pass over the image
+ */
+
+#ifndef AUGMENTATION_KERNEL_H
+#define AUGMENTATION_KERNEL_H
+
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+
+namespace Training {
+
+// Concrete augmentation applied to one sample in one epoch
+struct AugmentationParams {
+    bool flip;
+    float rotationDegrees;        // Geometric pass, applied separately before the pixel pass
+    float contrast;               // Gain around mid-gray
+    float brightnessShift;
+    float channelGain[3];         // Color jitter per channel (BGR)
+    float noiseAmplitude;         // Additive noise drawn from [0, amplitude)
+    uint32_t noiseSeed;
+
+    AugmentationParams()
+        : flip(false),
+          rotationDegrees(0.0f),
+          contrast(1.0f),
+          brightnessShift(0.0f),
+          channelGain{1.0f, 1.0f, 1.0f},
+          noiseAmplitude(0.0f),
+          noiseSeed(0) {
+    }
+};
+
+// Apply flip, contrast/brightness, color jitter and noise to an 8-bit image
+// in one pass. The output is reused when it already has the right size and
+// type. Noise comes from a counter-based hash, so the result only depends on
+// the params and never on which thread runs the kernel. Flipped rows are
+// mirrored into a scratch row first, so every image runs the same
+// contiguous row loop, which vectorizes.
+void applyPixelAugmentation(const cv::Mat& source, cv::Mat& output, const AugmentationParams& params);
+
+} // namespace Training
+
+#endif // AUGMENTATION_KERNEL_H
@@ -0,0 +1,227 @@
+/**
+ * Training Dataset Manifest Implementation
+ */
+
+#include "dataset_manifest.h"
+#include "../utils/content_hash.h"
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace Training {
+
+namespace {
+
+const int MANIFEST_VERSION = 1;
+
+} // namespace
+
+DatasetManifest::DatasetManifest(const std::string& manifestPath)
+    : m_manifestPath(manifestPath) {
+}
+
+bool DatasetManifest::load() {
+    m_samples.clear();
+    m_sources.clear();
+
+    if (!fs::exists(m_manifestPath)) {
+        return false;
+    }
+
+    try {
+        std::ifstream file(m_manifestPath);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open dataset manifest: " << m_manifestPath << std::endl;
+            return false;
+        }
+
+        json manifest;
+        file >> manifest;
+
+        // An unknown layout is treated as an empty manifest and rebuilt
+        if (manifest.value("version", 0) != MANIFEST_VERSION) {
+            std::cout << "Dataset manifest version changed, rebuilding dataset" << std::endl;
+            return false;
+        }
+
+        for (const auto& [hash, value] : manifest["samples"].items()) {
+            ManifestSample sample;
+            sample.label = value.value("label", "");
+            sample.policy = value.value("policy", "");
+            sample.files = value.value("files", std::vector<std::string>());
+            m_samples[hash] = sample;
+        }
+
+        for (const auto& [path, value] : manifest["sources"].items()) {
+            ManifestSource source;
+            source.size = value.value("size", static_cast<uintmax_t>(0));
+            source.modifiedTime = value.value("mtime", static_cast<int64_t>(0));
+            source.contentHash = value.value("hash", "");
+            source.hasImageHash = value.contains("image_hash");
+            source.imageHash = value.value("image_hash", static_cast<uint64_t>(0));
+            m_sources[path] = source;
+        }
+
+        return true;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error loading dataset manifest: " << e.what() << std::endl;
+        m_samples.clear();
+        m_sources.clear();
+        return false;
+    }
+}
+
+bool DatasetManifest::save() const {
+    try {
+        json manifest;
+        manifest["version"] = MANIFEST_VERSION;
+        manifest["samples"] = json::object();
+        manifest["sources"] = json::object();
+
+        for (const auto& [hash, sample] : m_samples) {
+            manifest["samples"][hash] = {
+                {"label", sample.label},
+                {"policy", sample.policy},
+                {"files", sample.files}
+            };
+        }
+
+        for (const auto& [path, source] : m_sources) {
+            manifest["sources"][path] = {
+                {"size", source.size},
+                {"mtime", source.modifiedTime},
+                {"hash", source.contentHash}
+            };
+            if (source.hasImageHash) {
+                manifest["sources"][path]["image_hash"] = source.imageHash;
+            }
+        }
+
+        // Write to a temporary file first so a crash never leaves a torn manifest
+        std::string tempPath = m_manifestPath + ".tmp";
+        {
+            std::ofstream file(tempPath);
+            if (!file.is_open()) {
+                std::cerr << "Failed to write dataset manifest: " << tempPath << std::endl;
+                return false;
+            }
+            file << manifest.dump(2);
+        }
+        fs::rename(tempPath, m_manifestPath);
+
+        return true;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error saving dataset manifest: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+std::string DatasetManifest::resolveContentHash(const std::string& sourcePath) {
+    std::error_code ec;
+    uintmax_t size = fs::file_size(sourcePath, ec);
+    if (ec) {
+        return "";
+    }
+
+    auto writeTime = fs::last_write_time(sourcePath, ec);
+    if (ec) {
+        return "";
+    }
+    int64_t modifiedTime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+
+    auto it = m_sources.find(sourcePath);
+    if (it != m_sources.end() && it->second.size == size && it->second.modifiedTime == modifiedTime) {
+        return it->second.contentHash;
+    }
+
+    ManifestSource source;
+    source.size = size;
+    source.modifiedTime = modifiedTime;
+    source.contentHash = Utils::hashFileContents(sourcePath);
+    if (source.contentHash.empty()) {
+        return "";
+    }
+
+    m_sources[sourcePath] = source;
+    return source.contentHash;
+}
+
+bool DatasetManifest::findImageHash(const std::string& sourcePath, uint64_t& imageHash) const {
+    auto it = m_sources.find(sourcePath);
+    if (it == m_sources.end() || !it->second.hasImageHash) {
+        return false;
+    }
+
+    imageHash = it->second.imageHash;
+    return true;
+}
+
+void DatasetManifest::setImageHash(const std::string& sourcePath, uint64_t imageHash) {
+    auto it = m_sources.find(sourcePath);
+    if (it != m_sources.end()) {
+        it->second.imageHash = imageHash;
+        it->second.hasImageHash = true;
+    }
+}
+
+bool DatasetManifest::hasSample(const std::string& contentHash, const std::string& label,
+                                const std::string& policy) const {
+    auto it = m_samples.find(contentHash);
+    return it != m_samples.end() &&
+           it->second.label == label &&
+           it->second.policy == policy &&
+           !it->second.files.empty();
+}
+
+const ManifestSample* DatasetManifest::findSample(const std::string& contentHash) const {
+    auto it = m_samples.find(contentHash);
+    return it != m_samples.end() ? &it->second : nullptr;
+}
+
+void DatasetManifest::setSample(const std::string& contentHash, const ManifestSample& sample) {
+    m_samples[contentHash] = sample;
+}
+
+size_t DatasetManifest::retainOnly(const std::set<std::string>& contentHashes,
+                                   const std::set<std::string>& sourcePaths) {
+    size_t dropped = 0;
+
+    for (auto it = m_samples.begin(); it != m_samples.end();) {
+        if (contentHashes.count(it->first) == 0) {
+            it = m_samples.erase(it);
+            dropped++;
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto it = m_sources.begin(); it != m_sources.end();) {
+        if (sourcePaths.count(it->first) == 0) {
+            it = m_sources.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    return dropped;
+}
+
+std::set<std::string> DatasetManifest::getReferencedFiles() const {
+    std::set<std::string> files;
+    for (const auto& [hash, sample] : m_samples) {
+        files.insert(sample.files.begin(), sample.files.end());
+    }
+    return files;
+}
+
+size_t DatasetManifest::getSampleCount() const {
+    return m_samples.size();
+}
+
+} // namespace Training
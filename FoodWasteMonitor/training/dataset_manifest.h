@@ -0,0 +1,76 @@
+/**
+ * Training Dataset Manifest Header
+ *
+ * Records which source images have already been turned into training
+ * samples, keyed by content hash and augmentation policy, so dataset
+ * builds only process new data
+ */
+
+#ifndef DATASET_MANIFEST_H
+#define DATASET_MANIFEST_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <cstdint>
+
+namespace Training {
+
+// Samples generated from one source image
+struct ManifestSample {
+    std::string label;                  // Class name used for the annotations
+    std::string policy;                 // Augmentation policy the files were built with
+    std::vector<std::string> files;     // Image file names; the first is the original
+};
+
+// Cached hashes of a source image, valid while size and mtime match
+struct ManifestSource {
+    uintmax_t size;
+    int64_t modifiedTime;
+    std::string contentHash;
+    uint64_t imageHash;           // Perceptual hash used for sample selection
+    bool hasImageHash;
+
+    ManifestSource() : size(0), modifiedTime(0), imageHash(0), hasImageHash(false) {}
+};
+
+class DatasetManifest {
+public:
+    explicit DatasetManifest(const std::string& manifestPath);
+
+    bool load();
+    bool save() const;
+
+    // Content hash of a source file, reusing the cached value when the file
+    // is unchanged. Returns an empty string if the file cannot be read.
+    std::string resolveContentHash(const std::string& sourcePath);
+
+    // Cached perceptual hash of a source whose content hash was resolved
+    bool findImageHash(const std::string& sourcePath, uint64_t& imageHash) const;
+    void setImageHash(const std::string& sourcePath, uint64_t imageHash);
+
+    // Whether a sample for this content, label and policy is already built
+    bool hasSample(const std::string& contentHash, const std::string& label, const std::string& policy) const;
+    const ManifestSample* findSample(const std::string& contentHash) const;
+    void setSample(const std::string& contentHash, const ManifestSample& sample);
+
+    // Drop samples and sources not in the given sets. Returns the number of
+    // samples dropped; their files are no longer referenced afterwards.
+    size_t retainOnly(const std::set<std::string>& contentHashes,
+                      const std::set<std::string>& sourcePaths);
+
+    // Every image file name referenced by the manifest
+    std::set<std::string> getReferencedFiles() const;
+
+    size_t getSampleCount() const;
+
+private:
+    std::string m_manifestPath;
+    std::map<std::string, ManifestSample> m_samples;    // Keyed by content hash
+    std::map<std::string, ManifestSource> m_sources;    // Keyed by source path
+};
+
+} // namespace Training
+
+#endif // DATASET_MANIFEST_H
@@ -0,0 +1,363 @@
+/**
+ * Model Evaluator Implementation
+ */
+
+#include "model_evaluator.h"
+#include "record_file.h"
+#include "../detection/food_detector.h"
+#include "../utils/task_scheduler.h"
+#include "../utils/logger.h"
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+namespace Training {
+
+namespace {
+
+// IoU thresholds 0.50, 0.55, ..., 0.95
+const int NUM_IOU_THRESHOLDS = 10;
+
+float iouThreshold(int index) {
+    return 0.5f + 0.05f * index;
+}
+
+// Matches gathered by one worker
+struct EvaluationAccumulator {
+    // [class][threshold] -> (confidence, true positive)
+    std::vector<std::vector<std::vector<std::pair<float, bool>>>> matches;
+    std::vector<int> groundTruthCounts;
+    int imageCount;
+
+    explicit EvaluationAccumulator(size_t numClasses)
+        : matches(numClasses, std::vector<std::vector<std::pair<float, bool>>>(NUM_IOU_THRESHOLDS)),
+          groundTruthCounts(numClasses, 0),
+          imageCount(0) {
+    }
+};
+
+// Greedy COCO-style matching of one image's predictions to its ground truth
+void scoreImage(const Detection::DetectionResult& predictions,
+                const std::vector<TrainingAnnotation>& groundTruth,
+                const std::vector<std::string>& classNames,
+                const cv::Size& imageSize,
+                EvaluationAccumulator& accumulator) {
+    size_t numClasses = classNames.size();
+
+    // Ground truth as corner arrays per class (normalized coordinates)
+    std::vector<std::vector<float>> gx1(numClasses), gy1(numClasses), gx2(numClasses), gy2(numClasses);
+    for (const auto& annotation : groundTruth) {
+        if (annotation.classId < 0 || annotation.classId >= static_cast<int>(numClasses)) {
+            continue;
+        }
+        size_t c = static_cast<size_t>(annotation.classId);
+        gx1[c].push_back(annotation.box.x);
+        gy1[c].push_back(annotation.box.y);
+        gx2[c].push_back(annotation.box.x + annotation.box.width);
+        gy2[c].push_back(annotation.box.y + annotation.box.height);
+        accumulator.groundTruthCounts[c]++;
+    }
+
+    // Predictions sorted by confidence, highest first
+    std::vector<const Detection::FoodItem*> sorted;
+    for (const auto& prediction : predictions) {
+        sorted.push_back(&prediction);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const Detection::FoodItem* a, const Detection::FoodItem* b) {
+        return a->confidence > b->confidence;
+    });
+
+    std::vector<std::vector<std::vector<char>>> matched(numClasses);
+    for (size_t c = 0; c < numClasses; c++) {
+        matched[c].assign(NUM_IOU_THRESHOLDS, std::vector<char>(gx1[c].size(), 0));
+    }
+
+    std::vector<float> iou;
+    float invWidth = 1.0f / std::max(1, imageSize.width);
+    float invHeight = 1.0f / std::max(1, imageSize.height);
+
+    for (const auto* prediction : sorted) {
+        auto classIt = std::find(classNames.begin(), classNames.end(), prediction->className);
+        if (classIt == classNames.end()) {
+            continue;
+        }
+        size_t c = static_cast<size_t>(classIt - classNames.begin());
+
+        cv::Rect2f box(prediction->boundingBox.x * invWidth, prediction->boundingBox.y * invHeight,
+                       prediction->boundingBox.width * invWidth, prediction->boundingBox.height * invHeight);
+
+        // One IoU row per prediction, reused for every threshold
+        size_t numTruth = gx1[c].size();
+        iou.resize(numTruth);
+        if (numTruth > 0) {
+            ModelEvaluator::computeIoU(box, gx1[c].data(), gy1[c].data(), gx2[c].data(), gy2[c].data(),
+                                       numTruth, iou.data());
+        }
+
+        for (int t = 0; t < NUM_IOU_THRESHOLDS; t++) {
+            float threshold = iouThreshold(t);
+            int best = -1;
+            float bestIoU = threshold;
+            for (size_t g = 0; g < numTruth; g++) {
+                if (!matched[c][t][g] && iou[g] >= bestIoU) {
+                    bestIoU = iou[g];
+                    best = static_cast<int>(g);
+                }
+            }
+
+            if (best >= 0) {
+                matched[c][t][best] = 1;
+            }
+            accumulator.matches[c][t].emplace_back(prediction->confidence, best >= 0);
+        }
+    }
+
+    accumulator.imageCount++;
+}
+
+} // namespace
+
+ModelEvaluator::ModelEvaluator(const std::string& modelPath,
+                               const std::string& classesPath,
+                               const EvaluationConfig& config)
+    : m_modelPath(modelPath),
+      m_classesPath(classesPath),
+      m_config(config) {
+}
+
+void ModelEvaluator::computeIoU(const cv::Rect2f& box,
+                                const float* x1, const float* y1, const float* x2, const float* y2,
+                                size_t count, float* iou) {
+    const float bx1 = box.x;
+    const float by1 = box.y;
+    const float bx2 = box.x + box.width;
+    const float by2 = box.y + box.height;
+    const float boxArea = box.width * box.height;
+
+    for (size_t i = 0; i < count; i++) {
+        float w = std::max(0.0f, std::min(bx2, x2[i]) - std::max(bx1, x1[i]));
+        float h = std::max(0.0f, std::min(by2, y2[i]) - std::max(by1, y1[i]));
+        float intersection = w * h;
+        float unionArea = boxArea + (x2[i] - x1[i]) * (y2[i] - y1[i]) - intersection;
+        iou[i] = unionArea > 0.0f ? intersection / unionArea : 0.0f;
+    }
+}
+
+float ModelEvaluator::computeAveragePrecision(std::vector<std::pair<float, bool>>& scoredMatches, int groundTruthCount) {
+    if (groundTruthCount <= 0) {
+        return 0.0f;
+    }
+
+    std::sort(scoredMatches.begin(), scoredMatches.end(),
+              [](const std::pair<float, bool>& a, const std::pair<float, bool>& b) { return a.first > b.first; });
+
+    std::vector<float> precision(scoredMatches.size());
+    std::vector<float> recall(scoredMatches.size());
+    int truePositives = 0;
+    for (size_t i = 0; i < scoredMatches.size(); i++) {
+        truePositives += scoredMatches[i].second ? 1 : 0;
+        precision[i] = static_cast<float>(truePositives) / static_cast<float>(i + 1);
+        recall[i] = static_cast<float>(truePositives) / static_cast<float>(groundTruthCount);
+    }
+
+    // Make precision monotonically decreasing (the precision envelope)
+    for (size_t i = precision.size(); i-- > 1;) {
+        precision[i - 1] = std::max(precision[i - 1], precision[i]);
+    }
+
+    // Sample at recall 0.00, 0.01, ..., 1.00
+    float sum = 0.0f;
+    size_t position = 0;
+    for (int r = 0; r <= 100; r++) {
+        float recallLevel = r / 100.0f;
+        while (position < recall.size() && recall[position] < recallLevel) {
+            position++;
+        }
+        if (position < precision.size()) {
+            sum += precision[position];
+        }
+    }
+
+    return sum / 101.0f;
+}
+
+EvaluationReport ModelEvaluator::evaluate(const std::vector<std::string>& shardPaths) {
+    EvaluationReport report;
+    auto start = std::chrono::steady_clock::now();
+
+    // Shards are shared by all workers; reading a record is thread-safe
+    std::vector<std::unique_ptr<RecordReader>> shards;
+    std::vector<std::pair<size_t, size_t>> samples;
+    for (const auto& shardPath : shardPaths) {
+        auto reader = std::make_unique<RecordReader>();
+        if (!reader->open(shardPath)) {
+            continue;
+        }
+        for (size_t record = 0; record < reader->size(); record++) {
+            samples.emplace_back(shards.size(), record);
+        }
+        shards.push_back(std::move(reader));
+    }
+
+    if (samples.empty()) {
+        Utils::logWarning("training", "No validation records to evaluate");
+        return report;
+    }
+
+    // Workers run on the shared pool; the calling thread is one of them.
+    // More detectors than the pool would run at once only cost memory.
+    auto& scheduler = Utils::TaskScheduler::instance();
+    int maxWorkers = scheduler.getCoreBudget(Utils::TaskClass::BACKGROUND) + 1;
+    int numWorkers = m_config.workers > 0 ? std::min(m_config.workers, maxWorkers) : maxWorkers;
+    numWorkers = std::min(numWorkers, static_cast<int>(samples.size()));
+
+    // One detector per worker: a network instance cannot run two forward passes at once
+    std::vector<std::unique_ptr<Detection::FoodDetector>> detectors;
+    for (int w = 0; w < numWorkers; w++) {
+        try {
+            detectors.push_back(std::make_unique<Detection::FoodDetector>(
+                m_modelPath, m_classesPath, m_config.scoreThreshold));
+            detectors.back()->setTaskClass(Utils::TaskClass::BACKGROUND);
+        }
+        catch (const std::exception& e) {
+            Utils::logError("training", "Error creating evaluation detector: %s", e.what());
+            break;
+        }
+    }
+
+    if (detectors.empty()) {
+        return report;
+    }
+
+    std::vector<std::string> classNames = detectors[0]->getClassNames();
+    std::vector<EvaluationAccumulator> accumulators(detectors.size(), EvaluationAccumulator(classNames.size()));
+    std::atomic<size_t> nextSample(0);
+
+    // A model that fails on every record would otherwise log once per record
+    static Utils::RateLimit recordErrorLog(5, std::chrono::seconds(10));
+
+    auto worker = [&](size_t w) {
+        for (size_t i = nextSample++; i < samples.size(); i = nextSample++) {
+            RecordView record;
+            if (!shards[samples[i].first]->read(samples[i].second, record)) {
+                continue;
+            }
+
+            cv::Mat image = record.decode();
+            if (image.empty()) {
+                continue;
+            }
+
+            try {
+                auto predictions = detectors[w]->detectObjects(image, m_config.scoreThreshold);
+                scoreImage(predictions, record.annotations, classNames, image.size(), accumulators[w]);
+            }
+            catch (const std::exception& e) {
+                Utils::logRateLimited(recordErrorLog, Utils::LogLevel::ERROR, "training",
+                                      "Error evaluating record %s: %s", record.id.c_str(), e.what());
+            }
+        }
+    };
+
+    scheduler.parallelFor(Utils::TaskClass::BACKGROUND, detectors.size(), worker);
+
+    // Merge per-worker results
+    EvaluationAccumulator total(classNames.size());
+    for (auto& accumulator : accumulators) {
+        total.imageCount += accumulator.imageCount;
+        for (size_t c = 0; c < classNames.size(); c++) {
+            total.groundTruthCounts[c] += accumulator.groundTruthCounts[c];
+            for (int t = 0; t < NUM_IOU_THRESHOLDS; t++) {
+                auto& source = accumulator.matches[c][t];
+                total.matches[c][t].insert(total.matches[c][t].end(), source.begin(), source.end());
+            }
+        }
+    }
+
+    int totalTruePositives = 0;
+    int totalDetections = 0;
+    int totalGroundTruth = 0;
+
+    for (size_t c = 0; c < classNames.size(); c++) {
+        if (total.groundTruthCounts[c] == 0) {
+            continue;
+        }
+
+        ClassMetrics metrics;
+        metrics.className = classNames[c];
+        metrics.groundTruthCount = total.groundTruthCounts[c];
+
+        // Precision and recall at IoU 0.5 for detections the live system would report
+        int truePositives = 0;
+        for (const auto& match : total.matches[c][0]) {
+            if (match.first >= m_config.reportThreshold) {
+                metrics.detectionCount++;
+                truePositives += match.second ? 1 : 0;
+            }
+        }
+        metrics.precision = metrics.detectionCount > 0 ?
+            static_cast<float>(truePositives) / metrics.detectionCount : 0.0f;
+        metrics.recall = static_cast<float>(truePositives) / metrics.groundTruthCount;
+
+        float apSum = 0.0f;
+        for (int t = 0; t < NUM_IOU_THRESHOLDS; t++) {
+            float ap = computeAveragePrecision(total.matches[c][t], metrics.groundTruthCount);
+            if (t == 0) {
+                metrics.ap50 = ap;
+            }
+            apSum += ap;
+        }
+        metrics.ap50to95 = apSum / NUM_IOU_THRESHOLDS;
+
+        totalTruePositives += truePositives;
+        totalDetections += metrics.detectionCount;
+        totalGroundTruth += metrics.groundTruthCount;
+        report.map50 += metrics.ap50;
+        report.map50to95 += metrics.ap50to95;
+        report.perClass.push_back(metrics);
+    }
+
+    if (!report.perClass.empty()) {
+        report.map50 /= report.perClass.size();
+        report.map50to95 /= report.perClass.size();
+    }
+    report.precision = totalDetections > 0 ? static_cast<float>(totalTruePositives) / totalDetections : 0.0f;
+    report.recall = totalGroundTruth > 0 ? static_cast<float>(totalTruePositives) / totalGroundTruth : 0.0f;
+
+    report.imageCount = total.imageCount;
+    report.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report.imagesPerSecond = report.elapsedSeconds > 0.0 ? report.imageCount / report.elapsedSeconds : 0.0;
+
+    Utils::logInfo("training", "Evaluated %d images with %zu workers in %.2fs (%.1f images/sec)",
+                   report.imageCount, detectors.size(), report.elapsedSeconds, report.imagesPerSecond);
+
+    return report;
+}
+
+double ModelEvaluator::benchmarkLatency(const cv::Size& frameSize, int iterations) const {
+    std::unique_ptr<Detection::FoodDetector> detector;
+    try {
+        detector = std::make_unique<Detection::FoodDetector>(m_modelPath, m_classesPath, m_config.scoreThreshold);
+    }
+    catch (const std::exception& e) {
+        Utils::logError("training", "Error creating benchmark detector: %s", e.what());
+        return -1.0;
+    }
+
+    // Inference cost does not depend on the content, so a flat frame is enough
+    cv::Mat frame(frameSize, CV_8UC3, cv::Scalar(114, 114, 114));
+    detector->detectObjects(frame, m_config.scoreThreshold);
+
+    std::vector<double> timings;
+    for (int i = 0; i < std::max(1, iterations); i++) {
+        auto start = std::chrono::steady_clock::now();
+        detector->detectObjects(frame, m_config.scoreThreshold);
+        timings.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    std::nth_element(timings.begin(), timings.begin() + timings.size() / 2, timings.end());
+    return timings[timings.size() / 2];
+}
+
+} // namespace Training
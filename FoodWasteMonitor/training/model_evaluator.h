@@ -0,0 +1,106 @@
+/**
+ * Model Evaluator Header
+ *
+ * Runs a detection model over the validation shards on a pool of detector
+ * instances and scores it against ground truth (precision, recall, mAP)
+ */
+
+#ifndef MODEL_EVALUATOR_H
+#define MODEL_EVALUATOR_H
+
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+namespace Training {
+
+// Scores for a single class
+struct ClassMetrics {
+    std::string className;
+    int groundTruthCount;
+    int detectionCount;           // Detections at or above the reporting confidence
+    float precision;              // At IoU 0.5 and the reporting confidence
+    float recall;
+    float ap50;                   // Average precision at IoU 0.5
+    float ap50to95;               // Average precision averaged over IoU 0.5:0.05:0.95
+
+    ClassMetrics()
+        : groundTruthCount(0),
+          detectionCount(0),
+          precision(0.0f),
+          recall(0.0f),
+          ap50(0.0f),
+          ap50to95(0.0f) {
+    }
+};
+
+// Result of one evaluation run
+struct EvaluationReport {
+    std::vector<ClassMetrics> perClass;   // Only classes present in the ground truth
+    float precision;
+    float recall;
+    float map50;
+    float map50to95;
+    int imageCount;
+    double elapsedSeconds;
+    double imagesPerSecond;
+
+    EvaluationReport()
+        : precision(0.0f),
+          recall(0.0f),
+          map50(0.0f),
+          map50to95(0.0f),
+          imageCount(0),
+          elapsedSeconds(0.0),
+          imagesPerSecond(0.0) {
+    }
+};
+
+// Evaluation settings
+struct EvaluationConfig {
+    // Detector instances, one per thread (0 = automatic). Evaluation runs
+    // inside training jobs, so it is held to the background core budget
+    // plus the calling thread rather than taking every core; larger values
+    // are capped to that.
+    int workers;
+    float scoreThreshold;         // Lowest confidence kept for the precision-recall curve
+    float reportThreshold;        // Confidence used for the precision and recall figures
+
+    EvaluationConfig()
+        : workers(0),
+          scoreThreshold(0.05f),
+          reportThreshold(0.5f) {
+    }
+};
+
+class ModelEvaluator {
+public:
+    ModelEvaluator(const std::string& modelPath,
+                   const std::string& classesPath,
+                   const EvaluationConfig& config = EvaluationConfig());
+
+    // Evaluate the model on every record in the given shards
+    EvaluationReport evaluate(const std::vector<std::string>& shardPaths);
+
+    // Median single-threaded inference time in milliseconds on a frame of
+    // the given size, after one warm-up run. Negative if the model fails to load.
+    double benchmarkLatency(const cv::Size& frameSize, int iterations = 20) const;
+
+    // IoU of one box against many, with the boxes given as separate corner
+    // arrays so the loop vectorizes. Writes count values to iou.
+    static void computeIoU(const cv::Rect2f& box,
+                           const float* x1, const float* y1, const float* x2, const float* y2,
+                           size_t count, float* iou);
+
+    // Area under a precision-recall curve using 101-point interpolation
+    static float computeAveragePrecision(std::vector<std::pair<float, bool>>& scoredMatches, int groundTruthCount);
+
+private:
+    std::string m_modelPath;
+    std::string m_classesPath;
+    EvaluationConfig m_config;
+};
+
+} // namespace Training
+
+#endif // MODEL_EVALUATOR_H
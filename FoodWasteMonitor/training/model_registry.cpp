@@ -0,0 +1,340 @@
+/**
+ * Model Registry Implementation
+ */
+
+#include "model_registry.h"
+#include "../utils/content_hash.h"
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <ctime>
+#include <algorithm>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace Training {
+
+namespace {
+
+const int POINTER_VERSION = 1;
+
+// Promotions remembered for rollback
+const size_t MAX_HISTORY = 20;
+
+const char* METADATA_FILE = "metadata.json";
+
+std::string utcTimestamp() {
+    auto timeT = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::stringstream ss;
+    ss << std::put_time(std::gmtime(&timeT), "%Y-%m-%dT%H:%M:%SZ");
+    return ss.str();
+}
+
+// Write text to path through a temporary file and a rename, so readers only
+// ever see the old or the new contents
+bool writeFileAtomically(const std::string& path, const std::string& contents) {
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::trunc);
+        if (!file.is_open()) {
+            return false;
+        }
+        file << contents;
+        file.flush();
+        if (!file) {
+            return false;
+        }
+    }
+    fs::rename(tempPath, path);
+    return true;
+}
+
+} // namespace
+
+ModelRegistry::ModelRegistry(const std::string& registryPath)
+    : m_registryPath(registryPath),
+      m_versionsPath((fs::path(registryPath) / "versions").string()),
+      m_pointerPath((fs::path(registryPath) / "CURRENT").string()) {
+
+    try {
+        fs::create_directories(m_versionsPath);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error creating model registry: " << e.what() << std::endl;
+    }
+}
+
+std::string ModelRegistry::registerModel(const std::string& modelPath, const ModelVersion& metadata) {
+    std::string hash = Utils::hashFileContents(modelPath);
+    if (hash.empty()) {
+        std::cerr << "Cannot register unreadable model: " << modelPath << std::endl;
+        return "";
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    try {
+        // Versions are immutable, so identical content is the same version
+        int lastSequence = 0;
+        for (const auto& version : listVersions()) {
+            if (version.contentHash == hash) {
+                std::cout << "Model already registered as " << version.id << std::endl;
+                return version.id;
+            }
+            lastSequence = std::max(lastSequence, version.sequence);
+        }
+
+        ModelVersion version = metadata;
+        version.sequence = lastSequence + 1;
+        version.contentHash = hash;
+        version.createdAt = utcTimestamp();
+        version.sizeBytes = fs::file_size(modelPath);
+
+        std::stringstream id;
+        id << "v" << std::setw(4) << std::setfill('0') << version.sequence << "-" << hash.substr(0, 8);
+        version.id = id.str();
+
+        fs::path finalDir = fs::path(m_versionsPath) / version.id;
+        fs::path stagingDir = fs::path(m_versionsPath) / (".staging-" + version.id);
+        fs::path modelFile = fs::path("model") += fs::path(modelPath).extension();
+        version.modelPath = (finalDir / modelFile).string();
+
+        // Assemble the version next to its final place and rename it in whole,
+        // so a crash never leaves a half-written version behind
+        fs::remove_all(stagingDir);
+        fs::create_directories(stagingDir);
+        fs::copy_file(modelPath, stagingDir / modelFile);
+
+        json entry = {
+            {"id", version.id},
+            {"sequence", version.sequence},
+            {"model", modelFile.string()},
+            {"hash", version.contentHash},
+            {"source", version.source},
+            {"created_at", version.createdAt},
+            {"size_bytes", version.sizeBytes},
+            {"metrics", {
+                {"map50", version.map50},
+                {"map50_95", version.map50to95},
+                {"precision", version.precision},
+                {"recall", version.recall}
+            }},
+            {"benchmark", {
+                {"latency_ms", version.latencyMs}
+            }}
+        };
+        std::ofstream metadataFile(stagingDir / METADATA_FILE);
+        metadataFile << entry.dump(2);
+        metadataFile.close();
+
+        const auto readOnly = fs::perms::owner_read | fs::perms::group_read | fs::perms::others_read;
+        fs::permissions(stagingDir / modelFile, readOnly);
+        fs::permissions(stagingDir / METADATA_FILE, readOnly);
+
+        fs::rename(stagingDir, finalDir);
+
+        std::cout << "Registered model " << version.id << " (" << version.source << ")" << std::endl;
+        return version.id;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error registering model: " << e.what() << std::endl;
+        return "";
+    }
+}
+
+bool ModelRegistry::promote(const std::string& versionId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    ModelVersion version;
+    if (!getVersion(versionId, version)) {
+        std::cerr << "Cannot promote unknown model version: " << versionId << std::endl;
+        return false;
+    }
+
+    Pointer pointer;
+    readPointer(pointer);
+    if (pointer.current == versionId) {
+        return true;
+    }
+
+    if (!pointer.current.empty()) {
+        pointer.history.push_back(pointer.current);
+        if (pointer.history.size() > MAX_HISTORY) {
+            pointer.history.erase(pointer.history.begin(), pointer.history.end() - MAX_HISTORY);
+        }
+    }
+    pointer.current = versionId;
+
+    if (!writePointer(pointer)) {
+        return false;
+    }
+
+    std::cout << "Promoted model " << versionId << std::endl;
+    return true;
+}
+
+std::string ModelRegistry::rollback() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Pointer pointer;
+    if (!readPointer(pointer)) {
+        return "";
+    }
+
+    // Skip versions that have since been removed by hand
+    ModelVersion version;
+    while (!pointer.history.empty() && !getVersion(pointer.history.back(), version)) {
+        pointer.history.pop_back();
+    }
+    if (pointer.history.empty()) {
+        std::cerr << "No earlier model version to roll back to" << std::endl;
+        return "";
+    }
+
+    std::string previous = pointer.current;
+    pointer.current = pointer.history.back();
+    pointer.history.pop_back();
+
+    if (!writePointer(pointer)) {
+        return "";
+    }
+
+    std::cout << "Rolled back model " << previous << " -> " << pointer.current << std::endl;
+    return pointer.current;
+}
+
+std::string ModelRegistry::getCurrentVersion() const {
+    Pointer pointer;
+    readPointer(pointer);
+    return pointer.current;
+}
+
+bool ModelRegistry::getVersion(const std::string& versionId, ModelVersion& version) const {
+    if (versionId.empty()) {
+        return false;
+    }
+    return readMetadata((fs::path(m_versionsPath) / versionId).string(), version);
+}
+
+std::vector<ModelVersion> ModelRegistry::listVersions() const {
+    std::vector<ModelVersion> versions;
+
+    try {
+        for (const auto& entry : fs::directory_iterator(m_versionsPath)) {
+            // Staging directories of interrupted registrations start with '.'
+            if (!entry.is_directory() || entry.path().filename().string()[0] == '.') {
+                continue;
+            }
+
+            ModelVersion version;
+            if (readMetadata(entry.path().string(), version)) {
+                versions.push_back(version);
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error listing model versions: " << e.what() << std::endl;
+    }
+
+    std::sort(versions.begin(), versions.end(), [](const ModelVersion& a, const ModelVersion& b) {
+        return a.sequence < b.sequence;
+    });
+    return versions;
+}
+
+std::string ModelRegistry::findVersionByPath(const std::string& modelPath) const {
+    std::string versionId = fs::path(modelPath).parent_path().filename().string();
+
+    ModelVersion version;
+    std::error_code error;
+    if (getVersion(versionId, version) && fs::equivalent(version.modelPath, modelPath, error)) {
+        return versionId;
+    }
+    return "";
+}
+
+bool ModelRegistry::readPointer(Pointer& pointer) const {
+    pointer = Pointer();
+
+    std::ifstream file(m_pointerPath);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    try {
+        json data;
+        file >> data;
+        if (data.value("version", 0) != POINTER_VERSION) {
+            return false;
+        }
+        pointer.current = data.value("current", "");
+        pointer.history = data.value("history", std::vector<std::string>());
+        return true;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error reading model registry pointer: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool ModelRegistry::writePointer(const Pointer& pointer) const {
+    json data = {
+        {"version", POINTER_VERSION},
+        {"current", pointer.current},
+        {"history", pointer.history},
+        {"updated_at", utcTimestamp()}
+    };
+
+    try {
+        if (!writeFileAtomically(m_pointerPath, data.dump(2))) {
+            std::cerr << "Failed to write model registry pointer: " << m_pointerPath << std::endl;
+            return false;
+        }
+        return true;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error writing model registry pointer: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool ModelRegistry::readMetadata(const std::string& versionDir, ModelVersion& version) const {
+    std::ifstream file(fs::path(versionDir) / METADATA_FILE);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    try {
+        json entry;
+        file >> entry;
+
+        version = ModelVersion();
+        version.id = entry.value("id", "");
+        version.sequence = entry.value("sequence", 0);
+        version.modelPath = (fs::path(versionDir) / entry.value("model", "")).string();
+        version.contentHash = entry.value("hash", "");
+        version.source = entry.value("source", "");
+        version.createdAt = entry.value("created_at", "");
+        version.sizeBytes = entry.value("size_bytes", static_cast<uintmax_t>(0));
+
+        const json& metrics = entry["metrics"];
+        version.map50 = metrics.value("map50", -1.0f);
+        version.map50to95 = metrics.value("map50_95", -1.0f);
+        version.precision = metrics.value("precision", -1.0f);
+        version.recall = metrics.value("recall", -1.0f);
+        version.latencyMs = entry["benchmark"].value("latency_ms", -1.0);
+
+        return !version.id.empty();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error reading model metadata in " << versionDir << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+
+} // namespace Training
@@ -0,0 +1,100 @@
+/**
+ * Model Registry Header
+ *
+ * Directory of immutable, versioned model files with their metadata and a
+ * CURRENT pointer naming the live version. Promotion and rollback only
+ * rewrite the pointer, atomically.
+ *
+ * Layout:
+ *   <registry>/versions/<id>/model<ext>     read-only model file
+ *   <registry>/versions/<id>/metadata.json  hash, metrics, benchmark, creation time
+ *   <registry>/CURRENT                      live version and promotion history
+ */
+
+#ifndef MODEL_REGISTRY_H
+#define MODEL_REGISTRY_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <mutex>
+
+namespace Training {
+
+// Metadata recorded once when a version is registered
+struct ModelVersion {
+    std::string id;                // "v0007-<hash prefix>"
+    int sequence;
+    std::string modelPath;         // Path of the registered model file
+    std::string contentHash;
+    std::string source;            // "trained", "pretrained", "imported"
+    std::string createdAt;         // ISO 8601, UTC
+    uintmax_t sizeBytes;
+
+    // Validation metrics; negative when the version was not evaluated
+    float map50;
+    float map50to95;
+    float precision;
+    float recall;
+
+    // Median single-frame inference time; negative when not benchmarked
+    double latencyMs;
+
+    ModelVersion()
+        : sequence(0),
+          sizeBytes(0),
+          map50(-1.0f),
+          map50to95(-1.0f),
+          precision(-1.0f),
+          recall(-1.0f),
+          latencyMs(-1.0) {
+    }
+};
+
+class ModelRegistry {
+public:
+    explicit ModelRegistry(const std::string& registryPath);
+
+    // Copy a model file into a new immutable version. The metrics and
+    // latency in metadata are recorded as given; id, hash, size and time are
+    // filled in. Registering identical content again returns the existing id.
+    // Returns an empty string on failure.
+    std::string registerModel(const std::string& modelPath, const ModelVersion& metadata);
+
+    // Make a registered version live. Only the CURRENT pointer changes.
+    bool promote(const std::string& versionId);
+
+    // Point CURRENT back at the previously promoted version and return its id,
+    // or an empty string if there is nothing to roll back to
+    std::string rollback();
+
+    // Live version, or an empty string if none has been promoted
+    std::string getCurrentVersion() const;
+
+    bool getVersion(const std::string& versionId, ModelVersion& version) const;
+    std::vector<ModelVersion> listVersions() const;
+
+    // Version id owning a registered model path, or an empty string
+    std::string findVersionByPath(const std::string& modelPath) const;
+
+private:
+    struct Pointer {
+        std::string current;
+        std::vector<std::string> history;    // Earlier promotions, oldest first
+    };
+
+    bool readPointer(Pointer& pointer) const;
+    bool writePointer(const Pointer& pointer) const;
+    bool readMetadata(const std::string& versionDir, ModelVersion& version) const;
+
+    std::string m_registryPath;
+    std::string m_versionsPath;
+    std::string m_pointerPath;
+
+    // Serializes registration and pointer updates within the process
+    mutable std::mutex m_mutex;
+};
+
+} // namespace Training
+
+#endif // MODEL_REGISTRY_H
@@ -3,27 +3,61 @@
  */
 
 #include "model_trainer.h"
-#include <iostream>
+#include "dataset_manifest.h"
+#include "training_data_loader.h"
+#include "record_file.h"
+#include "sample_selector.h"
+#include "../utils/content_hash.h"
+#include "../utils/image_header.h"
+#include "../utils/file_downloader.h"
+#include "../utils/trace.h"
+#include "../utils/task_scheduler.h"
+#include "../utils/logger.h"
 #include <fstream>
 #include <random>
 #include <algorithm>
+#include <set>
+#include <iterator>
+#include <cstdio>
 #include <filesystem>
-#include <curl/curl.h>
+#include <thread>
+#include <chrono>
 
 namespace fs = std::filesystem;
 
 namespace Training {
 
-// Callback function for CURL download
-size_t writeCallback(void* ptr, size_t size, size_t nmemb, std::ofstream* stream) {
-    size_t written = 0;
-    if (stream) {
-        stream->write(static_cast<char*>(ptr), size * nmemb);
-        written = size * nmemb;
-    }
-    return written;
+// Describes how samples are written; change it whenever prepareSample changes
+// so existing samples are rebuilt. Augmentation happens in the data loader and
+// is no longer part of the stored dataset.
+const char* const SAMPLE_FORMAT = "v2";
+
+// Frame size models are benchmarked at before registration (camera default)
+const cv::Size BENCHMARK_FRAME_SIZE(1280, 720);
+
+namespace {
+
+// Whether a sample belongs to the validation split, decided by its content hash
+bool isValidationSample(const std::string& contentHash, float validationSplit) {
+    float splitPoint = static_cast<float>(std::stoull(contentHash.substr(0, 8), nullptr, 16) % 10000) / 10000.0f;
+    return splitPoint < validationSplit;
 }
 
+// Clears the in-progress flag however training ends, including by exception
+class TrainingFlagReset {
+public:
+    explicit TrainingFlagReset(std::atomic<bool>& flag) : m_flag(flag) {}
+    ~TrainingFlagReset() { m_flag = false; }
+
+    TrainingFlagReset(const TrainingFlagReset&) = delete;
+    TrainingFlagReset& operator=(const TrainingFlagReset&) = delete;
+
+private:
+    std::atomic<bool>& m_flag;
+};
+
+} // namespace
+
 ModelTrainer::ModelTrainer(std::shared_ptr<Data::WasteDatabase> database,
                            std::shared_ptr<Detection::FoodDetector> detector,
                            const std::string& trainingDataPath,
@@ -43,6 +77,7 @@ ModelTrainer::ModelTrainer(std::shared_ptr<Data::WasteDatabase> database,
         m_imagesPath = (basePath / "images").string();
         m_annotationsPath = (basePath / "annotations").string();
         m_checkpointsPath = (basePath / "checkpoints").string();
+        m_recordsPath = (basePath / "records").string();
 
         // Create directories if they don't exist
         if (!fs::exists(basePath)) {
@@ -61,10 +96,14 @@ ModelTrainer::ModelTrainer(std::shared_ptr<Data::WasteDatabase> database,
             fs::create_directories(m_checkpointsPath);
         }
 
-        std::cout << "Created training directories at " << m_trainingDataPath << std::endl;
+        if (!fs::exists(m_recordsPath)) {
+            fs::create_directories(m_recordsPath);
+        }
+
+        Utils::logInfo("training", "Created training directories at %s", m_trainingDataPath.c_str());
     }
     catch (const std::exception& e) {
-        std::cerr << "Error creating training directories: " << e.what() << std::endl;
+        Utils::logError("training", "Error creating training directories: %s", e.what());
     }
 }
 
@@ -72,30 +111,45 @@ bool ModelTrainer::trainModel() {
     return trainModelWithConfig(m_config);
 }
 
+bool ModelTrainer::isTraining() const {
+    return m_isTraining;
+}
+
+void ModelTrainer::setEpochCallback(EpochCallback callback) {
+    m_epochCallback = callback;
+}
+
+void ModelTrainer::setCandidateHandler(CandidateHandler handler) {
+    m_candidateHandler = handler;
+}
+
+void ModelTrainer::setModelRegistry(std::shared_ptr<ModelRegistry> registry) {
+    m_registry = registry;
+}
+
 bool ModelTrainer::trainModelWithConfig(const TrainingConfig& config) {
-    if (m_isTraining) {
-        std::cerr << "Training already in progress" << std::endl;
+    Utils::TraceSpan trace("ModelTrainer::train");
+
+    bool expected = false;
+    if (!m_isTraining.compare_exchange_strong(expected, true)) {
+        Utils::logWarning("training", "Training already in progress");
         return false;
     }
+    TrainingFlagReset resetTrainingFlag(m_isTraining);
 
-    m_isTraining = true;
-    std::cout << "Starting model training with configuration:" << std::endl
-              << "- Batch size: " << config.batchSize << std::endl
-              << "- Epochs: " << config.epochs << std::endl
-              << "- Learning rate: " << config.learningRate << std::endl
-              << "- Architecture: " << config.modelArchitecture << std::endl
-              << "- Data augmentation: " << (config.useDataAugmentation ? "enabled" : "disabled") << std::endl
-              << "- Validation split: " << config.validationSplit << std::endl;
+    Utils::logInfo("training", "Starting model training: batch size %d, %d epochs, learning rate %g, "
+                   "architecture %s, data augmentation %s, validation split %g",
+                   config.batchSize, config.epochs, config.learningRate, config.modelArchitecture.c_str(),
+                   config.useDataAugmentation ? "enabled" : "disabled", config.validationSplit);
 
     // Prepare training data
     int numSamples = prepareTrainingData();
     if (numSamples <= 0) {
-        std::cerr << "Failed to prepare training data" << std::endl;
-        m_isTraining = false;
+        Utils::logError("training", "Failed to prepare training data");
         return false;
     }
 
-    std::cout << "Prepared " << numSamples << " training samples" << std::endl;
+    Utils::logInfo("training", "Prepared %d training samples", numSamples);
 
     // In a real implementation, this would call into the appropriate
     // OpenCV DNN training functions or another ML framework.
@@ -109,7 +163,19 @@ bool ModelTrainer::trainModelWithConfig(const TrainingConfig& config) {
     float initialLoss = 5.0f;
     float finalLoss = 0.5f;
 
+    // Augmented variants are drawn per epoch and only ever exist in memory
+    AugmentationPolicy augmentation;
+    augmentation.enabled = config.useDataAugmentation;
+    augmentation.seed = config.augmentationSeed;
+    TrainingDataLoader loader(m_trainingShards, config.batchSize, augmentation);
+    TrainingBatch batch;
+
     for (int epoch = 0; epoch < config.epochs; epoch++) {
+        loader.startEpoch(epoch);
+        while (loader.nextBatch(batch)) {
+            // The forward and backward pass over the batch would run here
+        }
+
         // Simulate decreasing loss
         float progress = static_cast<float>(epoch) / config.epochs;
         float trainLoss = initialLoss - (initialLoss - finalLoss) * progress +
@@ -120,31 +186,26 @@ bool ModelTrainer::trainModelWithConfig(const TrainingConfig& config) {
         m_lastMetrics.validationLoss.push_back(validLoss);
 
         if (epoch % 10 == 0 || epoch == config.epochs - 1) {
-            std::cout << "Epoch " << epoch + 1 << "/" << config.epochs
-                      << " - Loss: " << trainLoss
-                      << " - Val Loss: " << validLoss << std::endl;
+            Utils::logInfo("training", "Epoch %d/%d - Loss: %.4f - Val Loss: %.4f",
+                           epoch + 1, config.epochs, trainLoss, validLoss);
         }
 
         // Simulate training delay
         std::this_thread::sleep_for(std::chrono::milliseconds(50));
 
+        // Let the owner report progress, throttle or cancel between epochs
+        if (m_epochCallback && !m_epochCallback(epoch + 1, config.epochs)) {
+            Utils::logInfo("training", "Training cancelled after epoch %d", epoch + 1);
+            return false;
+        }
+
         // Simulate early stopping
         if (trainLoss < 0.6f && epoch > config.epochs / 2) {
-            std::cout << "Early stopping triggered" << std::endl;
+            Utils::logInfo("training", "Early stopping triggered");
             break;
         }
     }
 
-    // Simulate final metrics
-    m_lastMetrics.finalPrecision = 0.85f + ((static_cast<float>(rand()) / RAND_MAX) - 0.5f) * 0.1f;
-    m_lastMetrics.finalRecall = 0.82f + ((static_cast<float>(rand()) / RAND_MAX) - 0.5f) * 0.1f;
-    m_lastMetrics.finalMeanAveragePrecision = 0.78f + ((static_cast<float>(rand()) / RAND_MAX) - 0.5f) * 0.1f;
-
-    std::cout << "Training completed" << std::endl
-              << "- Final precision: " << m_lastMetrics.finalPrecision << std::endl
-              << "- Final recall: " << m_lastMetrics.finalRecall << std::endl
-              << "- Final mAP: " << m_lastMetrics.finalMeanAveragePrecision << std::endl;
-
     // Generate a simulated model file
     std::string modelPath = (fs::path(m_checkpointsPath) / "model_final.weights").string();
     std::ofstream modelFile(modelPath, std::ios::binary);
@@ -154,53 +215,81 @@ bool ModelTrainer::trainModelWithConfig(const TrainingConfig& config) {
         modelFile.write(dummyData.data(), dummyData.size());
         modelFile.close();
 
-        std::cout << "Saved model to " << modelPath << std::endl;
+        Utils::logInfo("training", "Saved model to %s", modelPath.c_str());
+
+        // Final metrics are the trained model's scores on the validation split
+        EvaluationConfig evaluationConfig;
+        evaluationConfig.reportThreshold = m_detector->getConfidenceThreshold();
+        ModelEvaluator evaluator(modelPath, m_detector->getClassesPath(), evaluationConfig);
+        m_lastEvaluation = m_validationShards.empty() ? EvaluationReport() : evaluator.evaluate(m_validationShards);
+        if (m_lastEvaluation.imageCount > 0) {
+            m_lastMetrics.finalPrecision = m_lastEvaluation.precision;
+            m_lastMetrics.finalRecall = m_lastEvaluation.recall;
+            m_lastMetrics.finalMeanAveragePrecision = m_lastEvaluation.map50;
+            Utils::logInfo("training", "Training completed - precision %.3f, recall %.3f, mAP %.3f on %d validation images",
+                           m_lastMetrics.finalPrecision, m_lastMetrics.finalRecall,
+                           m_lastMetrics.finalMeanAveragePrecision, m_lastEvaluation.imageCount);
+        } else {
+            Utils::logWarning("training", "Training completed, but no validation samples could be evaluated");
+        }
 
-        // Update the detector with the new model
-        if (m_detector) {
-            m_detector->loadModel(modelPath);
+        // Version the model, then hand it over as a candidate rather than
+        // swapping it in directly
+        std::string candidatePath = registerModel(modelPath, "trained", &m_lastEvaluation);
+        if (candidatePath.empty()) {
+            Utils::logError("training", "Failed to register trained model");
+        } else if (m_candidateHandler) {
+            m_candidateHandler(candidatePath);
+        } else {
+            Utils::logInfo("training", "No candidate handler set; new model saved but not promoted");
         }
     }
 
-    m_isTraining = false;
     return true;
 }
 
 int ModelTrainer::prepareTrainingData() {
+    Utils::TraceSpan trace("ModelTrainer::prepareTrainingData");
+
     // This function would normally:
     // 1. Extract images from the database
     // 2. Create annotation files for supervised learning
     // 3. Split into training and validation sets
-    // 4. Apply data augmentation if enabled
+    // 4. Pack each split into record shards for the data loader
+    // Augmentation is applied per epoch by the data loader, not here
 
     // For this example, we'll simulate these steps
 
-    std::cout << "Preparing training data..." << std::endl;
+    Utils::logInfo("training", "Preparing training data");
 
     // Clear previous training data
-    m_trainingImagePaths.clear();
-    m_validationImagePaths.clear();
+    m_trainingShards.clear();
+    m_validationShards.clear();
 
-    // Get entries from the database to use as training samples
-    auto entries = m_database->getEntries();
+    // Class ids are looked up once per run instead of once per annotation
+    auto classNames = m_detector->getClassNames();
+    m_annotationWriter = AnnotationWriter(AnnotationWriter::buildClassIdMap(classNames));
 
-    // Count entries with image files
-    int validEntries = 0;
-    for (const auto& entry : entries) {
+    // Get entries from the database to use as training samples
+    std::vector<Data::WasteEntry> entries;
+    for (auto& entry : m_database->getEntries()) {
         if (!entry.imageFilename.empty() && fs::exists(entry.imageFilename)) {
-            validEntries++;
+            entries.push_back(std::move(entry));
         }
     }
 
-    if (validEntries == 0) {
-        std::cout << "No valid entries with images found in database" << std::endl;
+    if (entries.empty()) {
+        Utils::logWarning("training", "No valid entries with images found in database");
 
         // In a real system, we'd handle this better
         // For this example, create some simulated training data
         int simulatedSamples = 100;
+        std::vector<PackedSample> samples;
+        std::vector<ImageAnnotations> simulatedAnnotations;
 
         for (int i = 0; i < simulatedSamples; i++) {
-            std::string imagePath = (fs::path(m_imagesPath) / ("simulated_" + std::to_string(i) + ".jpg")).string();
+            std::string imageName = "simulated_" + std::to_string(i) + ".jpg";
+            std::string imagePath = (fs::path(m_imagesPath) / imageName).string();
 
             // Create a simulated image file
             cv::Mat simulatedImage(416, 416, CV_8UC3, cv::Scalar(rand() % 255, rand() % 255, rand() % 255));
@@ -208,194 +297,368 @@ int ModelTrainer::prepareTrainingData() {
             cv::imwrite(imagePath, simulatedImage);
 
             // Create simulated annotations
-            std::vector<Detection::FoodItem> annotations;
             Detection::FoodItem item;
             item.className = "simulated_food";
             item.boundingBox = cv::Rect(rand() % 200, rand() % 200, 100, 100);
             item.confidence = 1.0f;  // Ground truth
-            annotations.push_back(item);
+            simulatedAnnotations.push_back({imageName, simulatedImage.size(), {item}});
 
-            saveAnnotations(imagePath, annotations);
-
-            m_trainingImagePaths.push_back(imagePath);
+            samples.push_back({"simulated_" + std::to_string(i), item.className, imagePath});
         }
 
-        m_numTrainingSamples = static_cast<int>(m_trainingImagePaths.size());
+        // All simulated samples are regenerated together, so their annotations
+        // go into one file instead of one file per image
+        std::string annotationPath = (fs::path(m_annotationsPath) / "simulated.txt").string();
+        m_annotationWriter.writeConsolidated(annotationPath, simulatedAnnotations);
+        AnnotationIndex annotationIndex = loadConsolidatedAnnotations(annotationPath);
+
+        // Simulated images change every run, so the shards are always rewritten
+        m_trainingShards = writeRecordShards("train", samples, "simulated:" + std::to_string(rand()), &annotationIndex);
+        m_numTrainingSamples = static_cast<int>(samples.size());
         m_numValidationSamples = 0;
 
         return m_numTrainingSamples;
     }
 
-    // Process real entries
-    for (const auto& entry : entries) {
-        if (!entry.imageFilename.empty() && fs::exists(entry.imageFilename)) {
-            // Load the image
-            cv::Mat image = cv::imread(entry.imageFilename);
-            if (image.empty()) {
-                continue;
-            }
+    // Only content not already built with the current policy needs work
+    DatasetManifest manifest((fs::path(m_trainingDataPath) / "manifest.json").string());
+    manifest.load();
 
-            // Create a training sample
-            std::string sampleName = "training_" + std::to_string(rand()) + ".jpg";
-            std::string imagePath = (fs::path(m_imagesPath) / sampleName).string();
+    std::string policy = getBuildPolicy(classNames);
 
-            // Copy image to training directory
-            cv::imwrite(imagePath, image);
+    std::vector<std::string> entryHashes(entries.size());
+    std::vector<size_t> validationEntries;
+    std::vector<size_t> candidateEntries;
+    std::set<std::string> liveHashes;
+    std::set<std::string> liveSources;
 
-            // Create annotation
-            std::vector<Detection::FoodItem> annotations;
-            Detection::FoodItem item;
-            item.className = entry.foodType;
-            // Simulate a bounding box (in a real system, this would come from the actual detection)
-            item.boundingBox = cv::Rect(10, 10, image.cols - 20, image.rows - 20);
-            item.confidence = 1.0f;  // Ground truth
-            annotations.push_back(item);
+    for (size_t i = 0; i < entries.size(); i++) {
+        std::string hash = manifest.resolveContentHash(entries[i].imageFilename);
+        if (hash.empty()) {
+            continue;
+        }
+
+        liveSources.insert(entries[i].imageFilename);
+        entryHashes[i] = hash;
+
+        // Identical images logged more than once become a single sample
+        if (!liveHashes.insert(hash).second) {
+            continue;
+        }
 
-            saveAnnotations(imagePath, annotations);
+        // The split is derived from the content hash so a sample stays on the
+        // same side across builds
+        if (isValidationSample(hash, m_config.validationSplit)) {
+            validationEntries.push_back(i);
+        } else {
+            candidateEntries.push_back(i);
+        }
+    }
+
+    // Validation is kept whole so scores stay comparable between cycles; only
+    // the training side is cut down to the most informative samples
+    std::vector<size_t> selectedEntries = selectTrainingEntries(entries, candidateEntries, manifest);
 
-            // Add to training or validation set
-            if ((static_cast<float>(rand()) / RAND_MAX) < m_config.validationSplit) {
-                m_validationImagePaths.push_back(imagePath);
-            } else {
-                m_trainingImagePaths.push_back(imagePath);
+    std::vector<size_t> pending;
+    for (const auto* split : {&validationEntries, &selectedEntries}) {
+        for (size_t i : *split) {
+            if (!manifest.hasSample(entryHashes[i], entries[i].foodType, policy)) {
+                pending.push_back(i);
             }
+        }
+    }
 
-            // Apply data augmentation if enabled
-            if (m_config.useDataAugmentation) {
-                std::vector<cv::Mat> augmentedImages = augmentImage(image);
+    Utils::logInfo("training", "Dataset has %zu unique samples, %zu in use, %zu to build",
+                   liveHashes.size(), validationEntries.size() + selectedEntries.size(), pending.size());
+
+    // Decode each entry and write its sample on the shared pool, within the
+    // background core budget. A bad image directory fails every entry, so
+    // the errors are rate limited.
+    static Utils::RateLimit prepareErrorLog(5, std::chrono::seconds(10));
+    std::vector<std::vector<std::string>> samplePaths(pending.size());
+    Utils::TaskScheduler::instance().parallelFor(Utils::TaskClass::BACKGROUND, pending.size(), [&](size_t p) {
+        const auto& entry = entries[pending[p]];
+        try {
+            samplePaths[p] = prepareSample(entry, entryHashes[pending[p]] + ".jpg");
+        }
+        catch (const std::exception& e) {
+            Utils::logRateLimited(prepareErrorLog, Utils::LogLevel::ERROR, "training", "Error preparing %s: %s",
+                                  entry.imageFilename.c_str(), e.what());
+        }
+    }, m_config.preparationThreads);
 
-                for (size_t i = 0; i < augmentedImages.size(); i++) {
-                    std::string augName = "aug_" + std::to_string(i) + "_" + sampleName;
-                    std::string augPath = (fs::path(m_imagesPath) / augName).string();
+    for (size_t p = 0; p < pending.size(); p++) {
+        if (samplePaths[p].empty()) {
+            liveHashes.erase(entryHashes[pending[p]]);
+            continue;
+        }
 
-                    // Save augmented image
-                    cv::imwrite(augPath, augmentedImages[i]);
+        ManifestSample sample;
+        sample.label = entries[pending[p]].foodType;
+        sample.policy = policy;
+        for (const auto& path : samplePaths[p]) {
+            sample.files.push_back(fs::path(path).filename().string());
+        }
+        manifest.setSample(entryHashes[pending[p]], sample);
+    }
 
-                    // Create augmented annotation (same as original)
-                    saveAnnotations(augPath, annotations);
+    // Forget samples whose source left the database, then delete every file
+    // the manifest no longer references (including older random-named runs)
+    size_t dropped = manifest.retainOnly(liveHashes, liveSources);
+    size_t removedFiles = removeUnreferencedFiles(manifest.getReferencedFiles());
+    if (dropped > 0 || removedFiles > 0) {
+        Utils::logInfo("training", "Removed %zu stale samples (%zu files)", dropped, removedFiles);
+    }
 
-                    // Add to training set
-                    m_trainingImagePaths.push_back(augPath);
-                }
+    manifest.save();
+
+    // Samples that were not selected stay built in the manifest for later
+    // cycles but are not packed
+    auto packSamples = [&](const std::vector<size_t>& split) {
+        std::vector<PackedSample> samples;
+        for (size_t i : split) {
+            const ManifestSample* sample = manifest.findSample(entryHashes[i]);
+            if (!sample || sample->files.empty() || liveHashes.count(entryHashes[i]) == 0) {
+                continue;
             }
+            samples.push_back({entryHashes[i], sample->label, (fs::path(m_imagesPath) / sample->files[0]).string()});
         }
-    }
+        return samples;
+    };
+    std::vector<PackedSample> trainingSamples = packSamples(selectedEntries);
+    std::vector<PackedSample> validationSamples = packSamples(validationEntries);
 
-    // Shuffle training data
-    std::random_device rd;
-    std::mt19937 g(rd());
-    std::shuffle(m_trainingImagePaths.begin(), m_trainingImagePaths.end(), g);
+    // The loader shuffles per epoch, so shards only need a stable layout
+    m_trainingShards = writeRecordShards("train", trainingSamples, policy);
+    m_validationShards = writeRecordShards("val", validationSamples, policy);
 
-    m_numTrainingSamples = static_cast<int>(m_trainingImagePaths.size());
-    m_numValidationSamples = static_cast<int>(m_validationImagePaths.size());
+    m_numTrainingSamples = static_cast<int>(trainingSamples.size());
+    m_numValidationSamples = static_cast<int>(validationSamples.size());
 
-    std::cout << "Prepared " << m_numTrainingSamples << " training samples and "
-              << m_numValidationSamples << " validation samples" << std::endl;
+    Utils::logInfo("training", "Prepared %d training samples and %d validation samples (%zu built)",
+                   m_numTrainingSamples, m_numValidationSamples, pending.size());
 
     return m_numTrainingSamples + m_numValidationSamples;
 }
 
-std::vector<cv::Mat> ModelTrainer::augmentImage(const cv::Mat& image) {
-    std::vector<cv::Mat> augmentedImages;
+std::vector<size_t> ModelTrainer::selectTrainingEntries(const std::vector<Data::WasteEntry>& entries,
+                                                      const std::vector<size_t>& candidates,
+                                                      DatasetManifest& manifest) const {
+    std::vector<SelectionCandidate> selection(candidates.size());
+    std::vector<size_t> missingHashes;
+
+    for (size_t c = 0; c < candidates.size(); c++) {
+        const auto& entry = entries[candidates[c]];
+        selection[c].label = entry.foodType;
+        selection[c].confidence = entry.confidence;
+        selection[c].time = SampleSelector::parseTimestamp(entry.timestamp);
+        selection[c].hasImageHash = manifest.findImageHash(entry.imageFilename, selection[c].imageHash);
+        if (!selection[c].hasImageHash) {
+            missingHashes.push_back(c);
+        }
+    }
 
-    if (image.empty()) {
-        return augmentedImages;
+    // Hash new images in parallel; they are decoded at 1/8 scale so this is
+    // far cheaper than building the samples
+    Utils::TaskScheduler::instance().parallelFor(Utils::TaskClass::BACKGROUND, missingHashes.size(), [&](size_t m) {
+        auto& candidate = selection[missingHashes[m]];
+        candidate.hasImageHash = SampleSelector::computeImageHash(
+            entries[candidates[missingHashes[m]]].imageFilename, candidate.imageHash);
+    }, m_config.preparationThreads);
+
+    for (size_t c : missingHashes) {
+        if (selection[c].hasImageHash) {
+            manifest.setImageHash(entries[candidates[c]].imageFilename, selection[c].imageHash);
+        }
     }
 
-    // 1. Horizontal flip
-    cv::Mat flipped;
-    cv::flip(image, flipped, 1);
-    augmentedImages.push_back(flipped);
+    SelectionConfig selectionConfig;
+    selectionConfig.budget = m_config.sampleBudget;
+    SampleSelector selector(selectionConfig);
+
+    std::vector<size_t> selected;
+    for (size_t c : selector.select(selection)) {
+        selected.push_back(candidates[c]);
+    }
+    return selected;
+}
+
+std::string ModelTrainer::getBuildPolicy(const std::vector<std::string>& classNames) const {
+    // Annotations bake in class ids, so the class list is part of the policy
+    std::string classList;
+    for (const auto& name : classNames) {
+        classList += name + "\n";
+    }
 
-    // 2. Rotation (slight)
-    cv::Mat rotationMatrix = cv::getRotationMatrix2D(
-        cv::Point2f(image.cols / 2, image.rows / 2),
-        10.0,  // 10 degrees
-        1.0
-    );
-    cv::Mat rotated;
-    cv::warpAffine(image, rotated, rotationMatrix, image.size());
-    augmentedImages.push_back(rotated);
+    return std::string(SAMPLE_FORMAT) + ";classes=" + Utils::hashString(classList);
+}
 
-    // 3. Brightness adjustment
-    cv::Mat brighter;
-    image.convertTo(brighter, -1, 1.0, 30);  // Increase brightness
-    augmentedImages.push_back(brighter);
+size_t ModelTrainer::removeUnreferencedFiles(const std::set<std::string>& referencedFiles) const {
+    size_t removed = 0;
+    std::set<std::string> referencedStems;
 
-    cv::Mat darker;
-    image.convertTo(darker, -1, 1.0, -30);  // Decrease brightness
-    augmentedImages.push_back(darker);
+    try {
+        for (const auto& dirEntry : fs::directory_iterator(m_imagesPath)) {
+            std::string name = dirEntry.path().filename().string();
+            if (referencedFiles.count(name) > 0) {
+                referencedStems.insert(dirEntry.path().stem().string());
+            } else if (dirEntry.is_regular_file() && fs::remove(dirEntry.path())) {
+                removed++;
+            }
+        }
 
-    // 4. Add noise
-    cv::Mat noise = image.clone();
-    cv::Mat randomNoise(image.size(), CV_8UC3);
-    cv::randu(randomNoise, cv::Scalar(0, 0, 0), cv::Scalar(20, 20, 20));
-    cv::add(image, randomNoise, noise);
-    augmentedImages.push_back(noise);
+        for (const auto& dirEntry : fs::directory_iterator(m_annotationsPath)) {
+            if (dirEntry.is_regular_file() && referencedStems.count(dirEntry.path().stem().string()) == 0) {
+                fs::remove(dirEntry.path());
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        Utils::logError("training", "Error removing stale training files: %s", e.what());
+    }
 
-    return augmentedImages;
+    return removed;
 }
 
-bool ModelTrainer::saveAnnotations(const std::string& imagePath, const std::vector<Detection::FoodItem>& annotations) {
-    // Extract base filename without extension
-    fs::path path(imagePath);
-    std::string baseName = path.stem().string();
+std::vector<std::string> ModelTrainer::writeRecordShards(const std::string& prefix,
+                                                      const std::vector<PackedSample>& samples,
+                                                      const std::string& policy,
+                                                      const AnnotationIndex* annotationIndex) {
+    Utils::TraceSpan trace("ModelTrainer::writeRecordShards");
 
-    // Create annotation file path
-    std::string annotationPath = (fs::path(m_annotationsPath) / (baseName + ".txt")).string();
+    int numShards = samples.empty() ? 0 : std::max(1, std::min(m_config.recordShards, static_cast<int>(samples.size())));
 
-    try {
-        std::ofstream file(annotationPath);
-        if (!file.is_open()) {
-            std::cerr << "Failed to open annotation file: " << annotationPath << std::endl;
-            return false;
+    // Assign by id hash so a new sample only changes the shard it lands in
+    std::vector<std::vector<const PackedSample*>> shardSamples(numShards);
+    for (const auto& sample : samples) {
+        uint64_t idHash = Utils::fnv1a64(sample.id.data(), sample.id.size());
+        shardSamples[idHash % numShards].push_back(&sample);
+    }
+
+    std::vector<std::string> shardPaths(numShards);
+    std::vector<std::function<void()>> writers;
+
+    for (int shard = 0; shard < numShards; shard++) {
+        auto& members = shardSamples[shard];
+        std::sort(members.begin(), members.end(),
+                  [](const PackedSample* a, const PackedSample* b) { return a->id < b->id; });
+
+        // Sample ids are content hashes, so ids, labels and policy fully describe the shard
+        uint64_t signature = Utils::fnv1a64(policy.data(), policy.size());
+        for (const auto* sample : members) {
+            signature = Utils::fnv1a64(sample->id.data(), sample->id.size(), signature);
+            signature = Utils::fnv1a64(sample->label.data(), sample->label.size(), signature);
         }
 
-        // Get image dimensions (used for normalization)
-        cv::Mat image = cv::imread(imagePath);
-        if (image.empty()) {
-            std::cerr << "Failed to read image: " << imagePath << std::endl;
-            return false;
+        char shardName[32];
+        std::snprintf(shardName, sizeof(shardName), "-%05d.rec", shard);
+        shardPaths[shard] = (fs::path(m_recordsPath) / (prefix + shardName)).string();
+
+        uint64_t existingSignature = 0;
+        if (RecordReader::readSignature(shardPaths[shard], existingSignature) && existingSignature == signature) {
+            continue;
         }
 
-        int imageWidth = image.cols;
-        int imageHeight = image.rows;
-
-        // Write annotations in YOLO format:
-        // <class_id> <center_x> <center_y> <width> <height>
-        // Where coordinates are normalized to [0, 1]
-        for (const auto& item : annotations) {
-            // Get class ID from detector
-            int classId = 0;
-            auto classNames = m_detector->getClassNames();
-            for (size_t i = 0; i < classNames.size(); i++) {
-                if (classNames[i] == item.className) {
-                    classId = static_cast<int>(i);
-                    break;
+        writers.push_back([this, &members, annotationIndex, path = shardPaths[shard], signature]() {
+            RecordWriter writer;
+            if (!writer.open(path, signature)) {
+                return;
+            }
+
+            for (const auto* sample : members) {
+                TrainingRecord record;
+                record.id = sample->id;
+                record.label = sample->label;
+
+                std::ifstream imageFile(sample->imagePath, std::ios::binary);
+                record.image.assign(std::istreambuf_iterator<char>(imageFile), std::istreambuf_iterator<char>());
+                if (record.image.empty()) {
+                    continue;
                 }
+
+                fs::path imagePath(sample->imagePath);
+                if (annotationIndex) {
+                    auto it = annotationIndex->find(imagePath.filename().string());
+                    if (it != annotationIndex->end()) {
+                        record.annotations = it->second;
+                    }
+                } else {
+                    std::string annotationName = imagePath.stem().string() + ".txt";
+                    record.annotations = loadYoloAnnotations((fs::path(m_annotationsPath) / annotationName).string());
+                }
+                writer.append(record);
             }
 
-            // Calculate normalized coordinates
-            float centerX = (item.boundingBox.x + item.boundingBox.width / 2.0f) / imageWidth;
-            float centerY = (item.boundingBox.y + item.boundingBox.height / 2.0f) / imageHeight;
-            float width = static_cast<float>(item.boundingBox.width) / imageWidth;
-            float height = static_cast<float>(item.boundingBox.height) / imageHeight;
+            writer.close();
+        });
+    }
 
-            // Write to file
-            file << classId << " "
-                 << centerX << " "
-                 << centerY << " "
-                 << width << " "
-                 << height << std::endl;
-        }
+    Utils::TaskScheduler::instance().parallelFor(Utils::TaskClass::BACKGROUND, writers.size(), [&writers](size_t w) {
+        writers[w]();
+    });
 
-        file.close();
-        return true;
+    // Remove shards of this split left over from a build with more shards
+    std::set<std::string> current(shardPaths.begin(), shardPaths.end());
+    try {
+        for (const auto& dirEntry : fs::directory_iterator(m_recordsPath)) {
+            std::string name = dirEntry.path().filename().string();
+            if (name.rfind(prefix + "-", 0) == 0 && current.count(dirEntry.path().string()) == 0) {
+                fs::remove(dirEntry.path());
+            }
+        }
     }
     catch (const std::exception& e) {
-        std::cerr << "Error saving annotations: " << e.what() << std::endl;
-        return false;
+        Utils::logError("training", "Error removing stale record shards: %s", e.what());
+    }
+
+    if (numShards == 0) {
+        return shardPaths;
+    }
+
+    Utils::logInfo("training", "Packed %zu samples into %d %s shards (%zu rewritten)",
+                   samples.size(), numShards, prefix.c_str(), writers.size());
+    return shardPaths;
+}
+
+std::vector<std::string> ModelTrainer::prepareSample(const Data::WasteEntry& entry, const std::string& sampleName) {
+    std::vector<std::string> paths;
+
+    // Only the size is needed; JPEG snapshots give it from their header,
+    // anything else is decoded
+    cv::Size imageSize;
+    if (!Utils::readJpegSize(entry.imageFilename, imageSize)) {
+        imageSize = cv::imread(entry.imageFilename).size();
+        if (imageSize.area() == 0) {
+            return paths;
+        }
     }
+
+    // The source is already an encoded image, so copy the bytes rather than re-encoding
+    std::string imagePath = (fs::path(m_imagesPath) / sampleName).string();
+    fs::copy_file(entry.imageFilename, imagePath, fs::copy_options::overwrite_existing);
+
+    // Create annotation
+    std::vector<Detection::FoodItem> annotations;
+    Detection::FoodItem item;
+    item.className = entry.foodType;
+    // Simulate a bounding box (in a real system, this would come from the actual detection)
+    item.boundingBox = cv::Rect(10, 10, imageSize.width - 20, imageSize.height - 20);
+    item.confidence = 1.0f;  // Ground truth
+    annotations.push_back(item);
+
+    saveAnnotations(imagePath, imageSize, annotations);
+    paths.push_back(imagePath);
+
+    return paths;
+}
+
+bool ModelTrainer::saveAnnotations(const std::string& imagePath, const cv::Size& imageSize,
+                                   const std::vector<Detection::FoodItem>& annotations) {
+    // Annotation files are named after the image
+    std::string baseName = fs::path(imagePath).stem().string();
+    std::string annotationPath = (fs::path(m_annotationsPath) / (baseName + ".txt")).string();
+
+    return m_annotationWriter.writeFile(annotationPath, imageSize, annotations);
 }
 
 TrainingMetrics ModelTrainer::getLastTrainingMetrics() const {
@@ -410,104 +673,138 @@ bool ModelTrainer::getUseDataAugmentation() const {
     return m_config.useDataAugmentation;
 }
 
-bool ModelTrainer::downloadPretrainedModel(const std::string& modelUrl, const std::string& outputPath) {
-    std::cout << "Downloading pretrained model from " << modelUrl << " to " << outputPath << std::endl;
+bool ModelTrainer::downloadPretrainedModel(const std::string& modelUrl, const std::string& outputPath,
+                                           const std::string& expectedSha256) {
+    Utils::logInfo("training", "Downloading pretrained model from %s to %s", modelUrl.c_str(), outputPath.c_str());
 
-    // Initialize CURL
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        std::cerr << "Failed to initialize CURL" << std::endl;
-        return false;
-    }
-
-    // Open output file
-    std::ofstream outFile(outputPath, std::ios::binary);
-    if (!outFile.is_open()) {
-        std::cerr << "Failed to open output file: " << outputPath << std::endl;
-        curl_easy_cleanup(curl);
-        return false;
-    }
+    // Resumes an earlier interrupted download of the same file and only
+    // moves the model into place once it is complete and verified
+    Utils::DownloadOptions options;
+    options.expectedSha256 = expectedSha256;
+    Utils::FileDownloader downloader(options);
 
-    // Configure CURL
-    curl_easy_setopt(curl, CURLOPT_URL, modelUrl.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &outFile);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 3600L); // 1 hour timeout
-
-    // Perform download
-    CURLcode res = curl_easy_perform(curl);
-
-    // Cleanup
-    outFile.close();
-    curl_easy_cleanup(curl);
-
-    if (res != CURLE_OK) {
-        std::cerr << "Download failed: " << curl_easy_strerror(res) << std::endl;
-        // Remove partial file
-        std::remove(outputPath.c_str());
+    Utils::DownloadResult result = downloader.download(modelUrl, outputPath);
+    if (!result.success) {
+        Utils::logError("training", "Download failed: %s", result.error.c_str());
         return false;
     }
 
-    std::cout << "Download completed successfully" << std::endl;
+    Utils::logInfo("training", "Download completed successfully (%lld bytes, %lld resumed, sha256 %s)",
+                   static_cast<long long>(result.totalBytes), static_cast<long long>(result.resumedBytes),
+                   result.sha256.c_str());
     return true;
 }
 
 bool ModelTrainer::initializeFromPretrainedModel(const std::string& modelPath) {
     if (!fs::exists(modelPath)) {
-        std::cerr << "Pretrained model file not found: " << modelPath << std::endl;
+        Utils::logError("training", "Pretrained model file not found: %s", modelPath.c_str());
         return false;
     }
 
-    std::cout << "Initializing from pretrained model: " << modelPath << std::endl;
+    Utils::logInfo("training", "Initializing from pretrained model: %s", modelPath.c_str());
 
     // In a real implementation, this would load the model
     // and prepare it for transfer learning
 
-    // For this example, we'll just copy the file to our checkpoints directory
-    std::string destPath = (fs::path(m_checkpointsPath) / "pretrained_base.weights").string();
-
+    // For this example, we'll just add the file to the model registry
     try {
-        fs::copy_file(modelPath, destPath, fs::copy_options::overwrite_existing);
+        std::string registeredPath = registerModel(modelPath, "pretrained");
+        if (registeredPath.empty()) {
+            return false;
+        }
 
-        // Update the detector
-        if (m_detector) {
-            return m_detector->loadModel(destPath);
+        // Update the detector, and make the version live once it has loaded
+        if (m_detector && !m_detector->loadModel(registeredPath)) {
+            return false;
+        }
+
+        if (m_registry) {
+            return m_registry->promote(m_registry->findVersionByPath(registeredPath));
         }
 
         return true;
     }
     catch (const std::exception& e) {
-        std::cerr << "Error initializing from pretrained model: " << e.what() << std::endl;
+        Utils::logError("training", "Error initializing from pretrained model: %s", e.what());
         return false;
     }
 }
 
+std::string ModelTrainer::registerModel(const std::string& modelPath, const std::string& source,
+                                        const EvaluationReport* evaluation) {
+    if (!m_registry) {
+        return modelPath;
+    }
+
+    ModelVersion metadata;
+    metadata.source = source;
+
+    EvaluationConfig evaluationConfig;
+    evaluationConfig.reportThreshold = m_detector->getConfidenceThreshold();
+    ModelEvaluator evaluator(modelPath, m_detector->getClassesPath(), evaluationConfig);
+
+    EvaluationReport report;
+    if (evaluation) {
+        report = *evaluation;
+    } else if (!m_validationShards.empty()) {
+        report = evaluator.evaluate(m_validationShards);
+    }
+    if (report.imageCount > 0) {
+        metadata.map50 = report.map50;
+        metadata.map50to95 = report.map50to95;
+        metadata.precision = report.precision;
+        metadata.recall = report.recall;
+    }
+    metadata.latencyMs = evaluator.benchmarkLatency(BENCHMARK_FRAME_SIZE);
+
+    ModelVersion version;
+    std::string versionId = m_registry->registerModel(modelPath, metadata);
+    if (versionId.empty() || !m_registry->getVersion(versionId, version)) {
+        return "";
+    }
+
+    return version.modelPath;
+}
+
 float ModelTrainer::evaluateModel() {
-    // In a real implementation, this would:
-    // 1. Run the model on validation data
-    // 2. Calculate precision, recall, mAP, etc.
+    Utils::TraceSpan trace("ModelTrainer::evaluateModel");
+
+    if (m_validationShards.empty()) {
+        Utils::logWarning("training", "No validation samples available for evaluation");
+        return 0.0f;
+    }
 
-    // For this example, we'll simulate evaluation
+    // Score the detector's current model against the held-out shards
+    EvaluationConfig evaluationConfig;
+    evaluationConfig.reportThreshold = m_detector->getConfidenceThreshold();
+    ModelEvaluator evaluator(m_detector->getModelPath(), m_detector->getClassesPath(), evaluationConfig);
 
-    if (m_numValidationSamples == 0) {
-        std::cerr << "No validation samples available for evaluation" << std::endl;
+    EvaluationReport report = evaluator.evaluate(m_validationShards);
+    m_numValidationSamples = report.imageCount;
+    if (report.imageCount == 0) {
+        Utils::logWarning("training", "No validation samples could be evaluated");
         return 0.0f;
     }
 
-    std::cout << "Evaluating model on " << m_numValidationSamples << " validation samples..." << std::endl;
+    m_lastEvaluation = report;
+    m_lastMetrics.finalPrecision = report.precision;
+    m_lastMetrics.finalRecall = report.recall;
+    m_lastMetrics.finalMeanAveragePrecision = report.map50;
 
-    // Simulate evaluation metrics
-    float precision = 0.85f + ((static_cast<float>(rand()) / RAND_MAX) - 0.5f) * 0.1f;
-    float recall = 0.82f + ((static_cast<float>(rand()) / RAND_MAX) - 0.5f) * 0.1f;
-    float mAP = 0.78f + ((static_cast<float>(rand()) / RAND_MAX) - 0.5f) * 0.1f;
+    Utils::logInfo("training", "Evaluation results: precision %.3f, recall %.3f, mAP@0.5 %.3f, mAP@0.5:0.95 %.3f",
+                   report.precision, report.recall, report.map50, report.map50to95);
 
-    std::cout << "Evaluation results:" << std::endl
-              << "- Precision: " << precision << std::endl
-              << "- Recall: " << recall << std::endl
-              << "- mAP: " << mAP << std::endl;
+    for (const auto& metrics : report.perClass) {
+        Utils::logInfo("training", "  %s: P=%.3f R=%.3f AP50=%.3f AP50:95=%.3f (%d objects)",
+                       metrics.className.c_str(), metrics.precision, metrics.recall,
+                       metrics.ap50, metrics.ap50to95, metrics.groundTruthCount);
+    }
+
+    return report.map50;
+}
 
-    return mAP;
+EvaluationReport ModelTrainer::getLastEvaluation() const {
+    return m_lastEvaluation;
 }
 
 void ModelTrainer::setLearningRate(float rate) {
@@ -534,6 +831,14 @@ int ModelTrainer::getEpochs() const {
     return m_config.epochs;
 }
 
+void ModelTrainer::setSampleBudget(int samples) {
+    m_config.sampleBudget = std::max(0, samples);
+}
+
+int ModelTrainer::getSampleBudget() const {
+    return m_config.sampleBudget;
+}
+
 void ModelTrainer::onEpochEnd(void* userData, int epoch, float loss, float accuracy) {
     ModelTrainer* trainer = static_cast<ModelTrainer*>(userData);
 
@@ -543,7 +848,9 @@ void ModelTrainer::onEpochEnd(void* userData, int epoch, float loss, float accur
 
         // Log progress
         if (epoch % 10 == 0) {
-            std::cout << "Epoch " << epoch << " - Loss: " << loss << " - Accuracy: " << accuracy << std::endl;
+            Utils::logInfo("training", "Epoch %d - Loss: %.4f - Accuracy: %.4f", epoch, loss, accuracy);
         }
     }
-}
\ No newline at end of file
+}
+
+} // namespace Training
\ No newline at end of file
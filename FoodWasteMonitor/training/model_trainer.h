@@ -10,14 +10,24 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
+#include <cstdint>
 #include <memory>
+#include <atomic>
+#include <functional>
 #include <opencv2/opencv.hpp>
 #include <opencv2/dnn.hpp>
 #include "../detection/food_detector.h"
 #include "../data/waste_database.h"
+#include "model_evaluator.h"
+#include "model_registry.h"
+#include "annotation_writer.h"
+#include "record_file.h"
 
 namespace Training {
 
+class DatasetManifest;
+
 // Training configuration structure
 struct TrainingConfig {
     int batchSize;
@@ -26,6 +36,10 @@ struct TrainingConfig {
     std::string modelArchitecture;
     bool useDataAugmentation;
     float validationSplit;
+    int preparationThreads;     // Data preparation workers (0 = the background core budget)
+    uint32_t augmentationSeed;  // Seed for the per-epoch augmentation draws
+    int recordShards;           // Packed record shards per split
+    int sampleBudget;           // Training samples selected per cycle (0 = all)
 
     TrainingConfig()
         : batchSize(16),
@@ -33,7 +47,11 @@ struct TrainingConfig {
           learningRate(0.001f),
           modelArchitecture("YOLOv4-tiny"),
           useDataAugmentation(true),
-          validationSplit(0.2f) {
+          validationSplit(0.2f),
+          preparationThreads(0),
+          augmentationSeed(42),
+          recordShards(4),
+          sampleBudget(2000) {
     }
 };
 
@@ -62,6 +80,21 @@ public:
     // Training functions
     bool trainModel();
     bool trainModelWithConfig(const TrainingConfig& config);
+    bool isTraining() const;
+
+    // Called after every epoch with the number of completed epochs.
+    // Returning false stops training without updating the detector.
+    using EpochCallback = std::function<bool(int completedEpochs, int totalEpochs)>;
+    void setEpochCallback(EpochCallback callback);
+
+    // Called with the path of each newly trained model. The handler decides
+    // whether and when the model goes live; without one the model is only saved.
+    using CandidateHandler = std::function<void(const std::string& modelPath)>;
+    void setCandidateHandler(CandidateHandler handler);
+
+    // Registry that trained and pretrained models are versioned in. Without
+    // one, models are handed over from the checkpoints directory.
+    void setModelRegistry(std::shared_ptr<ModelRegistry> registry);
 
     // Data preparation
     int prepareTrainingData();
@@ -74,11 +107,15 @@ public:
     bool getUseDataAugmentation() const;
 
     // Transfer learning
-    bool downloadPretrainedModel(const std::string& modelUrl, const std::string& outputPath);
+    // Resumable download; when expectedSha256 is given a file that does not
+    // match it is discarded instead of being left at outputPath
+    bool downloadPretrainedModel(const std::string& modelUrl, const std::string& outputPath,
+                                 const std::string& expectedSha256 = "");
     bool initializeFromPretrainedModel(const std::string& modelPath);
 
-    // Model evaluation
+    // Model evaluation on the validation shards; returns mAP@0.5
     float evaluateModel();
+    EvaluationReport getLastEvaluation() const;
 
     // Configuration
     void setLearningRate(float rate);
@@ -87,12 +124,53 @@ public:
     int getBatchSize() const;
     void setEpochs(int epochs);
     int getEpochs() const;
+    void setSampleBudget(int samples);
+    int getSampleBudget() const;
 
 private:
     // Helper functions
-    std::vector<cv::Mat> augmentImage(const cv::Mat& image);
     void prepareImageForTraining(const cv::Mat& image, const std::vector<Detection::FoodItem>& annotations);
-    bool saveAnnotations(const std::string& imagePath, const std::vector<Detection::FoodItem>& annotations);
+    bool saveAnnotations(const std::string& imagePath, const cv::Size& imageSize,
+                         const std::vector<Detection::FoodItem>& annotations);
+
+    // Write one database entry into the training set with its annotations.
+    // Returns the written image paths.
+    std::vector<std::string> prepareSample(const Data::WasteEntry& entry, const std::string& sampleName);
+
+    // Rank training candidates (indices into entries) by uncertainty, skip
+    // near duplicates and return those within the sample budget. Perceptual
+    // hashes are cached in the manifest.
+    std::vector<size_t> selectTrainingEntries(const std::vector<Data::WasteEntry>& entries,
+                                              const std::vector<size_t>& candidates,
+                                              DatasetManifest& manifest) const;
+
+    // Identifies how samples are built; samples built under another policy are rebuilt
+    std::string getBuildPolicy(const std::vector<std::string>& classNames) const;
+
+    // Delete images and annotations not referenced by the dataset manifest
+    size_t removeUnreferencedFiles(const std::set<std::string>& referencedFiles) const;
+
+    // A prepared sample on disk, to be packed into a record shard
+    struct PackedSample {
+        std::string id;
+        std::string label;
+        std::string imagePath;
+    };
+
+    // Pack samples into <prefix>-NNNNN.rec shards. Shards whose contents are
+    // unchanged since the last build are kept as they are. Annotations come
+    // from the index when one is given, otherwise from per-image files.
+    // Returns the shard paths.
+    std::vector<std::string> writeRecordShards(const std::string& prefix,
+                                               const std::vector<PackedSample>& samples,
+                                               const std::string& policy,
+                                               const AnnotationIndex* annotationIndex = nullptr);
+
+    // Evaluate and benchmark a model file and add it to the registry. An
+    // evaluation already run on the validation shards can be passed in.
+    // Returns the registered path, or the given path without a registry.
+    std::string registerModel(const std::string& modelPath, const std::string& source,
+                              const EvaluationReport* evaluation = nullptr);
 
     // Callbacks for integrating with OpenCV DNN module
     static void onEpochEnd(void* userData, int epoch, float loss, float accuracy);
@@ -100,6 +178,7 @@ private:
     // Pointers to other components
     std::shared_ptr<Data::WasteDatabase> m_database;
     std::shared_ptr<Detection::FoodDetector> m_detector;
+    std::shared_ptr<ModelRegistry> m_registry;
 
     // Training configuration
     TrainingConfig m_config;
@@ -109,16 +188,23 @@ private:
     std::string m_imagesPath;
     std::string m_annotationsPath;
     std::string m_checkpointsPath;
+    std::string m_recordsPath;
 
     // Training state
-    bool m_isTraining;
+    std::atomic<bool> m_isTraining;
+    EpochCallback m_epochCallback;
+    CandidateHandler m_candidateHandler;
     TrainingMetrics m_lastMetrics;
+    EvaluationReport m_lastEvaluation;
     int m_numTrainingSamples;
     int m_numValidationSamples;
 
-    // Training data
-    std::vector<std::string> m_trainingImagePaths;
-    std::vector<std::string> m_validationImagePaths;
+    // Training data, packed into record shards
+    std::vector<std::string> m_trainingShards;
+    std::vector<std::string> m_validationShards;
+
+    // Writes annotations with the class ids of the current preparation run
+    AnnotationWriter m_annotationWriter;
 };
 
 } // namespace Training
@@ -0,0 +1,328 @@
+/**
+ * Training Record File Implementation
+ */
+
+#include "record_file.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace Training {
+
+namespace {
+
+const char RECORD_MAGIC[4] = {'F', 'W', 'R', 'C'};
+const uint32_t RECORD_VERSION = 1;
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+    uint64_t signature;
+    uint64_t indexOffset;
+};
+
+const size_t ANNOTATION_BYTES = sizeof(int32_t) + 4 * sizeof(float);
+
+template<typename T>
+void appendValue(std::vector<uint8_t>& buffer, const T& value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+bool readValue(const uint8_t*& cursor, const uint8_t* end, T& value) {
+    if (static_cast<size_t>(end - cursor) < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return true;
+}
+
+bool isValidHeader(const FileHeader& header) {
+    return std::memcmp(header.magic, RECORD_MAGIC, sizeof(RECORD_MAGIC)) == 0 &&
+           header.version == RECORD_VERSION;
+}
+
+} // namespace
+
+std::vector<TrainingAnnotation> loadYoloAnnotations(const std::string& annotationPath) {
+    std::vector<TrainingAnnotation> annotations;
+
+    std::ifstream file(annotationPath);
+    if (!file.is_open()) {
+        return annotations;
+    }
+
+    TrainingAnnotation annotation;
+    float centerX, centerY, width, height;
+    while (file >> annotation.classId >> centerX >> centerY >> width >> height) {
+        annotation.box = cv::Rect2f(centerX - width / 2.0f, centerY - height / 2.0f, width, height);
+        annotations.push_back(annotation);
+    }
+
+    return annotations;
+}
+
+AnnotationIndex loadConsolidatedAnnotations(const std::string& annotationPath) {
+    AnnotationIndex annotations;
+
+    std::ifstream file(annotationPath);
+    if (!file.is_open()) {
+        return annotations;
+    }
+
+    std::string imageName;
+    TrainingAnnotation annotation;
+    float centerX, centerY, width, height;
+    while (file >> imageName >> annotation.classId >> centerX >> centerY >> width >> height) {
+        annotation.box = cv::Rect2f(centerX - width / 2.0f, centerY - height / 2.0f, width, height);
+        annotations[imageName].push_back(annotation);
+    }
+
+    return annotations;
+}
+
+cv::Mat RecordView::decode() const {
+    if (!image || imageSize == 0) {
+        return cv::Mat();
+    }
+
+    // Wraps the mapped bytes without copying
+    cv::Mat encoded(1, static_cast<int>(imageSize), CV_8UC1, const_cast<uint8_t*>(image));
+    return cv::imdecode(encoded, cv::IMREAD_COLOR);
+}
+
+RecordWriter::RecordWriter()
+    : m_file(nullptr),
+      m_signature(0),
+      m_offset(0) {
+}
+
+RecordWriter::~RecordWriter() {
+    if (m_file) {
+        std::fclose(m_file);
+        std::remove(m_tempPath.c_str());
+    }
+}
+
+bool RecordWriter::open(const std::string& path, uint64_t signature) {
+    // Written under a temporary name and renamed on close, so readers never see a partial shard
+    m_path = path;
+    m_tempPath = path + ".tmp";
+    m_signature = signature;
+    m_index.clear();
+
+    m_file = std::fopen(m_tempPath.c_str(), "wb");
+    if (!m_file) {
+        std::cerr << "Failed to create record file: " << m_tempPath << std::endl;
+        return false;
+    }
+
+    // Placeholder header, rewritten once the index offset is known
+    FileHeader header = {};
+    std::fwrite(&header, sizeof(header), 1, m_file);
+    m_offset = sizeof(header);
+    return true;
+}
+
+bool RecordWriter::append(const TrainingRecord& record) {
+    if (!m_file) {
+        return false;
+    }
+
+    std::vector<uint8_t> buffer;
+    buffer.reserve(16 + record.label.size() + record.id.size() +
+                   record.annotations.size() * ANNOTATION_BYTES + record.image.size());
+
+    appendValue(buffer, static_cast<uint32_t>(record.image.size()));
+    appendValue(buffer, static_cast<uint32_t>(record.annotations.size()));
+    appendValue(buffer, static_cast<uint16_t>(record.label.size()));
+    appendValue(buffer, static_cast<uint16_t>(record.id.size()));
+    buffer.insert(buffer.end(), record.label.begin(), record.label.end());
+    buffer.insert(buffer.end(), record.id.begin(), record.id.end());
+
+    for (const auto& annotation : record.annotations) {
+        appendValue(buffer, static_cast<int32_t>(annotation.classId));
+        appendValue(buffer, annotation.box.x);
+        appendValue(buffer, annotation.box.y);
+        appendValue(buffer, annotation.box.width);
+        appendValue(buffer, annotation.box.height);
+    }
+
+    buffer.insert(buffer.end(), record.image.begin(), record.image.end());
+
+    if (std::fwrite(buffer.data(), 1, buffer.size(), m_file) != buffer.size()) {
+        std::cerr << "Failed to write record to " << m_tempPath << std::endl;
+        return false;
+    }
+
+    m_index.push_back(m_offset);
+    m_offset += buffer.size();
+    return true;
+}
+
+bool RecordWriter::close() {
+    if (!m_file) {
+        return false;
+    }
+
+    bool ok = std::fwrite(m_index.data(), sizeof(uint64_t), m_index.size(), m_file) == m_index.size();
+
+    FileHeader header = {};
+    std::memcpy(header.magic, RECORD_MAGIC, sizeof(RECORD_MAGIC));
+    header.version = RECORD_VERSION;
+    header.count = static_cast<uint32_t>(m_index.size());
+    header.signature = m_signature;
+    header.indexOffset = m_offset;
+
+    ok = ok && std::fseek(m_file, 0, SEEK_SET) == 0;
+    ok = ok && std::fwrite(&header, sizeof(header), 1, m_file) == 1;
+    ok = (std::fclose(m_file) == 0) && ok;
+    m_file = nullptr;
+
+    if (!ok) {
+        std::cerr << "Failed to finish record file: " << m_tempPath << std::endl;
+        std::remove(m_tempPath.c_str());
+        return false;
+    }
+
+    std::error_code ec;
+    fs::rename(m_tempPath, m_path, ec);
+    if (ec) {
+        std::cerr << "Failed to move record file into place: " << ec.message() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+size_t RecordWriter::getRecordCount() const {
+    return m_index.size();
+}
+
+RecordReader::RecordReader()
+    : m_signature(0) {
+}
+
+RecordReader::~RecordReader() {
+    close();
+}
+
+bool RecordReader::open(const std::string& path) {
+    close();
+
+    if (!m_file.open(path)) {
+        std::cerr << "Failed to map record file: " << path << std::endl;
+        return false;
+    }
+
+    if (!parseHeader()) {
+        std::cerr << "Invalid record file: " << path << std::endl;
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void RecordReader::close() {
+    m_file.close();
+    m_index.clear();
+    m_signature = 0;
+}
+
+bool RecordReader::parseHeader() {
+    if (m_file.size() < sizeof(FileHeader)) {
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, m_file.data(), sizeof(header));
+    if (!isValidHeader(header)) {
+        return false;
+    }
+
+    uint64_t indexBytes = static_cast<uint64_t>(header.count) * sizeof(uint64_t);
+    if (header.indexOffset > m_file.size() || m_file.size() - header.indexOffset < indexBytes) {
+        return false;
+    }
+
+    m_index.resize(header.count);
+    std::memcpy(m_index.data(), m_file.data() + header.indexOffset, indexBytes);
+    m_signature = header.signature;
+    return true;
+}
+
+size_t RecordReader::size() const {
+    return m_index.size();
+}
+
+uint64_t RecordReader::getSignature() const {
+    return m_signature;
+}
+
+bool RecordReader::read(size_t index, RecordView& view) const {
+    if (index >= m_index.size() || m_index[index] >= m_file.size()) {
+        return false;
+    }
+
+    const uint8_t* cursor = m_file.data() + m_index[index];
+    const uint8_t* end = m_file.data() + m_file.size();
+
+    uint32_t imageBytes, annotationCount;
+    uint16_t labelLength, idLength;
+    if (!readValue(cursor, end, imageBytes) || !readValue(cursor, end, annotationCount) ||
+        !readValue(cursor, end, labelLength) || !readValue(cursor, end, idLength)) {
+        return false;
+    }
+
+    size_t remaining = static_cast<size_t>(end - cursor);
+    size_t needed = static_cast<size_t>(labelLength) + idLength +
+                    static_cast<size_t>(annotationCount) * ANNOTATION_BYTES + imageBytes;
+    if (remaining < needed) {
+        return false;
+    }
+
+    view.label.assign(reinterpret_cast<const char*>(cursor), labelLength);
+    cursor += labelLength;
+    view.id.assign(reinterpret_cast<const char*>(cursor), idLength);
+    cursor += idLength;
+
+    view.annotations.resize(annotationCount);
+    for (auto& annotation : view.annotations) {
+        int32_t classId;
+        readValue(cursor, end, classId);
+        readValue(cursor, end, annotation.box.x);
+        readValue(cursor, end, annotation.box.y);
+        readValue(cursor, end, annotation.box.width);
+        readValue(cursor, end, annotation.box.height);
+        annotation.classId = classId;
+    }
+
+    view.image = cursor;
+    view.imageSize = imageBytes;
+    return true;
+}
+
+bool RecordReader::readSignature(const std::string& path, uint64_t& signature) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    FileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || !isValidHeader(header)) {
+        return false;
+    }
+
+    signature = header.signature;
+    return true;
+}
+
+} // namespace Training
@@ -0,0 +1,123 @@
+/**
+ * Training Record File Header
+ *
+ * Packed training shards: a sequence of (encoded image, annotations,
+ * metadata) records followed by an offset index, read through mmap with
+ * random access
+ *
+ * Layout (native little-endian):
+ *   header  : magic "FWRC", version u32, count u32, reserved u32,
+ *             signature u64, indexOffset u64
+ *   record  : imageBytes u32, annotationCount u32, labelLength u16,
+ *             idLength u16, label, id,
+ *             annotationCount x (classId i32, x f32, y f32, w f32, h f32),
+ *             image bytes
+ *   index   : count x record offset u64
+ */
+
+#ifndef RECORD_FILE_H
+#define RECORD_FILE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstdio>
+#include <opencv2/opencv.hpp>
+#include "../utils/mapped_file.h"
+
+namespace Training {
+
+// Ground truth box in normalized [0, 1] image coordinates
+struct TrainingAnnotation {
+    int classId;
+    cv::Rect2f box;
+
+    TrainingAnnotation() : classId(0) {}
+};
+
+// Read a YOLO annotation file (<class_id> <center_x> <center_y> <width> <height>)
+std::vector<TrainingAnnotation> loadYoloAnnotations(const std::string& annotationPath);
+
+// Annotations of many images, keyed by image file name
+using AnnotationIndex = std::unordered_map<std::string, std::vector<TrainingAnnotation>>;
+
+// Read a consolidated annotation file, where every YOLO line is prefixed
+// with the image file name
+AnnotationIndex loadConsolidatedAnnotations(const std::string& annotationPath);
+
+// One sample to be written to a shard
+struct TrainingRecord {
+    std::string id;                               // Sample id, e.g. the content hash
+    std::string label;
+    std::vector<TrainingAnnotation> annotations;
+    std::vector<uint8_t> image;                   // Encoded image bytes
+};
+
+// One sample read from a shard; the image points into the mapped file
+struct RecordView {
+    std::string id;
+    std::string label;
+    std::vector<TrainingAnnotation> annotations;
+    const uint8_t* image;
+    size_t imageSize;
+
+    RecordView() : image(nullptr), imageSize(0) {}
+
+    // Decode the image bytes (BGR)
+    cv::Mat decode() const;
+};
+
+class RecordWriter {
+public:
+    RecordWriter();
+    ~RecordWriter();
+
+    // The signature identifies the shard contents so unchanged shards can be kept
+    bool open(const std::string& path, uint64_t signature);
+    bool append(const TrainingRecord& record);
+    bool close();
+
+    size_t getRecordCount() const;
+
+private:
+    std::FILE* m_file;
+    std::string m_path;
+    std::string m_tempPath;
+    uint64_t m_signature;
+    uint64_t m_offset;
+    std::vector<uint64_t> m_index;
+};
+
+class RecordReader {
+public:
+    RecordReader();
+    ~RecordReader();
+
+    RecordReader(const RecordReader&) = delete;
+    RecordReader& operator=(const RecordReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    size_t size() const;
+    uint64_t getSignature() const;
+
+    // Parse record i. Safe to call from several threads at once.
+    bool read(size_t index, RecordView& view) const;
+
+    // Signature of a shard without mapping it; false if it is missing or invalid
+    static bool readSignature(const std::string& path, uint64_t& signature);
+
+private:
+    bool parseHeader();
+
+    Utils::MappedFile m_file;
+
+    uint64_t m_signature;
+    std::vector<uint64_t> m_index;
+};
+
+} // namespace Training
+
+#endif // RECORD_FILE_H
@@ -0,0 +1,225 @@
+/**
+ * Sample Selector Implementation
+ */
+
+#include "sample_selector.h"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <ctime>
+#include <map>
+#include <unordered_map>
+#include <numeric>
+#include <algorithm>
+#include <bitset>
+
+namespace Training {
+
+namespace {
+
+// Finds near-duplicate hashes without comparing against every kept image.
+// The hash is cut into distance + 1 bands; two hashes within the distance
+// must agree exactly on at least one band, so only hashes sharing a band
+// value are compared.
+class DuplicateIndex {
+public:
+    explicit DuplicateIndex(int distance)
+        : m_distance(std::max(0, std::min(distance, 15))),
+          m_bands(m_distance + 1) {
+    }
+
+    bool containsNear(uint64_t hash) const {
+        for (int band = 0; band < static_cast<int>(m_bands.size()); band++) {
+            auto it = m_bands[band].find(bandValue(hash, band));
+            if (it == m_bands[band].end()) {
+                continue;
+            }
+            for (uint64_t other : it->second) {
+                if (SampleSelector::hashDistance(hash, other) <= m_distance) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void insert(uint64_t hash) {
+        for (int band = 0; band < static_cast<int>(m_bands.size()); band++) {
+            m_bands[band][bandValue(hash, band)].push_back(hash);
+        }
+    }
+
+private:
+    uint64_t bandValue(uint64_t hash, int band) const {
+        int count = static_cast<int>(m_bands.size());
+        int begin = 64 * band / count;
+        int end = 64 * (band + 1) / count;
+        uint64_t mask = (end - begin) >= 64 ? ~0ULL : ((1ULL << (end - begin)) - 1);
+        return (hash >> begin) & mask;
+    }
+
+    int m_distance;
+    std::vector<std::unordered_map<uint64_t, std::vector<uint64_t>>> m_bands;
+};
+
+} // namespace
+
+SampleSelector::SampleSelector(const SelectionConfig& config)
+    : m_config(config) {
+}
+
+std::vector<float> SampleSelector::scoreUncertainty(const std::vector<SelectionCandidate>& candidates) const {
+    std::vector<float> scores(candidates.size(), 0.0f);
+
+    // Successive frames of the same item: close in time and nearly the same image
+    std::vector<size_t> byTime;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        if (candidates[i].time > 0 && candidates[i].hasImageHash) {
+            byTime.push_back(i);
+        }
+    }
+    std::sort(byTime.begin(), byTime.end(), [&](size_t a, size_t b) {
+        return candidates[a].time < candidates[b].time;
+    });
+
+    std::vector<int> neighbours(candidates.size(), 0);
+    std::vector<int> disagreeing(candidates.size(), 0);
+    for (size_t a = 0; a < byTime.size(); a++) {
+        const auto& first = candidates[byTime[a]];
+        for (size_t b = a + 1; b < byTime.size(); b++) {
+            const auto& second = candidates[byTime[b]];
+            if (second.time - first.time > m_config.sequenceSeconds) {
+                break;
+            }
+            if (hashDistance(first.imageHash, second.imageHash) > m_config.sameItemDistance) {
+                continue;
+            }
+
+            neighbours[byTime[a]]++;
+            neighbours[byTime[b]]++;
+            if (first.label != second.label) {
+                disagreeing[byTime[a]]++;
+                disagreeing[byTime[b]]++;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < candidates.size(); i++) {
+        float margin = 1.0f - std::max(0.0f, std::min(1.0f, candidates[i].confidence));
+        float disagreement = neighbours[i] > 0 ? static_cast<float>(disagreeing[i]) / neighbours[i] : 0.0f;
+        scores[i] = m_config.marginWeight * margin + m_config.disagreementWeight * disagreement;
+    }
+
+    return scores;
+}
+
+std::vector<size_t> SampleSelector::select(const std::vector<SelectionCandidate>& candidates) const {
+    std::vector<float> scores = scoreUncertainty(candidates);
+
+    // Most uncertain first; index order breaks ties so selection is repeatable
+    std::vector<size_t> order(candidates.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return scores[a] > scores[b];
+    });
+
+    size_t budget = m_config.budget > 0 ? static_cast<size_t>(m_config.budget) : candidates.size();
+    std::vector<size_t> selected;
+    std::vector<char> taken(candidates.size(), 0);
+    DuplicateIndex duplicates(m_config.duplicateDistance);
+    int skippedDuplicates = 0;
+
+    auto tryTake = [&](size_t i) {
+        if (taken[i]) {
+            return false;
+        }
+        taken[i] = 1;    // Considered once, whether kept or skipped
+
+        if (candidates[i].hasImageHash) {
+            if (duplicates.containsNear(candidates[i].imageHash)) {
+                skippedDuplicates++;
+                return false;
+            }
+            duplicates.insert(candidates[i].imageHash);
+        }
+        selected.push_back(i);
+        return true;
+    };
+
+    // Reserve a few of the most informative samples of every class so rare
+    // classes are not crowded out by the global ranking
+    if (m_config.minPerClass > 0) {
+        std::map<std::string, int> perClass;
+        for (size_t i : order) {
+            if (selected.size() >= budget) {
+                break;
+            }
+            int& count = perClass[candidates[i].label];
+            if (count < m_config.minPerClass && tryTake(i)) {
+                count++;
+            }
+        }
+    }
+
+    for (size_t i : order) {
+        if (selected.size() >= budget) {
+            break;
+        }
+        tryTake(i);
+    }
+
+    std::cout << "Selected " << selected.size() << " of " << candidates.size()
+              << " training candidates (" << skippedDuplicates << " near duplicates skipped)" << std::endl;
+
+    return selected;
+}
+
+bool SampleSelector::computeImageHash(const std::string& imagePath, uint64_t& hash) {
+    // The JPEG decoder can scale by 1/8 while decoding, which is plenty for a 9x8 hash
+    cv::Mat image = cv::imread(imagePath, cv::IMREAD_REDUCED_GRAYSCALE_8);
+    if (image.empty()) {
+        return false;
+    }
+
+    hash = computeImageHash(image);
+    return true;
+}
+
+uint64_t SampleSelector::computeImageHash(const cv::Mat& image) {
+    cv::Mat gray = image;
+    if (image.channels() == 3) {
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    }
+
+    cv::Mat small;
+    cv::resize(gray, small, cv::Size(9, 8), 0, 0, cv::INTER_AREA);
+
+    // One bit per horizontal neighbour pair: is the left pixel brighter?
+    uint64_t hash = 0;
+    for (int y = 0; y < 8; y++) {
+        const uint8_t* row = small.ptr<uint8_t>(y);
+        for (int x = 0; x < 8; x++) {
+            hash = (hash << 1) | (row[x] > row[x + 1] ? 1 : 0);
+        }
+    }
+    return hash;
+}
+
+int SampleSelector::hashDistance(uint64_t a, uint64_t b) {
+    return static_cast<int>(std::bitset<64>(a ^ b).count());
+}
+
+int64_t SampleSelector::parseTimestamp(const std::string& timestamp) {
+    std::tm time = {};
+    std::istringstream ss(timestamp);
+    ss >> std::get_time(&time, "%Y-%m-%d %H:%M:%S");
+    if (ss.fail()) {
+        return 0;
+    }
+
+    time.tm_isdst = -1;
+    std::time_t seconds = std::mktime(&time);
+    return seconds < 0 ? 0 : static_cast<int64_t>(seconds);
+}
+
+} // namespace Training
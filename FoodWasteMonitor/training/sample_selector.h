@@ -0,0 +1,78 @@
+/**
+ * Sample Selector Header
+ *
+ * Active-learning selection of training samples. Candidates are ranked by
+ * how uncertain the detector was about them and near-duplicate images are
+ * skipped, so a fixed budget of samples covers as much as possible.
+ */
+
+#ifndef SAMPLE_SELECTOR_H
+#define SAMPLE_SELECTOR_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+
+namespace Training {
+
+// Selection settings
+struct SelectionConfig {
+    int budget;                   // Samples kept per build (0 = no limit, dedup only)
+    int minPerClass;              // Samples reserved for every class before the global ranking
+    int duplicateDistance;        // Image hash distance at or below which images are near duplicates
+    int sameItemDistance;         // Image hash distance under which nearby frames show the same item
+    int sequenceSeconds;          // Frames logged this close together may show the same item
+    float marginWeight;           // Weight of the confidence margin in the uncertainty score
+    float disagreementWeight;     // Weight of label disagreement between successive frames
+
+    SelectionConfig()
+        : budget(2000),
+          minPerClass(20),
+          duplicateDistance(6),
+          sameItemDistance(12),
+          sequenceSeconds(10),
+          marginWeight(0.6f),
+          disagreementWeight(0.4f) {
+    }
+};
+
+// What the selector knows about one candidate sample
+struct SelectionCandidate {
+    std::string label;
+    float confidence;             // Detector confidence when the entry was logged
+    int64_t time;                 // Seconds since the epoch; 0 if unknown
+    uint64_t imageHash;           // Perceptual hash (see computeImageHash)
+    bool hasImageHash;
+
+    SelectionCandidate() : confidence(0.0f), time(0), imageHash(0), hasImageHash(false) {}
+};
+
+class SampleSelector {
+public:
+    explicit SampleSelector(const SelectionConfig& config = SelectionConfig());
+
+    // Indices of the candidates to keep, most informative first
+    std::vector<size_t> select(const std::vector<SelectionCandidate>& candidates) const;
+
+    // Uncertainty of each candidate in 0..1, from its confidence margin and
+    // from label disagreement with successive frames of the same item
+    std::vector<float> scoreUncertainty(const std::vector<SelectionCandidate>& candidates) const;
+
+    // 64-bit difference hash of an image: similar images differ in few bits.
+    // Decodes at reduced size; returns false if the image cannot be read.
+    static bool computeImageHash(const std::string& imagePath, uint64_t& hash);
+    static uint64_t computeImageHash(const cv::Mat& image);
+
+    static int hashDistance(uint64_t a, uint64_t b);
+
+    // Seconds since the epoch for a "YYYY-MM-DD HH:MM:SS" local timestamp, 0 if invalid
+    static int64_t parseTimestamp(const std::string& timestamp);
+
+private:
+    SelectionConfig m_config;
+};
+
+} // namespace Training
+
+#endif // SAMPLE_SELECTOR_H
@@ -0,0 +1,343 @@
+/**
+ * Shadow Evaluator Implementation
+ */
+
+#include "shadow_evaluator.h"
+#include "../utils/thread_priority.h"
+#include "../utils/trace.h"
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+namespace Training {
+
+namespace {
+
+double percentile(std::vector<double>& values, double fraction) {
+    if (values.empty()) {
+        return 0.0;
+    }
+
+    size_t index = static_cast<size_t>(fraction * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+float boxIoU(const cv::Rect& a, const cv::Rect& b) {
+    float intersection = static_cast<float>((a & b).area());
+    float unionArea = static_cast<float>(a.area() + b.area()) - intersection;
+    return unionArea > 0.0f ? intersection / unionArea : 0.0f;
+}
+
+} // namespace
+
+ShadowEvaluator::ShadowEvaluator(std::shared_ptr<Detection::FoodDetector> liveDetector,
+                                 const ShadowConfig& config)
+    : m_liveDetector(liveDetector),
+      m_config(config),
+      m_scoreThreshold(config.scoreThreshold),
+      m_frameCounter(0),
+      m_accepting(false),
+      m_running(true) {
+
+    m_worker = std::thread(&ShadowEvaluator::workerLoop, this);
+}
+
+ShadowEvaluator::~ShadowEvaluator() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_accepting = false;
+    m_condition.notify_all();
+
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+
+void ShadowEvaluator::submitCandidate(const std::string& modelPath) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_pendingCandidate = modelPath;
+    m_frames.clear();
+    m_accepting = false;
+
+    m_report = ShadowReport();
+    m_report.state = ShadowState::LOADING;
+    m_report.candidatePath = modelPath;
+
+    std::cout << "Shadowing candidate model " << modelPath << std::endl;
+    m_condition.notify_all();
+}
+
+void ShadowEvaluator::offerFrame(const cv::Mat& frame) {
+    if (!m_accepting || frame.empty() || m_config.sampleRate <= 0.0f) {
+        return;
+    }
+
+    // Every Nth frame, so the sample is spread evenly over time
+    uint64_t interval = static_cast<uint64_t>(std::max(1.0f, std::round(1.0f / m_config.sampleRate)));
+    if (m_frameCounter++ % interval != 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (static_cast<int>(m_frames.size()) >= m_config.maxQueuedFrames) {
+        return;  // Worker is behind; never let shadowing back up the frame loop
+    }
+
+    m_frames.push_back(frame.clone());
+    m_condition.notify_one();
+}
+
+void ShadowEvaluator::setPromotionHandler(PromotionHandler handler) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_promotionHandler = handler;
+}
+
+void ShadowEvaluator::setScoreThreshold(float threshold) {
+    m_scoreThreshold = threshold;
+}
+
+ShadowReport ShadowEvaluator::getReport() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_report;
+}
+
+std::string ShadowEvaluator::stateToString(ShadowState state) {
+    switch (state) {
+        case ShadowState::IDLE: return "Idle";
+        case ShadowState::LOADING: return "Loading";
+        case ShadowState::SHADOWING: return "Shadowing";
+        case ShadowState::PROMOTED: return "Promoted";
+        case ShadowState::REJECTED: return "Rejected";
+        default: return "Unknown";
+    }
+}
+
+void ShadowEvaluator::workerLoop() {
+    Utils::applyBackgroundThreadLimits(m_config.niceLevel, m_config.maxCores, "shadow evaluation");
+    Utils::Tracer::instance().setThreadName("shadow");
+
+    while (true) {
+        std::string candidatePath;
+        cv::Mat frame;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() {
+                return !m_running || !m_pendingCandidate.empty() || !m_frames.empty();
+            });
+
+            if (!m_running) {
+                return;
+            }
+
+            if (!m_pendingCandidate.empty()) {
+                candidatePath = m_pendingCandidate;
+                m_pendingCandidate.clear();
+            } else {
+                frame = std::move(m_frames.front());
+                m_frames.pop_front();
+            }
+        }
+
+        if (!candidatePath.empty()) {
+            // Load both models off the frame loop
+            try {
+                std::string classesPath = m_liveDetector->getClassesPath();
+                m_shadowLive = std::make_unique<Detection::FoodDetector>(
+                    m_liveDetector->getModelPath(), classesPath, m_scoreThreshold.load());
+                m_candidate = std::make_unique<Detection::FoodDetector>(
+                    candidatePath, classesPath, m_scoreThreshold.load());
+                m_shadowLive->setCpuSet(m_config.cpus);
+                m_candidate->setCpuSet(m_config.cpus);
+                m_shadowLive->setTaskClass(Utils::TaskClass::BACKGROUND);
+                m_candidate->setTaskClass(Utils::TaskClass::BACKGROUND);
+            }
+            catch (const std::exception& e) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_report.state = ShadowState::REJECTED;
+                m_report.decision = std::string("Candidate failed to load: ") + e.what();
+                std::cerr << m_report.decision << std::endl;
+                continue;
+            }
+
+            m_liveLatencies.clear();
+            m_candidateLatencies.clear();
+            m_liveConfidences.clear();
+            m_candidateConfidences.clear();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_pendingCandidate.empty()) {
+                m_report.state = ShadowState::SHADOWING;
+                m_accepting = true;
+            }
+            continue;
+        }
+
+        if (m_candidate && m_shadowLive) {
+            evaluateFrame(frame);
+        }
+    }
+}
+
+void ShadowEvaluator::evaluateFrame(const cv::Mat& frame) {
+    // Both models see the same threshold even if it changes mid-frame
+    float scoreThreshold = m_scoreThreshold;
+
+    auto start = std::chrono::steady_clock::now();
+    auto liveResult = m_shadowLive->detectObjects(frame, scoreThreshold);
+    auto middle = std::chrono::steady_clock::now();
+    auto candidateResult = m_candidate->detectObjects(frame, scoreThreshold);
+    auto end = std::chrono::steady_clock::now();
+
+    m_liveLatencies.push_back(std::chrono::duration<double, std::milli>(middle - start).count());
+    m_candidateLatencies.push_back(std::chrono::duration<double, std::milli>(end - middle).count());
+    for (const auto& item : liveResult) {
+        m_liveConfidences.push_back(item.confidence);
+    }
+    for (const auto& item : candidateResult) {
+        m_candidateConfidences.push_back(item.confidence);
+    }
+
+    bool agree = detectionsAgree(liveResult, candidateResult);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_report.state != ShadowState::SHADOWING) {
+            return;  // A newer candidate replaced this one
+        }
+
+        m_report.framesEvaluated++;
+        m_report.framesDisagreeing += agree ? 0 : 1;
+        m_report.disagreementRate = static_cast<float>(m_report.framesDisagreeing) / m_report.framesEvaluated;
+    }
+
+    // Refresh the published distributions now and then rather than every frame
+    if (m_liveLatencies.size() % 20 == 0 || static_cast<int>(m_liveLatencies.size()) >= m_config.minFrames) {
+        ShadowModelStats liveStats, candidateStats;
+        std::vector<double> liveCopy = m_liveLatencies;
+        std::vector<double> candidateCopy = m_candidateLatencies;
+        summarize(liveCopy, m_liveConfidences, liveStats);
+        summarize(candidateCopy, m_candidateConfidences, candidateStats);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_report.live = liveStats;
+        m_report.candidate = candidateStats;
+    }
+
+    if (static_cast<int>(m_liveLatencies.size()) >= m_config.minFrames) {
+        decide();
+    }
+}
+
+void ShadowEvaluator::decide() {
+    std::string candidatePath;
+    PromotionHandler promotionHandler;
+    bool promote = true;
+    std::stringstream reasons;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        candidatePath = m_report.candidatePath;
+        promotionHandler = m_promotionHandler;
+
+        // Agreement on empty frames says nothing about a model that never
+        // detects; too few frames or detections is no evidence to promote on
+        if (m_report.framesEvaluated < m_config.minFrames) {
+            promote = false;
+            reasons << "only " << m_report.framesEvaluated << " shadow frames < " << m_config.minFrames << "; ";
+        }
+
+        if (m_report.candidate.detections < m_config.minCandidateDetections) {
+            promote = false;
+            reasons << "candidate detections " << m_report.candidate.detections << " < "
+                    << m_config.minCandidateDetections << "; ";
+        }
+
+        if (m_report.disagreementRate > m_config.maxDisagreementRate) {
+            promote = false;
+            reasons << "disagreement " << m_report.disagreementRate << " > " << m_config.maxDisagreementRate << "; ";
+        }
+
+        double latencyLimit = m_report.live.latencyP95Ms * m_config.maxLatencyRatio;
+        if (m_report.candidate.latencyP95Ms > latencyLimit) {
+            promote = false;
+            reasons << "p95 latency " << m_report.candidate.latencyP95Ms << "ms > " << latencyLimit << "ms; ";
+        }
+
+        float confidenceLimit = m_report.live.meanConfidence * m_config.minConfidenceRatio;
+        if (m_report.candidate.meanConfidence < confidenceLimit) {
+            promote = false;
+            reasons << "mean confidence " << m_report.candidate.meanConfidence << " < " << confidenceLimit << "; ";
+        }
+    }
+
+    // Swap the model in only after every check passed
+    if (promote) {
+        bool promoted = promotionHandler ? promotionHandler(candidatePath) : m_liveDetector->loadModel(candidatePath);
+        if (!promoted) {
+            promote = false;
+            reasons << "candidate could not be put into service; ";
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_accepting = false;
+    m_frames.clear();
+    m_report.state = promote ? ShadowState::PROMOTED : ShadowState::REJECTED;
+    m_report.decision = promote ? "Met all promotion thresholds" : reasons.str();
+
+    std::cout << "Candidate model " << candidatePath << " "
+              << (promote ? "promoted" : "rejected") << " after " << m_report.framesEvaluated
+              << " shadow frames: " << m_report.decision << std::endl;
+
+    m_candidate.reset();
+    m_shadowLive.reset();
+}
+
+bool ShadowEvaluator::detectionsAgree(const Detection::DetectionResult& a, const Detection::DetectionResult& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+
+    std::vector<char> used(b.size(), 0);
+    for (const auto& item : a) {
+        bool found = false;
+        for (size_t j = 0; j < b.size(); j++) {
+            if (!used[j] && b[j].className == item.className && boxIoU(item.boundingBox, b[j].boundingBox) >= 0.5f) {
+                used[j] = 1;
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ShadowEvaluator::summarize(std::vector<double>& latencies, const std::vector<float>& confidences,
+                                ShadowModelStats& stats) {
+    stats.latencyP50Ms = percentile(latencies, 0.5);
+    stats.latencyP95Ms = percentile(latencies, 0.95);
+    stats.detections = static_cast<int>(confidences.size());
+
+    float sum = 0.0f;
+    stats.confidenceHistogram.fill(0);
+    for (float confidence : confidences) {
+        sum += confidence;
+        int bin = std::min(ShadowModelStats::CONFIDENCE_BINS - 1,
+                           std::max(0, static_cast<int>(confidence * ShadowModelStats::CONFIDENCE_BINS)));
+        stats.confidenceHistogram[bin]++;
+    }
+    stats.meanConfidence = confidences.empty() ? 0.0f : sum / confidences.size();
+}
+
+} // namespace Training
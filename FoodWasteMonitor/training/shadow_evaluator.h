@@ -0,0 +1,173 @@
+/**
+ * Shadow Evaluator Header
+ *
+ * Runs a freshly trained candidate model next to the live one on a sample
+ * of production frames and promotes it only if it agrees with the live
+ * model closely enough, is not slower and is not less confident
+ */
+
+#ifndef SHADOW_EVALUATOR_H
+#define SHADOW_EVALUATOR_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <array>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <opencv2/opencv.hpp>
+#include "../detection/food_detector.h"
+#include "../utils/thread_placement.h"
+
+namespace Training {
+
+enum class ShadowState {
+    IDLE,             // No candidate
+    LOADING,          // Candidate submitted, model loading
+    SHADOWING,        // Collecting frames
+    PROMOTED,
+    REJECTED
+};
+
+// Promotion thresholds and resource limits
+struct ShadowConfig {
+    float sampleRate;                 // Fraction of production frames shadowed
+    int minFrames;                    // Frames required before a decision
+    int minCandidateDetections;       // Detections the candidate must make to be promoted
+    int maxQueuedFrames;              // Sampled frames waiting; extra samples are dropped
+    float maxDisagreementRate;        // Fraction of frames where the models may disagree
+    float maxLatencyRatio;            // Candidate p95 latency / live p95 latency
+    float minConfidenceRatio;         // Candidate mean confidence / live mean confidence
+    float scoreThreshold;             // Confidence at which both models are compared
+    int niceLevel;
+    int maxCores;
+    Utils::CpuSet cpus;               // Where both shadow models run (empty = background limits)
+
+    ShadowConfig()
+        : sampleRate(0.1f),
+          minFrames(200),
+          minCandidateDetections(20),
+          maxQueuedFrames(4),
+          maxDisagreementRate(0.2f),
+          maxLatencyRatio(1.2f),
+          minConfidenceRatio(0.95f),
+          scoreThreshold(0.5f),
+          niceLevel(15),
+          maxCores(1) {
+    }
+};
+
+// Latency and confidence figures for one model
+struct ShadowModelStats {
+    static constexpr int CONFIDENCE_BINS = 10;
+
+    double latencyP50Ms;
+    double latencyP95Ms;
+    float meanConfidence;
+    int detections;
+    std::array<int, CONFIDENCE_BINS> confidenceHistogram;    // Bins of width 0.1
+
+    ShadowModelStats()
+        : latencyP50Ms(0.0),
+          latencyP95Ms(0.0),
+          meanConfidence(0.0f),
+          detections(0) {
+        confidenceHistogram.fill(0);
+    }
+};
+
+// Snapshot of the current or last shadow run
+struct ShadowReport {
+    ShadowState state;
+    std::string candidatePath;
+    int framesEvaluated;
+    int framesDisagreeing;
+    float disagreementRate;
+    ShadowModelStats live;
+    ShadowModelStats candidate;
+    std::string decision;             // Reason for the promotion or rejection
+
+    ShadowReport()
+        : state(ShadowState::IDLE),
+          framesEvaluated(0),
+          framesDisagreeing(0),
+          disagreementRate(0.0f) {
+    }
+};
+
+class ShadowEvaluator {
+public:
+    ShadowEvaluator(std::shared_ptr<Detection::FoodDetector> liveDetector,
+                    const ShadowConfig& config = ShadowConfig());
+    ~ShadowEvaluator();
+
+    // Start shadowing a new candidate, replacing any candidate in progress
+    void submitCandidate(const std::string& modelPath);
+
+    // Offer a production frame. Cheap and non-blocking; only a sample of
+    // frames is copied and queued for the shadow worker.
+    void offerFrame(const cv::Mat& frame);
+
+    // Called to put a candidate that passed every threshold into service.
+    // Without a handler the candidate is loaded into the live detector.
+    using PromotionHandler = std::function<bool(const std::string& modelPath)>;
+    void setPromotionHandler(PromotionHandler handler);
+
+    // Follow the live confidence threshold. Frames evaluated from here on
+    // compare both models at the new value.
+    void setScoreThreshold(float threshold);
+
+    ShadowReport getReport() const;
+    static std::string stateToString(ShadowState state);
+
+private:
+    void workerLoop();
+
+    // Run both models on one frame and record the result
+    void evaluateFrame(const cv::Mat& frame);
+
+    // Promote or reject once enough frames were seen
+    void decide();
+
+    // Whether two detection sets match one to one by class and IoU >= 0.5
+    static bool detectionsAgree(const Detection::DetectionResult& a, const Detection::DetectionResult& b);
+
+    static void summarize(std::vector<double>& latencies, const std::vector<float>& confidences,
+                          ShadowModelStats& stats);
+
+    std::shared_ptr<Detection::FoodDetector> m_liveDetector;
+    ShadowConfig m_config;
+    std::atomic<float> m_scoreThreshold;    // m_config.scoreThreshold, changed at runtime
+    PromotionHandler m_promotionHandler;
+
+    // Models used by the worker. The live model is reloaded privately so both
+    // are timed on the same thread under the same conditions.
+    std::unique_ptr<Detection::FoodDetector> m_shadowLive;
+    std::unique_ptr<Detection::FoodDetector> m_candidate;
+    std::string m_pendingCandidate;
+
+    // Frame queue
+    std::deque<cv::Mat> m_frames;
+    std::atomic<uint64_t> m_frameCounter;
+    std::atomic<bool> m_accepting;
+
+    // Raw measurements, owned by the worker
+    std::vector<double> m_liveLatencies;
+    std::vector<double> m_candidateLatencies;
+    std::vector<float> m_liveConfidences;
+    std::vector<float> m_candidateConfidences;
+
+    ShadowReport m_report;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::thread m_worker;
+    bool m_running;
+};
+
+} // namespace Training
+
+#endif // SHADOW_EVALUATOR_H
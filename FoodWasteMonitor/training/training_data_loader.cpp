@@ -0,0 +1,220 @@
+/**
+ * Training Data Loader Implementation
+ */
+
+#include "training_data_loader.h"
+#include "../utils/task_scheduler.h"
+#include <iostream>
+#include <random>
+#include <algorithm>
+
+namespace Training {
+
+void TrainingBatch::clear() {
+    images.clear();
+    annotations.clear();
+    sampleIds.clear();
+}
+
+TrainingDataLoader::TrainingDataLoader(const std::vector<std::string>& shardPaths,
+                                       int batchSize,
+                                       const AugmentationPolicy& policy)
+    : m_batchSize(std::max(1, batchSize)),
+      m_policy(policy),
+      m_position(0),
+      m_epoch(0) {
+
+    for (const auto& shardPath : shardPaths) {
+        auto reader = std::make_unique<RecordReader>();
+        if (!reader->open(shardPath)) {
+            continue;
+        }
+
+        uint32_t shard = static_cast<uint32_t>(m_shards.size());
+        for (size_t record = 0; record < reader->size(); record++) {
+            m_samples.push_back({shard, static_cast<uint32_t>(record)});
+        }
+        m_shards.push_back(std::move(reader));
+    }
+
+    startEpoch(0);
+}
+
+void TrainingDataLoader::startEpoch(int epoch) {
+    m_epoch = epoch;
+    m_position = 0;
+
+    std::seed_seq seq{m_policy.seed, static_cast<uint32_t>(epoch)};
+    std::mt19937 rng(seq);
+
+    // Samples are grouped by shard in m_samples; shuffle the shards, then
+    // the records inside each one
+    std::vector<std::pair<size_t, size_t>> shardRanges;
+    for (size_t start = 0; start < m_samples.size();) {
+        size_t end = start;
+        while (end < m_samples.size() && m_samples[end].shard == m_samples[start].shard) {
+            end++;
+        }
+        shardRanges.emplace_back(start, end);
+        start = end;
+    }
+    std::shuffle(shardRanges.begin(), shardRanges.end(), rng);
+
+    m_order.clear();
+    m_order.reserve(m_samples.size());
+    for (const auto& range : shardRanges) {
+        size_t first = m_order.size();
+        for (size_t i = range.first; i < range.second; i++) {
+            m_order.push_back(i);
+        }
+        std::shuffle(m_order.begin() + first, m_order.end(), rng);
+    }
+}
+
+bool TrainingDataLoader::nextBatch(TrainingBatch& batch) {
+    if (m_position >= m_order.size()) {
+        batch.clear();
+        return false;
+    }
+
+    // Resize rather than clear so the image buffers of the previous batch
+    // are reused as augmentation outputs
+    size_t count = std::min(static_cast<size_t>(m_batchSize), m_order.size() - m_position);
+    batch.images.resize(count);
+    batch.annotations.resize(count);
+    batch.sampleIds.resize(count);
+    std::vector<char> loaded(count, 0);
+
+    // Samples in a batch are independent, so decode and augment them in parallel
+    // on the shared pool's background budget rather than OpenCV's pool, which
+    // is sized for inference. Parameters depend only on (seed, epoch, sample),
+    // never on thread timing.
+    Utils::TaskScheduler::instance().parallelFor(Utils::TaskClass::BACKGROUND, count, [&](size_t i) {
+        size_t sampleIndex = m_order[m_position + i];
+        const SampleRef& ref = m_samples[sampleIndex];
+
+        RecordView record;
+        if (!m_shards[ref.shard]->read(ref.record, record)) {
+            return;
+        }
+
+        cv::Mat decoded = record.decode();
+        if (decoded.empty()) {
+            return;
+        }
+
+        batch.annotations[i] = std::move(record.annotations);
+        batch.sampleIds[i] = std::move(record.id);
+        if (m_policy.enabled) {
+            applyAugmentation(decoded, batch.images[i], batch.annotations[i],
+                              drawParams(m_policy, m_epoch, sampleIndex));
+        } else {
+            batch.images[i] = decoded;
+        }
+        loaded[i] = 1;
+    });
+
+    // Drop samples that failed to decode, keeping the order of the rest
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!loaded[i]) {
+            const SampleRef& ref = m_samples[m_order[m_position + i]];
+            std::cerr << "Failed to read training record " << ref.record << " of shard " << ref.shard << std::endl;
+            continue;
+        }
+
+        if (kept != i) {
+            std::swap(batch.images[kept], batch.images[i]);
+            std::swap(batch.annotations[kept], batch.annotations[i]);
+            std::swap(batch.sampleIds[kept], batch.sampleIds[i]);
+        }
+        kept++;
+    }
+    batch.images.resize(kept);
+    batch.annotations.resize(kept);
+    batch.sampleIds.resize(kept);
+
+    m_position += count;
+    return true;
+}
+
+size_t TrainingDataLoader::getSampleCount() const {
+    return m_samples.size();
+}
+
+int TrainingDataLoader::getBatchesPerEpoch() const {
+    return static_cast<int>((m_samples.size() + m_batchSize - 1) / m_batchSize);
+}
+
+AugmentationParams TrainingDataLoader::drawParams(const AugmentationPolicy& policy, int epoch, size_t sampleIndex) {
+    std::seed_seq seq{policy.seed, static_cast<uint32_t>(epoch),
+                      static_cast<uint32_t>(sampleIndex), static_cast<uint32_t>(sampleIndex >> 32)};
+    std::mt19937 rng(seq);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    AugmentationParams params;
+    params.flip = unit(rng) < policy.flipProbability;
+    params.rotationDegrees = (unit(rng) * 2.0f - 1.0f) * policy.maxRotationDegrees;
+    params.brightnessShift = (unit(rng) * 2.0f - 1.0f) * policy.maxBrightnessShift;
+    params.contrast = 1.0f + (unit(rng) * 2.0f - 1.0f) * policy.maxContrast;
+    for (float& gain : params.channelGain) {
+        gain = 1.0f + (unit(rng) * 2.0f - 1.0f) * policy.maxColorJitter;
+    }
+    params.noiseAmplitude = unit(rng) * policy.maxNoise;
+    params.noiseSeed = rng();
+    return params;
+}
+
+void TrainingDataLoader::applyAugmentation(const cv::Mat& image, cv::Mat& output,
+                                           std::vector<TrainingAnnotation>& annotations,
+                                           const AugmentationParams& params) {
+    if (image.empty()) {
+        output.release();
+        return;
+    }
+
+    // Geometric pass: rotation about the image center. Boxes become the
+    // bounds of their rotated corners.
+    cv::Mat pixelSource = image;
+    if (params.rotationDegrees != 0.0f) {
+        cv::Point2f center(image.cols / 2.0f, image.rows / 2.0f);
+        cv::Mat rotationMatrix = cv::getRotationMatrix2D(center, params.rotationDegrees, 1.0);
+
+        thread_local cv::Mat rotated;
+        cv::warpAffine(image, rotated, rotationMatrix, image.size());
+        pixelSource = rotated;
+
+        cv::Size2f size(static_cast<float>(image.cols), static_cast<float>(image.rows));
+        for (auto& annotation : annotations) {
+            std::vector<cv::Point2f> corners = {
+                {annotation.box.x * size.width, annotation.box.y * size.height},
+                {(annotation.box.x + annotation.box.width) * size.width, annotation.box.y * size.height},
+                {annotation.box.x * size.width, (annotation.box.y + annotation.box.height) * size.height},
+                {(annotation.box.x + annotation.box.width) * size.width, (annotation.box.y + annotation.box.height) * size.height}
+            };
+            cv::transform(corners, corners, rotationMatrix);
+
+            float minX = size.width, minY = size.height, maxX = 0.0f, maxY = 0.0f;
+            for (const auto& corner : corners) {
+                minX = std::max(0.0f, std::min(minX, corner.x));
+                minY = std::max(0.0f, std::min(minY, corner.y));
+                maxX = std::min(size.width, std::max(maxX, corner.x));
+                maxY = std::min(size.height, std::max(maxY, corner.y));
+            }
+            annotation.box = cv::Rect2f(minX / size.width, minY / size.height,
+                                        std::max(0.0f, maxX - minX) / size.width,
+                                        std::max(0.0f, maxY - minY) / size.height);
+        }
+    }
+
+    // Pixel pass: flip, contrast/brightness, color jitter and noise fused
+    applyPixelAugmentation(pixelSource, output, params);
+
+    if (params.flip) {
+        for (auto& annotation : annotations) {
+            annotation.box.x = 1.0f - annotation.box.x - annotation.box.width;
+        }
+    }
+}
+
+} // namespace Training
@@ -0,0 +1,102 @@
+/**
+ * Training Data Loader Header
+ *
+ * Streams training samples from packed record shards in shuffled batches
+ * and applies randomized augmentation in memory, so augmented images never
+ * touch disk
+ */
+
+#ifndef TRAINING_DATA_LOADER_H
+#define TRAINING_DATA_LOADER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <memory>
+#include <opencv2/opencv.hpp>
+#include "augmentation_kernel.h"
+#include "record_file.h"
+
+namespace Training {
+
+// Ranges augmentation parameters are drawn from. The same seed, epoch and
+// sample always produce the same augmentation.
+struct AugmentationPolicy {
+    bool enabled;
+    float flipProbability;        // Chance of a horizontal flip
+    float maxRotationDegrees;     // Rotation drawn from [-max, max]
+    float maxBrightnessShift;     // Brightness offset drawn from [-max, max]
+    float maxContrast;            // Contrast gain drawn from [1 - max, 1 + max]
+    float maxColorJitter;         // Per-channel gain drawn from [1 - max, 1 + max] (0 = off)
+    float maxNoise;               // Uniform noise amplitude drawn from [0, max]
+    uint32_t seed;
+
+    AugmentationPolicy()
+        : enabled(true),
+          flipProbability(0.5f),
+          maxRotationDegrees(10.0f),
+          maxBrightnessShift(30.0f),
+          maxContrast(0.2f),
+          maxColorJitter(0.0f),
+          maxNoise(20.0f),
+          seed(42) {
+    }
+};
+
+// One batch of decoded, augmented samples
+struct TrainingBatch {
+    std::vector<cv::Mat> images;
+    std::vector<std::vector<TrainingAnnotation>> annotations;
+    std::vector<std::string> sampleIds;
+
+    size_t size() const { return images.size(); }
+    void clear();
+};
+
+class TrainingDataLoader {
+public:
+    TrainingDataLoader(const std::vector<std::string>& shardPaths,
+                       int batchSize,
+                       const AugmentationPolicy& policy = AugmentationPolicy());
+
+    // Reshuffle and redraw augmentation parameters for a new epoch. Shards are
+    // visited in random order and records shuffled within each shard, so reads
+    // stay within one mapped file at a time.
+    void startEpoch(int epoch);
+
+    // Decode and augment the next batch. Returns false once the epoch is exhausted.
+    bool nextBatch(TrainingBatch& batch);
+
+    size_t getSampleCount() const;
+    int getBatchesPerEpoch() const;
+
+    // Draw the augmentation for one sample in one epoch
+    static AugmentationParams drawParams(const AugmentationPolicy& policy, int epoch, size_t sampleIndex);
+
+    // Augment an image into output and transform its annotations to match.
+    // The rotation runs as a separate warp; everything else is one fused pass.
+    static void applyAugmentation(const cv::Mat& image, cv::Mat& output,
+                                  std::vector<TrainingAnnotation>& annotations,
+                                  const AugmentationParams& params);
+
+private:
+    // Location of a sample: shard and record within it
+    struct SampleRef {
+        uint32_t shard;
+        uint32_t record;
+    };
+
+    std::vector<std::unique_ptr<RecordReader>> m_shards;
+    std::vector<SampleRef> m_samples;
+    int m_batchSize;
+    AugmentationPolicy m_policy;
+
+    // Epoch state
+    std::vector<size_t> m_order;
+    size_t m_position;
+    int m_epoch;
+};
+
+} // namespace Training
+
+#endif // TRAINING_DATA_LOADER_H
@@ -0,0 +1,265 @@
+/**
+ * Training Job Manager Implementation
+ */
+
+#include "training_job_manager.h"
+#include "../utils/thread_priority.h"
+#include "../utils/trace.h"
+#include "../utils/logger.h"
+#include <algorithm>
+
+namespace Training {
+
+namespace {
+
+int64_t steadyMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Latency reports older than this mean detection is idle and needs no protection
+const int64_t LATENCY_REPORT_TIMEOUT_MS = 1000;
+
+// How long a throttled job sleeps before re-checking detection latency
+const std::chrono::milliseconds THROTTLE_POLL_INTERVAL(200);
+
+} // namespace
+
+TrainingJobManager::TrainingJobManager(std::shared_ptr<ModelTrainer> trainer, const JobLimits& limits)
+    : m_trainer(trainer),
+      m_limits(limits),
+      m_jobRunning(false),
+      m_cancelRequested(false),
+      m_hasEpochTiming(false),
+      m_averageEpochSeconds(0.0),
+      m_detectionLatencyMs(0.0),
+      m_lastLatencyReportMs(0) {
+
+    m_trainer->setEpochCallback([this](int completedEpochs, int totalEpochs) {
+        return onEpochEnd(completedEpochs, totalEpochs);
+    });
+}
+
+TrainingJobManager::~TrainingJobManager() {
+    cancelJob();
+
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+
+    m_trainer->setEpochCallback(nullptr);
+}
+
+bool TrainingJobManager::startJob() {
+    bool expected = false;
+    if (!m_jobRunning.compare_exchange_strong(expected, true)) {
+        return false;  // A job is already running
+    }
+
+    // Reap the previous, already finished worker
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+
+    m_cancelRequested = false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_progressMutex);
+        m_progress = JobProgress();
+        m_progress.state = JobState::RUNNING;
+        m_progress.totalEpochs = m_trainer->getEpochs();
+        m_jobStart = std::chrono::steady_clock::now();
+        m_hasEpochTiming = false;
+        m_averageEpochSeconds = 0.0;
+    }
+
+    m_worker = std::thread(&TrainingJobManager::runJob, this);
+    return true;
+}
+
+void TrainingJobManager::cancelJob() {
+    if (!m_jobRunning) {
+        return;
+    }
+
+    m_cancelRequested = true;
+
+    {
+        std::lock_guard<std::mutex> lock(m_progressMutex);
+        if (m_progress.state == JobState::RUNNING) {
+            m_progress.state = JobState::CANCELLING;
+        }
+    }
+
+    m_waitCondition.notify_all();
+}
+
+bool TrainingJobManager::isJobRunning() const {
+    return m_jobRunning;
+}
+
+JobProgress TrainingJobManager::getProgress() const {
+    std::lock_guard<std::mutex> lock(m_progressMutex);
+
+    JobProgress progress = m_progress;
+    if (m_jobRunning) {
+        progress.elapsedSeconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - m_jobStart).count();
+    }
+    return progress;
+}
+
+void TrainingJobManager::reportDetectionLatency(double milliseconds) {
+    // Smooth over a handful of frames so a single slow frame does not stall training
+    double previous = m_detectionLatencyMs.load(std::memory_order_relaxed);
+    double smoothed = previous <= 0.0 ? milliseconds : previous * 0.9 + milliseconds * 0.1;
+
+    m_detectionLatencyMs.store(smoothed, std::memory_order_relaxed);
+    m_lastLatencyReportMs.store(steadyMillis(), std::memory_order_relaxed);
+}
+
+std::string TrainingJobManager::jobStateToString(JobState state) {
+    switch (state) {
+        case JobState::IDLE: return "Idle";
+        case JobState::RUNNING: return "Running";
+        case JobState::CANCELLING: return "Cancelling";
+        case JobState::COMPLETED: return "Completed";
+        case JobState::FAILED: return "Failed";
+        case JobState::CANCELLED: return "Cancelled";
+        default: return "Unknown";
+    }
+}
+
+void TrainingJobManager::runJob() {
+    applyThreadLimits();
+
+    Utils::logInfo("training", "Training job started");
+
+    bool success = false;
+    try {
+        success = m_trainer->trainModel();
+    }
+    catch (const std::exception& e) {
+        Utils::logError("training", "Training job failed: %s", e.what());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_progressMutex);
+        m_progress.elapsedSeconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - m_jobStart).count();
+        m_progress.etaSeconds = 0.0;
+        m_progress.throttled = false;
+        m_progress.paused = false;
+
+        if (m_cancelRequested) {
+            m_progress.state = JobState::CANCELLED;
+        } else if (success) {
+            m_progress.state = JobState::COMPLETED;
+            m_progress.fraction = 1.0f;
+        } else {
+            m_progress.state = JobState::FAILED;
+        }
+    }
+
+    Utils::logInfo("training", "Training job finished: %s", jobStateToString(getProgress().state).c_str());
+
+    m_jobRunning = false;
+}
+
+bool TrainingJobManager::onEpochEnd(int completedEpochs, int totalEpochs) {
+    auto now = std::chrono::steady_clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(m_progressMutex);
+
+        m_progress.completedEpochs = completedEpochs;
+        m_progress.totalEpochs = totalEpochs;
+        m_progress.fraction = totalEpochs > 0 ? static_cast<float>(completedEpochs) / totalEpochs : 0.0f;
+
+        // Estimate from the time between epoch boundaries. The first epoch also
+        // contains data preparation, so the ETA stays unknown until the second.
+        if (m_hasEpochTiming) {
+            double epochSeconds = std::chrono::duration<double>(now - m_lastEpochEnd).count();
+            m_averageEpochSeconds = m_averageEpochSeconds <= 0.0 ?
+                epochSeconds : m_averageEpochSeconds * 0.8 + epochSeconds * 0.2;
+            m_progress.etaSeconds = m_averageEpochSeconds * (totalEpochs - completedEpochs);
+        }
+    }
+
+    // Hold the job at the epoch boundary while detection is struggling or
+    // the owner has asked it to yield
+    while (!m_cancelRequested) {
+        bool throttled = isDetectionOverloaded();
+        bool paused = isPauseRequested();
+        if (!throttled && !paused) {
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_progressMutex);
+            m_progress.throttled = throttled;
+            m_progress.paused = paused;
+        }
+
+        std::unique_lock<std::mutex> lock(m_waitMutex);
+        m_waitCondition.wait_for(lock, THROTTLE_POLL_INTERVAL, [this]() { return m_cancelRequested.load(); });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_progressMutex);
+        m_progress.throttled = false;
+        m_progress.paused = false;
+
+        // Time spent throttled is not counted towards the epoch duration
+        m_lastEpochEnd = std::chrono::steady_clock::now();
+        m_hasEpochTiming = true;
+    }
+
+    return !m_cancelRequested;
+}
+
+void TrainingJobManager::setPauseCondition(PauseCondition condition) {
+    std::lock_guard<std::mutex> lock(m_pauseMutex);
+    m_pauseCondition = condition;
+}
+
+bool TrainingJobManager::isPauseRequested() const {
+    std::lock_guard<std::mutex> lock(m_pauseMutex);
+    return m_pauseCondition && m_pauseCondition();
+}
+
+void TrainingJobManager::setLimits(const JobLimits& limits) {
+    std::lock_guard<std::mutex> lock(m_limitsMutex);
+    m_limits = limits;
+}
+
+bool TrainingJobManager::isDetectionOverloaded() const {
+    float maxLatencyMs;
+    {
+        std::lock_guard<std::mutex> lock(m_limitsMutex);
+        maxLatencyMs = m_limits.maxDetectionLatencyMs;
+    }
+    if (maxLatencyMs <= 0.0f) {
+        return false;
+    }
+
+    // No recent frames means there is no inference to protect
+    int64_t lastReport = m_lastLatencyReportMs.load(std::memory_order_relaxed);
+    if (steadyMillis() - lastReport > LATENCY_REPORT_TIMEOUT_MS) {
+        return false;
+    }
+
+    return m_detectionLatencyMs.load(std::memory_order_relaxed) > maxLatencyMs;
+}
+
+void TrainingJobManager::applyThreadLimits() const {
+    JobLimits limits;
+    {
+        std::lock_guard<std::mutex> lock(m_limitsMutex);
+        limits = m_limits;
+    }
+    Utils::applyBackgroundThreadLimits(limits.niceLevel, limits.maxCores, "training");
+    Utils::Tracer::instance().setThreadName("training");
+}
+
+} // namespace Training
@@ -0,0 +1,143 @@
+/**
+ * Training Job Manager Header
+ *
+ * Runs model training as a cancelable background job on a low-priority,
+ * core-limited worker thread and reports progress while it runs
+ */
+
+#ifndef TRAINING_JOB_MANAGER_H
+#define TRAINING_JOB_MANAGER_H
+
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include "model_trainer.h"
+
+namespace Training {
+
+// Lifecycle of a training job
+enum class JobState {
+    IDLE,
+    RUNNING,
+    CANCELLING,
+    COMPLETED,
+    FAILED,
+    CANCELLED
+};
+
+// Snapshot of the current or most recent job
+struct JobProgress {
+    JobState state;
+    int completedEpochs;
+    int totalEpochs;
+    float fraction;           // 0..1
+    double elapsedSeconds;
+    double etaSeconds;        // Negative while unknown
+    bool throttled;           // Waiting for detection latency to recover
+    bool paused;              // Held at an epoch boundary by the pause condition
+
+    JobProgress()
+        : state(JobState::IDLE),
+          completedEpochs(0),
+          totalEpochs(0),
+          fraction(0.0f),
+          elapsedSeconds(0.0),
+          etaSeconds(-1.0),
+          throttled(false),
+          paused(false) {
+    }
+};
+
+// Resource limits applied to the training worker
+struct JobLimits {
+    int niceLevel;                     // Scheduling niceness of the worker thread
+    int maxCores;                      // Cores the worker may run on (0 = no limit)
+    float maxDetectionLatencyMs;       // Hold training while detection is slower than this (0 = off)
+
+    JobLimits()
+        : niceLevel(10),
+          maxCores(1),
+          maxDetectionLatencyMs(100.0f) {
+    }
+};
+
+class TrainingJobManager {
+public:
+    TrainingJobManager(std::shared_ptr<ModelTrainer> trainer, const JobLimits& limits = JobLimits());
+    ~TrainingJobManager();
+
+    // Job control. At most one job runs at a time; startJob returns false
+    // if a job is already running.
+    bool startJob();
+    void cancelJob();
+    bool isJobRunning() const;
+    JobProgress getProgress() const;
+
+    // Latency limit applies from the next epoch, thread limits from the next job
+    void setLimits(const JobLimits& limits);
+
+    // Detection loop feedback used to keep training from starving inference
+    void reportDetectionLatency(double milliseconds);
+
+    // While this returns true a running job parks itself at the next epoch
+    // boundary and resumes once it turns false again
+    using PauseCondition = std::function<bool()>;
+    void setPauseCondition(PauseCondition condition);
+
+    static std::string jobStateToString(JobState state);
+
+private:
+    // Worker thread body
+    void runJob();
+
+    // Epoch boundary hook installed on the trainer
+    bool onEpochEnd(int completedEpochs, int totalEpochs);
+
+    // Lower priority and restrict the calling thread to the last maxCores cores
+    void applyThreadLimits() const;
+
+    // True while the detection loop is reporting latency above the limit
+    bool isDetectionOverloaded() const;
+
+    // True while the pause condition asks the job to yield
+    bool isPauseRequested() const;
+
+    std::shared_ptr<ModelTrainer> m_trainer;
+    JobLimits m_limits;
+    mutable std::mutex m_limitsMutex;
+
+    // Worker
+    std::thread m_worker;
+    std::atomic<bool> m_jobRunning;
+    std::atomic<bool> m_cancelRequested;
+
+    // Progress
+    JobProgress m_progress;
+    std::chrono::steady_clock::time_point m_jobStart;
+    std::chrono::steady_clock::time_point m_lastEpochEnd;
+    bool m_hasEpochTiming;
+    double m_averageEpochSeconds;
+    mutable std::mutex m_progressMutex;
+
+    // Pause condition
+    PauseCondition m_pauseCondition;
+    mutable std::mutex m_pauseMutex;
+
+    // Used to wake a throttled job on cancel
+    std::mutex m_waitMutex;
+    std::condition_variable m_waitCondition;
+
+    // Detection latency feedback (exponential moving average)
+    std::atomic<double> m_detectionLatencyMs;
+    std::atomic<int64_t> m_lastLatencyReportMs;
+};
+
+} // namespace Training
+
+#endif // TRAINING_JOB_MANAGER_H
@@ -0,0 +1,209 @@
+/**
+ * Training Scheduler Implementation
+ */
+
+#include "training_scheduler.h"
+#include "../utils/logger.h"
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+namespace Training {
+
+namespace {
+
+const int MINUTES_PER_DAY = 24 * 60;
+
+// How long fewer detections must last before the items are taken as gone
+const std::chrono::milliseconds ITEM_HOLD(1000);
+
+int64_t bucketIndexNow(int bucketSeconds) {
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return seconds / bucketSeconds;
+}
+
+std::tm currentLocalTime() {
+    auto now = std::chrono::system_clock::now();
+    auto timeT = std::chrono::system_clock::to_time_t(now);
+    std::tm localTime = {};
+    localtime_r(&timeT, &localTime);
+    return localTime;
+}
+
+} // namespace
+
+TrainingScheduler::TrainingScheduler(std::shared_ptr<Data::WasteDatabase> database,
+                                     std::shared_ptr<TrainingJobManager> jobManager,
+                                     const SchedulerConfig& config)
+    : m_database(database),
+      m_jobManager(jobManager),
+      m_config(config),
+      m_currentBucket(bucketIndexNow(LOAD_BUCKET_SECONDS)),
+      m_itemsInView(0),
+      m_itemsInViewSeen(std::chrono::steady_clock::now()),
+      m_lastTrainingTime(std::chrono::steady_clock::now()),
+      m_jobStartedByScheduler(false) {
+
+    m_loadBuckets.fill(0);
+    {
+        std::lock_guard<std::mutex> lock(m_configMutex);
+        loadPeakWindows();
+    }
+
+    // Running jobs yield at the next epoch boundary once it gets busy
+    m_jobManager->setPauseCondition([this]() { return shouldPauseJob(); });
+}
+
+TrainingScheduler::~TrainingScheduler() {
+    m_jobManager->setPauseCondition(nullptr);
+}
+
+void TrainingScheduler::loadPeakWindows() {
+    m_peakWindows.clear();
+
+    for (const auto& [period, range] : m_database->getMealTimeRanges()) {
+        // Snack time is the catch-all for the rest of the day, not a rush
+        if (period != Data::MealPeriod::BREAKFAST &&
+            period != Data::MealPeriod::LUNCH &&
+            period != Data::MealPeriod::DINNER) {
+            continue;
+        }
+
+        Window window;
+        window.startMinute = range.startHour * 60 + range.startMinute - m_config.quietMarginMinutes;
+        window.endMinute = range.endHour * 60 + range.endMinute + m_config.quietMarginMinutes;
+        m_peakWindows.push_back(window);
+    }
+}
+
+void TrainingScheduler::setConfig(const SchedulerConfig& config) {
+    std::lock_guard<std::mutex> lock(m_configMutex);
+    m_config = config;
+    loadPeakWindows();
+}
+
+bool TrainingScheduler::isQuietTime(const std::tm& localTime) const {
+    std::lock_guard<std::mutex> lock(m_configMutex);
+    int minute = localTime.tm_hour * 60 + localTime.tm_min;
+
+    for (const auto& window : m_peakWindows) {
+        // Windows widened by the margin may wrap around midnight
+        for (int offset : {-MINUTES_PER_DAY, 0, MINUTES_PER_DAY}) {
+            if (minute + offset >= window.startMinute && minute + offset <= window.endMinute) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void TrainingScheduler::recordDetections(int count) {
+    std::lock_guard<std::mutex> lock(m_loadMutex);
+
+    // The frame loop reports every frame; only newly seen items add load
+    auto now = std::chrono::steady_clock::now();
+    int arrived = 0;
+    if (count >= m_itemsInView) {
+        arrived = count - m_itemsInView;
+        m_itemsInView = count;
+        m_itemsInViewSeen = now;
+    } else if (now - m_itemsInViewSeen >= ITEM_HOLD) {
+        m_itemsInView = count;
+        m_itemsInViewSeen = now;
+    }
+    if (arrived == 0) {
+        return;
+    }
+
+    // Advance the ring, clearing buckets that fell out of the window
+    int64_t bucket = bucketIndexNow(LOAD_BUCKET_SECONDS);
+    for (int64_t b = m_currentBucket + 1; b <= bucket && b <= m_currentBucket + LOAD_BUCKETS; b++) {
+        m_loadBuckets[b % LOAD_BUCKETS] = 0;
+    }
+    m_currentBucket = std::max(m_currentBucket, bucket);
+
+    m_loadBuckets[m_currentBucket % LOAD_BUCKETS] += arrived;
+}
+
+float TrainingScheduler::getCurrentLoad() const {
+    std::lock_guard<std::mutex> lock(m_loadMutex);
+
+    int64_t bucket = bucketIndexNow(LOAD_BUCKET_SECONDS);
+    int64_t staleBuckets = bucket - m_currentBucket;
+
+    // Sum only buckets still inside the window
+    int total = 0;
+    for (int i = 0; i < LOAD_BUCKETS - staleBuckets && i < LOAD_BUCKETS; i++) {
+        total += m_loadBuckets[(m_currentBucket - i + LOAD_BUCKETS * 2) % LOAD_BUCKETS];
+    }
+
+    float windowMinutes = static_cast<float>(LOAD_BUCKETS * LOAD_BUCKET_SECONDS) / 60.0f;
+    return total / windowMinutes;
+}
+
+bool TrainingScheduler::shouldPauseJob() const {
+    // Only park jobs the scheduler started; manual training runs as requested
+    if (!m_jobStartedByScheduler) {
+        return false;
+    }
+
+    float pauseLoad;
+    {
+        std::lock_guard<std::mutex> lock(m_configMutex);
+        pauseLoad = m_config.pauseLoad;
+    }
+    return !isQuietTime(currentLocalTime()) || getCurrentLoad() > pauseLoad;
+}
+
+void TrainingScheduler::tick() {
+    if (m_jobManager->isJobRunning()) {
+        return;
+    }
+
+    m_jobStartedByScheduler = false;
+
+    SchedulerConfig config;
+    {
+        std::lock_guard<std::mutex> lock(m_configMutex);
+        config = m_config;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    auto elapsedHours = std::chrono::duration_cast<std::chrono::hours>(now - m_lastTrainingTime).count();
+    if (elapsedHours < config.trainingIntervalHours) {
+        return;
+    }
+
+    // Training is due - wait for a quiet window with little activity
+    if (!isQuietTime(currentLocalTime()) || getCurrentLoad() > config.maxStartLoad) {
+        return;
+    }
+
+    m_jobStartedByScheduler = true;
+    if (m_jobManager->startJob()) {
+        m_lastTrainingTime = now;
+        Utils::logInfo("training", "Started scheduled model training during quiet period");
+    } else {
+        m_jobStartedByScheduler = false;
+    }
+}
+
+std::string TrainingScheduler::getStatus() const {
+    std::stringstream ss;
+
+    if (m_jobManager->isJobRunning()) {
+        auto progress = m_jobManager->getProgress();
+        ss << (progress.paused ? "Training paused (busy)" : "Training running");
+    } else if (isQuietTime(currentLocalTime())) {
+        ss << "Quiet period";
+    } else {
+        ss << "Peak period - training deferred";
+    }
+
+    ss << ", load " << std::fixed << std::setprecision(1) << getCurrentLoad() << "/min";
+    return ss.str();
+}
+
+} // namespace Training
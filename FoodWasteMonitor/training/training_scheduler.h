@@ -0,0 +1,108 @@
+/**
+ * Training Scheduler Header
+ *
+ * Defers periodic model training into quiet windows outside of meal
+ * periods and pauses running jobs when the dining hall gets busy
+ */
+
+#ifndef TRAINING_SCHEDULER_H
+#define TRAINING_SCHEDULER_H
+
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include "training_job_manager.h"
+#include "../data/waste_database.h"
+
+namespace Training {
+
+// Scheduling policy
+struct SchedulerConfig {
+    int trainingIntervalHours;        // Minimum time between training runs
+    int quietMarginMinutes;           // Buffer kept clear before and after each meal
+    float maxStartLoad;               // Items per minute above which no job starts
+    float pauseLoad;                  // Items per minute that pause a running job
+
+    SchedulerConfig()
+        : trainingIntervalHours(48),
+          quietMarginMinutes(30),
+          maxStartLoad(2.0f),
+          pauseLoad(10.0f) {
+    }
+};
+
+class TrainingScheduler {
+public:
+    TrainingScheduler(std::shared_ptr<Data::WasteDatabase> database,
+                      std::shared_ptr<TrainingJobManager> jobManager,
+                      const SchedulerConfig& config = SchedulerConfig());
+    ~TrainingScheduler();
+
+    // Call once per processed frame with the number of items detected in it.
+    // Load counts items as they come into view, so a tray that stays under
+    // the camera for many frames counts once, not once per frame.
+    void recordDetections(int count);
+
+    // Replace the policy; peak windows are rebuilt for the new margin
+    void setConfig(const SchedulerConfig& config);
+
+    // Start a due training job if the current time and load allow it.
+    // Call periodically from the main loop.
+    void tick();
+
+    // Whether the given local time lies outside every meal window plus margin
+    bool isQuietTime(const std::tm& localTime) const;
+
+    // Current load in items per minute over the recent window
+    float getCurrentLoad() const;
+
+    // Short description of the scheduler state for display
+    std::string getStatus() const;
+
+private:
+    // Pause condition installed on the job manager
+    bool shouldPauseJob() const;
+
+    // Rebuild peak windows from the database meal time ranges. Called with
+    // m_configMutex held, which also guards m_peakWindows.
+    void loadPeakWindows();
+
+    // Peak windows in minutes since midnight, already widened by the margin
+    struct Window {
+        int startMinute;
+        int endMinute;
+    };
+    std::vector<Window> m_peakWindows;
+
+    std::shared_ptr<Data::WasteDatabase> m_database;
+    std::shared_ptr<TrainingJobManager> m_jobManager;
+
+    // The pause condition reads these on the training thread
+    SchedulerConfig m_config;
+    mutable std::mutex m_configMutex;
+
+    // Arriving items in fixed-width time buckets covering the load window
+    static constexpr int LOAD_BUCKETS = 30;
+    static constexpr int LOAD_BUCKET_SECONDS = 10;
+    std::array<int, LOAD_BUCKETS> m_loadBuckets;
+    int64_t m_currentBucket;
+
+    // Items currently in view. Fewer detections only lower it once they
+    // have lasted ITEM_HOLD, so a missed frame does not re-count the items.
+    int m_itemsInView;
+    std::chrono::steady_clock::time_point m_itemsInViewSeen;
+    mutable std::mutex m_loadMutex;
+
+    // Scheduling state
+    std::chrono::steady_clock::time_point m_lastTrainingTime;
+    std::atomic<bool> m_jobStartedByScheduler;
+};
+
+} // namespace Training
+
+#endif // TRAINING_SCHEDULER_H
@@ -0,0 +1,459 @@
+/**
+ * Image Gallery Implementation
+ */
+
+#include "image_gallery.h"
+#include "../utils/task_scheduler.h"
+#include "../utils/image_header.h"
+#include "../utils/logger.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace UI {
+
+//
+// ThumbnailCache Implementation
+//
+
+ThumbnailCache::ThumbnailCache(size_t capacity)
+    : m_capacity(std::max<size_t>(1, capacity)) {
+}
+
+bool ThumbnailCache::get(const std::string& path, cv::Mat& thumbnail) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_index.find(path);
+    if (it == m_index.end()) {
+        return false;
+    }
+
+    // Move to the front as most recently used
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    thumbnail = it->second->second;
+    return true;
+}
+
+void ThumbnailCache::put(const std::string& path, const cv::Mat& thumbnail) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_index.find(path);
+    if (it != m_index.end()) {
+        it->second->second = thumbnail;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return;
+    }
+
+    m_entries.emplace_front(path, thumbnail);
+    m_index[path] = m_entries.begin();
+
+    // Evict the least recently used thumbnail
+    if (m_entries.size() > m_capacity) {
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+}
+
+bool ThumbnailCache::contains(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_index.count(path) > 0;
+}
+
+void ThumbnailCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+}
+
+//
+// ImageGallery Implementation
+//
+
+ImageGallery::ImageGallery(const std::string& imagesDir,
+                           cv::Size thumbnailSize,
+                           size_t cacheCapacity,
+                           int maxConcurrentDecodes)
+    : m_imagesDir(imagesDir),
+      m_thumbnailSize(thumbnailSize),
+      m_cache(cacheCapacity),
+      m_currentPage(0),
+      m_columns(1),
+      m_rows(1),
+      m_cellWidth(thumbnailSize.width),
+      m_cellHeight(thumbnailSize.height),
+      m_maxConcurrentDecodes(std::max(1, maxConcurrentDecodes)),
+      m_activeDecodes(0),
+      m_running(false) {
+}
+
+ImageGallery::~ImageGallery() {
+    // Running decode tasks finish their current image and stop
+    std::unique_lock<std::mutex> lock(m_queueMutex);
+    m_running = false;
+    m_queueCondition.wait(lock, [this]() { return m_activeDecodes == 0; });
+}
+
+void ImageGallery::update() {
+    // Decoding starts on first use
+    m_running = true;
+
+    scanImages();
+}
+
+void ImageGallery::scanImages() {
+    std::vector<std::pair<fs::file_time_type, std::string>> files;
+
+    try {
+        if (fs::exists(m_imagesDir)) {
+            for (const auto& entry : fs::directory_iterator(m_imagesDir)) {
+                if (!entry.is_regular_file()) {
+                    continue;
+                }
+
+                std::string ext = entry.path().extension().string();
+                std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+                if (ext == ".jpg" || ext == ".jpeg" || ext == ".png") {
+                    files.emplace_back(entry.last_write_time(), entry.path().string());
+                }
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error scanning gallery images: " << e.what() << std::endl;
+    }
+
+    // Newest first, since recent crops are the ones being reviewed
+    std::sort(files.begin(), files.end(),
+              [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_imagePaths.clear();
+    m_imagePaths.reserve(files.size());
+    for (const auto& file : files) {
+        m_imagePaths.push_back(file.second);
+    }
+
+    int pageCount = std::max(1, static_cast<int>((m_imagePaths.size() + m_columns * m_rows - 1) / (m_columns * m_rows)));
+    m_currentPage = std::min(m_currentPage, pageCount - 1);
+}
+
+void ImageGallery::nextPage() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int pageSize = m_columns * m_rows;
+    if ((m_currentPage + 1) * pageSize < static_cast<int>(m_imagePaths.size())) {
+        m_currentPage++;
+    }
+}
+
+void ImageGallery::previousPage() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_currentPage > 0) {
+        m_currentPage--;
+    }
+}
+
+int ImageGallery::getCurrentPage() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_currentPage;
+}
+
+int ImageGallery::getPageCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int pageSize = m_columns * m_rows;
+    return std::max(1, static_cast<int>((m_imagePaths.size() + pageSize - 1) / pageSize));
+}
+
+std::string ImageGallery::getSelectedImage() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_selectedImage;
+}
+
+void ImageGallery::computeLayout(const cv::Mat& frame) {
+    // Leave room for the control panel on the left and the mode bar below
+    int padding = 10;
+    int labelHeight = 20;
+
+    m_gridOrigin = cv::Point(180, 60);
+    m_cellWidth = m_thumbnailSize.width + padding;
+    m_cellHeight = m_thumbnailSize.height + labelHeight + padding;
+
+    m_columns = std::max(1, (frame.cols - m_gridOrigin.x) / m_cellWidth);
+    m_rows = std::max(1, (frame.rows - m_gridOrigin.y - 30) / m_cellHeight);
+}
+
+void ImageGallery::render(cv::Mat& frame) {
+    std::vector<std::string> pagePaths;
+    int page = 0;
+    int pageCount = 1;
+    size_t totalImages = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        computeLayout(frame);
+
+        int pageSize = m_columns * m_rows;
+        pageCount = std::max(1, static_cast<int>((m_imagePaths.size() + pageSize - 1) / pageSize));
+        m_currentPage = std::min(m_currentPage, pageCount - 1);
+        page = m_currentPage;
+        totalImages = m_imagePaths.size();
+
+        size_t first = static_cast<size_t>(page) * pageSize;
+        size_t last = std::min(first + pageSize, m_imagePaths.size());
+        pagePaths.assign(m_imagePaths.begin() + first, m_imagePaths.begin() + last);
+    }
+
+    // Add a gallery background
+    cv::rectangle(
+        frame,
+        cv::Rect(0, 0, frame.cols, frame.rows),
+        cv::Scalar(40, 40, 40),
+        cv::FILLED
+    );
+
+    // Render title with page position
+    std::stringstream ss;
+    ss << "Waste Image Gallery - page " << (page + 1) << "/" << pageCount
+       << " (" << totalImages << " images)";
+
+    cv::putText(
+        frame,
+        ss.str(),
+        cv::Point(m_gridOrigin.x, 35),
+        cv::FONT_HERSHEY_SIMPLEX,
+        0.7,
+        cv::Scalar(255, 255, 255),
+        2
+    );
+
+    if (pagePaths.empty()) {
+        cv::putText(
+            frame,
+            "No saved detection images",
+            cv::Point(m_gridOrigin.x, m_gridOrigin.y + 30),
+            cv::FONT_HERSHEY_SIMPLEX,
+            0.6,
+            cv::Scalar(200, 200, 200),
+            1
+        );
+        return;
+    }
+
+    // Make sure the visible page is decoding, then warm up its neighbours
+    requestPage(page, true);
+    if (page + 1 < pageCount) {
+        requestPage(page + 1, false);
+    }
+    if (page > 0) {
+        requestPage(page - 1, false);
+    }
+
+    for (size_t i = 0; i < pagePaths.size(); i++) {
+        int column = static_cast<int>(i) % m_columns;
+        int row = static_cast<int>(i) / m_columns;
+        cv::Rect cell(m_gridOrigin.x + column * m_cellWidth,
+                      m_gridOrigin.y + row * m_cellHeight,
+                      m_thumbnailSize.width,
+                      m_thumbnailSize.height);
+
+        cv::Mat thumbnail;
+        if (m_cache.get(pagePaths[i], thumbnail) && !thumbnail.empty()) {
+            // Center the thumbnail in its cell
+            cv::Rect target(cell.x + (cell.width - thumbnail.cols) / 2,
+                            cell.y + (cell.height - thumbnail.rows) / 2,
+                            thumbnail.cols,
+                            thumbnail.rows);
+            target &= cv::Rect(0, 0, frame.cols, frame.rows);
+            if (target.area() > 0) {
+                thumbnail(cv::Rect(0, 0, target.width, target.height)).copyTo(frame(target));
+            }
+        } else {
+            // Placeholder while decoding
+            cv::rectangle(frame, cell, cv::Scalar(60, 60, 60), cv::FILLED);
+            cv::putText(
+                frame,
+                "Loading...",
+                cv::Point(cell.x + 10, cell.y + cell.height / 2),
+                cv::FONT_HERSHEY_SIMPLEX,
+                0.4,
+                cv::Scalar(150, 150, 150),
+                1
+            );
+        }
+
+        // Highlight the selected image
+        bool selected = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            selected = pagePaths[i] == m_selectedImage;
+        }
+        cv::rectangle(frame, cell, selected ? cv::Scalar(0, 255, 255) : cv::Scalar(100, 100, 100), selected ? 2 : 1);
+
+        // Draw file name below the thumbnail
+        std::string label = fs::path(pagePaths[i]).stem().string();
+        if (label.rfind("food_waste_", 0) == 0) {
+            label = label.substr(11);
+        }
+        if (label.size() > 22) {
+            label = label.substr(0, 22);
+        }
+
+        cv::putText(
+            frame,
+            label,
+            cv::Point(cell.x, cell.y + cell.height + 14),
+            cv::FONT_HERSHEY_SIMPLEX,
+            0.35,
+            cv::Scalar(200, 200, 200),
+            1
+        );
+    }
+}
+
+void ImageGallery::handleMouseEvent(int event, int x, int y) {
+    if (event != cv::EVENT_LBUTTONDOWN) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    int column = (x - m_gridOrigin.x) / m_cellWidth;
+    int row = (y - m_gridOrigin.y) / m_cellHeight;
+    if (x < m_gridOrigin.x || y < m_gridOrigin.y || column >= m_columns || row >= m_rows) {
+        return;
+    }
+
+    size_t index = static_cast<size_t>(m_currentPage) * m_columns * m_rows + row * m_columns + column;
+    if (index < m_imagePaths.size()) {
+        m_selectedImage = m_imagePaths[index];
+        Utils::logDebug("gallery", "Selected image %s", m_selectedImage.c_str());
+    }
+}
+
+void ImageGallery::requestPage(int page, bool visible) {
+    std::vector<std::string> paths;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        int pageSize = m_columns * m_rows;
+        size_t first = static_cast<size_t>(page) * pageSize;
+        size_t last = std::min(first + pageSize, m_imagePaths.size());
+        if (first < last) {
+            paths.assign(m_imagePaths.begin() + first, m_imagePaths.begin() + last);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        if (visible) {
+            // Visible thumbnails go ahead of any pending prefetch work
+            for (auto it = paths.rbegin(); it != paths.rend(); ++it) {
+                if (m_cache.contains(*it)) {
+                    continue;
+                }
+                if (m_pendingDecodes.count(*it)) {
+                    auto queuedIt = std::find(m_decodeQueue.begin(), m_decodeQueue.end(), *it);
+                    if (queuedIt != m_decodeQueue.end()) {
+                        m_decodeQueue.erase(queuedIt);
+                        m_decodeQueue.push_front(*it);
+                    }
+                    continue;
+                }
+                m_pendingDecodes.insert(*it);
+                m_decodeQueue.push_front(*it);
+            }
+        } else {
+            for (const auto& path : paths) {
+                if (m_cache.contains(path) || m_pendingDecodes.count(path)) {
+                    continue;
+                }
+                m_pendingDecodes.insert(path);
+                m_decodeQueue.push_back(path);
+            }
+        }
+
+        scheduleDecodes();
+    }
+}
+
+void ImageGallery::scheduleDecodes() {
+    while (m_running && m_activeDecodes < m_maxConcurrentDecodes &&
+           static_cast<size_t>(m_activeDecodes) < m_decodeQueue.size()) {
+        m_activeDecodes++;
+        Utils::TaskScheduler::instance().submit(Utils::TaskClass::INGEST, [this]() { drainDecodeQueue(); });
+    }
+}
+
+void ImageGallery::drainDecodeQueue() {
+    while (true) {
+        std::string path;
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            if (!m_running || m_decodeQueue.empty()) {
+                m_activeDecodes--;
+                m_queueCondition.notify_all();
+                return;
+            }
+
+            path = m_decodeQueue.front();
+            m_decodeQueue.pop_front();
+        }
+
+        cv::Mat thumbnail = loadThumbnail(path);
+
+        // Cache failures as empty thumbnails so they are not retried every frame
+        m_cache.put(path, thumbnail);
+
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_pendingDecodes.erase(path);
+    }
+}
+
+cv::Mat ImageGallery::loadThumbnail(const std::string& path) const {
+    cv::Mat image = cv::imread(path, chooseReadMode(path));
+    if (image.empty()) {
+        return cv::Mat();
+    }
+
+    // Fit inside the thumbnail box, preserving aspect ratio
+    double scale = std::min(static_cast<double>(m_thumbnailSize.width) / image.cols,
+                            static_cast<double>(m_thumbnailSize.height) / image.rows);
+    scale = std::min(scale, 1.0);
+
+    cv::Mat thumbnail;
+    if (scale < 1.0) {
+        cv::Size size(std::max(1, static_cast<int>(image.cols * scale)),
+                      std::max(1, static_cast<int>(image.rows * scale)));
+        cv::resize(image, thumbnail, size, 0, 0, cv::INTER_AREA);
+    } else {
+        thumbnail = image;
+    }
+
+    return thumbnail;
+}
+
+int ImageGallery::chooseReadMode(const std::string& path) const {
+    cv::Size imageSize;
+    if (!Utils::readJpegSize(path, imageSize)) {
+        return cv::IMREAD_COLOR;
+    }
+
+    // The JPEG decoder can skip DCT coefficients for 1/2, 1/4 and 1/8 scale
+    // output, which is far cheaper than a full decode followed by a resize
+    int longestSide = std::max(imageSize.width, imageSize.height);
+    int thumbnailSide = std::max(m_thumbnailSize.width, m_thumbnailSize.height);
+
+    if (longestSide / 8 >= thumbnailSide) {
+        return cv::IMREAD_REDUCED_COLOR_8;
+    }
+    if (longestSide / 4 >= thumbnailSide) {
+        return cv::IMREAD_REDUCED_COLOR_4;
+    }
+    if (longestSide / 2 >= thumbnailSide) {
+        return cv::IMREAD_REDUCED_COLOR_2;
+    }
+    return cv::IMREAD_COLOR;
+}
+
+} // namespace UI
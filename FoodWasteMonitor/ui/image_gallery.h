@@ -0,0 +1,120 @@
+/**
+ * Image Gallery Header
+ *
+ * Pages through saved detection images as a grid of thumbnails that are
+ * decoded in the background at reduced resolution
+ */
+
+#ifndef IMAGE_GALLERY_H
+#define IMAGE_GALLERY_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include <list>
+#include <deque>
+#include <set>
+#include <unordered_map>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include "user_interface.h"
+
+namespace UI {
+
+    // Fixed-capacity least-recently-used thumbnail cache
+    class ThumbnailCache {
+    public:
+        explicit ThumbnailCache(size_t capacity);
+
+        bool get(const std::string& path, cv::Mat& thumbnail);
+        void put(const std::string& path, const cv::Mat& thumbnail);
+        bool contains(const std::string& path) const;
+        void clear();
+
+    private:
+        using Entry = std::pair<std::string, cv::Mat>;
+
+        size_t m_capacity;
+        std::list<Entry> m_entries;  // Most recently used at the front
+        std::unordered_map<std::string, std::list<Entry>::iterator> m_index;
+        mutable std::mutex m_mutex;
+    };
+
+    // Gallery view of saved waste images
+    class ImageGallery : public UIElement {
+    public:
+        ImageGallery(const std::string& imagesDir,
+                     cv::Size thumbnailSize = cv::Size(160, 160),
+                     size_t cacheCapacity = 256,
+                     int maxConcurrentDecodes = 2);
+        ~ImageGallery();
+
+        // Paging
+        void nextPage();
+        void previousPage();
+        int getCurrentPage() const;
+        int getPageCount() const;
+
+        // Path of the most recently clicked image, empty if none
+        std::string getSelectedImage() const;
+
+        // UIElement interface
+        void render(cv::Mat& frame) override;
+        void update() override;
+        void handleMouseEvent(int event, int x, int y) override;
+
+    private:
+        // Rescan the image directory, newest images first
+        void scanImages();
+
+        // Queue the images of a page for decoding; visible pages jump the queue
+        void requestPage(int page, bool visible);
+
+        // Start decode tasks on the shared pool for queued work, up to the
+        // concurrency limit. Call with m_queueMutex held.
+        void scheduleDecodes();
+
+        // Decode queued thumbnails until the queue is empty
+        void drainDecodeQueue();
+        cv::Mat loadThumbnail(const std::string& path) const;
+
+        // Pick the strongest IMREAD_REDUCED_* mode that still covers the thumbnail
+        int chooseReadMode(const std::string& path) const;
+
+        // Grid layout for the current frame
+        void computeLayout(const cv::Mat& frame);
+
+        std::string m_imagesDir;
+        cv::Size m_thumbnailSize;
+        ThumbnailCache m_cache;
+
+        // Image list
+        std::vector<std::string> m_imagePaths;
+        int m_currentPage;
+        std::string m_selectedImage;
+
+        // Layout
+        cv::Point m_gridOrigin;
+        int m_columns;
+        int m_rows;
+        int m_cellWidth;
+        int m_cellHeight;
+
+        // Decode tasks
+        int m_maxConcurrentDecodes;
+        int m_activeDecodes;
+        std::atomic<bool> m_running;
+        std::deque<std::string> m_decodeQueue;
+        std::set<std::string> m_pendingDecodes;
+        std::mutex m_queueMutex;
+        std::condition_variable m_queueCondition;
+
+        mutable std::mutex m_mutex;
+    };
+
+} // namespace UI
+
+#endif // IMAGE_GALLERY_H
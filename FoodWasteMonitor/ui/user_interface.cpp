@@ -3,14 +3,39 @@
  */
 
 #include "user_interface.h"
+#include "image_gallery.h"
+#include "../utils/trace.h"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <thread>
 #include <chrono>
+#include <filesystem>
 
 namespace UI {
 
+namespace {
+
+// Format a duration in seconds as a short human readable string
+std::string formatDuration(double seconds) {
+    if (seconds < 0) {
+        return "unknown";
+    }
+
+    int total = static_cast<int>(seconds + 0.5);
+    std::stringstream ss;
+    if (total >= 3600) {
+        ss << total / 3600 << "h " << (total % 3600) / 60 << "m";
+    } else if (total >= 60) {
+        ss << total / 60 << "m " << total % 60 << "s";
+    } else {
+        ss << total << "s";
+    }
+    return ss.str();
+}
+
+} // namespace
+
 //
 // DetectionVisualizer Implementation
 //
@@ -111,7 +136,8 @@ StatsVisualizer::StatsVisualizer(std::shared_ptr<Analysis::StatsAnalyzer> analyz
       m_showTopWastedFoods(true),
       m_showWasteTrend(true),
       m_showWasteByMeal(true),
-      m_showInsights(true) {
+      m_showInsights(true),
+      m_trendDays(7) {
 
     update();
 }
@@ -132,6 +158,11 @@ void StatsVisualizer::setShowInsights(bool show) {
     m_showInsights = show;
 }
 
+void StatsVisualizer::setTrendDays(int days) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_trendDays = std::max(2, days);
+}
+
 void StatsVisualizer::render(cv::Mat& frame) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
@@ -295,12 +326,12 @@ void StatsVisualizer::renderTopWastedFoods(cv::Mat& frame, int x, int y) {
 
 void StatsVisualizer::renderWasteTrend(cv::Mat& frame, int x, int y) {
     // Get trend data
-    auto trend = m_analyzer->analyzeDailyTrend(7); // Last 7 days
+    auto trend = m_analyzer->analyzeDailyTrend(m_trendDays);
 
     // Render title
     cv::putText(
         frame,
-        "Waste Trend (Last 7 Days)",
+        "Waste Trend (Last " + std::to_string(m_trendDays) + " Days)",
         cv::Point(x, y + 20),
         cv::FONT_HERSHEY_SIMPLEX,
         0.6,
@@ -341,37 +372,45 @@ void StatsVisualizer::renderWasteTrend(cv::Mat& frame, int x, int y) {
         float maxVal = *std::max_element(trend.values.begin(), trend.values.end());
         if (maxVal < 1.0f) maxVal = 1.0f; // Avoid division by zero
 
-        // Plot points and lines
-        std::vector<cv::Point> points;
-        int numPoints = static_cast<int>(trend.values.size());
-        int pointSpacing = graphWidth / std::max(1, numPoints - 1);
+        // Reduce the series to at most one point per pixel column, so long
+        // ranges cost the same to draw as a week
+        auto chartPoints = m_chartCache.getSeries("daily_waste", trend.values, graphWidth);
+
+        int numValues = static_cast<int>(trend.values.size());
+        float xScale = static_cast<float>(graphWidth) / std::max(1, numValues - 1);
 
-        for (int i = 0; i < numPoints; i++) {
-            int pointX = x + i * pointSpacing;
-            int pointY = y + graphHeight - static_cast<int>((trend.values[i] / maxVal) * graphHeight);
+        std::vector<cv::Point> points;
+        points.reserve(chartPoints.size());
+        for (const auto& point : chartPoints) {
+            int pointX = x + static_cast<int>(point.index * xScale);
+            int pointY = y + graphHeight - static_cast<int>((point.value / maxVal) * graphHeight);
             points.push_back(cv::Point(pointX, pointY));
+        }
 
-            // Draw point
-            cv::circle(frame, cv::Point(pointX, pointY), 3, cv::Scalar(0, 255, 255), cv::FILLED);
+        // Draw the series as a single polyline
+        cv::polylines(frame, points, false, cv::Scalar(0, 255, 255), 2);
 
-            // Draw date label
-            if (i < static_cast<int>(trend.timeLabels.size())) {
-                std::string dateLabel = trend.timeLabels[i].substr(5); // Skip year
-                cv::putText(
-                    frame,
-                    dateLabel,
-                    cv::Point(pointX - 15, y + graphHeight + 15),
-                    cv::FONT_HERSHEY_SIMPLEX,
-                    0.4,
-                    cv::Scalar(200, 200, 200),
-                    1
-                );
+        // Only mark individual points while they are far enough apart to see
+        if (static_cast<int>(points.size()) * 10 <= graphWidth) {
+            for (const auto& point : points) {
+                cv::circle(frame, point, 3, cv::Scalar(0, 255, 255), cv::FILLED);
             }
         }
 
-        // Draw lines connecting points
-        for (size_t i = 1; i < points.size(); i++) {
-            cv::line(frame, points[i-1], points[i], cv::Scalar(0, 255, 255), 2);
+        // Draw a bounded number of date labels regardless of range
+        const int maxLabels = 7;
+        int labelStep = std::max(1, (numValues + maxLabels - 1) / maxLabels);
+        for (int i = 0; i < numValues && i < static_cast<int>(trend.timeLabels.size()); i += labelStep) {
+            std::string dateLabel = trend.timeLabels[i].substr(5); // Skip year
+            cv::putText(
+                frame,
+                dateLabel,
+                cv::Point(x + static_cast<int>(i * xScale) - 15, y + graphHeight + 15),
+                cv::FONT_HERSHEY_SIMPLEX,
+                0.4,
+                cv::Scalar(200, 200, 200),
+                1
+            );
         }
 
         // Draw trend direction
@@ -539,9 +578,9 @@ void StatsVisualizer::renderInsights(cv::Mat& frame, int x, int y) {
 //
 
 ControlPanel::ControlPanel(std::shared_ptr<Utils::ConfigLoader> config,
-                         std::shared_ptr<Training::ModelTrainer> trainer)
+                         std::shared_ptr<Training::TrainingJobManager> jobManager)
     : m_config(config),
-      m_trainer(trainer),
+      m_jobManager(jobManager),
       m_trainingInProgress(false) {
 
     initializeButtons();
@@ -553,13 +592,9 @@ void ControlPanel::initializeButtons() {
         cv::Rect(10, 10, 150, 30),
         "Start Training",
         [this]() {
-            if (!m_trainingInProgress && m_trainer) {
-                // Start training in a separate thread
-                std::thread([this]() {
-                    setTrainingInProgress(true);
-                    m_trainer->trainModel();
-                    setTrainingInProgress(false);
-                }).detach();
+            if (!m_trainingInProgress && m_jobManager) {
+                // Training runs as a background job; update() picks up its state
+                m_jobManager->startJob();
             }
         },
         true
@@ -584,6 +619,17 @@ void ControlPanel::initializeButtons() {
         },
         true
     });
+
+    m_buttons.push_back({
+        cv::Rect(10, 130, 150, 30),
+        "Cancel Training",
+        [this]() {
+            if (m_jobManager) {
+                m_jobManager->cancelJob();
+            }
+        },
+        false
+    });
 }
 
 void ControlPanel::render(cv::Mat& frame) {
@@ -601,16 +647,35 @@ void ControlPanel::render(cv::Mat& frame) {
     renderButtons(frame);
 
     // Render training status if in progress
-    if (m_trainingInProgress) {
+    if (m_trainingInProgress && m_jobManager) {
+        auto progress = m_jobManager->getProgress();
+
+        std::stringstream ss;
+        ss << "Training " << std::fixed << std::setprecision(0) << (progress.fraction * 100) << "%";
+
         cv::putText(
             frame,
-            "Training in progress...",
-            cv::Point(10, 140),
+            ss.str(),
+            cv::Point(10, 180),
             cv::FONT_HERSHEY_SIMPLEX,
             0.5,
             cv::Scalar(0, 255, 255),
             1
         );
+
+        std::string detail = progress.paused ? "Paused for peak hours" :
+            progress.throttled ? "Paused for detection" :
+            "ETA " + formatDuration(progress.etaSeconds);
+
+        cv::putText(
+            frame,
+            detail,
+            cv::Point(10, 200),
+            cv::FONT_HERSHEY_SIMPLEX,
+            0.45,
+            cv::Scalar(0, 255, 255),
+            1
+        );
     }
 }
 
@@ -649,7 +714,11 @@ void ControlPanel::renderButtons(cv::Mat& frame) {
 }
 
 void ControlPanel::update() {
-    // Nothing to update here
+    // Mirror the background job state into the buttons
+    bool running = m_jobManager && m_jobManager->isJobRunning();
+    if (running != m_trainingInProgress) {
+        setTrainingInProgress(running);
+    }
 }
 
 void ControlPanel::handleMouseEvent(int event, int x, int y) {
@@ -671,11 +740,12 @@ void ControlPanel::setTrainingInProgress(bool inProgress) {
     std::lock_guard<std::mutex> lock(m_mutex);
     m_trainingInProgress = inProgress;
 
-    // Disable training button when training is in progress
+    // Only one of start and cancel is available at a time
     for (auto& button : m_buttons) {
         if (button.label == "Start Training") {
             button.enabled = !inProgress;
-            break;
+        } else if (button.label == "Cancel Training") {
+            button.enabled = inProgress;
         }
     }
 }
@@ -692,11 +762,15 @@ UserInterface::UserInterface(std::shared_ptr<Camera::CameraManager> cameraManage
                            std::shared_ptr<Detection::FoodDetector> detector,
                            std::shared_ptr<Analysis::StatsAnalyzer> analyzer,
                            std::shared_ptr<Training::ModelTrainer> trainer,
+                           std::shared_ptr<Training::TrainingJobManager> jobManager,
+                           std::shared_ptr<Training::TrainingScheduler> trainingScheduler,
                            const Utils::ConfigLoader& config)
     : m_cameraManager(cameraManager),
       m_detector(detector),
       m_analyzer(analyzer),
       m_trainer(trainer),
+      m_jobManager(jobManager),
+      m_trainingScheduler(trainingScheduler),
       m_config(std::make_shared<Utils::ConfigLoader>(config)),
       m_running(false),
       m_currentMode(Mode::LIVE_VIEW) {
@@ -704,7 +778,11 @@ UserInterface::UserInterface(std::shared_ptr<Camera::CameraManager> cameraManage
     // Create UI elements
     m_detectionVisualizer = std::make_unique<DetectionVisualizer>(detector);
     m_statsVisualizer = std::make_unique<StatsVisualizer>(analyzer);
-    m_controlPanel = std::make_unique<ControlPanel>(m_config, trainer);
+    m_controlPanel = std::make_unique<ControlPanel>(m_config, jobManager);
+
+    // Detection crops are saved next to the database by WasteDatabase::saveDetectionImage
+    std::filesystem::path imagesDir = std::filesystem::path(m_config->getDatabasePath()).parent_path() / "images";
+    m_imageGallery = std::make_unique<ImageGallery>(imagesDir.string());
 }
 
 UserInterface::~UserInterface() {
@@ -746,6 +824,7 @@ void UserInterface::updateFrame(const cv::Mat& frame, const Detection::Detection
         return;
     }
 
+    Utils::TraceSpan trace("UserInterface::updateFrame");
     std::lock_guard<std::mutex> lock(m_frameMutex);
 
     // Make a copy of the frame
@@ -767,7 +846,11 @@ void UserInterface::updateFrame(const cv::Mat& frame, const Detection::Detection
 
 void UserInterface::processEvents() {
     // Process OpenCV window events
-    int key = cv::waitKey(1);
+    int key;
+    {
+        Utils::TraceSpan trace("UserInterface::waitKey");
+        key = cv::waitKey(1);
+    }
 
     // Handle keyboard shortcuts
     switch (key) {
@@ -791,6 +874,22 @@ void UserInterface::processEvents() {
             setMode(Mode::SETTINGS);
             break;
 
+        case '5':
+            setMode(Mode::GALLERY);
+            break;
+
+        case 'n':
+            if (m_currentMode == Mode::GALLERY) {
+                m_imageGallery->nextPage();
+            }
+            break;
+
+        case 'p':
+            if (m_currentMode == Mode::GALLERY) {
+                m_imageGallery->previousPage();
+            }
+            break;
+
         case 's':
             // Save screenshot
             if (!m_displayFrame.empty()) {
@@ -799,6 +898,11 @@ void UserInterface::processEvents() {
                 std::cout << "Screenshot saved to " << filename << std::endl;
             }
             break;
+
+        case 't':
+            // Start tracing, or save the recorded trace when already tracing
+            Utils::Tracer::requestDump();
+            break;
     }
 }
 
@@ -826,6 +930,12 @@ void UserInterface::setMode(Mode mode) {
         case Mode::SETTINGS:
             std::cout << "Settings" << std::endl;
             break;
+
+        case Mode::GALLERY:
+            std::cout << "Gallery" << std::endl;
+            // Pick up images saved since the gallery was last opened
+            m_imageGallery->update();
+            break;
     }
 }
 
@@ -834,6 +944,8 @@ UserInterface::Mode UserInterface::getMode() const {
 }
 
 void UserInterface::renderUI() {
+    Utils::TraceSpan trace("UserInterface::renderUI");
+
     // Skip if display frame is empty
     if (m_displayFrame.empty()) {
         return;
@@ -873,7 +985,7 @@ void UserInterface::renderUI() {
             );
             break;
 
-        case Mode::TRAINING:
+        case Mode::TRAINING: {
             // Add a training background
             cv::rectangle(
                 m_displayFrame,
@@ -894,12 +1006,22 @@ void UserInterface::renderUI() {
             );
 
             // Display training status
-            std::string statusText = m_controlPanel->isTrainingInProgress() ?
-                "Training in progress..." : "Ready to train";
+            auto progress = m_jobManager->getProgress();
+
+            std::stringstream ss;
+            if (m_controlPanel->isTrainingInProgress()) {
+                ss << "Training in progress - epoch " << progress.completedEpochs << "/" << progress.totalEpochs
+                   << " (" << std::fixed << std::setprecision(0) << (progress.fraction * 100) << "%)";
+            } else if (progress.state == Training::JobState::IDLE) {
+                ss << "Ready to train";
+            } else {
+                ss << "Last training job: " << Training::TrainingJobManager::jobStateToString(progress.state)
+                   << " after " << formatDuration(progress.elapsedSeconds);
+            }
 
             cv::putText(
                 m_displayFrame,
-                statusText,
+                ss.str(),
                 cv::Point(m_displayFrame.cols / 2 - 100, 100),
                 cv::FONT_HERSHEY_SIMPLEX,
                 0.7,
@@ -907,6 +1029,37 @@ void UserInterface::renderUI() {
                 1
             );
 
+            if (m_controlPanel->isTrainingInProgress()) {
+                std::string etaText = progress.paused ?
+                    "Paused until the dining hall is quiet again" :
+                    progress.throttled ?
+                    "Paused while detection catches up" :
+                    "Estimated time remaining: " + formatDuration(progress.etaSeconds);
+
+                cv::putText(
+                    m_displayFrame,
+                    etaText,
+                    cv::Point(m_displayFrame.cols / 2 - 100, 130),
+                    cv::FONT_HERSHEY_SIMPLEX,
+                    0.6,
+                    cv::Scalar(200, 200, 200),
+                    1
+                );
+            }
+
+            // Why scheduled training is or is not running right now
+            if (m_trainingScheduler) {
+                cv::putText(
+                    m_displayFrame,
+                    "Schedule: " + m_trainingScheduler->getStatus(),
+                    cv::Point(m_displayFrame.cols / 2 - 100, 160),
+                    cv::FONT_HERSHEY_SIMPLEX,
+                    0.6,
+                    cv::Scalar(200, 200, 200),
+                    1
+                );
+            }
+
             // Add mode indicator
             cv::putText(
                 m_displayFrame,
@@ -918,6 +1071,7 @@ void UserInterface::renderUI() {
                 1
             );
             break;
+        }
 
         case Mode::SETTINGS:
             // Add a settings background
@@ -950,9 +1104,26 @@ void UserInterface::renderUI() {
                 1
             );
             break;
+
+        case Mode::GALLERY:
+            // Render saved detection images
+            m_imageGallery->render(m_displayFrame);
+
+            // Add mode indicator
+            cv::putText(
+                m_displayFrame,
+                "Mode: Gallery (n/p to change page, Press 1 for Live View)",
+                cv::Point(10, m_displayFrame.rows - 10),
+                cv::FONT_HERSHEY_SIMPLEX,
+                0.5,
+                cv::Scalar(255, 255, 255),
+                1
+            );
+            break;
     }
 
     // Always render control panel
+    m_controlPanel->update();
     m_controlPanel->render(m_displayFrame);
 }
 
@@ -1015,6 +1186,10 @@ void UserInterface::handleMouseEvent(int event, int x, int y) {
             m_statsVisualizer->handleMouseEvent(event, x, y);
             break;
 
+        case Mode::GALLERY:
+            m_imageGallery->handleMouseEvent(event, x, y);
+            break;
+
         case Mode::TRAINING:
         case Mode::SETTINGS:
             // No specific handlers for these modes
@@ -20,7 +20,10 @@
 #include "../camera/camera_manager.h"
 #include "../detection/food_detector.h"
 #include "../analysis/stats_analyzer.h"
+#include "../analysis/chart_data.h"
 #include "../training/model_trainer.h"
+#include "../training/training_job_manager.h"
+#include "../training/training_scheduler.h"
 #include "../utils/config_loader.h"
 
 namespace UI {
@@ -32,4 +35,182 @@ namespace UI {
         virtual void render(cv::Mat& frame) = 0;
         virtual void update() = 0;
         virtual void handleMouseEvent(int event, int x, int y) = 0;
-    };
\ No newline at end of file
+    };
+
+    class ImageGallery;
+    // Detection visualization element
+    class DetectionVisualizer : public UIElement {
+    public:
+        explicit DetectionVisualizer(std::shared_ptr<Detection::FoodDetector> detector);
+
+        void setDetections(const Detection::DetectionResult& detections);
+
+        // Display options
+        void setShowLabels(bool show);
+        void setShowConfidence(bool show);
+        void setShowWeight(bool show);
+
+        // UIElement interface
+        void render(cv::Mat& frame) override;
+        void update() override;
+        void handleMouseEvent(int event, int x, int y) override;
+
+    private:
+        std::shared_ptr<Detection::FoodDetector> m_detector;
+        Detection::DetectionResult m_detections;
+
+        bool m_showLabels;
+        bool m_showConfidence;
+        bool m_showWeight;
+
+        std::mutex m_mutex;
+    };
+
+    // Statistics visualization element
+    class StatsVisualizer : public UIElement {
+    public:
+        explicit StatsVisualizer(std::shared_ptr<Analysis::StatsAnalyzer> analyzer);
+
+        // Display options
+        void setShowTopWastedFoods(bool show);
+        void setShowWasteTrend(bool show);
+        void setShowWasteByMeal(bool show);
+        void setShowInsights(bool show);
+        void setTrendDays(int days);
+
+        // UIElement interface
+        void render(cv::Mat& frame) override;
+        void update() override;
+        void handleMouseEvent(int event, int x, int y) override;
+
+    private:
+        // Rendering helpers
+        void renderTopWastedFoods(cv::Mat& frame, int x, int y);
+        void renderWasteTrend(cv::Mat& frame, int x, int y);
+        void renderWasteByMeal(cv::Mat& frame, int x, int y);
+        void renderInsights(cv::Mat& frame, int x, int y);
+
+        std::shared_ptr<Analysis::StatsAnalyzer> m_analyzer;
+
+        bool m_showTopWastedFoods;
+        bool m_showWasteTrend;
+        bool m_showWasteByMeal;
+        bool m_showInsights;
+
+        // Number of days shown in the trend chart
+        int m_trendDays;
+
+        // Downsampled chart series, cached per series and chart width
+        Analysis::ChartDataCache m_chartCache;
+
+        std::vector<std::string> m_insights;
+        std::mutex m_mutex;
+    };
+
+    // Control panel with buttons for common actions
+    class ControlPanel : public UIElement {
+    public:
+        ControlPanel(std::shared_ptr<Utils::ConfigLoader> config,
+                     std::shared_ptr<Training::TrainingJobManager> jobManager);
+
+        // UIElement interface
+        void render(cv::Mat& frame) override;
+        void update() override;
+        void handleMouseEvent(int event, int x, int y) override;
+
+        // Training state
+        void setTrainingInProgress(bool inProgress);
+        bool isTrainingInProgress() const;
+
+    private:
+        struct Button {
+            cv::Rect region;
+            std::string label;
+            std::function<void()> callback;
+            bool enabled;
+        };
+
+        void initializeButtons();
+        void renderButtons(cv::Mat& frame);
+
+        std::shared_ptr<Utils::ConfigLoader> m_config;
+        std::shared_ptr<Training::TrainingJobManager> m_jobManager;
+
+        std::vector<Button> m_buttons;
+        std::atomic<bool> m_trainingInProgress;
+
+        std::mutex m_mutex;
+    };
+
+    // Main user interface
+    class UserInterface {
+    public:
+        // Display modes
+        enum class Mode {
+            LIVE_VIEW,
+            STATISTICS,
+            TRAINING,
+            SETTINGS,
+            GALLERY
+        };
+
+        UserInterface(std::shared_ptr<Camera::CameraManager> cameraManager,
+                      std::shared_ptr<Detection::FoodDetector> detector,
+                      std::shared_ptr<Analysis::StatsAnalyzer> analyzer,
+                      std::shared_ptr<Training::ModelTrainer> trainer,
+                      std::shared_ptr<Training::TrainingJobManager> jobManager,
+                      std::shared_ptr<Training::TrainingScheduler> trainingScheduler,
+                      const Utils::ConfigLoader& config);
+        ~UserInterface();
+
+        // Lifecycle
+        void start();
+        void stop();
+        bool isRunning() const;
+
+        // Frame display and event handling
+        void updateFrame(const cv::Mat& frame, const Detection::DetectionResult& detections);
+        void processEvents();
+
+        // Mode management
+        void setMode(Mode mode);
+        Mode getMode() const;
+
+    private:
+        void renderUI();
+        void createMainWindow();
+        void destroyMainWindow();
+
+        // Mouse handling
+        static void onMouse(int event, int x, int y, int flags, void* userdata);
+        void handleMouseEvent(int event, int x, int y);
+
+        // Components
+        std::shared_ptr<Camera::CameraManager> m_cameraManager;
+        std::shared_ptr<Detection::FoodDetector> m_detector;
+        std::shared_ptr<Analysis::StatsAnalyzer> m_analyzer;
+        std::shared_ptr<Training::ModelTrainer> m_trainer;
+        std::shared_ptr<Training::TrainingJobManager> m_jobManager;
+        std::shared_ptr<Training::TrainingScheduler> m_trainingScheduler;
+        std::shared_ptr<Utils::ConfigLoader> m_config;
+
+        // UI elements
+        std::unique_ptr<DetectionVisualizer> m_detectionVisualizer;
+        std::unique_ptr<StatsVisualizer> m_statsVisualizer;
+        std::unique_ptr<ControlPanel> m_controlPanel;
+        std::unique_ptr<ImageGallery> m_imageGallery;
+
+        // State
+        std::atomic<bool> m_running;
+        Mode m_currentMode;
+
+        // Display frame
+        cv::Mat m_displayFrame;
+        std::mutex m_frameMutex;
+
+        static constexpr const char* WINDOW_NAME = "Food Waste Monitor";
+    };
+
+} // namespace UI
+
+#endif // USER_INTERFACE_H
@@ -0,0 +1,359 @@
+/**
+ * Append Log Implementation
+ */
+
+#include "append_log.h"
+#include "logger.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+#include <zlib.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace Utils {
+
+namespace {
+
+const size_t RECORD_HEADER_BYTES = 8;
+const char* const SEGMENT_EXTENSION = ".log";
+
+uint32_t checksum(const void* data, size_t size) {
+    return static_cast<uint32_t>(crc32(0L, static_cast<const Bytef*>(data), static_cast<uInt>(size)));
+}
+
+bool readFully(int fd, void* buffer, size_t size, uint64_t position) {
+    uint8_t* out = static_cast<uint8_t*>(buffer);
+    while (size > 0) {
+        ssize_t n = pread(fd, out, size, static_cast<off_t>(position));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        out += n;
+        size -= static_cast<size_t>(n);
+        position += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool writeFully(int fd, const void* buffer, size_t size) {
+    const uint8_t* in = static_cast<const uint8_t*>(buffer);
+    while (size > 0) {
+        ssize_t n = write(fd, in, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        in += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Parse and verify the record at position; false on a short or corrupt record
+bool readRecord(int fd, uint64_t position, uint64_t fileSize, std::string& payload) {
+    uint32_t header[2];
+    if (position + RECORD_HEADER_BYTES > fileSize || !readFully(fd, header, sizeof(header), position)) {
+        return false;
+    }
+    if (header[0] > AppendLog::MAX_RECORD_BYTES || position + RECORD_HEADER_BYTES + header[0] > fileSize) {
+        return false;
+    }
+
+    payload.resize(header[0]);
+    if (header[0] > 0 && !readFully(fd, &payload[0], header[0], position + RECORD_HEADER_BYTES)) {
+        return false;
+    }
+    return checksum(payload.data(), payload.size()) == header[1];
+}
+
+} // namespace
+
+AppendLog::AppendLog()
+    : m_segmentBytes(DEFAULT_SEGMENT_BYTES),
+      m_activeFd(-1),
+      m_lastRecordOffset(0),
+      m_hasRecords(false),
+      m_readFd(-1),
+      m_readBase(0) {
+}
+
+AppendLog::~AppendLog() {
+    close();
+}
+
+bool AppendLog::open(const std::string& directory, uint64_t segmentBytes) {
+    close();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_directory = directory;
+    m_segmentBytes = std::max<uint64_t>(segmentBytes, 4096);
+
+    try {
+        fs::create_directories(directory);
+        for (const auto& file : fs::directory_iterator(directory)) {
+            if (file.path().extension() != SEGMENT_EXTENSION) {
+                continue;
+            }
+            Segment segment;
+            segment.baseOffset = std::stoull(file.path().stem().string());
+            segment.size = fs::file_size(file.path());
+            m_segments.push_back(segment);
+        }
+    }
+    catch (const std::exception& e) {
+        logError("log", "Cannot open log %s: %s", directory.c_str(), e.what());
+        m_segments.clear();
+        return false;
+    }
+
+    std::sort(m_segments.begin(), m_segments.end(),
+              [](const Segment& a, const Segment& b) { return a.baseOffset < b.baseOffset; });
+
+    // A crash between creating a segment and writing to it leaves it empty
+    while (m_segments.size() > 1 && m_segments.back().size == 0) {
+        std::remove(segmentPath(m_segments.back().baseOffset).c_str());
+        m_segments.pop_back();
+    }
+
+    if (m_segments.empty()) {
+        return openActiveSegment(0);
+    }
+    if (!recoverTail(m_segments.back())) {
+        return false;
+    }
+    return openActiveSegment(m_segments.back().baseOffset);
+}
+
+bool AppendLog::recoverTail(Segment& segment) {
+    std::string path = segmentPath(segment.baseOffset);
+    int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        logError("log", "Cannot open %s: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+
+    uint64_t position = 0;
+    std::string payload;
+    while (readRecord(fd, position, segment.size, payload)) {
+        m_lastRecordOffset = segment.baseOffset + position;
+        m_hasRecords = true;
+        position += RECORD_HEADER_BYTES + payload.size();
+    }
+
+    if (position < segment.size) {
+        logWarning("log", "Cutting %llu torn bytes from %s",
+                   static_cast<unsigned long long>(segment.size - position), path.c_str());
+        if (ftruncate(fd, static_cast<off_t>(position)) != 0) {
+            logError("log", "Cannot truncate %s: %s", path.c_str(), strerror(errno));
+            ::close(fd);
+            return false;
+        }
+        segment.size = position;
+    }
+
+    // Every record of the tail segment was torn; the last one is then in the segment before
+    if (!m_hasRecords && m_segments.size() > 1) {
+        const Segment& previous = m_segments[m_segments.size() - 2];
+        int previousFd = ::open(segmentPath(previous.baseOffset).c_str(), O_RDONLY | O_CLOEXEC);
+        uint64_t previousPosition = 0;
+        while (previousFd >= 0 && readRecord(previousFd, previousPosition, previous.size, payload)) {
+            m_lastRecordOffset = previous.baseOffset + previousPosition;
+            m_hasRecords = true;
+            previousPosition += RECORD_HEADER_BYTES + payload.size();
+        }
+        if (previousFd >= 0) {
+            ::close(previousFd);
+        }
+    }
+
+    ::close(fd);
+    return true;
+}
+
+bool AppendLog::openActiveSegment(uint64_t baseOffset) {
+    std::string path = segmentPath(baseOffset);
+    m_activeFd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (m_activeFd < 0) {
+        logError("log", "Cannot open %s: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+
+    if (m_segments.empty() || m_segments.back().baseOffset != baseOffset) {
+        Segment segment;
+        segment.baseOffset = baseOffset;
+        segment.size = 0;
+        m_segments.push_back(segment);
+    }
+    return true;
+}
+
+void AppendLog::close() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_activeFd >= 0) {
+        fdatasync(m_activeFd);
+        ::close(m_activeFd);
+        m_activeFd = -1;
+    }
+    if (m_readFd >= 0) {
+        ::close(m_readFd);
+        m_readFd = -1;
+    }
+    m_segments.clear();
+    m_hasRecords = false;
+    m_lastRecordOffset = 0;
+}
+
+bool AppendLog::isOpen() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_activeFd >= 0;
+}
+
+bool AppendLog::append(const std::string& payload, uint64_t* offset) {
+    if (payload.size() > MAX_RECORD_BYTES) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_activeFd < 0) {
+        return false;
+    }
+
+    // Roll before a record would overflow the segment, never leaving one empty
+    Segment* active = &m_segments.back();
+    uint64_t recordBytes = RECORD_HEADER_BYTES + payload.size();
+    if (active->size > 0 && active->size + recordBytes > m_segmentBytes) {
+        fdatasync(m_activeFd);
+        ::close(m_activeFd);
+        if (!openActiveSegment(active->baseOffset + active->size)) {
+            return false;
+        }
+        active = &m_segments.back();
+    }
+
+    // One write per record keeps a concurrent reader from seeing half of it
+    std::string record(RECORD_HEADER_BYTES + payload.size(), '\0');
+    uint32_t header[2] = {static_cast<uint32_t>(payload.size()), checksum(payload.data(), payload.size())};
+    std::memcpy(&record[0], header, sizeof(header));
+    std::memcpy(&record[RECORD_HEADER_BYTES], payload.data(), payload.size());
+
+    if (!writeFully(m_activeFd, record.data(), record.size())) {
+        logError("log", "Append to %s failed: %s", m_directory.c_str(), strerror(errno));
+
+        // Drop whatever part made it, so the next record starts cleanly
+        if (ftruncate(m_activeFd, static_cast<off_t>(active->size)) != 0) {
+            logError("log", "Cannot repair %s: %s", m_directory.c_str(), strerror(errno));
+        }
+        return false;
+    }
+
+    uint64_t recordOffset = active->baseOffset + active->size;
+    active->size += recordBytes;
+    m_lastRecordOffset = recordOffset;
+    m_hasRecords = true;
+    if (offset) {
+        *offset = recordOffset;
+    }
+    return true;
+}
+
+bool AppendLog::sync() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_activeFd >= 0 && fdatasync(m_activeFd) == 0;
+}
+
+uint64_t AppendLog::startOffset() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_segments.empty() ? 0 : m_segments.front().baseOffset;
+}
+
+uint64_t AppendLog::endOffset() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_segments.empty() ? 0 : m_segments.back().baseOffset + m_segments.back().size;
+}
+
+int AppendLog::readFd(size_t segmentIndex) const {
+    uint64_t baseOffset = m_segments[segmentIndex].baseOffset;
+    if (m_readFd >= 0 && m_readBase == baseOffset) {
+        return m_readFd;
+    }
+    if (m_readFd >= 0) {
+        ::close(m_readFd);
+    }
+    m_readFd = ::open(segmentPath(baseOffset).c_str(), O_RDONLY | O_CLOEXEC);
+    m_readBase = baseOffset;
+    return m_readFd;
+}
+
+bool AppendLog::read(uint64_t offset, std::string& payload, uint64_t& nextOffset) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // The segment with the largest base at or before the offset. A segment
+    // starts where the previous one ends, so an offset at the end of one
+    // segment lands at the start of the next.
+    auto segment = std::upper_bound(m_segments.begin(), m_segments.end(), offset,
+        [](uint64_t value, const Segment& s) { return value < s.baseOffset; });
+    if (segment == m_segments.begin()) {
+        return false;
+    }
+    --segment;
+
+    uint64_t position = offset - segment->baseOffset;
+    if (position >= segment->size) {
+        return false;
+    }
+
+    int fd = readFd(static_cast<size_t>(segment - m_segments.begin()));
+    if (fd < 0 || !readRecord(fd, position, segment->size, payload)) {
+        return false;
+    }
+    nextOffset = offset + RECORD_HEADER_BYTES + payload.size();
+    return true;
+}
+
+bool AppendLog::readLast(std::string& payload) const {
+    uint64_t lastOffset;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_hasRecords) {
+            return false;
+        }
+        lastOffset = m_lastRecordOffset;
+    }
+
+    uint64_t nextOffset = 0;
+    return read(lastOffset, payload, nextOffset);
+}
+
+void AppendLog::truncateBefore(uint64_t offset) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Never the active segment; a segment goes once the next one starts at or before offset
+    while (m_segments.size() > 1 && m_segments[1].baseOffset <= offset) {
+        uint64_t baseOffset = m_segments.front().baseOffset;
+        if (m_readFd >= 0 && m_readBase == baseOffset) {
+            ::close(m_readFd);
+            m_readFd = -1;
+        }
+        std::remove(segmentPath(baseOffset).c_str());
+        m_segments.erase(m_segments.begin());
+    }
+}
+
+std::string AppendLog::segmentPath(uint64_t baseOffset) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%020llu", static_cast<unsigned long long>(baseOffset));
+    return (fs::path(m_directory) / (std::string(name) + SEGMENT_EXTENSION)).string();
+}
+
+} // namespace Utils
@@ -0,0 +1,88 @@
+/**
+ * Append Log Header
+ *
+ * Durable append-only record log split into segment files, addressed by
+ * logical byte offsets that never change. Used as the write-ahead log of
+ * new waste entries and as the collector's per-site store.
+ *
+ * Layout (native little-endian):
+ *   segment : "<20-digit base offset>.log", records back to back
+ *   record  : payloadBytes u32, crc32(payload) u32, payload
+ */
+
+#ifndef APPEND_LOG_H
+#define APPEND_LOG_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstddef>
+#include <cstdint>
+
+namespace Utils {
+
+class AppendLog {
+public:
+    static constexpr uint64_t DEFAULT_SEGMENT_BYTES = 64ULL * 1024 * 1024;
+    static constexpr size_t MAX_RECORD_BYTES = 64 * 1024 * 1024;
+
+    AppendLog();
+    ~AppendLog();
+
+    AppendLog(const AppendLog&) = delete;
+    AppendLog& operator=(const AppendLog&) = delete;
+
+    // Open the log in a directory, creating it if needed. A record torn by
+    // a crash at the tail is cut off.
+    bool open(const std::string& directory, uint64_t segmentBytes = DEFAULT_SEGMENT_BYTES);
+    void close();
+    bool isOpen() const;
+
+    // Append one record and return its offset. Safe from several threads.
+    bool append(const std::string& payload, uint64_t* offset = nullptr);
+
+    // Flush appended records to disk
+    bool sync();
+
+    // Oldest retained offset and the offset the next record will get
+    uint64_t startOffset() const;
+    uint64_t endOffset() const;
+
+    // Read the record at offset and the offset of the one after it. False
+    // past the end, before the start or on a corrupt record.
+    bool read(uint64_t offset, std::string& payload, uint64_t& nextOffset) const;
+
+    // The last record, e.g. to recover state stored with it
+    bool readLast(std::string& payload) const;
+
+    // Delete segments holding only records before offset
+    void truncateBefore(uint64_t offset);
+
+private:
+    struct Segment {
+        uint64_t baseOffset;
+        uint64_t size;
+    };
+
+    std::string segmentPath(uint64_t baseOffset) const;
+    bool openActiveSegment(uint64_t baseOffset);
+    bool recoverTail(Segment& segment);
+    int readFd(size_t segmentIndex) const;
+
+    std::string m_directory;
+    uint64_t m_segmentBytes;
+    std::vector<Segment> m_segments;      // Ordered by base offset; the last is active
+    int m_activeFd;
+    uint64_t m_lastRecordOffset;
+    bool m_hasRecords;
+
+    // Read descriptor of the most recently read older segment
+    mutable int m_readFd;
+    mutable uint64_t m_readBase;
+
+    mutable std::mutex m_mutex;
+};
+
+} // namespace Utils
+
+#endif // APPEND_LOG_H
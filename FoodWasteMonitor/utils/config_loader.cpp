@@ -3,8 +3,8 @@
  */
 
 #include "config_loader.h"
+#include "logger.h"
 #include <fstream>
-#include <iostream>
 #include <filesystem>
 #include <nlohmann/json.hpp>
 
@@ -18,22 +18,61 @@ const std::map<std::string, std::string> ConfigLoader::DEFAULT_STRING_CONFIG = {
     {"database_path", "data/waste_database.csv"},
     {"model_path", "models/food_detection_model.weights"},
     {"classes_path", "models/food_classes.txt"},
+    {"model_registry_path", "models/registry"},
+    {"metrics_dump_path", "data/metrics.prom"},
+    {"trace_output_dir", "data/traces"},
+    {"log_level", "info"},
+    {"log_file", ""},
+    {"placement_capture_cpus", ""},
+    {"placement_inference_cpus", ""},
+    {"placement_shadow_cpus", ""},
+    {"placement_worker_cpus", ""},
+    {"placement_background_cpus", ""},
+    {"ipc_ring_name", "/food_waste_frames"},
+    {"query_socket_path", "data/query.sock"},
+    {"sync_collector_address", ""},
+    {"sync_site_id", ""},
+    {"sync_wal_path", "data/wal"},
     {"training_data_path", "data/training"}
 };
 
 const std::map<std::string, int> ConfigLoader::DEFAULT_INT_CONFIG = {
     {"camera_index", 0},
-    {"training_interval_hours", 48}
+    {"camera_frame_rate", 30},
+    {"training_interval_hours", 48},
+    {"training_nice_level", 10},
+    {"training_max_cores", 1},
+    {"training_quiet_margin_minutes", 30},
+    {"shadow_min_frames", 200},
+    {"shadow_min_detections", 20},
+    {"training_sample_budget", 2000},
+    {"metrics_port", 9464},
+    {"scheduler_realtime_cores", 0},
+    {"scheduler_ingest_cores", 0},
+    {"scheduler_analytics_cores", 0},
+    {"ipc_ring_slots", 8},
+    {"ipc_inference_workers", 2},
+    {"sync_batch_entries", 500},
+    {"sync_batch_delay_ms", 1000}
 };
 
 const std::map<std::string, float> ConfigLoader::DEFAULT_FLOAT_CONFIG = {
     {"confidence_threshold", 0.5f},
-    {"learning_rate", 0.001f}
+    {"learning_rate", 0.001f},
+    {"max_detection_latency_ms", 100.0f},
+    {"training_max_load_per_minute", 2.0f},
+    {"training_pause_load_per_minute", 10.0f},
+    {"shadow_sample_rate", 0.1f},
+    {"shadow_max_disagreement", 0.2f},
+    {"shadow_max_latency_ratio", 1.2f},
+    {"shadow_min_confidence_ratio", 0.95f}
 };
 
 const std::map<std::string, bool> ConfigLoader::DEFAULT_BOOL_CONFIG = {
     {"show_detection_boxes", true},
-    {"show_statistics", true}
+    {"show_statistics", true},
+    {"trace_enabled", false},
+    {"log_json", false}
 };
 
 ConfigLoader::ConfigLoader(const std::string& configPath)
@@ -49,13 +88,13 @@ ConfigLoader::ConfigLoader(const std::string& configPath)
 bool ConfigLoader::loadConfig() {
     try {
         if (!fs::exists(m_configPath)) {
-            std::cout << "Config file not found: " << m_configPath << std::endl;
+            logInfo("config", "Config file not found: %s", m_configPath.c_str());
             return false;
         }
 
         std::ifstream file(m_configPath);
         if (!file.is_open()) {
-            std::cerr << "Failed to open config file: " << m_configPath << std::endl;
+            logError("config", "Failed to open config file: %s", m_configPath.c_str());
             return false;
         }
 
@@ -83,15 +122,33 @@ bool ConfigLoader::loadConfig() {
             m_boolConfig[key] = config.value(key, defaultValue);
         }
 
-        std::cout << "Loaded configuration from " << m_configPath << std::endl;
+        logInfo("config", "Loaded configuration from %s", m_configPath.c_str());
         return true;
     }
     catch (const std::exception& e) {
-        std::cerr << "Error loading config: " << e.what() << std::endl;
+        logError("config", "Error loading config: %s", e.what());
         return false;
     }
 }
 
+std::vector<std::string> ConfigLoader::changedKeys(const ConfigLoader& other) const {
+    std::vector<std::string> keys;
+    auto compare = [&keys](const auto& ours, const auto& theirs) {
+        for (const auto& [key, value] : ours) {
+            auto it = theirs.find(key);
+            if (it == theirs.end() || it->second != value) {
+                keys.push_back(key);
+            }
+        }
+    };
+
+    compare(m_stringConfig, other.m_stringConfig);
+    compare(m_intConfig, other.m_intConfig);
+    compare(m_floatConfig, other.m_floatConfig);
+    compare(m_boolConfig, other.m_boolConfig);
+    return keys;
+}
+
 bool ConfigLoader::saveConfig() const {
     try {
         // Create parent directory if it doesn't exist
@@ -128,18 +185,18 @@ bool ConfigLoader::saveConfig() const {
         // Write to file
         std::ofstream file(m_configPath);
         if (!file.is_open()) {
-            std::cerr << "Failed to open config file for writing: " << m_configPath << std::endl;
+            logError("config", "Failed to open config file for writing: %s", m_configPath.c_str());
             return false;
         }
 
         file << config.dump(4); // Pretty print with 4-space indentation
         file.close();
 
-        std::cout << "Saved configuration to " << m_configPath << std::endl;
+        logInfo("config", "Saved configuration to %s", m_configPath.c_str());
         return true;
     }
     catch (const std::exception& e) {
-        std::cerr << "Error saving config: " << e.what() << std::endl;
+        logError("config", "Error saving config: %s", e.what());
         return false;
     }
 }
@@ -151,7 +208,7 @@ void ConfigLoader::createDefaultConfig() {
     m_floatConfig = DEFAULT_FLOAT_CONFIG;
     m_boolConfig = DEFAULT_BOOL_CONFIG;
 
-    std::cout << "Created default configuration" << std::endl;
+    logInfo("config", "Created default configuration");
 }
 
 int ConfigLoader::getCameraIndex() const {
@@ -162,6 +219,14 @@ void ConfigLoader::setCameraIndex(int index) {
     m_intConfig["camera_index"] = index;
 }
 
+int ConfigLoader::getCameraFrameRate() const {
+    return m_intConfig.at("camera_frame_rate");
+}
+
+void ConfigLoader::setCameraFrameRate(int fps) {
+    m_intConfig["camera_frame_rate"] = fps;
+}
+
 std::string ConfigLoader::getDatabasePath() const {
     return m_stringConfig.at("database_path");
 }
@@ -186,6 +251,14 @@ void ConfigLoader::setClassesPath(const std::string& path) {
     m_stringConfig["classes_path"] = path;
 }
 
+std::string ConfigLoader::getModelRegistryPath() const {
+    return m_stringConfig.at("model_registry_path");
+}
+
+void ConfigLoader::setModelRegistryPath(const std::string& path) {
+    m_stringConfig["model_registry_path"] = path;
+}
+
 std::string ConfigLoader::getTrainingDataPath() const {
     return m_stringConfig.at("training_data_path");
 }
@@ -218,6 +291,302 @@ void ConfigLoader::setTrainingIntervalHours(int hours) {
     m_intConfig["training_interval_hours"] = hours;
 }
 
+int ConfigLoader::getTrainingNiceLevel() const {
+    return m_intConfig.at("training_nice_level");
+}
+
+void ConfigLoader::setTrainingNiceLevel(int niceLevel) {
+    m_intConfig["training_nice_level"] = niceLevel;
+}
+
+int ConfigLoader::getTrainingMaxCores() const {
+    return m_intConfig.at("training_max_cores");
+}
+
+void ConfigLoader::setTrainingMaxCores(int cores) {
+    m_intConfig["training_max_cores"] = cores;
+}
+
+float ConfigLoader::getMaxDetectionLatencyMs() const {
+    return m_floatConfig.at("max_detection_latency_ms");
+}
+
+void ConfigLoader::setMaxDetectionLatencyMs(float latencyMs) {
+    m_floatConfig["max_detection_latency_ms"] = latencyMs;
+}
+
+int ConfigLoader::getTrainingQuietMarginMinutes() const {
+    return m_intConfig.at("training_quiet_margin_minutes");
+}
+
+void ConfigLoader::setTrainingQuietMarginMinutes(int minutes) {
+    m_intConfig["training_quiet_margin_minutes"] = minutes;
+}
+
+int ConfigLoader::getTrainingSampleBudget() const {
+    return m_intConfig.at("training_sample_budget");
+}
+
+void ConfigLoader::setTrainingSampleBudget(int samples) {
+    m_intConfig["training_sample_budget"] = samples;
+}
+
+float ConfigLoader::getTrainingMaxLoadPerMinute() const {
+    return m_floatConfig.at("training_max_load_per_minute");
+}
+
+void ConfigLoader::setTrainingMaxLoadPerMinute(float itemsPerMinute) {
+    m_floatConfig["training_max_load_per_minute"] = itemsPerMinute;
+}
+
+float ConfigLoader::getTrainingPauseLoadPerMinute() const {
+    return m_floatConfig.at("training_pause_load_per_minute");
+}
+
+void ConfigLoader::setTrainingPauseLoadPerMinute(float itemsPerMinute) {
+    m_floatConfig["training_pause_load_per_minute"] = itemsPerMinute;
+}
+
+float ConfigLoader::getShadowSampleRate() const {
+    return m_floatConfig.at("shadow_sample_rate");
+}
+
+void ConfigLoader::setShadowSampleRate(float rate) {
+    m_floatConfig["shadow_sample_rate"] = rate;
+}
+
+int ConfigLoader::getShadowMinFrames() const {
+    return m_intConfig.at("shadow_min_frames");
+}
+
+void ConfigLoader::setShadowMinFrames(int frames) {
+    m_intConfig["shadow_min_frames"] = frames;
+}
+
+int ConfigLoader::getShadowMinDetections() const {
+    return m_intConfig.at("shadow_min_detections");
+}
+
+void ConfigLoader::setShadowMinDetections(int detections) {
+    m_intConfig["shadow_min_detections"] = detections;
+}
+
+float ConfigLoader::getShadowMaxDisagreement() const {
+    return m_floatConfig.at("shadow_max_disagreement");
+}
+
+void ConfigLoader::setShadowMaxDisagreement(float rate) {
+    m_floatConfig["shadow_max_disagreement"] = rate;
+}
+
+float ConfigLoader::getShadowMaxLatencyRatio() const {
+    return m_floatConfig.at("shadow_max_latency_ratio");
+}
+
+void ConfigLoader::setShadowMaxLatencyRatio(float ratio) {
+    m_floatConfig["shadow_max_latency_ratio"] = ratio;
+}
+
+float ConfigLoader::getShadowMinConfidenceRatio() const {
+    return m_floatConfig.at("shadow_min_confidence_ratio");
+}
+
+void ConfigLoader::setShadowMinConfidenceRatio(float ratio) {
+    m_floatConfig["shadow_min_confidence_ratio"] = ratio;
+}
+
+int ConfigLoader::getSchedulerRealtimeCores() const {
+    return m_intConfig.at("scheduler_realtime_cores");
+}
+
+void ConfigLoader::setSchedulerRealtimeCores(int cores) {
+    m_intConfig["scheduler_realtime_cores"] = cores;
+}
+
+int ConfigLoader::getSchedulerIngestCores() const {
+    return m_intConfig.at("scheduler_ingest_cores");
+}
+
+void ConfigLoader::setSchedulerIngestCores(int cores) {
+    m_intConfig["scheduler_ingest_cores"] = cores;
+}
+
+int ConfigLoader::getSchedulerAnalyticsCores() const {
+    return m_intConfig.at("scheduler_analytics_cores");
+}
+
+void ConfigLoader::setSchedulerAnalyticsCores(int cores) {
+    m_intConfig["scheduler_analytics_cores"] = cores;
+}
+
+int ConfigLoader::getMetricsPort() const {
+    return m_intConfig.at("metrics_port");
+}
+
+void ConfigLoader::setMetricsPort(int port) {
+    m_intConfig["metrics_port"] = port;
+}
+
+std::string ConfigLoader::getMetricsDumpPath() const {
+    return m_stringConfig.at("metrics_dump_path");
+}
+
+void ConfigLoader::setMetricsDumpPath(const std::string& path) {
+    m_stringConfig["metrics_dump_path"] = path;
+}
+
+bool ConfigLoader::getTraceEnabled() const {
+    return m_boolConfig.at("trace_enabled");
+}
+
+void ConfigLoader::setTraceEnabled(bool enabled) {
+    m_boolConfig["trace_enabled"] = enabled;
+}
+
+std::string ConfigLoader::getTraceOutputDir() const {
+    return m_stringConfig.at("trace_output_dir");
+}
+
+void ConfigLoader::setTraceOutputDir(const std::string& path) {
+    m_stringConfig["trace_output_dir"] = path;
+}
+
+std::string ConfigLoader::getLogLevel() const {
+    return m_stringConfig.at("log_level");
+}
+
+void ConfigLoader::setLogLevel(const std::string& level) {
+    m_stringConfig["log_level"] = level;
+}
+
+bool ConfigLoader::getLogJson() const {
+    return m_boolConfig.at("log_json");
+}
+
+void ConfigLoader::setLogJson(bool json) {
+    m_boolConfig["log_json"] = json;
+}
+
+std::string ConfigLoader::getLogFile() const {
+    return m_stringConfig.at("log_file");
+}
+
+void ConfigLoader::setLogFile(const std::string& path) {
+    m_stringConfig["log_file"] = path;
+}
+
+std::string ConfigLoader::getPlacementCaptureCpus() const {
+    return m_stringConfig.at("placement_capture_cpus");
+}
+
+void ConfigLoader::setPlacementCaptureCpus(const std::string& cpus) {
+    m_stringConfig["placement_capture_cpus"] = cpus;
+}
+
+std::string ConfigLoader::getPlacementInferenceCpus() const {
+    return m_stringConfig.at("placement_inference_cpus");
+}
+
+void ConfigLoader::setPlacementInferenceCpus(const std::string& cpus) {
+    m_stringConfig["placement_inference_cpus"] = cpus;
+}
+
+std::string ConfigLoader::getPlacementShadowCpus() const {
+    return m_stringConfig.at("placement_shadow_cpus");
+}
+
+void ConfigLoader::setPlacementShadowCpus(const std::string& cpus) {
+    m_stringConfig["placement_shadow_cpus"] = cpus;
+}
+
+std::string ConfigLoader::getPlacementWorkerCpus() const {
+    return m_stringConfig.at("placement_worker_cpus");
+}
+
+void ConfigLoader::setPlacementWorkerCpus(const std::string& cpus) {
+    m_stringConfig["placement_worker_cpus"] = cpus;
+}
+
+std::string ConfigLoader::getPlacementBackgroundCpus() const {
+    return m_stringConfig.at("placement_background_cpus");
+}
+
+void ConfigLoader::setPlacementBackgroundCpus(const std::string& cpus) {
+    m_stringConfig["placement_background_cpus"] = cpus;
+}
+
+std::string ConfigLoader::getIpcRingName() const {
+    return m_stringConfig.at("ipc_ring_name");
+}
+
+void ConfigLoader::setIpcRingName(const std::string& name) {
+    m_stringConfig["ipc_ring_name"] = name;
+}
+
+int ConfigLoader::getIpcRingSlots() const {
+    return m_intConfig.at("ipc_ring_slots");
+}
+
+void ConfigLoader::setIpcRingSlots(int slots) {
+    m_intConfig["ipc_ring_slots"] = slots;
+}
+
+int ConfigLoader::getIpcInferenceWorkers() const {
+    return m_intConfig.at("ipc_inference_workers");
+}
+
+void ConfigLoader::setIpcInferenceWorkers(int workers) {
+    m_intConfig["ipc_inference_workers"] = workers;
+}
+
+std::string ConfigLoader::getQuerySocketPath() const {
+    return m_stringConfig.at("query_socket_path");
+}
+
+void ConfigLoader::setQuerySocketPath(const std::string& path) {
+    m_stringConfig["query_socket_path"] = path;
+}
+
+std::string ConfigLoader::getSyncCollectorAddress() const {
+    return m_stringConfig.at("sync_collector_address");
+}
+
+void ConfigLoader::setSyncCollectorAddress(const std::string& address) {
+    m_stringConfig["sync_collector_address"] = address;
+}
+
+std::string ConfigLoader::getSyncSiteId() const {
+    return m_stringConfig.at("sync_site_id");
+}
+
+void ConfigLoader::setSyncSiteId(const std::string& siteId) {
+    m_stringConfig["sync_site_id"] = siteId;
+}
+
+std::string ConfigLoader::getSyncWalPath() const {
+    return m_stringConfig.at("sync_wal_path");
+}
+
+void ConfigLoader::setSyncWalPath(const std::string& path) {
+    m_stringConfig["sync_wal_path"] = path;
+}
+
+int ConfigLoader::getSyncBatchEntries() const {
+    return m_intConfig.at("sync_batch_entries");
+}
+
+void ConfigLoader::setSyncBatchEntries(int entries) {
+    m_intConfig["sync_batch_entries"] = entries;
+}
+
+int ConfigLoader::getSyncBatchDelayMs() const {
+    return m_intConfig.at("sync_batch_delay_ms");
+}
+
+void ConfigLoader::setSyncBatchDelayMs(int delayMs) {
+    m_intConfig["sync_batch_delay_ms"] = delayMs;
+}
+
 bool ConfigLoader::getShowDetectionBoxes() const {
     return m_boolConfig.at("show_detection_boxes");
 }
@@ -21,10 +21,18 @@ public:
     bool loadConfig();
     bool saveConfig() const;
 
+    const std::string& getConfigPath() const { return m_configPath; }
+
+    // Keys whose values differ from another loader's
+    std::vector<std::string> changedKeys(const ConfigLoader& other) const;
+
     // Camera settings
     int getCameraIndex() const;
     void setCameraIndex(int index);
 
+    int getCameraFrameRate() const;
+    void setCameraFrameRate(int fps);
+
     // Paths
     std::string getDatabasePath() const;
     void setDatabasePath(const std::string& path);
@@ -35,6 +43,10 @@ public:
     std::string getClassesPath() const;
     void setClassesPath(const std::string& path);
 
+    // Versioned models; the promoted version takes precedence over model_path
+    std::string getModelRegistryPath() const;
+    void setModelRegistryPath(const std::string& path);
+
     std::string getTrainingDataPath() const;
     void setTrainingDataPath(const std::string& path);
 
@@ -49,6 +61,138 @@ public:
     int getTrainingIntervalHours() const;
     void setTrainingIntervalHours(int hours);
 
+    // Training samples selected per cycle (0 = use every sample)
+    int getTrainingSampleBudget() const;
+    void setTrainingSampleBudget(int samples);
+
+    // Background training limits
+    int getTrainingNiceLevel() const;
+    void setTrainingNiceLevel(int niceLevel);
+
+    int getTrainingMaxCores() const;
+    void setTrainingMaxCores(int cores);
+
+    float getMaxDetectionLatencyMs() const;
+    void setMaxDetectionLatencyMs(float latencyMs);
+
+    // Training schedule (quiet windows and load thresholds)
+    int getTrainingQuietMarginMinutes() const;
+    void setTrainingQuietMarginMinutes(int minutes);
+
+    float getTrainingMaxLoadPerMinute() const;
+    void setTrainingMaxLoadPerMinute(float itemsPerMinute);
+
+    float getTrainingPauseLoadPerMinute() const;
+    void setTrainingPauseLoadPerMinute(float itemsPerMinute);
+
+    // Shadow evaluation of candidate models
+    float getShadowSampleRate() const;
+    void setShadowSampleRate(float rate);
+
+    int getShadowMinFrames() const;
+    void setShadowMinFrames(int frames);
+
+    int getShadowMinDetections() const;
+    void setShadowMinDetections(int detections);
+
+    float getShadowMaxDisagreement() const;
+    void setShadowMaxDisagreement(float rate);
+
+    float getShadowMaxLatencyRatio() const;
+    void setShadowMaxLatencyRatio(float ratio);
+
+    float getShadowMinConfidenceRatio() const;
+    void setShadowMinConfidenceRatio(float ratio);
+
+    // Core budgets of the shared task scheduler (0 = automatic). Background
+    // work uses training_max_cores; realtime also sizes OpenCV's thread pool.
+    int getSchedulerRealtimeCores() const;
+    void setSchedulerRealtimeCores(int cores);
+
+    int getSchedulerIngestCores() const;
+    void setSchedulerIngestCores(int cores);
+
+    int getSchedulerAnalyticsCores() const;
+    void setSchedulerAnalyticsCores(int cores);
+
+    // Pipeline metrics: Prometheus endpoint on localhost (0 = off) and the
+    // file they are dumped to periodically and on exit (empty = off)
+    int getMetricsPort() const;
+    void setMetricsPort(int port);
+
+    std::string getMetricsDumpPath() const;
+    void setMetricsDumpPath(const std::string& path);
+
+    // Timeline tracing: record spans from startup, and where dumps
+    // requested with SIGUSR1 or the 't' key are written
+    bool getTraceEnabled() const;
+    void setTraceEnabled(bool enabled);
+
+    std::string getTraceOutputDir() const;
+    void setTraceOutputDir(const std::string& path);
+
+    // Logging: minimum level (debug, info, warning, error), one JSON object
+    // per line instead of text, and a file that receives a copy (empty = none)
+    std::string getLogLevel() const;
+    void setLogLevel(const std::string& level);
+
+    bool getLogJson() const;
+    void setLogJson(bool json);
+
+    std::string getLogFile() const;
+    void setLogFile(const std::string& path);
+
+    // Thread placement as CPU lists ("0-3,8", "node:1", "socket:0"; empty =
+    // unpinned). Capture also takes per-camera entries: "0=2;1=node:1".
+    // A background set replaces the training_max_cores rule.
+    std::string getPlacementCaptureCpus() const;
+    void setPlacementCaptureCpus(const std::string& cpus);
+
+    std::string getPlacementInferenceCpus() const;
+    void setPlacementInferenceCpus(const std::string& cpus);
+
+    std::string getPlacementShadowCpus() const;
+    void setPlacementShadowCpus(const std::string& cpus);
+
+    std::string getPlacementWorkerCpus() const;
+    void setPlacementWorkerCpus(const std::string& cpus);
+
+    std::string getPlacementBackgroundCpus() const;
+    void setPlacementBackgroundCpus(const std::string& cpus);
+
+    // Multi-process mode (--role capture): shared-memory frame ring and the
+    // number of inference worker processes started next to the UI process
+    std::string getIpcRingName() const;
+    void setIpcRingName(const std::string& name);
+
+    int getIpcRingSlots() const;
+    void setIpcRingSlots(int slots);
+
+    int getIpcInferenceWorkers() const;
+    void setIpcInferenceWorkers(int workers);
+
+    // Unix socket of the local query service (empty = off)
+    std::string getQuerySocketPath() const;
+    void setQuerySocketPath(const std::string& path);
+
+    // Shipping entries to a campus collector ("host:port", empty = off). The
+    // site id defaults to the host name; batches close at sync_batch_entries
+    // or after sync_batch_delay_ms, whichever comes first
+    std::string getSyncCollectorAddress() const;
+    void setSyncCollectorAddress(const std::string& address);
+
+    std::string getSyncSiteId() const;
+    void setSyncSiteId(const std::string& siteId);
+
+    std::string getSyncWalPath() const;
+    void setSyncWalPath(const std::string& path);
+
+    int getSyncBatchEntries() const;
+    void setSyncBatchEntries(int entries);
+
+    int getSyncBatchDelayMs() const;
+    void setSyncBatchDelayMs(int delayMs);
+
     // UI settings
     bool getShowDetectionBoxes() const;
     void setShowDetectionBoxes(bool show);
@@ -0,0 +1,306 @@
+/**
+ * Config Store Implementation
+ */
+
+#include "config_store.h"
+#include "metrics.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace Utils {
+
+namespace {
+
+// Editors write a file in several steps; reload once it has been quiet this long
+const int RELOAD_SETTLE_MS = 200;
+
+const char* const RELOADABLE_KEYS[] = {
+    "confidence_threshold",
+    "camera_frame_rate",
+    "log_level",
+    "log_json",
+    "log_file",
+    "trace_enabled",
+    "training_interval_hours",
+    "training_quiet_margin_minutes",
+    "training_max_load_per_minute",
+    "training_pause_load_per_minute",
+    "training_nice_level",
+    "training_max_cores",
+    "max_detection_latency_ms"
+};
+
+} // namespace
+
+bool ConfigSnapshot::compile(const ConfigLoader& loader, ConfigSnapshot& snapshot, std::string& error) {
+    snapshot.confidenceThreshold = loader.getConfidenceThreshold();
+    snapshot.cameraFrameRate = loader.getCameraFrameRate();
+    snapshot.logJson = loader.getLogJson();
+    snapshot.logFile = loader.getLogFile();
+    snapshot.traceEnabled = loader.getTraceEnabled();
+    snapshot.trainingIntervalHours = loader.getTrainingIntervalHours();
+    snapshot.trainingQuietMarginMinutes = loader.getTrainingQuietMarginMinutes();
+    snapshot.trainingMaxLoadPerMinute = loader.getTrainingMaxLoadPerMinute();
+    snapshot.trainingPauseLoadPerMinute = loader.getTrainingPauseLoadPerMinute();
+    snapshot.trainingNiceLevel = loader.getTrainingNiceLevel();
+    snapshot.trainingMaxCores = loader.getTrainingMaxCores();
+    snapshot.maxDetectionLatencyMs = loader.getMaxDetectionLatencyMs();
+
+    if (!Logger::parseLevel(loader.getLogLevel(), snapshot.logLevel)) {
+        error = "unknown log_level '" + loader.getLogLevel() + "'";
+        return false;
+    }
+    if (snapshot.confidenceThreshold < 0.0f || snapshot.confidenceThreshold > 1.0f) {
+        error = "confidence_threshold must be between 0 and 1";
+        return false;
+    }
+    if (snapshot.cameraFrameRate <= 0) {
+        error = "camera_frame_rate must be positive";
+        return false;
+    }
+    if (snapshot.trainingIntervalHours < 0 || snapshot.trainingQuietMarginMinutes < 0 ||
+        snapshot.trainingMaxLoadPerMinute < 0.0f || snapshot.trainingPauseLoadPerMinute < 0.0f) {
+        error = "training schedule settings must not be negative";
+        return false;
+    }
+    if (snapshot.trainingNiceLevel < -20 || snapshot.trainingNiceLevel > 19) {
+        error = "training_nice_level must be between -20 and 19";
+        return false;
+    }
+    if (snapshot.trainingMaxCores < 0 || snapshot.maxDetectionLatencyMs < 0.0f) {
+        error = "training_max_cores and max_detection_latency_ms must not be negative";
+        return false;
+    }
+    return true;
+}
+
+bool ConfigSnapshot::isReloadable(const std::string& key) {
+    return std::find(std::begin(RELOADABLE_KEYS), std::end(RELOADABLE_KEYS), key) != std::end(RELOADABLE_KEYS);
+}
+
+ConfigStore::ConfigStore()
+    : m_version(0),
+      m_watching(false),
+      m_inotifyFd(-1),
+      m_wakeFd(-1) {
+}
+
+ConfigStore::~ConfigStore() {
+    stopWatching();
+}
+
+bool ConfigStore::initialize(const ConfigLoader& loader) {
+    auto snapshot = std::make_shared<ConfigSnapshot>();
+    std::string error;
+    if (!ConfigSnapshot::compile(loader, *snapshot, error)) {
+        logError("config", "Invalid configuration in %s: %s", loader.getConfigPath().c_str(), error.c_str());
+        return false;
+    }
+    snapshot->version = 1;
+
+    {
+        std::lock_guard<std::mutex> lock(m_reloadMutex);
+        m_loader = std::make_unique<ConfigLoader>(loader);
+    }
+    m_applied = snapshot;
+    publish(snapshot);
+    return true;
+}
+
+std::shared_ptr<const ConfigSnapshot> ConfigStore::current() const {
+    return std::atomic_load(&m_snapshot);
+}
+
+void ConfigStore::subscribe(Subscriber subscriber) {
+    std::lock_guard<std::mutex> lock(m_subscribersMutex);
+    m_subscribers.push_back(std::move(subscriber));
+}
+
+bool ConfigStore::applyPending() {
+    if (!m_applied || m_version.load(std::memory_order_acquire) == m_applied->version) {
+        return false;
+    }
+
+    std::shared_ptr<const ConfigSnapshot> snapshot = current();
+    std::vector<Subscriber> subscribers;
+    {
+        std::lock_guard<std::mutex> lock(m_subscribersMutex);
+        subscribers = m_subscribers;
+    }
+
+    for (const auto& subscriber : subscribers) {
+        try {
+            subscriber(*m_applied, *snapshot);
+        }
+        catch (const std::exception& e) {
+            logError("config", "Applying config version %llu failed: %s",
+                     static_cast<unsigned long long>(snapshot->version), e.what());
+        }
+    }
+
+    m_applied = snapshot;
+    return true;
+}
+
+bool ConfigStore::reload() {
+    static auto& reloads = MetricsRegistry::instance().counter(
+        "config_reloads_total", "Config file changes applied without a restart");
+    static auto& rejected = MetricsRegistry::instance().counter(
+        "config_reload_failures_total", "Config file changes rejected as unreadable or invalid");
+
+    std::lock_guard<std::mutex> lock(m_reloadMutex);
+    if (!m_loader) {
+        return false;
+    }
+
+    // Loading into a copy keeps the current values if the file is half written
+    auto loader = std::make_unique<ConfigLoader>(*m_loader);
+    const std::string& path = loader->getConfigPath();
+    if (!loader->loadConfig()) {
+        rejected.increment();
+        logWarning("config", "Cannot read %s; keeping the current settings", path.c_str());
+        return false;
+    }
+
+    auto snapshot = std::make_shared<ConfigSnapshot>();
+    std::string error;
+    if (!ConfigSnapshot::compile(*loader, *snapshot, error)) {
+        rejected.increment();
+        logWarning("config", "Ignoring %s: %s", path.c_str(), error.c_str());
+        return false;
+    }
+
+    bool reloadable = false;
+    for (const auto& key : loader->changedKeys(*m_loader)) {
+        if (ConfigSnapshot::isReloadable(key)) {
+            reloadable = true;
+        } else {
+            logWarning("config", "%s changed; it takes effect after a restart", key.c_str());
+        }
+    }
+    m_loader = std::move(loader);
+    if (!reloadable) {
+        return true;
+    }
+
+    snapshot->version = m_version.load(std::memory_order_relaxed) + 1;
+    publish(snapshot);
+    reloads.increment();
+    logInfo("config", "Reloaded %s as version %llu", m_loader->getConfigPath().c_str(),
+            static_cast<unsigned long long>(snapshot->version));
+    return true;
+}
+
+void ConfigStore::publish(std::shared_ptr<const ConfigSnapshot> snapshot) {
+    uint64_t version = snapshot->version;
+    std::atomic_store(&m_snapshot, std::move(snapshot));
+    m_version.store(version, std::memory_order_release);
+}
+
+bool ConfigStore::startWatching() {
+    if (m_watching) {
+        return true;
+    }
+
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(m_reloadMutex);
+        if (!m_loader) {
+            return false;
+        }
+        path = m_loader->getConfigPath();
+    }
+    fs::path directory = fs::path(path).parent_path();
+    if (directory.empty()) {
+        directory = ".";
+    }
+
+    // Watch the directory: editors and deployment tools usually replace the
+    // file with a rename rather than write it in place
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_inotifyFd < 0 || m_wakeFd < 0 ||
+        inotify_add_watch(m_inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        logWarning("config", "Cannot watch %s for changes: %s", path.c_str(), strerror(errno));
+        stopWatching();
+        return false;
+    }
+
+    m_watching = true;
+    m_watchThread = std::thread(&ConfigStore::watchLoop, this, fs::path(path).filename().string());
+    return true;
+}
+
+void ConfigStore::stopWatching() {
+    m_watching = false;
+    if (m_wakeFd >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(m_wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+    if (m_watchThread.joinable()) {
+        m_watchThread.join();
+    }
+
+    if (m_inotifyFd >= 0) {
+        close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+    if (m_wakeFd >= 0) {
+        close(m_wakeFd);
+        m_wakeFd = -1;
+    }
+}
+
+void ConfigStore::watchLoop(const std::string& fileName) {
+    alignas(inotify_event) char buffer[4096];
+    bool pending = false;
+
+    while (m_watching) {
+        pollfd fds[2];
+        fds[0].fd = m_inotifyFd;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = m_wakeFd;
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+
+        // Every further event restarts the settle time
+        int ready = poll(fds, 2, pending ? RELOAD_SETTLE_MS : -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            logError("config", "Watching %s failed: %s", fileName.c_str(), strerror(errno));
+            return;
+        }
+        if (ready == 0) {
+            pending = false;
+            reload();
+            continue;
+        }
+        if (!(fds[0].revents & POLLIN)) {
+            continue;
+        }
+
+        ssize_t length = read(m_inotifyFd, buffer, sizeof(buffer));
+        for (ssize_t position = 0; position < length; ) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + position);
+            if ((event->mask & IN_Q_OVERFLOW) || (event->len > 0 && fileName == event->name)) {
+                pending = true;
+            }
+            position += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        }
+    }
+}
+
+} // namespace Utils
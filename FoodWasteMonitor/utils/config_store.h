@@ -0,0 +1,133 @@
+/**
+ * Config Store Header
+ *
+ * Publishes the settings that can change while running as immutable typed
+ * snapshots, and reloads them when config.json is edited. Components keep
+ * their own copies of the values they use per frame and re-apply them from
+ * a subscription, so the hot paths never look anything up.
+ */
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include "config_loader.h"
+#include "logger.h"
+
+namespace Utils {
+
+// Settings applied without a restart. Everything else in config.json is
+// read once at startup; edits to it are reported as needing a restart.
+struct ConfigSnapshot {
+    uint64_t version;                   // 1 for the startup config, +1 per reload
+
+    // Detection
+    float confidenceThreshold;
+
+    // Camera
+    int cameraFrameRate;
+
+    // Logging and tracing
+    LogLevel logLevel;
+    bool logJson;
+    std::string logFile;
+    bool traceEnabled;
+
+    // Training schedule and thread budget
+    int trainingIntervalHours;
+    int trainingQuietMarginMinutes;
+    float trainingMaxLoadPerMinute;
+    float trainingPauseLoadPerMinute;
+    int trainingNiceLevel;
+    int trainingMaxCores;
+    float maxDetectionLatencyMs;
+
+    ConfigSnapshot()
+        : version(0),
+          confidenceThreshold(0.5f),
+          cameraFrameRate(30),
+          logLevel(LogLevel::INFO),
+          logJson(false),
+          traceEnabled(false),
+          trainingIntervalHours(48),
+          trainingQuietMarginMinutes(30),
+          trainingMaxLoadPerMinute(2.0f),
+          trainingPauseLoadPerMinute(10.0f),
+          trainingNiceLevel(10),
+          trainingMaxCores(1),
+          maxDetectionLatencyMs(100.0f) {
+    }
+
+    // Typed and range-checked values of a loaded config
+    static bool compile(const ConfigLoader& loader, ConfigSnapshot& snapshot, std::string& error);
+
+    // Config keys the snapshot is compiled from
+    static bool isReloadable(const std::string& key);
+};
+
+class ConfigStore {
+public:
+    ConfigStore();
+    ~ConfigStore();
+
+    ConfigStore(const ConfigStore&) = delete;
+    ConfigStore& operator=(const ConfigStore&) = delete;
+
+    // Compile the startup snapshot from an already loaded config
+    bool initialize(const ConfigLoader& loader);
+
+    // The latest published snapshot. Hold on to the pointer while a set of
+    // values has to stay consistent.
+    std::shared_ptr<const ConfigSnapshot> current() const;
+
+    // Called as (previous, current) from applyPending() after a reload
+    using Subscriber = std::function<void(const ConfigSnapshot&, const ConfigSnapshot&)>;
+    void subscribe(Subscriber subscriber);
+
+    // Run the subscribers if a newer snapshot was published since the last
+    // call; otherwise this is one atomic load. Components apply changes on
+    // the thread that calls it, usually their own loop.
+    bool applyPending();
+
+    // Re-read the config file. An unreadable or invalid file leaves the
+    // current snapshot in place.
+    bool reload();
+
+    // Reload whenever the config file is written or replaced
+    bool startWatching();
+    void stopWatching();
+
+private:
+    void watchLoop(const std::string& fileName);
+    void publish(std::shared_ptr<const ConfigSnapshot> snapshot);
+
+    // Last successfully loaded file, for reloads and restart-only diffs
+    std::unique_ptr<ConfigLoader> m_loader;
+    std::mutex m_reloadMutex;
+
+    // Read with std::atomic_load; m_version mirrors its version
+    std::shared_ptr<const ConfigSnapshot> m_snapshot;
+    std::atomic<uint64_t> m_version;
+
+    // applyPending() caller only
+    std::shared_ptr<const ConfigSnapshot> m_applied;
+
+    std::vector<Subscriber> m_subscribers;
+    std::mutex m_subscribersMutex;
+
+    std::thread m_watchThread;
+    std::atomic<bool> m_watching;
+    int m_inotifyFd;
+    int m_wakeFd;
+};
+
+} // namespace Utils
+
+#endif // CONFIG_STORE_H
@@ -0,0 +1,57 @@
+/**
+ * Content Hash Implementation
+ */
+
+#include "content_hash.h"
+#include <fstream>
+#include <vector>
+#include <cstdio>
+
+namespace Utils {
+
+namespace {
+
+std::string toHex(uint64_t value) {
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+    return std::string(buffer);
+}
+
+} // namespace
+
+uint64_t fnv1a64(const void* data, size_t size, uint64_t seed) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+std::string hashFileContents(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+        return "";
+    }
+
+    // Stream in large chunks so big images are never held in memory twice
+    std::vector<char> buffer(1 << 16);
+    uint64_t hash = fnv1a64(nullptr, 0);
+    while (file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        hash = fnv1a64(buffer.data(), static_cast<size_t>(file.gcount()), hash);
+    }
+
+    if (file.bad()) {
+        return "";
+    }
+
+    return toHex(hash);
+}
+
+std::string hashString(const std::string& text) {
+    return toHex(fnv1a64(text.data(), text.size()));
+}
+
+} // namespace Utils
@@ -0,0 +1,29 @@
+/**
+ * Content Hash Header
+ *
+ * Fast non-cryptographic content hashing used to recognise files and
+ * data that have already been processed
+ */
+
+#ifndef CONTENT_HASH_H
+#define CONTENT_HASH_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace Utils {
+
+// 64-bit FNV-1a; pass a previous result as seed to hash data in pieces
+uint64_t fnv1a64(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ULL);
+
+// Hash of a file's contents as 16 hex digits. Returns an empty string if
+// the file cannot be read.
+std::string hashFileContents(const std::string& filePath);
+
+// Hash of a string as 16 hex digits
+std::string hashString(const std::string& text);
+
+} // namespace Utils
+
+#endif // CONTENT_HASH_H
@@ -0,0 +1,522 @@
+/**
+ * File Downloader Implementation
+ */
+
+#include "file_downloader.h"
+#include "sha256.h"
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <curl/curl.h>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+namespace Utils {
+
+namespace {
+
+const int STATE_VERSION = 1;
+
+// Transfers below this rate for stallTimeoutSeconds are aborted and retried
+const long STALL_BYTES_PER_SECOND = 1024;
+
+void ensureCurlInitialized() {
+    // curl_global_init is not thread-safe, so run it once before any transfer
+    static std::once_flag initialized;
+    std::call_once(initialized, []() { curl_global_init(CURL_GLOBAL_DEFAULT); });
+}
+
+std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::tolower(c); });
+    return text;
+}
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return begin == std::string::npos ? "" : text.substr(begin, end - begin + 1);
+}
+
+// Response headers of interest from the probe and the transfers
+struct ResponseHeaders {
+    bool acceptsRanges = false;
+    std::string etag;
+    std::string lastModified;
+};
+
+size_t readHeader(char* data, size_t size, size_t count, void* userData) {
+    auto* headers = static_cast<ResponseHeaders*>(userData);
+    std::string line(data, size * count);
+
+    // Redirects repeat the headers; only the last response counts
+    if (line.rfind("HTTP/", 0) == 0) {
+        *headers = ResponseHeaders();
+        return size * count;
+    }
+
+    size_t colon = line.find(':');
+    if (colon != std::string::npos) {
+        std::string name = toLower(trim(line.substr(0, colon)));
+        std::string value = trim(line.substr(colon + 1));
+
+        if (name == "accept-ranges") {
+            headers->acceptsRanges = toLower(value) == "bytes";
+        } else if (name == "etag") {
+            headers->etag = value;
+        } else if (name == "last-modified") {
+            headers->lastModified = value;
+        }
+    }
+
+    return size * count;
+}
+
+// A weak ETag cannot be used with If-Range, fall back to the date then
+std::string validatorOf(const ResponseHeaders& headers) {
+    return !headers.etag.empty() && headers.etag.rfind("W/", 0) != 0 ? headers.etag : headers.lastModified;
+}
+
+// State of one transfer, shared with the write callback
+struct Transfer {
+    CURL* curl;
+    std::fstream* file;
+    Sha256* hasher;
+    int64_t requestedFrom;    // First byte asked for
+    int64_t offset;           // Where the next byte goes in the file
+    int64_t written;          // Bytes written by this transfer
+    int64_t limit;            // Bytes expected; -1 if unknown
+    bool wholeFile;           // The range covers the whole file
+    bool statusChecked;
+    bool restarted;           // The server sent the whole file from byte 0
+    bool rangeIgnored;        // The server sent the whole file to a partial range request
+    ResponseHeaders headers;
+};
+
+size_t writeChunk(char* data, size_t size, size_t count, void* userData) {
+    auto* transfer = static_cast<Transfer*>(userData);
+    size_t bytes = size * count;
+
+    if (!transfer->statusChecked) {
+        transfer->statusChecked = true;
+
+        // 200 to a range request means the server ignored the range, or that
+        // If-Range found the file changed; either way the body is the whole file
+        long status = 0;
+        curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &status);
+        if (status == 200 && transfer->requestedFrom > 0) {
+            if (!transfer->wholeFile) {
+                transfer->rangeIgnored = true;
+                return 0;
+            }
+            // The file may have changed size too; this reply is the new one
+            curl_off_t length = -1;
+            curl_easy_getinfo(transfer->curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+            transfer->restarted = true;
+            transfer->offset = 0;
+            transfer->limit = length >= 0 ? static_cast<int64_t>(length) : -1;
+            if (transfer->hasher) {
+                transfer->hasher->reset();
+            }
+        }
+    }
+
+    if (transfer->limit >= 0 && transfer->written + static_cast<int64_t>(bytes) > transfer->limit) {
+        return 0;    // More data than the range holds
+    }
+
+    transfer->file->seekp(transfer->offset);
+    transfer->file->write(data, static_cast<std::streamsize>(bytes));
+    if (!*transfer->file) {
+        return 0;
+    }
+
+    if (transfer->hasher) {
+        transfer->hasher->update(data, bytes);
+    }
+    transfer->offset += static_cast<int64_t>(bytes);
+    transfer->written += static_cast<int64_t>(bytes);
+    return bytes;
+}
+
+// Feed the first bytes of a file to the hasher; used when resuming a
+// download that is hashed while it streams
+bool hashPrefix(const std::string& path, int64_t bytes, Sha256& hasher) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> buffer(1 << 20);
+
+    while (bytes > 0 && file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(std::min<int64_t>(bytes, buffer.size())));
+        hasher.update(buffer.data(), static_cast<size_t>(file.gcount()));
+        bytes -= file.gcount();
+    }
+
+    return bytes == 0;
+}
+
+} // namespace
+
+FileDownloader::FileDownloader(const DownloadOptions& options)
+    : m_options(options) {
+}
+
+DownloadResult FileDownloader::download(const std::string& url, const std::string& outputPath) {
+    DownloadResult result;
+    std::string partPath = outputPath + ".part";
+    std::string statePath = partPath + ".json";
+
+    ensureCurlInitialized();
+
+    // A failed probe is not fatal; the download then runs as one stream
+    RemoteInfo info;
+    bool probed = probe(url, info);
+
+    try {
+        // Continue a previous attempt only if it was for the same, unchanged
+        // file. Without a probe the saved validator is sent as If-Range, and
+        // a changed file comes back whole instead of being spliced.
+        PartState state;
+        bool resuming = loadState(statePath, state) && fs::exists(partPath) && state.url == url &&
+                        (probed ? state.validator == info.validator && state.size == info.size
+                                : !state.validator.empty());
+
+        if (resuming) {
+            for (const auto& range : state.ranges) {
+                result.resumedBytes += range.done;
+            }
+            std::cout << "Resuming download of " << url << " at " << result.resumedBytes << " bytes"
+                      << (probed ? "" : " (probe failed; relying on If-Range)") << std::endl;
+        } else {
+            state = PartState();
+            state.url = url;
+            state.validator = info.validator;
+            state.size = info.size;
+
+            int rangeCount = 1;
+            if (info.size > 0 && info.acceptsRanges && m_options.minRangeBytes > 0) {
+                int64_t maxRanges = std::max<int64_t>(1, info.size / m_options.minRangeBytes);
+                rangeCount = static_cast<int>(std::min<int64_t>(std::max(1, m_options.parallelRanges), maxRanges));
+            }
+
+            for (int r = 0; r < rangeCount; r++) {
+                RangeState range;
+                range.begin = info.size > 0 ? info.size * r / rangeCount : 0;
+                range.end = info.size > 0 ? info.size * (r + 1) / rangeCount : -1;
+                range.done = 0;
+                state.ranges.push_back(range);
+            }
+
+            if (!fs::path(outputPath).parent_path().empty()) {
+                fs::create_directories(fs::path(outputPath).parent_path());
+            }
+            std::ofstream(partPath, std::ios::binary | std::ios::trunc).close();
+            if (info.size > 0) {
+                fs::resize_file(partPath, static_cast<uintmax_t>(info.size));
+            }
+            saveState(statePath, state);
+        }
+
+        std::string error;
+        bool complete = true;
+
+        if (state.ranges.size() == 1) {
+            // One stream arrives in order, so it is hashed as it is written
+            Sha256 hasher;
+            if (!hashPrefix(partPath, state.ranges[0].done, hasher)) {
+                std::lock_guard<std::mutex> lock(m_stateMutex);
+                state.ranges[0].done = 0;
+                hasher.reset();
+            }
+
+            complete = fetchRange(url, partPath, statePath, state, 0, &hasher, error);
+            if (complete) {
+                result.sha256 = hasher.finalHex();
+            }
+        } else {
+            std::vector<std::string> errors(state.ranges.size());
+            std::vector<char> finished(state.ranges.size(), 0);
+            std::vector<std::thread> threads;
+            for (size_t r = 0; r < state.ranges.size(); r++) {
+                threads.emplace_back([&, r]() {
+                    finished[r] = fetchRange(url, partPath, statePath, state, r, nullptr, errors[r]) ? 1 : 0;
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            for (size_t r = 0; r < state.ranges.size(); r++) {
+                if (!finished[r]) {
+                    complete = false;
+                    error = errors[r];
+                    break;
+                }
+            }
+
+            // Ranges land out of order, so the file is hashed in one pass afterwards
+            if (complete) {
+                result.sha256 = sha256File(partPath);
+            }
+        }
+
+        if (!complete) {
+            int64_t kept = 0;
+            for (const auto& range : state.ranges) {
+                kept += range.done;
+            }
+            result.error = error;
+            std::cerr << "Download interrupted (" << error << "); kept " << kept
+                      << " bytes to resume from" << std::endl;
+            return result;
+        }
+
+        // A restarted stream may be shorter than the data it replaced
+        if (state.ranges.size() == 1) {
+            fs::resize_file(partPath, static_cast<uintmax_t>(state.ranges[0].done));
+        }
+        if (state.size >= 0 && static_cast<int64_t>(fs::file_size(partPath)) != state.size) {
+            result.error = "downloaded size does not match Content-Length";
+            return result;
+        }
+
+        if (!m_options.expectedSha256.empty() && toLower(m_options.expectedSha256) != result.sha256) {
+            result.error = "SHA-256 mismatch: expected " + m_options.expectedSha256 + ", got " + result.sha256;
+            std::cerr << "Discarding corrupt download: " << result.error << std::endl;
+            fs::remove(partPath);
+            fs::remove(statePath);
+            return result;
+        }
+
+        fs::rename(partPath, outputPath);
+        fs::remove(statePath);
+
+        result.success = true;
+        result.totalBytes = static_cast<int64_t>(fs::file_size(outputPath));
+        return result;
+    }
+    catch (const std::exception& e) {
+        result.error = e.what();
+        std::cerr << "Download error: " << e.what() << std::endl;
+        return result;
+    }
+}
+
+bool FileDownloader::probe(const std::string& url, RemoteInfo& info) const {
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+        return false;
+    }
+
+    ResponseHeaders headers;
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, m_options.connectTimeoutSeconds);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, readHeader);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &headers);
+
+    CURLcode res = curl_easy_perform(curl);
+    curl_off_t length = -1;
+    if (res == CURLE_OK) {
+        curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+    }
+    curl_easy_cleanup(curl);
+
+    if (res != CURLE_OK) {
+        return false;
+    }
+
+    info.size = length >= 0 ? static_cast<int64_t>(length) : -1;
+    info.acceptsRanges = headers.acceptsRanges;
+    info.validator = validatorOf(headers);
+    return true;
+}
+
+bool FileDownloader::fetchRange(const std::string& url, const std::string& partPath, const std::string& statePath,
+                                PartState& state, size_t rangeIndex, Sha256* hasher, std::string& error) {
+    for (int attempt = 1; attempt <= m_options.maxAttempts; attempt++) {
+        RangeState range;
+        int64_t fullSize;
+        {
+            std::lock_guard<std::mutex> lock(m_stateMutex);
+            range = state.ranges[rangeIndex];
+            fullSize = state.size;
+        }
+
+        if (range.end >= 0 && range.begin + range.done >= range.end) {
+            return true;
+        }
+
+        std::fstream file(partPath, std::ios::in | std::ios::out | std::ios::binary);
+        if (!file.is_open()) {
+            error = "cannot open " + partPath;
+            return false;
+        }
+
+        CURL* curl = curl_easy_init();
+        if (!curl) {
+            error = "failed to initialize CURL";
+            return false;
+        }
+
+        bool wholeFile = range.begin == 0 && (range.end < 0 || range.end == fullSize);
+
+        Transfer transfer;
+        transfer.curl = curl;
+        transfer.file = &file;
+        transfer.hasher = hasher;
+        transfer.requestedFrom = range.begin + range.done;
+        transfer.offset = transfer.requestedFrom;
+        transfer.written = 0;
+        transfer.limit = range.end >= 0 ? range.end - transfer.requestedFrom : -1;
+        transfer.wholeFile = wholeFile;
+        transfer.statusChecked = false;
+        transfer.restarted = false;
+        transfer.rangeIgnored = false;
+
+        std::string byteRange = std::to_string(transfer.requestedFrom) + "-" +
+                                (range.end >= 0 ? std::to_string(range.end - 1) : "");
+        curl_slist* requestHeaders = nullptr;
+        if (transfer.requestedFrom > 0 || !wholeFile) {
+            curl_easy_setopt(curl, CURLOPT_RANGE, byteRange.c_str());
+
+            // Only continue if the file is still the one the first bytes came from
+            if (!state.validator.empty()) {
+                std::string ifRange = "If-Range: " + state.validator;
+                requestHeaders = curl_slist_append(requestHeaders, ifRange.c_str());
+                curl_easy_setopt(curl, CURLOPT_HTTPHEADER, requestHeaders);
+            }
+        }
+
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeChunk);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, readHeader);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &transfer.headers);
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, m_options.connectTimeoutSeconds);
+        // No overall timeout: a large file on a slow link is fine as long as it moves
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, STALL_BYTES_PER_SECOND);
+        curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, m_options.stallTimeoutSeconds);
+
+        CURLcode res = curl_easy_perform(curl);
+        curl_easy_cleanup(curl);
+        curl_slist_free_all(requestHeaders);
+        file.close();
+
+        // Record progress, even of a failed attempt, so a crash resumes from here
+        bool rangeComplete;
+        {
+            std::lock_guard<std::mutex> lock(m_stateMutex);
+            RangeState& shared = state.ranges[rangeIndex];
+            if (transfer.restarted) {
+                // The file changed since the saved bytes; carry on with the new one
+                shared.done = transfer.written;
+                shared.end = transfer.limit;
+                state.size = transfer.limit;
+                state.validator = validatorOf(transfer.headers);
+            } else {
+                shared.done += transfer.written;
+            }
+
+            if (res == CURLE_OK && shared.end < 0) {
+                // Size was unknown; the end of the stream is the end of the file
+                shared.end = shared.begin + shared.done;
+                state.size = shared.end;
+            }
+            rangeComplete = shared.end >= 0 && shared.begin + shared.done >= shared.end;
+            saveState(statePath, state);
+        }
+
+        if (transfer.rangeIgnored) {
+            error = "server does not honour range requests";
+            return false;
+        }
+
+        if (res == CURLE_OK && rangeComplete) {
+            return true;
+        }
+
+        error = res != CURLE_OK ? curl_easy_strerror(res) : "connection closed before the range was complete";
+        if (attempt < m_options.maxAttempts) {
+            auto backoff = std::chrono::seconds(std::min(30, 1 << (attempt - 1)));
+            std::cerr << "Download attempt " << attempt << " failed (" << error << "), retrying in "
+                      << backoff.count() << "s" << std::endl;
+            std::this_thread::sleep_for(backoff);
+        }
+    }
+
+    return false;
+}
+
+bool FileDownloader::loadState(const std::string& statePath, PartState& state) const {
+    std::ifstream file(statePath);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    try {
+        json data;
+        file >> data;
+        if (data.value("version", 0) != STATE_VERSION) {
+            return false;
+        }
+
+        state.url = data.value("url", "");
+        state.validator = data.value("validator", "");
+        state.size = data.value("size", static_cast<int64_t>(-1));
+        state.ranges.clear();
+        for (const auto& entry : data["ranges"]) {
+            RangeState range;
+            range.begin = entry.value("begin", static_cast<int64_t>(0));
+            range.end = entry.value("end", static_cast<int64_t>(-1));
+            range.done = entry.value("done", static_cast<int64_t>(0));
+            state.ranges.push_back(range);
+        }
+        return !state.ranges.empty();
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Ignoring unreadable download state " << statePath << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool FileDownloader::saveState(const std::string& statePath, const PartState& state) const {
+    json data;
+    data["version"] = STATE_VERSION;
+    data["url"] = state.url;
+    data["validator"] = state.validator;
+    data["size"] = state.size;
+    data["ranges"] = json::array();
+    for (const auto& range : state.ranges) {
+        data["ranges"].push_back({{"begin", range.begin}, {"end", range.end}, {"done", range.done}});
+    }
+
+    try {
+        std::string tempPath = statePath + ".tmp";
+        {
+            std::ofstream file(tempPath);
+            if (!file.is_open()) {
+                return false;
+            }
+            file << data.dump(2);
+        }
+        fs::rename(tempPath, statePath);
+        return true;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error saving download state: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+} // namespace Utils
@@ -0,0 +1,103 @@
+/**
+ * File Downloader Header
+ *
+ * Resumable HTTP downloads for large files. Data goes to "<output>.part"
+ * with its progress in "<output>.part.json", so an interrupted download
+ * continues with Range requests where it stopped. Large files can be
+ * fetched as several ranges in parallel. The result is checked against
+ * an expected SHA-256 before being renamed into place.
+ */
+
+#ifndef FILE_DOWNLOADER_H
+#define FILE_DOWNLOADER_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+namespace Utils {
+
+class Sha256;
+
+// Download behaviour
+struct DownloadOptions {
+    std::string expectedSha256;       // Hex digest the file must match (empty = not checked)
+    int parallelRanges;               // Concurrent range requests when the server allows them
+    int64_t minRangeBytes;            // Smallest range worth its own connection
+    int maxAttempts;                  // Attempts per range before the download is left for later
+    long connectTimeoutSeconds;
+    long stallTimeoutSeconds;         // Abort a transfer that stays under 1 KB/s this long
+
+    DownloadOptions()
+        : parallelRanges(4),
+          minRangeBytes(16 * 1024 * 1024),
+          maxAttempts(5),
+          connectTimeoutSeconds(30),
+          stallTimeoutSeconds(60) {
+    }
+};
+
+// Outcome of one download call
+struct DownloadResult {
+    bool success;
+    int64_t totalBytes;               // Size of the finished file
+    int64_t resumedBytes;             // Bytes kept from earlier attempts
+    std::string sha256;
+    std::string error;
+
+    DownloadResult() : success(false), totalBytes(0), resumedBytes(0) {}
+};
+
+class FileDownloader {
+public:
+    explicit FileDownloader(const DownloadOptions& options = DownloadOptions());
+
+    // Download url to outputPath. outputPath only ever appears complete and
+    // verified; on failure the partial data is kept for the next call.
+    DownloadResult download(const std::string& url, const std::string& outputPath);
+
+private:
+    // What a HEAD request tells us about the remote file
+    struct RemoteInfo {
+        int64_t size;                 // -1 if unknown
+        bool acceptsRanges;
+        std::string validator;        // ETag or Last-Modified; detects a changed file
+
+        RemoteInfo() : size(-1), acceptsRanges(false) {}
+    };
+
+    // One byte range of the file and how much of it is on disk
+    struct RangeState {
+        int64_t begin;
+        int64_t end;                  // Exclusive; -1 while the size is unknown
+        int64_t done;
+    };
+
+    // Persistent progress of a partial download
+    struct PartState {
+        std::string url;
+        std::string validator;
+        int64_t size;
+        std::vector<RangeState> ranges;
+
+        PartState() : size(-1) {}
+    };
+
+    bool probe(const std::string& url, RemoteInfo& info) const;
+
+    // Fetch the rest of one range, retrying with backoff. With a hasher
+    // attached the range must be the whole file and is hashed in order.
+    bool fetchRange(const std::string& url, const std::string& partPath, const std::string& statePath,
+                    PartState& state, size_t rangeIndex, Sha256* hasher, std::string& error);
+
+    bool loadState(const std::string& statePath, PartState& state) const;
+    bool saveState(const std::string& statePath, const PartState& state) const;
+
+    DownloadOptions m_options;
+    std::mutex m_stateMutex;          // Guards the shared PartState across range threads
+};
+
+} // namespace Utils
+
+#endif // FILE_DOWNLOADER_H
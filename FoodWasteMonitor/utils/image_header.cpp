@@ -0,0 +1,61 @@
+/**
+ * Image Header Reader Implementation
+ */
+
+#include "image_header.h"
+#include <fstream>
+#include <cstdio>
+
+namespace Utils {
+
+bool readJpegSize(const std::string& path, cv::Size& size) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    unsigned char header[2];
+    if (!file.read(reinterpret_cast<char*>(header), 2) || header[0] != 0xFF || header[1] != 0xD8) {
+        return false;  // Not a JPEG
+    }
+
+    // Walk the marker segments until a start-of-frame marker is found
+    while (file) {
+        int byte = file.get();
+        if (byte != 0xFF) {
+            return false;
+        }
+
+        int marker = file.get();
+        while (marker == 0xFF) {
+            marker = file.get();  // Skip fill bytes
+        }
+        if (marker == EOF || marker == 0xD9 || marker == 0xDA) {
+            return false;  // End of image or start of scan before any frame header
+        }
+
+        unsigned char lengthBytes[2];
+        if (!file.read(reinterpret_cast<char*>(lengthBytes), 2)) {
+            return false;
+        }
+        int length = (lengthBytes[0] << 8) | lengthBytes[1];
+
+        bool isStartOfFrame = marker >= 0xC0 && marker <= 0xCF &&
+                              marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+        if (isStartOfFrame) {
+            unsigned char frameHeader[5];
+            if (!file.read(reinterpret_cast<char*>(frameHeader), 5)) {
+                return false;
+            }
+            size.height = (frameHeader[1] << 8) | frameHeader[2];
+            size.width = (frameHeader[3] << 8) | frameHeader[4];
+            return size.width > 0 && size.height > 0;
+        }
+
+        file.seekg(length - 2, std::ios::cur);
+    }
+
+    return false;
+}
+
+} // namespace Utils
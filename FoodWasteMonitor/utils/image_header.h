@@ -0,0 +1,22 @@
+/**
+ * Image Header Reader
+ *
+ * Reads image dimensions from encoded file headers, for callers that need
+ * the size of an image but not its pixels
+ */
+
+#ifndef IMAGE_HEADER_H
+#define IMAGE_HEADER_H
+
+#include <string>
+#include <opencv2/core.hpp>
+
+namespace Utils {
+
+// Read image dimensions from a JPEG header without decoding. Returns false
+// for files that are not JPEGs or whose header is cut short.
+bool readJpegSize(const std::string& path, cv::Size& size);
+
+} // namespace Utils
+
+#endif // IMAGE_HEADER_H
@@ -0,0 +1,405 @@
+/**
+ * Logger Implementation
+ */
+
+#include "logger.h"
+#include <algorithm>
+#include <ctime>
+
+namespace Utils {
+
+namespace {
+
+int64_t wallClockNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+int64_t steadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// "2024-05-01 12:30:15.123" in local time
+void formatTimestamp(int64_t timestampNs, char* buffer, size_t size) {
+    std::time_t seconds = static_cast<std::time_t>(timestampNs / 1000000000);
+    int milliseconds = static_cast<int>((timestampNs / 1000000) % 1000);
+
+    std::tm localTime;
+    localtime_r(&seconds, &localTime);
+
+    size_t length = std::strftime(buffer, size, "%Y-%m-%d %H:%M:%S", &localTime);
+    std::snprintf(buffer + length, size - length, ".%03d", milliseconds);
+}
+
+void appendJsonString(std::string& out, const char* text) {
+    out += '"';
+    for (const char* c = text; *c; c++) {
+        switch (*c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(*c) >= 0x20) {
+                    out += *c;
+                }
+        }
+    }
+    out += '"';
+}
+
+} // namespace
+
+std::atomic<int> Logger::s_minLevel(static_cast<int>(LogLevel::INFO));
+
+RateLimit::RateLimit(int maxMessages, std::chrono::milliseconds period)
+    : m_maxMessages(maxMessages),
+      m_periodNs(std::chrono::duration_cast<std::chrono::nanoseconds>(period).count()),
+      m_windowStartNs(0),
+      m_windowCount(0),
+      m_suppressed(0) {
+}
+
+bool RateLimit::allow() {
+    int64_t now = steadyNs();
+    int64_t windowStart = m_windowStartNs.load(std::memory_order_relaxed);
+    if (now - windowStart >= m_periodNs &&
+        m_windowStartNs.compare_exchange_strong(windowStart, now, std::memory_order_relaxed)) {
+        m_windowCount.store(0, std::memory_order_relaxed);
+    }
+
+    if (m_windowCount.fetch_add(1, std::memory_order_relaxed) < m_maxMessages) {
+        return true;
+    }
+
+    m_suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+uint32_t RateLimit::takeSuppressed() {
+    return m_suppressed.exchange(0, std::memory_order_relaxed);
+}
+
+Logger::Logger()
+    : m_nextThreadId(1),
+      m_dropped(0),
+      m_reportedDropped(0),
+      m_jsonOutput(false),
+      m_file(nullptr),
+      m_flushIntervalMs(50),
+      m_urgent(false),
+      m_stopping(false) {
+    m_writer = std::thread(&Logger::writerLoop, this);
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopping = true;
+    }
+    m_wakeCondition.notify_all();
+
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+
+    if (m_file) {
+        std::fclose(m_file);
+    }
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+void Logger::configure(const LoggerConfig& config) {
+    s_minLevel.store(static_cast<int>(config.minLevel), std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(m_outputMutex);
+    m_jsonOutput = config.jsonOutput;
+    m_flushIntervalMs = std::max(1, config.flushIntervalMs);
+
+    if (m_file) {
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+    if (!config.filePath.empty()) {
+        m_file = std::fopen(config.filePath.c_str(), "a");
+        if (!m_file) {
+            std::fprintf(stderr, "Failed to open log file: %s\n", config.filePath.c_str());
+        }
+    }
+}
+
+void Logger::log(LogLevel level, const char* component, const char* format, ...) {
+    if (!isEnabled(level)) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    vlog(level, component, 0, format, args);
+    va_end(args);
+}
+
+void Logger::vlog(LogLevel level, const char* component, uint32_t suppressed, const char* format, va_list args) {
+    ThreadBuffer& buffer = threadBuffer();
+
+    uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    if (head - buffer.tail.load(std::memory_order_acquire) >= buffer.records.size()) {
+        // Never wait for the writer; losing a line beats stalling a frame
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Record& record = buffer.records[head % buffer.records.size()];
+    record.timestampNs = wallClockNs();
+    record.level = level;
+    record.threadId = buffer.threadId;
+    record.suppressed = suppressed;
+    record.component = component;
+    std::vsnprintf(record.message, MESSAGE_CAPACITY, format, args);
+
+    buffer.head.store(head + 1, std::memory_order_release);
+
+    // Problems are written promptly; routine messages wait for the next flush
+    if (level >= LogLevel::WARNING) {
+        m_urgent.store(true, std::memory_order_relaxed);
+        m_wakeCondition.notify_one();
+    }
+}
+
+void Logger::flush() {
+    drain();
+}
+
+uint64_t Logger::getDroppedCount() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+const char* Logger::levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "debug";
+        case LogLevel::INFO: return "info";
+        case LogLevel::WARNING: return "warning";
+        case LogLevel::ERROR: return "error";
+        default: return "unknown";
+    }
+}
+
+bool Logger::parseLevel(const std::string& name, LogLevel& level) {
+    for (LogLevel candidate : {LogLevel::DEBUG, LogLevel::INFO, LogLevel::WARNING, LogLevel::ERROR}) {
+        if (name == levelName(candidate)) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+Logger::ThreadBuffer& Logger::threadBuffer() {
+    // Marks the buffer as finished when its thread exits so the writer can
+    // drop it once drained
+    struct Holder {
+        std::shared_ptr<ThreadBuffer> buffer;
+        ~Holder() {
+            if (buffer) {
+                buffer->finished = true;
+            }
+        }
+    };
+
+    thread_local Holder holder;
+    if (!holder.buffer) {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        buffer->records.resize(RECORDS_PER_THREAD);
+        buffer->head = 0;
+        buffer->tail = 0;
+        buffer->finished = false;
+
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        buffer->threadId = m_nextThreadId++;
+        m_buffers.push_back(buffer);
+        holder.buffer = buffer;
+    }
+    return *holder.buffer;
+}
+
+void Logger::writerLoop() {
+    while (!m_stopping) {
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wakeCondition.wait_for(lock, std::chrono::milliseconds(m_flushIntervalMs.load()), [this]() {
+                return m_stopping.load() || m_urgent.load(std::memory_order_relaxed);
+            });
+        }
+        m_urgent.store(false, std::memory_order_relaxed);
+
+        drain();
+    }
+
+    drain();
+}
+
+void Logger::drain() {
+    std::lock_guard<std::mutex> outputLock(m_outputMutex);
+
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        buffers = m_buffers;
+    }
+
+    std::vector<Record> records;
+    for (const auto& buffer : buffers) {
+        uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        for (uint64_t i = tail; i < head; i++) {
+            records.push_back(buffer->records[i % buffer->records.size()]);
+        }
+        buffer->tail.store(head, std::memory_order_release);
+    }
+
+    // Threads are drained one after another; restore the order they logged in
+    std::stable_sort(records.begin(), records.end(), [](const Record& a, const Record& b) {
+        return a.timestampNs < b.timestampNs;
+    });
+
+    uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+    if (dropped > m_reportedDropped) {
+        Record notice = {};
+        notice.timestampNs = wallClockNs();
+        notice.level = LogLevel::WARNING;
+        notice.component = "logger";
+        std::snprintf(notice.message, MESSAGE_CAPACITY, "%llu log messages dropped (buffer full)",
+                      static_cast<unsigned long long>(dropped - m_reportedDropped));
+        records.push_back(notice);
+        m_reportedDropped = dropped;
+    }
+
+    std::string line;
+    bool wroteOut = false;
+    bool wroteErr = false;
+    for (const auto& record : records) {
+        writeRecord(record, line);
+
+        FILE* console = record.level >= LogLevel::WARNING ? stderr : stdout;
+        std::fwrite(line.data(), 1, line.size(), console);
+        (console == stderr ? wroteErr : wroteOut) = true;
+
+        if (m_file) {
+            std::fwrite(line.data(), 1, line.size(), m_file);
+        }
+    }
+
+    // One flush per batch instead of one per line
+    if (wroteOut) {
+        std::fflush(stdout);
+    }
+    if (wroteErr) {
+        std::fflush(stderr);
+    }
+    if (m_file && !records.empty()) {
+        std::fflush(m_file);
+    }
+
+    // Forget threads that have exited and been drained
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
+    m_buffers.erase(std::remove_if(m_buffers.begin(), m_buffers.end(),
+                                   [](const std::shared_ptr<ThreadBuffer>& buffer) {
+                                       return buffer->finished.load() &&
+                                              buffer->tail.load() == buffer->head.load();
+                                   }),
+                    m_buffers.end());
+}
+
+void Logger::writeRecord(const Record& record, std::string& line) const {
+    char timestamp[32];
+    formatTimestamp(record.timestampNs, timestamp, sizeof(timestamp));
+
+    char suppressed[64] = "";
+    if (record.suppressed > 0) {
+        std::snprintf(suppressed, sizeof(suppressed), " (%u similar messages suppressed)", record.suppressed);
+    }
+
+    line.clear();
+    if (m_jsonOutput) {
+        line += "{\"time\":\"";
+        line += timestamp;
+        line += "\",\"level\":\"";
+        line += levelName(record.level);
+        line += "\",\"component\":";
+        appendJsonString(line, record.component ? record.component : "");
+        line += ",\"thread\":";
+        line += std::to_string(record.threadId);
+        line += ",\"message\":";
+        appendJsonString(line, record.message);
+        if (record.suppressed > 0) {
+            line += ",\"suppressed\":";
+            line += std::to_string(record.suppressed);
+        }
+        line += "}\n";
+        return;
+    }
+
+    char prefix[96];
+    std::snprintf(prefix, sizeof(prefix), "%s %-7s [%s] ", timestamp, levelName(record.level),
+                  record.component ? record.component : "");
+    line += prefix;
+    line += record.message;
+    line += suppressed;
+    line += '\n';
+}
+
+namespace {
+
+void logWithLevel(LogLevel level, const char* component, const char* format, va_list args) {
+    if (Logger::isEnabled(level)) {
+        Logger::instance().vlog(level, component, 0, format, args);
+    }
+}
+
+} // namespace
+
+void logDebug(const char* component, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    logWithLevel(LogLevel::DEBUG, component, format, args);
+    va_end(args);
+}
+
+void logInfo(const char* component, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    logWithLevel(LogLevel::INFO, component, format, args);
+    va_end(args);
+}
+
+void logWarning(const char* component, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    logWithLevel(LogLevel::WARNING, component, format, args);
+    va_end(args);
+}
+
+void logError(const char* component, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    logWithLevel(LogLevel::ERROR, component, format, args);
+    va_end(args);
+}
+
+void logRateLimited(RateLimit& limit, LogLevel level, const char* component, const char* format, ...) {
+    if (!Logger::isEnabled(level) || !limit.allow()) {
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    Logger::instance().vlog(level, component, limit.takeSuppressed(), format, args);
+    va_end(args);
+}
+
+} // namespace Utils
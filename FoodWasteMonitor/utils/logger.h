@@ -0,0 +1,156 @@
+/**
+ * Logger Header
+ *
+ * Asynchronous logging for the frame pipeline and background jobs. Callers
+ * format into a per-thread lock-free ring buffer; a background thread
+ * writes the records out, so logging never waits on the terminal or disk.
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdarg>
+#include <cstdint>
+#include <condition_variable>
+
+#if defined(__GNUC__)
+#define LOGGER_PRINTF_FORMAT(formatIndex, firstArgument) __attribute__((format(printf, formatIndex, firstArgument)))
+#else
+#define LOGGER_PRINTF_FORMAT(formatIndex, firstArgument)
+#endif
+
+namespace Utils {
+
+enum class LogLevel {
+    DEBUG = 0,
+    INFO,
+    WARNING,
+    ERROR
+};
+
+struct LoggerConfig {
+    LogLevel minLevel;
+    bool jsonOutput;            // One JSON object per line instead of plain text
+    std::string filePath;       // Also append to this file (empty = console only)
+    int flushIntervalMs;        // How often the writer drains the buffers
+
+    LoggerConfig()
+        : minLevel(LogLevel::INFO),
+          jsonOutput(false),
+          flushIntervalMs(50) {
+    }
+};
+
+// Lets at most maxMessages through per period; the rest are counted and
+// reported with the next message that passes. Keep one per call site.
+class RateLimit {
+public:
+    RateLimit(int maxMessages, std::chrono::milliseconds period);
+
+    bool allow();
+    uint32_t takeSuppressed();
+
+private:
+    const int m_maxMessages;
+    const int64_t m_periodNs;
+    std::atomic<int64_t> m_windowStartNs;
+    std::atomic<int> m_windowCount;
+    std::atomic<uint32_t> m_suppressed;
+};
+
+class Logger {
+public:
+    static Logger& instance();
+    ~Logger();
+
+    void configure(const LoggerConfig& config);
+
+    // A single relaxed load; check before building expensive arguments
+    static bool isEnabled(LogLevel level) {
+        return static_cast<int>(level) >= s_minLevel.load(std::memory_order_relaxed);
+    }
+
+    // Component is a short static name such as "database"
+    void log(LogLevel level, const char* component, const char* format, ...) LOGGER_PRINTF_FORMAT(4, 5);
+    void vlog(LogLevel level, const char* component, uint32_t suppressed, const char* format, va_list args);
+
+    // Write everything logged so far before returning
+    void flush();
+
+    // Records lost because a thread's buffer was full
+    uint64_t getDroppedCount() const;
+
+    static const char* levelName(LogLevel level);
+    static bool parseLevel(const std::string& name, LogLevel& level);
+
+private:
+    Logger();
+
+    static const size_t MESSAGE_CAPACITY = 232;
+    static const size_t RECORDS_PER_THREAD = 512;
+
+    struct Record {
+        int64_t timestampNs;
+        LogLevel level;
+        uint32_t threadId;
+        uint32_t suppressed;
+        const char* component;
+        char message[MESSAGE_CAPACITY];
+    };
+
+    // Single-producer single-consumer ring owned by one logging thread
+    struct ThreadBuffer {
+        std::vector<Record> records;
+        std::atomic<uint64_t> head;     // Next slot the owner writes
+        std::atomic<uint64_t> tail;     // Next slot the writer reads
+        uint32_t threadId;
+        std::atomic<bool> finished;
+    };
+
+    ThreadBuffer& threadBuffer();
+    void writerLoop();
+    void drain();
+    void writeRecord(const Record& record, std::string& line) const;
+
+    static std::atomic<int> s_minLevel;
+
+    mutable std::mutex m_buffersMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+    uint32_t m_nextThreadId;
+
+    std::atomic<uint64_t> m_dropped;
+    uint64_t m_reportedDropped;
+
+    // Output settings, used only by the writer
+    std::mutex m_outputMutex;
+    bool m_jsonOutput;
+    FILE* m_file;
+    std::atomic<int> m_flushIntervalMs;
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+    std::atomic<bool> m_urgent;
+    std::atomic<bool> m_stopping;
+    std::thread m_writer;
+};
+
+void logDebug(const char* component, const char* format, ...) LOGGER_PRINTF_FORMAT(2, 3);
+void logInfo(const char* component, const char* format, ...) LOGGER_PRINTF_FORMAT(2, 3);
+void logWarning(const char* component, const char* format, ...) LOGGER_PRINTF_FORMAT(2, 3);
+void logError(const char* component, const char* format, ...) LOGGER_PRINTF_FORMAT(2, 3);
+
+// Rate-limited variant for messages that can repeat every frame
+void logRateLimited(RateLimit& limit, LogLevel level, const char* component, const char* format, ...)
+    LOGGER_PRINTF_FORMAT(4, 5);
+
+} // namespace Utils
+
+#endif // LOGGER_H
@@ -0,0 +1,88 @@
+/**
+ * Mapped File Implementation
+ */
+
+#include "mapped_file.h"
+#include <iostream>
+#include <fstream>
+#include <iterator>
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Utils {
+
+MappedFile::MappedFile()
+    : m_data(nullptr),
+      m_size(0),
+      m_mapped(false) {
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+#ifdef __unix__
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        std::cerr << "Cannot map empty or unreadable file: " << path << std::endl;
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Failed to map file: " << path << std::endl;
+        return false;
+    }
+
+    // Mapped files are read front to back; start the readahead now
+    madvise(mapping, static_cast<size_t>(info.st_size), MADV_WILLNEED);
+
+    m_data = static_cast<const uint8_t*>(mapping);
+    m_size = static_cast<size_t>(info.st_size);
+    m_mapped = true;
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file: " << path << std::endl;
+        return false;
+    }
+    m_buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (m_buffer.empty()) {
+        return false;
+    }
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#endif
+
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef __unix__
+    if (m_mapped && m_data) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+    m_buffer.clear();
+}
+
+} // namespace Utils
@@ -0,0 +1,43 @@
+/**
+ * Mapped File Header
+ *
+ * Read-only memory mapping of a whole file, falling back to reading it
+ * into memory where mmap is not available
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace Utils {
+
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map the file read-only; any previous mapping is released first
+    bool open(const std::string& path);
+    void close();
+
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool isOpen() const { return m_data != nullptr; }
+
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    bool m_mapped;
+    std::vector<uint8_t> m_buffer;    // Used where mmap is not available
+};
+
+} // namespace Utils
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,375 @@
+/**
+ * Metrics Implementation
+ */
+
+#include "metrics.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+
+#ifdef __unix__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace Utils {
+
+namespace {
+
+// Common prefix of every exported metric
+const char* const METRIC_PREFIX = "foodwaste_";
+
+// Bucket bounds exported to Prometheus, in seconds. The internal buckets are
+// much finer; these are what dashboards need and keep scrapes small.
+const double EXPORTED_BOUNDS[] = {
+    0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0
+};
+
+// How often the server loop checks for shutdown
+const int ACCEPT_POLL_MS = 250;
+
+int highestBit(uint64_t value) {
+    int bit = 0;
+    while (value >>= 1) {
+        bit++;
+    }
+    return bit;
+}
+
+} // namespace
+
+Histogram::Histogram()
+    : m_count(0),
+      m_sumNanoseconds(0),
+      m_maxNanoseconds(0) {
+    reset();
+}
+
+void Histogram::reset() {
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sumNanoseconds.store(0, std::memory_order_relaxed);
+    m_maxNanoseconds.store(0, std::memory_order_relaxed);
+}
+
+int Histogram::bucketIndex(uint64_t nanoseconds) {
+    if (nanoseconds < static_cast<uint64_t>(SUB_BUCKETS)) {
+        return static_cast<int>(nanoseconds);
+    }
+
+    int exponent = highestBit(nanoseconds);
+    if (exponent > MAX_EXPONENT) {
+        return BUCKET_COUNT - 1;
+    }
+
+    // The top SUB_BUCKET_BITS bits below the leading one select the sub-bucket
+    int subBucket = static_cast<int>(nanoseconds >> (exponent - SUB_BUCKET_BITS)) - SUB_BUCKETS;
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + subBucket;
+}
+
+uint64_t Histogram::bucketUpperBound(int index) {
+    if (index < SUB_BUCKETS) {
+        return static_cast<uint64_t>(index);
+    }
+
+    int exponent = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    uint64_t subBucket = static_cast<uint64_t>(index % SUB_BUCKETS);
+    uint64_t width = 1ULL << (exponent - SUB_BUCKET_BITS);
+    return ((SUB_BUCKETS + subBucket) << (exponent - SUB_BUCKET_BITS)) + width - 1;
+}
+
+void Histogram::recordNanoseconds(uint64_t nanoseconds) {
+    m_buckets[bucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sumNanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    uint64_t currentMax = m_maxNanoseconds.load(std::memory_order_relaxed);
+    while (nanoseconds > currentMax &&
+           !m_maxNanoseconds.compare_exchange_weak(currentMax, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Histogram::count() const {
+    return m_count.load(std::memory_order_relaxed);
+}
+
+double Histogram::sumSeconds() const {
+    return m_sumNanoseconds.load(std::memory_order_relaxed) * 1e-9;
+}
+
+double Histogram::maxSeconds() const {
+    return m_maxNanoseconds.load(std::memory_order_relaxed) * 1e-9;
+}
+
+double Histogram::quantileSeconds(double quantile) const {
+    // Buckets are read one by one while writers may be adding, so the total
+    // comes from the buckets themselves rather than m_count
+    std::array<uint64_t, BUCKET_COUNT> counts;
+    uint64_t total = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0.0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(quantile * (total - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return bucketUpperBound(i) * 1e-9;
+        }
+    }
+    return maxSeconds();
+}
+
+uint64_t Histogram::countAtOrBelow(double seconds) const {
+    uint64_t bound = static_cast<uint64_t>(seconds * 1e9);
+    uint64_t total = 0;
+    for (int i = 0; i < BUCKET_COUNT && bucketUpperBound(i) <= bound; i++) {
+        total += m_buckets[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+MetricsRegistry& MetricsRegistry::instance() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& entry = m_counters[name];
+    if (!entry.metric) {
+        entry.help = help;
+        entry.metric = std::make_unique<Counter>();
+    }
+    return *entry.metric;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& entry = m_histograms[name];
+    if (!entry.metric) {
+        entry.help = help;
+        entry.metric = std::make_unique<Histogram>();
+    }
+    return *entry.metric;
+}
+
+void MetricsRegistry::forEachHistogram(
+    const std::function<void(const std::string& name, const Histogram& histogram)>& visit) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& [name, entry] : m_histograms) {
+        visit(name, *entry.metric);
+    }
+}
+
+void MetricsRegistry::reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& [name, entry] : m_counters) {
+        entry.metric->reset();
+    }
+    for (auto& [name, entry] : m_histograms) {
+        entry.metric->reset();
+    }
+}
+
+std::string MetricsRegistry::renderPrometheus() const {
+    return render(false);
+}
+
+std::string MetricsRegistry::render(bool withQuantiles) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::ostringstream out;
+    out.precision(9);
+
+    for (const auto& [name, entry] : m_counters) {
+        std::string fullName = METRIC_PREFIX + name;
+        out << "# HELP " << fullName << " " << entry.help << "\n"
+            << "# TYPE " << fullName << " counter\n"
+            << fullName << " " << entry.metric->value() << "\n";
+    }
+
+    for (const auto& [name, entry] : m_histograms) {
+        std::string fullName = METRIC_PREFIX + name;
+        const Histogram& histogram = *entry.metric;
+
+        out << "# HELP " << fullName << " " << entry.help << "\n"
+            << "# TYPE " << fullName << " histogram\n";
+        if (withQuantiles) {
+            out << "# p50=" << histogram.quantileSeconds(0.50)
+                << " p95=" << histogram.quantileSeconds(0.95)
+                << " p99=" << histogram.quantileSeconds(0.99)
+                << " max=" << histogram.maxSeconds() << "\n";
+        }
+
+        // Cumulative counts are read bucket by bucket, so clamp them to stay monotonic
+        uint64_t count = histogram.count();
+        uint64_t previous = 0;
+        for (double bound : EXPORTED_BOUNDS) {
+            uint64_t cumulative = std::min(std::max(previous, histogram.countAtOrBelow(bound)), count);
+            out << fullName << "_bucket{le=\"" << bound << "\"} " << cumulative << "\n";
+            previous = cumulative;
+        }
+        out << fullName << "_bucket{le=\"+Inf\"} " << count << "\n"
+            << fullName << "_sum " << histogram.sumSeconds() << "\n"
+            << fullName << "_count " << count << "\n";
+    }
+
+    return out.str();
+}
+
+bool MetricsRegistry::dumpToFile(const std::string& path) const {
+    try {
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream file(tempPath);
+            if (!file.is_open()) {
+                std::cerr << "Failed to write metrics to " << tempPath << std::endl;
+                return false;
+            }
+            file << render(true);
+        }
+        fs::rename(tempPath, path);
+        return true;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error dumping metrics: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+MetricsServer::MetricsServer(MetricsRegistry& registry, int port, const std::string& bindAddress)
+    : m_registry(registry),
+      m_port(port),
+      m_bindAddress(bindAddress),
+      m_listenFd(-1),
+      m_running(false) {
+}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start() {
+#ifdef __unix__
+    if (m_running) {
+        return true;
+    }
+
+    m_listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (m_listenFd < 0) {
+        std::cerr << "Failed to create metrics socket" << std::endl;
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(m_port));
+    if (inet_pton(AF_INET, m_bindAddress.c_str(), &address.sin_addr) != 1 ||
+        bind(m_listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(m_listenFd, 8) != 0) {
+        std::cerr << "Failed to listen for metrics on " << m_bindAddress << ":" << m_port << std::endl;
+        close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+
+    m_running = true;
+    m_thread = std::thread(&MetricsServer::serveLoop, this);
+
+    std::cout << "Serving metrics on http://" << m_bindAddress << ":" << m_port << "/metrics" << std::endl;
+    return true;
+#else
+    std::cerr << "Metrics endpoint is not supported on this platform" << std::endl;
+    return false;
+#endif
+}
+
+void MetricsServer::stop() {
+    m_running = false;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+#ifdef __unix__
+    if (m_listenFd >= 0) {
+        close(m_listenFd);
+        m_listenFd = -1;
+    }
+#endif
+}
+
+void MetricsServer::serveLoop() {
+#ifdef __unix__
+    while (m_running) {
+        pollfd listener = {m_listenFd, POLLIN, 0};
+        if (poll(&listener, 1, ACCEPT_POLL_MS) <= 0) {
+            continue;
+        }
+
+        int clientFd = accept(m_listenFd, nullptr, nullptr);
+        if (clientFd >= 0) {
+            handleConnection(clientFd);
+            close(clientFd);
+        }
+    }
+#endif
+}
+
+void MetricsServer::handleConnection(int clientFd) {
+#ifdef __unix__
+    // A scraper sends a short GET; don't let a silent client hold the loop
+    timeval timeout = {1, 0};
+    setsockopt(clientFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    char request[2048];
+    ssize_t received = recv(clientFd, request, sizeof(request) - 1, 0);
+    if (received <= 0) {
+        return;
+    }
+    request[received] = '\0';
+
+    std::string status = "200 OK";
+    std::string body;
+    if (std::strncmp(request, "GET /metrics", 12) == 0) {
+        body = m_registry.renderPrometheus();
+    } else {
+        status = "404 Not Found";
+        body = "Not found\n";
+    }
+
+    std::string response = "HTTP/1.1 " + status + "\r\n"
+                           "Content-Type: text/plain; version=0.0.4\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                           "Connection: close\r\n\r\n" + body;
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t n = send(clientFd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            break;
+        }
+        sent += static_cast<size_t>(n);
+    }
+#endif
+}
+
+} // namespace Utils
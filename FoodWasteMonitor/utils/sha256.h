@@ -0,0 +1,43 @@
+/**
+ * SHA-256 Header
+ *
+ * Incremental SHA-256 for verifying downloaded files while they stream
+ */
+
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <string>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace Utils {
+
+class Sha256 {
+public:
+    Sha256();
+
+    void reset();
+    void update(const void* data, size_t size);
+
+    // Finish and return the digest as 64 lowercase hex digits. The object
+    // must be reset before it is used again.
+    std::string finalHex();
+
+private:
+    void processBlock(const uint8_t* block);
+
+    std::array<uint32_t, 8> m_state;
+    std::array<uint8_t, 64> m_buffer;
+    size_t m_bufferSize;
+    uint64_t m_totalBytes;
+};
+
+// SHA-256 of a file's contents as hex. Returns an empty string if the file
+// cannot be read.
+std::string sha256File(const std::string& filePath);
+
+} // namespace Utils
+
+#endif // SHA256_H
@@ -0,0 +1,386 @@
+/**
+ * Task Scheduler Implementation
+ */
+
+#include "task_scheduler.h"
+#include "trace.h"
+#include "thread_placement.h"
+#include "thread_priority.h"
+#include "logger.h"
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <opencv2/core.hpp>
+
+namespace Utils {
+
+namespace {
+
+// Index of the pool worker running on this thread, -1 outside the pool
+thread_local int t_workerIndex = -1;
+
+// Idle workers re-check the queues this often, which also bounds how long a
+// task held back by its class budget waits after a slot frees up
+const std::chrono::milliseconds IDLE_WAIT(5);
+
+int hardwareThreads() {
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+} // namespace
+
+TaskScheduler::TaskScheduler()
+    : m_workerCount(0),
+      m_generalWorkers(0),
+      m_backgroundWorkers(0),
+      m_sharedRunning(0),
+      m_sharedBudget(1),
+      m_backgroundNiceLevel(10),
+      m_backgroundLimitsVersion(0),
+      m_started(false),
+      m_stopping(false) {
+    for (int c = 0; c < TASK_CLASS_COUNT; c++) {
+        m_running[c] = 0;
+        m_budgets[c] = 1;
+    }
+    for (int pool = 0; pool < POOL_COUNT; pool++) {
+        m_queuedTasks[pool] = 0;
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    for (auto& condition : m_wakeConditions) {
+        condition.notify_all();
+    }
+
+    for (auto& worker : m_workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+TaskScheduler& TaskScheduler::instance() {
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+void TaskScheduler::configure(const SchedulerConfig& config) {
+    std::lock_guard<std::mutex> lock(m_startMutex);
+
+    int numThreads = m_started ? m_generalWorkers :
+                     (config.numThreads > 0 ? config.numThreads : hardwareThreads());
+    applyBudgets(config, numThreads);
+    m_backgroundNiceLevel = config.backgroundNiceLevel;
+    m_backgroundLimitsVersion++;
+
+    int backgroundBudget = m_budgets[static_cast<int>(TaskClass::BACKGROUND)];
+    if (m_started) {
+        if (backgroundBudget > m_backgroundWorkers) {
+            logInfo("scheduler", "Background budget raised to %d cores, adding %d background workers",
+                    backgroundBudget, backgroundBudget - m_backgroundWorkers);
+            addWorkers(BACKGROUND_POOL, backgroundBudget - m_backgroundWorkers);
+        }
+        return;
+    }
+
+    // Budgets never exceed numThreads, so neither set of workers can outgrow this
+    m_workers.reserve(numThreads * 2);
+    addWorkers(GENERAL_POOL, numThreads);
+    addWorkers(BACKGROUND_POOL, backgroundBudget);
+    m_started = true;
+
+    logInfo("scheduler", "Task scheduler started with %d workers and %d background workers "
+            "(cores: realtime %d, ingest %d, analytics %d, background %d)", numThreads, backgroundBudget,
+            m_budgets[0].load(), m_budgets[1].load(), m_budgets[2].load(), m_budgets[3].load());
+}
+
+void TaskScheduler::addWorkers(Pool pool, int count) {
+    for (int i = 0; i < count; i++) {
+        size_t index = m_workers.size();
+        m_workers.push_back(std::make_unique<Worker>());
+        m_workers.back()->pool = pool;
+
+        // Visible to thieves before its thread starts taking tasks
+        m_workerCount = m_workers.size();
+        m_workers.back()->thread = std::thread(&TaskScheduler::workerLoop, this, index);
+    }
+
+    if (pool == GENERAL_POOL) {
+        m_generalWorkers += count;
+    } else {
+        m_backgroundWorkers += count;
+    }
+}
+
+TaskScheduler::Pool TaskScheduler::poolOf(int taskClass) {
+    return taskClass == static_cast<int>(TaskClass::BACKGROUND) ? BACKGROUND_POOL : GENERAL_POOL;
+}
+
+void TaskScheduler::applyBudgets(const SchedulerConfig& config, int numThreads) {
+    int cores = hardwareThreads();
+    auto budget = [numThreads](int requested, int automatic) {
+        return std::max(1, std::min(numThreads, requested > 0 ? requested : automatic));
+    };
+
+    int realtime = budget(config.realtimeCores, cores / 2);
+    m_budgets[static_cast<int>(TaskClass::REALTIME)] = realtime;
+    m_budgets[static_cast<int>(TaskClass::INGEST)] = budget(config.ingestCores, cores / 4);
+    m_budgets[static_cast<int>(TaskClass::ANALYTICS)] = budget(config.analyticsCores, cores / 4);
+    m_budgets[static_cast<int>(TaskClass::BACKGROUND)] = budget(config.backgroundCores, 1);
+    m_sharedBudget = std::max(1, numThreads - realtime);
+
+    // OpenCV's own pool runs the parallel parts of inference; keep it inside
+    // the realtime budget instead of letting it claim every core
+    cv::setNumThreads(realtime);
+}
+
+void TaskScheduler::ensureStarted() {
+    if (!m_started) {
+        configure(SchedulerConfig());
+    }
+}
+
+void TaskScheduler::submit(TaskClass taskClass, Task task) {
+    ensureStarted();
+
+    int c = static_cast<int>(taskClass);
+    if (t_workerIndex >= 0) {
+        // Tasks spawned by a task stay on that worker unless someone steals them
+        Worker& worker = *m_workers[t_workerIndex];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queues[c].push_back(std::move(task));
+    } else {
+        std::lock_guard<std::mutex> lock(m_globalMutex);
+        m_globalQueues[c].push_back(std::move(task));
+    }
+    Pool pool = poolOf(c);
+    m_queuedTasks[pool]++;
+
+    // Taking the sleep mutex orders this with a worker about to wait
+    { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+    m_wakeConditions[pool].notify_one();
+}
+
+void TaskScheduler::parallelFor(TaskClass taskClass, size_t count, const std::function<void(size_t)>& body,
+                                int maxParallelism) {
+    if (count == 0) {
+        return;
+    }
+
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto state = std::make_shared<State>();
+
+    // Helpers that start after every index is claimed return without touching body
+    auto run = [state, count, &body]() {
+        for (size_t i = state->next++; i < count; i = state->next++) {
+            try {
+                body(i);
+            }
+            catch (const std::exception& e) {
+                logError("scheduler", "Parallel task failed: %s", e.what());
+            }
+
+            if (++state->done == count) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->finished.notify_all();
+            }
+        }
+    };
+
+    // The caller is one of the threads, on top of the class budget
+    int parallelism = getCoreBudget(taskClass) + 1;
+    if (maxParallelism > 0) {
+        parallelism = std::min(parallelism, maxParallelism);
+    }
+    size_t helpers = std::min(count, static_cast<size_t>(parallelism)) - 1;
+    for (size_t h = 0; h < helpers; h++) {
+        submit(taskClass, run);
+    }
+
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state, count]() { return state->done.load() == count; });
+}
+
+int TaskScheduler::getCoreBudget(TaskClass taskClass) const {
+    return m_budgets[static_cast<int>(taskClass)];
+}
+
+int TaskScheduler::getThreadCount() const {
+    return static_cast<int>(m_workerCount.load());
+}
+
+const char* TaskScheduler::taskClassName(TaskClass taskClass) {
+    switch (taskClass) {
+        case TaskClass::REALTIME: return "realtime";
+        case TaskClass::INGEST: return "ingest";
+        case TaskClass::ANALYTICS: return "analytics";
+        case TaskClass::BACKGROUND: return "background";
+        default: return "unknown";
+    }
+}
+
+void TaskScheduler::workerLoop(size_t index) {
+    t_workerIndex = static_cast<int>(index);
+    Pool pool = m_workers[index]->pool;
+    std::string name = (pool == BACKGROUND_POOL ? "background-" : "worker-") + std::to_string(index);
+    Tracer::instance().setThreadName(name);
+    if (pool == GENERAL_POOL) {
+        ThreadPlacement::instance().bindCurrentThread(ThreadPlacement::instance().getConfig().workers, name);
+    }
+
+    int appliedLimitsVersion = 0;
+    while (!m_stopping) {
+        if (pool == BACKGROUND_POOL) {
+            applyBackgroundLimits(index, appliedLimitsVersion);
+        }
+        if (runOneTask(index)) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        if (m_stopping) {
+            break;
+        }
+        if (m_queuedTasks[pool] == 0) {
+            m_wakeConditions[pool].wait(lock);
+        } else {
+            // Work exists but its class is at budget
+            m_wakeConditions[pool].wait_for(lock, IDLE_WAIT);
+        }
+    }
+}
+
+void TaskScheduler::applyBackgroundLimits(size_t index, int& appliedVersion) {
+    int version = m_backgroundLimitsVersion.load();
+    if (version == appliedVersion) {
+        return;
+    }
+    appliedVersion = version;
+
+    // Same limits as the training thread: lowered priority, kept to the
+    // background placement or the last backgroundCores cores
+    std::string name = "background-" + std::to_string(index);
+    applyBackgroundThreadLimits(m_backgroundNiceLevel.load(),
+                                m_budgets[static_cast<int>(TaskClass::BACKGROUND)].load(), name.c_str());
+}
+
+bool TaskScheduler::runOneTask(size_t index) {
+    Pool pool = m_workers[index]->pool;
+    for (int c = 0; c < TASK_CLASS_COUNT; c++) {
+        if (poolOf(c) != pool) {
+            continue;
+        }
+        if (m_queuedTasks[pool] == 0) {
+            return false;
+        }
+        if (!tryAcquire(c)) {
+            continue;
+        }
+
+        Task task;
+        if (!popTask(index, c, task)) {
+            release(c);
+            continue;
+        }
+        m_queuedTasks[pool]--;
+
+        try {
+            task();
+        }
+        catch (const std::exception& e) {
+            logError("scheduler", "Task in class %s failed: %s", taskClassName(static_cast<TaskClass>(c)), e.what());
+        }
+
+        release(c);
+
+        // A budget slot freed up; let a waiting worker pick up held-back work
+        if (m_queuedTasks[pool] > 0) {
+            m_wakeConditions[pool].notify_one();
+        }
+        return true;
+    }
+    return false;
+}
+
+bool TaskScheduler::popTask(size_t index, int taskClass, Task& task) {
+    // Own queue newest first, for cache locality with the task that spawned it
+    {
+        Worker& self = *m_workers[index];
+        std::lock_guard<std::mutex> lock(self.mutex);
+        auto& queue = self.queues[taskClass];
+        if (!queue.empty()) {
+            task = std::move(queue.back());
+            queue.pop_back();
+            return true;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_globalMutex);
+        auto& queue = m_globalQueues[taskClass];
+        if (!queue.empty()) {
+            task = std::move(queue.front());
+            queue.pop_front();
+            return true;
+        }
+    }
+
+    // Steal the oldest task from another worker
+    size_t workerCount = m_workerCount.load();
+    for (size_t offset = 1; offset < workerCount; offset++) {
+        Worker& victim = *m_workers[(index + offset) % workerCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        auto& queue = victim.queues[taskClass];
+        if (!queue.empty()) {
+            task = std::move(queue.front());
+            queue.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool TaskScheduler::tryAcquire(int taskClass) {
+    int running = m_running[taskClass].load();
+    do {
+        if (running >= m_budgets[taskClass].load()) {
+            return false;
+        }
+    } while (!m_running[taskClass].compare_exchange_weak(running, running + 1));
+
+    if (taskClass == static_cast<int>(TaskClass::REALTIME)) {
+        return true;
+    }
+
+    int shared = m_sharedRunning.load();
+    do {
+        if (shared >= m_sharedBudget.load()) {
+            m_running[taskClass]--;
+            return false;
+        }
+    } while (!m_sharedRunning.compare_exchange_weak(shared, shared + 1));
+
+    return true;
+}
+
+void TaskScheduler::release(int taskClass) {
+    m_running[taskClass]--;
+    if (taskClass != static_cast<int>(TaskClass::REALTIME)) {
+        m_sharedRunning--;
+    }
+}
+
+} // namespace Utils
@@ -0,0 +1,163 @@
+/**
+ * Task Scheduler Header
+ *
+ * Work-stealing task scheduler shared by every subsystem. Tasks belong to
+ * a priority class with its own core budget, so inference, ingest,
+ * analytics and background work share the machine without oversubscribing it.
+ * There are two sets of workers: general workers, one per core, run every
+ * class but background, and background workers, only as many as the
+ * background budget has ever allowed, are niced and kept to the background
+ * cores like the training thread that submits them. Non-realtime classes
+ * count against one shared budget, so the two sets together never run more
+ * tasks than there are general workers.
+ */
+
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <future>
+#include <functional>
+#include <condition_variable>
+
+namespace Utils {
+
+// Priority classes, highest first. Idle workers always take work from the
+// highest class that still has budget.
+enum class TaskClass {
+    REALTIME = 0,   // Decoding live detector output; the budget also sizes OpenCV's pool for the forward pass
+    INGEST,         // Thumbnail decoding, detection image encoding
+    ANALYTICS,      // Statistics refreshes
+    BACKGROUND      // Training, evaluation, dataset preparation, exports
+};
+
+const int TASK_CLASS_COUNT = 4;
+
+// Core budgets cap how many tasks of a class run at once (0 = automatic)
+struct SchedulerConfig {
+    int numThreads;         // Worker threads (0 = one per core)
+    int realtimeCores;      // Also the OpenCV thread count used by inference (0 = half the cores)
+    int ingestCores;        // 0 = a quarter of the cores
+    int analyticsCores;     // 0 = a quarter of the cores
+    int backgroundCores;    // 0 = one core; background workers are also kept to this many cores
+    int backgroundNiceLevel;    // Scheduling niceness of the background workers
+
+    SchedulerConfig()
+        : numThreads(0),
+          realtimeCores(0),
+          ingestCores(0),
+          analyticsCores(0),
+          backgroundCores(0),
+          backgroundNiceLevel(10) {
+    }
+};
+
+class TaskScheduler {
+public:
+    using Task = std::function<void()>;
+
+    static TaskScheduler& instance();
+    ~TaskScheduler();
+
+    // Set the class budgets and start the workers. Call once at startup;
+    // without it the first task starts the pool with automatic budgets.
+    // Later calls change the budgets and background limits; the general
+    // workers stay as they are and background workers are added when the
+    // background budget grows past them.
+    void configure(const SchedulerConfig& config);
+
+    void submit(TaskClass taskClass, Task task);
+
+    template<typename Function>
+    auto async(TaskClass taskClass, Function function) -> std::future<decltype(function())> {
+        using Result = decltype(function());
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(function));
+        std::future<Result> result = task->get_future();
+        submit(taskClass, [task]() { (*task)(); });
+        return result;
+    }
+
+    // Run body(0) .. body(count - 1) and wait for all of them. The calling
+    // thread takes part, so this is safe to nest inside a task.
+    // maxParallelism caps the threads used, caller included (0 = class budget).
+    void parallelFor(TaskClass taskClass, size_t count, const std::function<void(size_t)>& body,
+                     int maxParallelism = 0);
+
+    int getCoreBudget(TaskClass taskClass) const;
+    int getThreadCount() const;
+
+    static const char* taskClassName(TaskClass taskClass);
+
+private:
+    TaskScheduler();
+
+    // General workers run every class but BACKGROUND; background workers
+    // run only BACKGROUND
+    enum Pool { GENERAL_POOL = 0, BACKGROUND_POOL, POOL_COUNT };
+
+    struct Worker {
+        Pool pool;
+        std::mutex mutex;
+        std::deque<Task> queues[TASK_CLASS_COUNT];
+        std::thread thread;
+    };
+
+    static Pool poolOf(int taskClass);
+
+    void ensureStarted();
+    void applyBudgets(const SchedulerConfig& config, int numThreads);
+
+    // Start workers for the pool until it has count of them. Called with
+    // the start mutex held.
+    void addWorkers(Pool pool, int count);
+    void workerLoop(size_t index);
+
+    // Re-nice and re-pin a background worker after the limits changed
+    void applyBackgroundLimits(size_t index, int& appliedVersion);
+
+    // Run one task the worker is allowed to; false if there was none
+    bool runOneTask(size_t index);
+    bool popTask(size_t index, int taskClass, Task& task);
+
+    bool tryAcquire(int taskClass);
+    void release(int taskClass);
+
+    // Capacity is reserved at startup so workers can be added while others
+    // iterate the first m_workerCount entries
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<size_t> m_workerCount;
+    int m_generalWorkers;
+    int m_backgroundWorkers;
+
+    // Tasks submitted from threads outside the pool
+    std::mutex m_globalMutex;
+    std::deque<Task> m_globalQueues[TASK_CLASS_COUNT];
+
+    // Running tasks per class against their budgets. Non-realtime classes
+    // also share the cores inference leaves free.
+    std::atomic<int> m_running[TASK_CLASS_COUNT];
+    std::atomic<int> m_budgets[TASK_CLASS_COUNT];
+    std::atomic<int> m_sharedRunning;
+    std::atomic<int> m_sharedBudget;
+
+    // Background worker limits; the version tells workers to re-apply them
+    std::atomic<int> m_backgroundNiceLevel;
+    std::atomic<int> m_backgroundLimitsVersion;
+
+    std::atomic<size_t> m_queuedTasks[POOL_COUNT];
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wakeConditions[POOL_COUNT];
+
+    std::mutex m_startMutex;
+    std::atomic<bool> m_started;
+    std::atomic<bool> m_stopping;
+};
+
+} // namespace Utils
+
+#endif // TASK_SCHEDULER_H
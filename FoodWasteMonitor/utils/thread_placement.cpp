@@ -0,0 +1,498 @@
+/**
+ * Thread Placement Implementation
+ */
+
+#include "thread_placement.h"
+#include "logger.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <filesystem>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace Utils {
+
+namespace {
+
+const char* SYSFS_CPU_PATH = "/sys/devices/system/cpu";
+const char* SYSFS_NODE_PATH = "/sys/devices/system/node";
+
+bool readFirstLine(const std::string& path, std::string& line) {
+    std::ifstream file(path);
+    return file.is_open() && std::getline(file, line);
+}
+
+int readIntFile(const std::string& path, int defaultValue) {
+    std::string line;
+    if (!readFirstLine(path, line)) {
+        return defaultValue;
+    }
+    try {
+        return std::stoi(line);
+    }
+    catch (const std::exception&) {
+        return defaultValue;
+    }
+}
+
+// Kernel list format: "0-3,8,10-11"
+bool parseCpuList(const std::string& list, std::vector<int>& cpus) {
+    std::stringstream stream(list);
+    std::string term;
+    while (std::getline(stream, term, ',')) {
+        term.erase(std::remove_if(term.begin(), term.end(), ::isspace), term.end());
+        if (term.empty()) {
+            continue;
+        }
+
+        try {
+            size_t dash = term.find('-');
+            int first = std::stoi(term.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(term.substr(dash + 1));
+            if (first < 0 || last < first) {
+                return false;
+            }
+            for (int cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    }
+    return true;
+}
+
+long currentThreadId() {
+#ifdef __linux__
+    return static_cast<long>(syscall(SYS_gettid));
+#else
+    return static_cast<long>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+#endif
+}
+
+// The CPU a thread last ran on (field 39 of its stat line), or -1
+int lastCpuOfThread(long tid) {
+    std::string line;
+    if (!readFirstLine("/proc/self/task/" + std::to_string(tid) + "/stat", line)) {
+        return -1;
+    }
+
+    // The command name may contain spaces; fields are counted after its closing paren
+    size_t paren = line.rfind(')');
+    if (paren == std::string::npos) {
+        return -1;
+    }
+
+    std::istringstream fields(line.substr(paren + 2));
+    std::string field;
+    for (int index = 3; fields >> field; index++) {
+        if (index == 39) {
+            try {
+                return std::stoi(field);
+            }
+            catch (const std::exception&) {
+                return -1;
+            }
+        }
+    }
+    return -1;
+}
+
+std::string describeSet(const CpuSet& cpus) {
+    return cpus.empty() ? "unpinned" : cpus.toString();
+}
+
+// The set most recently applied to this thread by bindCurrentThread
+thread_local CpuSet t_boundCpus;
+
+} // namespace
+
+void CpuSet::add(int cpu) {
+    auto it = std::lower_bound(m_cpus.begin(), m_cpus.end(), cpu);
+    if (it == m_cpus.end() || *it != cpu) {
+        m_cpus.insert(it, cpu);
+    }
+}
+
+bool CpuSet::contains(int cpu) const {
+    return std::binary_search(m_cpus.begin(), m_cpus.end(), cpu);
+}
+
+std::string CpuSet::toString() const {
+    std::string result;
+    for (size_t i = 0; i < m_cpus.size();) {
+        size_t end = i;
+        while (end + 1 < m_cpus.size() && m_cpus[end + 1] == m_cpus[end] + 1) {
+            end++;
+        }
+
+        if (!result.empty()) {
+            result += ",";
+        }
+        result += std::to_string(m_cpus[i]);
+        if (end > i) {
+            result += "-" + std::to_string(m_cpus[end]);
+        }
+        i = end + 1;
+    }
+    return result;
+}
+
+const CpuTopology& CpuTopology::instance() {
+    static CpuTopology topology;
+    return topology;
+}
+
+CpuTopology::CpuTopology()
+    : m_socketCount(1),
+      m_nodeCount(1),
+      m_physicalCores(0) {
+
+    std::vector<int> online;
+    std::string line;
+    if (!readFirstLine(std::string(SYSFS_CPU_PATH) + "/online", line) || !parseCpuList(line, online)) {
+        online.clear();
+    }
+    if (online.empty()) {
+        int count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        for (int cpu = 0; cpu < count; cpu++) {
+            online.push_back(cpu);
+        }
+    }
+
+    for (int cpu : online) {
+        CpuInfo info;
+        info.cpu = cpu;
+        std::string topologyPath = std::string(SYSFS_CPU_PATH) + "/cpu" + std::to_string(cpu) + "/topology/";
+        info.core = readIntFile(topologyPath + "core_id", cpu);
+        info.socket = std::max(0, readIntFile(topologyPath + "physical_package_id", 0));
+        m_cpus.push_back(info);
+    }
+
+    // Machines without NUMA support have no node directory; everything is node 0
+    std::error_code error;
+    if (fs::is_directory(SYSFS_NODE_PATH, error)) {
+        for (const auto& entry : fs::directory_iterator(SYSFS_NODE_PATH, error)) {
+            std::string name = entry.path().filename().string();
+            if (name.compare(0, 4, "node") != 0 || name.size() == 4 ||
+                !std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+                continue;
+            }
+
+            std::vector<int> nodeCpus;
+            if (!readFirstLine(entry.path().string() + "/cpulist", line) || !parseCpuList(line, nodeCpus)) {
+                continue;
+            }
+
+            int node = std::stoi(name.substr(4));
+            for (CpuInfo& info : m_cpus) {
+                if (std::find(nodeCpus.begin(), nodeCpus.end(), info.cpu) != nodeCpus.end()) {
+                    info.node = node;
+                }
+            }
+        }
+    }
+
+    std::set<int> sockets;
+    std::set<int> nodes;
+    std::set<std::pair<int, int>> cores;
+    for (const CpuInfo& info : m_cpus) {
+        sockets.insert(info.socket);
+        nodes.insert(info.node);
+        cores.insert({info.socket, info.core});
+    }
+    m_socketCount = static_cast<int>(sockets.size());
+    m_nodeCount = static_cast<int>(nodes.size());
+    m_physicalCores = static_cast<int>(cores.size());
+}
+
+CpuSet CpuTopology::getNodeCpus(int node) const {
+    CpuSet set;
+    for (const CpuInfo& info : m_cpus) {
+        if (info.node == node) {
+            set.add(info.cpu);
+        }
+    }
+    return set;
+}
+
+CpuSet CpuTopology::getSocketCpus(int socket) const {
+    CpuSet set;
+    for (const CpuInfo& info : m_cpus) {
+        if (info.socket == socket) {
+            set.add(info.cpu);
+        }
+    }
+    return set;
+}
+
+int CpuTopology::getNodeOfCpu(int cpu) const {
+    for (const CpuInfo& info : m_cpus) {
+        if (info.cpu == cpu) {
+            return info.node;
+        }
+    }
+    return -1;
+}
+
+bool CpuTopology::parseCpuSet(const std::string& spec, CpuSet& set, std::string& error) const {
+    set = CpuSet();
+
+    std::stringstream stream(spec);
+    std::string term;
+    while (std::getline(stream, term, ',')) {
+        term.erase(std::remove_if(term.begin(), term.end(), ::isspace), term.end());
+        if (term.empty()) {
+            continue;
+        }
+
+        size_t colon = term.find(':');
+        if (colon != std::string::npos) {
+            std::string kind = term.substr(0, colon);
+            int id = -1;
+            try {
+                id = std::stoi(term.substr(colon + 1));
+            }
+            catch (const std::exception&) {
+            }
+
+            CpuSet group;
+            if (kind == "node") {
+                group = getNodeCpus(id);
+            } else if (kind == "socket") {
+                group = getSocketCpus(id);
+            } else {
+                error = "unknown group '" + kind + "' in '" + spec + "'";
+                return false;
+            }
+
+            if (group.empty()) {
+                error = "no online CPUs in " + term;
+                return false;
+            }
+            for (int cpu : group.cpus()) {
+                set.add(cpu);
+            }
+            continue;
+        }
+
+        std::vector<int> cpus;
+        if (!parseCpuList(term, cpus)) {
+            error = "invalid CPU list '" + term + "'";
+            return false;
+        }
+        for (int cpu : cpus) {
+            if (getNodeOfCpu(cpu) < 0) {
+                error = "CPU " + std::to_string(cpu) + " is not online";
+                return false;
+            }
+            set.add(cpu);
+        }
+    }
+    return true;
+}
+
+std::string CpuTopology::describe() const {
+    std::ostringstream out;
+    out << "CPU topology: " << m_cpus.size() << " CPUs, " << m_physicalCores << " cores, "
+        << m_socketCount << " sockets, " << m_nodeCount << " NUMA nodes\n";
+
+    std::set<int> nodes;
+    for (const CpuInfo& info : m_cpus) {
+        nodes.insert(info.node);
+    }
+    for (int node : nodes) {
+        CpuSet cpus = getNodeCpus(node);
+        std::set<int> sockets;
+        for (const CpuInfo& info : m_cpus) {
+            if (info.node == node) {
+                sockets.insert(info.socket);
+            }
+        }
+
+        out << "  node " << node << ": CPUs " << cpus.toString() << " (socket";
+        for (int socket : sockets) {
+            out << " " << socket;
+        }
+        out << ")\n";
+    }
+    return out.str();
+}
+
+ThreadPlacement& ThreadPlacement::instance() {
+    static ThreadPlacement placement;
+    return placement;
+}
+
+void ThreadPlacement::configure(const PlacementConfig& config) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_config = config;
+}
+
+PlacementConfig ThreadPlacement::getConfig() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_config;
+}
+
+CpuSet ThreadPlacement::getCaptureCpus(int cameraIndex) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_config.captureByCamera.find(cameraIndex);
+    return it != m_config.captureByCamera.end() ? it->second : m_config.capture;
+}
+
+bool ThreadPlacement::bindCurrentThread(const CpuSet& cpus, const std::string& threadName) {
+    if (cpus.empty() || cpus == t_boundCpus) {
+        return true;
+    }
+
+#ifdef __linux__
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (int cpu : cpus.cpus()) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &cpuSet);
+        }
+    }
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0) {
+        logWarning("placement", "Could not pin %s thread to CPUs %s",
+                   threadName.c_str(), cpus.toString().c_str());
+        // Remember the attempt so per-frame callers do not retry every time
+        t_boundCpus = cpus;
+        return false;
+    }
+#endif
+
+    t_boundCpus = cpus;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_boundThreads[currentThreadId()] = BoundThread{threadName, cpus};
+    }
+
+    logInfo("placement", "Pinned %s thread to CPUs %s", threadName.c_str(), cpus.toString().c_str());
+    return true;
+}
+
+std::string ThreadPlacement::describe() const {
+    const CpuTopology& topology = CpuTopology::instance();
+
+    std::ostringstream out;
+    out << topology.describe();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out << "Placement: capture " << describeSet(m_config.capture);
+    for (const auto& [camera, cpus] : m_config.captureByCamera) {
+        out << ", camera " << camera << " " << describeSet(cpus);
+    }
+    out << ", inference " << describeSet(m_config.inference)
+        << ", shadow " << describeSet(m_config.shadow)
+        << ", workers " << describeSet(m_config.workers)
+        << ", background " << describeSet(m_config.background) << "\n";
+
+    for (const auto& [tid, thread] : m_boundThreads) {
+        int lastCpu = lastCpuOfThread(tid);
+        if (lastCpu < 0) {
+            continue;   // Thread has exited
+        }
+
+        out << "  " << thread.name << " (tid " << tid << "): CPUs " << thread.cpus.toString()
+            << ", last ran on CPU " << lastCpu << " (node " << topology.getNodeOfCpu(lastCpu) << ")";
+        if (!thread.cpus.contains(lastCpu)) {
+            out << " OUTSIDE ITS SET";
+        }
+        out << "\n";
+    }
+    return out.str();
+}
+
+bool ThreadPlacement::parseCaptureCpus(const std::string& spec, PlacementConfig& config, std::string& error) {
+    const CpuTopology& topology = CpuTopology::instance();
+    config.capture = CpuSet();
+    config.captureByCamera.clear();
+
+    if (spec.find('=') == std::string::npos) {
+        return topology.parseCpuSet(spec, config.capture, error);
+    }
+
+    std::stringstream stream(spec);
+    std::string entry;
+    while (std::getline(stream, entry, ';')) {
+        if (entry.find_first_not_of(" \t") == std::string::npos) {
+            continue;
+        }
+
+        size_t equals = entry.find('=');
+        if (equals == std::string::npos) {
+            error = "expected camera=CPUs in '" + entry + "'";
+            return false;
+        }
+
+        int camera = -1;
+        try {
+            camera = std::stoi(entry.substr(0, equals));
+        }
+        catch (const std::exception&) {
+        }
+        if (camera < 0) {
+            error = "invalid camera index in '" + entry + "'";
+            return false;
+        }
+
+        CpuSet cpus;
+        if (!topology.parseCpuSet(entry.substr(equals + 1), cpus, error)) {
+            return false;
+        }
+        config.captureByCamera[camera] = cpus;
+    }
+    return true;
+}
+
+bool placeOnLocalNode(void* data, size_t bytes) {
+#ifdef __linux__
+    if (data == nullptr || bytes == 0 || CpuTopology::instance().getNodeCount() < 2) {
+        return true;
+    }
+
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0 || node >= sizeof(unsigned long) * 8) {
+        return false;
+    }
+
+    // Only whole pages can be bound; partial pages at the ends are shared with other allocations
+    uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t start = (reinterpret_cast<uintptr_t>(data) + pageSize - 1) & ~(pageSize - 1);
+    uintptr_t end = (reinterpret_cast<uintptr_t>(data) + bytes) & ~(pageSize - 1);
+    if (end <= start) {
+        return true;
+    }
+
+    unsigned long nodeMask = 1UL << node;
+    if (syscall(SYS_mbind, reinterpret_cast<void*>(start), end - start, MPOL_PREFERRED,
+                &nodeMask, sizeof(nodeMask) * 8, MPOL_MF_MOVE) != 0) {
+        return false;
+    }
+    return true;
+#else
+    (void)data;
+    (void)bytes;
+    return true;
+#endif
+}
+
+} // namespace Utils
@@ -0,0 +1,139 @@
+/**
+ * Thread Placement Header
+ *
+ * CPU topology discovery and configurable pinning of the capture,
+ * inference, worker and background threads to core sets, so that on
+ * multi-socket machines the frame path stays on one socket
+ */
+
+#ifndef THREAD_PLACEMENT_H
+#define THREAD_PLACEMENT_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <cstddef>
+
+namespace Utils {
+
+// A set of logical CPU ids. Empty means "not pinned".
+class CpuSet {
+public:
+    CpuSet() = default;
+
+    void add(int cpu);
+    bool contains(int cpu) const;
+    bool empty() const { return m_cpus.empty(); }
+    int count() const { return static_cast<int>(m_cpus.size()); }
+    const std::vector<int>& cpus() const { return m_cpus; }
+
+    // Compact list form, e.g. "0-3,8"
+    std::string toString() const;
+
+    bool operator==(const CpuSet& other) const { return m_cpus == other.m_cpus; }
+    bool operator!=(const CpuSet& other) const { return m_cpus != other.m_cpus; }
+
+private:
+    std::vector<int> m_cpus;    // Sorted, unique
+};
+
+struct CpuInfo {
+    int cpu;
+    int core;       // Physical core id within the socket
+    int socket;
+    int node;       // NUMA node
+
+    CpuInfo()
+        : cpu(0),
+          core(0),
+          socket(0),
+          node(0) {
+    }
+};
+
+// Online CPUs with their core, socket and NUMA node, read once from sysfs
+class CpuTopology {
+public:
+    static const CpuTopology& instance();
+
+    const std::vector<CpuInfo>& getCpus() const { return m_cpus; }
+    int getSocketCount() const { return m_socketCount; }
+    int getNodeCount() const { return m_nodeCount; }
+    int getPhysicalCoreCount() const { return m_physicalCores; }
+
+    CpuSet getNodeCpus(int node) const;
+    CpuSet getSocketCpus(int socket) const;
+    int getNodeOfCpu(int cpu) const;    // -1 for an unknown CPU
+
+    // Parses "0-3,8", "node:1" or "socket:0" (comma separated terms may be
+    // mixed). CPUs that are not online are rejected.
+    bool parseCpuSet(const std::string& spec, CpuSet& set, std::string& error) const;
+
+    std::string describe() const;
+
+private:
+    CpuTopology();
+
+    std::vector<CpuInfo> m_cpus;
+    int m_socketCount;
+    int m_nodeCount;
+    int m_physicalCores;
+};
+
+// Where each kind of thread runs. Empty sets leave threads to the OS
+// scheduler, which is the default.
+struct PlacementConfig {
+    CpuSet capture;                         // Capture threads without an entry of their own
+    std::map<int, CpuSet> captureByCamera;  // Per camera index
+    CpuSet inference;                       // Frame loop, live detector and OpenCV's pool
+    CpuSet shadow;                          // Candidate detectors under shadow evaluation
+    CpuSet workers;                         // Shared task scheduler workers
+    CpuSet background;                      // Training and shadow threads; replaces training_max_cores
+};
+
+class ThreadPlacement {
+public:
+    static ThreadPlacement& instance();
+
+    // Apply before threads are started; threads bind themselves when they start
+    void configure(const PlacementConfig& config);
+    PlacementConfig getConfig() const;
+
+    CpuSet getCaptureCpus(int cameraIndex) const;
+
+    // Pin the calling thread to cpus. Returns immediately when the thread
+    // is already bound to the same set, so it is cheap on every frame.
+    // An empty set leaves the thread alone. Threads created afterwards by
+    // the calling thread (such as OpenCV's pool) inherit the set.
+    bool bindCurrentThread(const CpuSet& cpus, const std::string& threadName);
+
+    // Topology, configured sets and every bound thread with the CPU it last
+    // ran on, for checking that placement took effect
+    std::string describe() const;
+
+    // Parses the capture placement: either one set for every camera or
+    // "index=set" entries separated by ';', e.g. "0=2;1=node:1"
+    static bool parseCaptureCpus(const std::string& spec, PlacementConfig& config, std::string& error);
+
+private:
+    ThreadPlacement() = default;
+
+    struct BoundThread {
+        std::string name;
+        CpuSet cpus;
+    };
+
+    mutable std::mutex m_mutex;
+    PlacementConfig m_config;
+    std::map<long, BoundThread> m_boundThreads;     // By kernel thread id
+};
+
+// Prefer the NUMA node the calling thread runs on for the whole pages in
+// [data, data + bytes), moving pages already touched elsewhere. A no-op on
+// single-node machines. Call from the thread that will use the buffer.
+bool placeOnLocalNode(void* data, size_t bytes);
+
+} // namespace Utils
+
+#endif // THREAD_PLACEMENT_H
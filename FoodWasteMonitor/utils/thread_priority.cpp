@@ -0,0 +1,86 @@
+/**
+ * Thread Priority Implementation
+ */
+
+#include "thread_priority.h"
+#include "thread_placement.h"
+#include "logger.h"
+#include <algorithm>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace Utils {
+
+#ifdef __linux__
+namespace {
+
+// Nice level this thread was last refused, so an unprivileged thread warns
+// once instead of on every re-apply
+thread_local int t_refusedNiceLevel = -1000;
+
+} // namespace
+#endif
+
+bool applyBackgroundThreadLimits(int niceLevel, int maxCores, const char* threadName) {
+    bool ok = true;
+
+#ifdef __linux__
+    // Niceness is per-thread on Linux when applied to the thread id. Going
+    // back down needs privilege, so leave an unchanged level alone.
+    pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    errno = 0;
+    int currentNice = getpriority(PRIO_PROCESS, tid);
+    bool niceKnown = !(currentNice == -1 && errno != 0);
+    if (!niceKnown || currentNice != niceLevel) {
+        if (setpriority(PRIO_PROCESS, tid, niceLevel) == 0) {
+            t_refusedNiceLevel = -1000;
+        } else {
+            if (t_refusedNiceLevel != niceLevel) {
+                logWarning("scheduler", "Could not set %s thread nice level to %d (currently %d)",
+                           threadName, niceLevel, currentNice);
+                t_refusedNiceLevel = niceLevel;
+            }
+            ok = false;
+        }
+    }
+
+    // An explicit background core set takes precedence over the core count
+    CpuSet background = ThreadPlacement::instance().getConfig().background;
+    if (!background.empty()) {
+        return ThreadPlacement::instance().bindCurrentThread(background, threadName) && ok;
+    }
+
+    // Keep background work on the highest-numbered cores, away from capture
+    // and inference. Without a limit, or once it covers every core, the
+    // thread gets all of them back rather than keeping an earlier narrower set.
+    int numCores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    int firstCore = (maxCores > 0 && maxCores < numCores) ? numCores - maxCores : 0;
+
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (int core = firstCore; core < numCores; core++) {
+        CPU_SET(core, &cpuSet);
+    }
+
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0) {
+        logWarning("scheduler", "Could not restrict %s thread to %d cores", threadName, numCores - firstCore);
+        ok = false;
+    }
+#else
+    (void)niceLevel;
+    (void)maxCores;
+    (void)threadName;
+#endif
+
+    return ok;
+}
+
+} // namespace Utils
@@ -0,0 +1,23 @@
+/**
+ * Thread Priority Header
+ *
+ * Helpers for keeping background work off the cores and CPU time the
+ * capture and detection loop needs
+ */
+
+#ifndef THREAD_PRIORITY_H
+#define THREAD_PRIORITY_H
+
+namespace Utils {
+
+// Set the calling thread's nice level and restrict it to the configured
+// background placement or, without one, to the last maxCores cores
+// (0 = every core). Safe to call again when the limits change: an
+// unchanged nice level is left alone and the core set widens as well as
+// narrows. Failures are logged and otherwise ignored; returns false if
+// any limit could not be applied.
+bool applyBackgroundThreadLimits(int niceLevel, int maxCores, const char* threadName);
+
+} // namespace Utils
+
+#endif // THREAD_PRIORITY_H
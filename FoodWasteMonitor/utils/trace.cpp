@@ -0,0 +1,206 @@
+/**
+ * Trace Implementation
+ */
+
+#include "trace.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include <csignal>
+
+namespace fs = std::filesystem;
+
+namespace Utils {
+
+namespace {
+
+// Spans kept per thread; at a few hundred spans per second this covers the
+// last several seconds, which is the window a stall report is about
+const size_t EVENTS_PER_THREAD = 16384;
+
+// Buffers of exited threads are dropped once this many are registered
+const size_t MAX_THREAD_BUFFERS = 64;
+
+void onDumpSignal(int) {
+    Tracer::requestDump();
+}
+
+void writeJsonString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) >= 0x20) {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+} // namespace
+
+std::atomic<bool> Tracer::s_enabled(false);
+std::atomic<bool> Tracer::s_dumpRequested(false);
+
+Tracer::Tracer()
+    : m_nextThreadId(1) {
+}
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+void Tracer::setEnabled(bool enabled) {
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Tracer::setThreadName(const std::string& name) {
+    // The buffer is only allocated once the thread records a span
+    ThreadState& state = threadState();
+    state.name = name;
+    if (state.buffer) {
+        std::lock_guard<std::mutex> lock(state.buffer->mutex);
+        state.buffer->threadName = name;
+    }
+}
+
+void Tracer::record(const char* name, int64_t startNs, int64_t endNs) {
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+
+    buffer.events[buffer.next] = {name, startNs, endNs - startNs};
+    buffer.next++;
+    if (buffer.next == buffer.events.size()) {
+        buffer.next = 0;
+        buffer.wrapped = true;
+    }
+}
+
+Tracer::ThreadState::~ThreadState() {
+    // Lets the buffer be reclaimed once its thread has exited
+    if (buffer) {
+        buffer->finished = true;
+    }
+}
+
+Tracer::ThreadState& Tracer::threadState() {
+    thread_local ThreadState state;
+    return state;
+}
+
+Tracer::ThreadBuffer& Tracer::threadBuffer() {
+    ThreadState& state = threadState();
+    if (!state.buffer) {
+        state.buffer = registerThread(state.name);
+    }
+    return *state.buffer;
+}
+
+std::shared_ptr<Tracer::ThreadBuffer> Tracer::registerThread(const std::string& name) {
+    auto buffer = std::make_shared<ThreadBuffer>();
+    buffer->events.resize(EVENTS_PER_THREAD);
+    buffer->next = 0;
+    buffer->wrapped = false;
+    buffer->finished = false;
+
+    std::lock_guard<std::mutex> lock(m_buffersMutex);
+
+    if (m_buffers.size() >= MAX_THREAD_BUFFERS) {
+        m_buffers.erase(std::remove_if(m_buffers.begin(), m_buffers.end(),
+                                       [](const std::shared_ptr<ThreadBuffer>& existing) {
+                                           return existing->finished.load();
+                                       }),
+                        m_buffers.end());
+    }
+
+    buffer->threadId = m_nextThreadId++;
+    buffer->threadName = name.empty() ? "thread-" + std::to_string(buffer->threadId) : name;
+    m_buffers.push_back(buffer);
+    return buffer;
+}
+
+bool Tracer::writeChromeTrace(const std::string& path) const {
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(m_buffersMutex);
+        buffers = m_buffers;
+    }
+
+    try {
+        fs::path outputPath(path);
+        if (outputPath.has_parent_path()) {
+            fs::create_directories(outputPath.parent_path());
+        }
+
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open trace file: " << path << std::endl;
+            return false;
+        }
+
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        file.setf(std::ios::fixed);
+        file.precision(3);
+
+        bool first = true;
+        size_t eventCount = 0;
+        for (const auto& buffer : buffers) {
+            // Copy under the buffer's lock so the owning thread is held up only briefly
+            std::vector<TraceEvent> events;
+            std::string threadName;
+            uint32_t threadId;
+            {
+                std::lock_guard<std::mutex> lock(buffer->mutex);
+                if (buffer->wrapped) {
+                    events.assign(buffer->events.begin() + buffer->next, buffer->events.end());
+                }
+                events.insert(events.end(), buffer->events.begin(), buffer->events.begin() + buffer->next);
+                threadName = buffer->threadName;
+                threadId = buffer->threadId;
+            }
+
+            file << (first ? "" : ",\n")
+                 << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << threadId
+                 << ",\"args\":{\"name\":";
+            writeJsonString(file, threadName);
+            file << "}}";
+            first = false;
+
+            for (const auto& event : events) {
+                file << ",\n{\"ph\":\"X\",\"name\":";
+                writeJsonString(file, event.name);
+                file << ",\"pid\":1,\"tid\":" << threadId
+                     << ",\"ts\":" << event.startNs / 1000.0
+                     << ",\"dur\":" << event.durationNs / 1000.0 << "}";
+            }
+            eventCount += events.size();
+        }
+
+        file << "\n]}\n";
+
+        std::cout << "Wrote " << eventCount << " trace events to " << path << std::endl;
+        return true;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Error writing trace: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void Tracer::requestDump() {
+    s_dumpRequested.store(true, std::memory_order_relaxed);
+}
+
+bool Tracer::consumeDumpRequest() {
+    return s_dumpRequested.exchange(false, std::memory_order_relaxed);
+}
+
+void Tracer::installSignalHandler() {
+#ifdef SIGUSR1
+    std::signal(SIGUSR1, onDumpSignal);
+#endif
+}
+
+} // namespace Utils
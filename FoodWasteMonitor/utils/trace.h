@@ -0,0 +1,125 @@
+/**
+ * Trace Header
+ *
+ * Scoped trace spans recorded into per-thread ring buffers and written out
+ * on demand as Chrome trace-event JSON, for viewing single frames in
+ * Perfetto or chrome://tracing
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace Utils {
+
+// One completed span. Names must be string literals or otherwise outlive
+// the tracer; they are stored as pointers.
+struct TraceEvent {
+    const char* name;
+    int64_t startNs;
+    int64_t durationNs;
+};
+
+class Tracer {
+public:
+    static Tracer& instance();
+
+    // A single relaxed load, so spans cost next to nothing while disabled
+    static bool isEnabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    void setEnabled(bool enabled);
+
+    // Name shown for the calling thread in the trace
+    void setThreadName(const std::string& name);
+
+    // Nanoseconds on the tracer's monotonic clock
+    static int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void record(const char* name, int64_t startNs, int64_t endNs);
+
+    // Write the spans currently held in every thread's buffer
+    bool writeChromeTrace(const std::string& path) const;
+
+    // Ask the application to dump a trace. Safe to call from a signal handler.
+    static void requestDump();
+    bool consumeDumpRequest();
+
+    // Route SIGUSR1 to requestDump()
+    void installSignalHandler();
+
+private:
+    Tracer();
+
+    struct ThreadBuffer {
+        std::mutex mutex;           // Only contended while a dump copies the buffer
+        std::vector<TraceEvent> events;
+        size_t next;
+        bool wrapped;
+        uint32_t threadId;
+        std::string threadName;
+        std::atomic<bool> finished;
+    };
+
+    // Per-thread name and buffer, the buffer created on the first span
+    struct ThreadState {
+        std::string name;
+        std::shared_ptr<ThreadBuffer> buffer;
+        ~ThreadState();
+    };
+
+    static ThreadState& threadState();
+    ThreadBuffer& threadBuffer();
+    std::shared_ptr<ThreadBuffer> registerThread(const std::string& name);
+
+    static std::atomic<bool> s_enabled;
+    static std::atomic<bool> s_dumpRequested;
+
+    mutable std::mutex m_buffersMutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> m_buffers;
+    uint32_t m_nextThreadId;
+};
+
+// Records the lifetime of the scope as a span on the calling thread
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name)
+        : m_name(Tracer::isEnabled() ? name : nullptr),
+          m_startNs(m_name ? Tracer::nowNs() : 0) {
+    }
+
+    ~TraceSpan() {
+        if (m_name) {
+            Tracer::instance().record(m_name, m_startNs, Tracer::nowNs());
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* m_name;
+    int64_t m_startNs;
+};
+
+// Lock a mutex, recording the time spent waiting for it as a span
+template<typename Mutex>
+std::unique_lock<Mutex> traceLock(Mutex& mutex, const char* name) {
+    TraceSpan span(name);
+    return std::unique_lock<Mutex>(mutex);
+}
+
+} // namespace Utils
+
+#endif // TRACE_H
@@ -10,15 +10,305 @@
 #include <string>
 #include <memory>
 #include <chrono>
+#include <thread>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <unistd.h>
 #include <opencv2/opencv.hpp>
 
 #include "camera/camera_manager.h"
 #include "detection/food_detector.h"
 #include "data/waste_database.h"
+#include "data/query_service.h"
+#include "sync/entry_shipper.h"
+#include "sync/sync_protocol.h"
 #include "analysis/stats_analyzer.h"
 #include "training/model_trainer.h"
+#include "training/training_job_manager.h"
+#include "training/training_scheduler.h"
+#include "training/shadow_evaluator.h"
+#include "training/model_registry.h"
 #include "ui/user_interface.h"
 #include "utils/config_loader.h"
+#include "utils/config_store.h"
+#include "utils/metrics.h"
+#include "utils/trace.h"
+#include "utils/task_scheduler.h"
+#include "utils/logger.h"
+#include "utils/thread_placement.h"
+#include "utils/append_log.h"
+#include "ipc/shared_frame_ring.h"
+#include "ipc/process_supervisor.h"
+
+namespace {
+
+// How often the metrics file is rewritten while running
+const std::chrono::seconds METRICS_DUMP_INTERVAL(60);
+
+// Multi-process mode timing
+const int FRAME_WAIT_MS = 100;                              // Worker wait for a queued frame
+const int RESULT_WAIT_MS = 10;                              // UI wait for a completed frame
+const std::chrono::seconds MODEL_CHECK_INTERVAL(5);         // Workers follow registry promotions
+const std::chrono::milliseconds SLOT_RECLAIM_INTERVAL(500);
+const std::chrono::seconds RING_REPORT_INTERVAL(60);
+
+bool hasArgument(int argc, char* argv[], const std::string& name) {
+    return std::find(argv + 1, argv + argc, name) != argv + argc;
+}
+
+std::string getArgumentValue(int argc, char* argv[], const std::string& name, const std::string& defaultValue) {
+    char** it = std::find(argv + 1, argv + argc, name);
+    return (it != argv + argc && it + 1 != argv + argc) ? *(it + 1) : defaultValue;
+}
+
+int64_t systemNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Same format the detector stamps detections with
+std::string formatTimestamp(int64_t systemNs) {
+    time_t seconds = static_cast<time_t>(systemNs / 1000000000LL);
+    std::stringstream ss;
+    ss << std::put_time(std::localtime(&seconds), "%Y-%m-%d %H:%M:%S");
+    return ss.str();
+}
+
+// Invalid entries are reported and left unpinned
+Utils::PlacementConfig loadPlacementConfig(const Utils::ConfigLoader& config) {
+    const auto& topology = Utils::CpuTopology::instance();
+    Utils::PlacementConfig placement;
+    std::string error;
+
+    if (!Utils::ThreadPlacement::parseCaptureCpus(config.getPlacementCaptureCpus(), placement, error)) {
+        std::cerr << "Ignoring placement_capture_cpus: " << error << std::endl;
+        placement.capture = Utils::CpuSet();
+        placement.captureByCamera.clear();
+    }
+
+    auto parse = [&](const char* key, const std::string& spec, Utils::CpuSet& cpus) {
+        if (!topology.parseCpuSet(spec, cpus, error)) {
+            std::cerr << "Ignoring " << key << ": " << error << std::endl;
+            cpus = Utils::CpuSet();
+        }
+    };
+    parse("placement_inference_cpus", config.getPlacementInferenceCpus(), placement.inference);
+    parse("placement_shadow_cpus", config.getPlacementShadowCpus(), placement.shadow);
+    parse("placement_worker_cpus", config.getPlacementWorkerCpus(), placement.workers);
+    parse("placement_background_cpus", config.getPlacementBackgroundCpus(), placement.background);
+    return placement;
+}
+
+Utils::LoggerConfig loggerConfigFrom(const Utils::ConfigSnapshot& settings) {
+    Utils::LoggerConfig loggerConfig;
+    loggerConfig.minLevel = settings.logLevel;
+    loggerConfig.jsonOutput = settings.logJson;
+    loggerConfig.filePath = settings.logFile;
+    return loggerConfig;
+}
+
+Training::JobLimits jobLimitsFrom(const Utils::ConfigSnapshot& settings) {
+    Training::JobLimits limits;
+    limits.niceLevel = settings.trainingNiceLevel;
+    limits.maxCores = settings.trainingMaxCores;
+    limits.maxDetectionLatencyMs = settings.maxDetectionLatencyMs;
+    return limits;
+}
+
+Training::SchedulerConfig schedulerConfigFrom(const Utils::ConfigSnapshot& settings) {
+    Training::SchedulerConfig scheduleConfig;
+    scheduleConfig.trainingIntervalHours = settings.trainingIntervalHours;
+    scheduleConfig.quietMarginMinutes = settings.trainingQuietMarginMinutes;
+    scheduleConfig.maxStartLoad = settings.trainingMaxLoadPerMinute;
+    scheduleConfig.pauseLoad = settings.trainingPauseLoadPerMinute;
+    return scheduleConfig;
+}
+
+// Owns the camera and the frame ring and supervises the inference workers
+// and the UI process, so either can crash and restart without the camera
+int runCaptureProcess(const Utils::ConfigLoader& config, Utils::ConfigStore& configStore) {
+    IPC::installStopHandler();
+
+    auto cameraManager = std::make_shared<Camera::CameraManager>(config.getCameraIndex());
+    cameraManager->setFrameRate(configStore.current()->cameraFrameRate);
+    configStore.subscribe([cameraManager](const Utils::ConfigSnapshot& previous, const Utils::ConfigSnapshot& current) {
+        if (current.cameraFrameRate != previous.cameraFrameRate) {
+            cameraManager->setFrameRate(current.cameraFrameRate);
+        }
+    });
+    cv::Size resolution = cameraManager->getResolution();
+
+    IPC::SharedFrameRing ring;
+    if (!ring.create(config.getIpcRingName(), config.getIpcRingSlots(),
+                     static_cast<size_t>(resolution.area()) * 3)) {
+        return 1;
+    }
+
+    // Reclaiming must run on the thread that writes frames
+    auto lastReclaim = std::chrono::steady_clock::now();
+    cameraManager->setFrameSink([&ring, &lastReclaim](const cv::Mat& frame) {
+        ring.writeFrame(frame, systemNanoseconds());
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastReclaim >= SLOT_RECLAIM_INTERVAL) {
+            ring.reclaimAbandonedSlots();
+            lastReclaim = now;
+        }
+    });
+    if (!cameraManager->start()) {
+        return 1;
+    }
+
+    IPC::ProcessSupervisor supervisor;
+    for (int i = 0; i < std::max(1, config.getIpcInferenceWorkers()); i++) {
+        supervisor.addChild("inference-" + std::to_string(i), {"--role", "inference"});
+    }
+    supervisor.addChild("aggregator", {"--role", "aggregator"}, true);
+    supervisor.start();
+
+    auto lastReport = std::chrono::steady_clock::now();
+    while (!IPC::stopRequested() && supervisor.poll()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        configStore.applyPending();
+
+        if (std::chrono::steady_clock::now() - lastReport >= RING_REPORT_INTERVAL) {
+            IPC::RingStats stats = ring.getStats();
+            Utils::logInfo("ipc", "Frames written %llu, dropped %llu, results dropped %llu, slots reclaimed %llu",
+                           static_cast<unsigned long long>(stats.framesWritten),
+                           static_cast<unsigned long long>(stats.framesDropped),
+                           static_cast<unsigned long long>(stats.resultsDropped),
+                           static_cast<unsigned long long>(stats.slotsReclaimed));
+            lastReport = std::chrono::steady_clock::now();
+        }
+    }
+
+    supervisor.stop();
+    cameraManager->stop();
+    return 0;
+}
+
+// Runs detection on frames from the ring; any number of these can run
+int runInferenceWorker(const Utils::ConfigLoader& config, Utils::ConfigStore& configStore,
+                       const Utils::PlacementConfig& placementConfig) {
+    IPC::installStopHandler();
+    IPC::exitWithParent();
+
+    IPC::SharedFrameRing ring;
+    while (!ring.attach(config.getIpcRingName())) {
+        if (IPC::stopRequested()) {
+            return 0;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    Training::ModelRegistry modelRegistry(config.getModelRegistryPath());
+    std::string liveVersionId = modelRegistry.getCurrentVersion();
+    Training::ModelVersion liveVersion;
+    std::string modelPath = modelRegistry.getVersion(liveVersionId, liveVersion) ?
+        liveVersion.modelPath : config.getModelPath();
+
+    Detection::FoodDetector detector(modelPath, config.getClassesPath(), configStore.current()->confidenceThreshold);
+    detector.setCpuSet(placementConfig.inference);
+    configStore.subscribe([&detector](const Utils::ConfigSnapshot&, const Utils::ConfigSnapshot& current) {
+        detector.setConfidenceThreshold(current.confidenceThreshold);
+    });
+
+    auto lastModelCheck = std::chrono::steady_clock::now();
+    while (!IPC::stopRequested()) {
+        configStore.applyPending();
+
+        // Candidates are promoted by the UI process; pick up what it promotes
+        if (std::chrono::steady_clock::now() - lastModelCheck >= MODEL_CHECK_INTERVAL) {
+            lastModelCheck = std::chrono::steady_clock::now();
+            std::string currentVersionId = modelRegistry.getCurrentVersion();
+            Training::ModelVersion currentVersion;
+            if (currentVersionId != liveVersionId &&
+                modelRegistry.getVersion(currentVersionId, currentVersion) &&
+                detector.loadModel(currentVersion.modelPath)) {
+                liveVersionId = currentVersionId;
+                Utils::logInfo("ipc", "Inference worker switched to model version %s", liveVersionId.c_str());
+            }
+        }
+
+        IPC::FrameSlot slot;
+        if (!ring.takeFrame(slot, FRAME_WAIT_MS)) {
+            continue;
+        }
+
+        auto detectStart = std::chrono::steady_clock::now();
+        Detection::DetectionResult detections;
+        try {
+            detections = detector.detectFoodWaste(slot.frame);
+        }
+        catch (const std::exception& e) {
+            Utils::logError("ipc", "Detection failed on frame %llu: %s",
+                            static_cast<unsigned long long>(slot.frameId), e.what());
+        }
+        ring.completeFrame(slot, detections, std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - detectStart).count());
+    }
+    return 0;
+}
+
+// Ships every entry the database takes to the campus collector through a
+// local write-ahead log, so entries recorded while the collector or the
+// network is down are sent once it is back. Returns null when sync is off.
+std::shared_ptr<Sync::EntryShipper> startEntryShipper(const Utils::ConfigLoader& config,
+                                                      const std::shared_ptr<Data::WasteDatabase>& database) {
+    std::string address = config.getSyncCollectorAddress();
+    if (address.empty()) {
+        return nullptr;
+    }
+
+    Sync::ShipperConfig shipperConfig;
+    size_t colon = address.rfind(':');
+    try {
+        shipperConfig.collectorHost = address.substr(0, colon);
+        if (colon != std::string::npos) {
+            shipperConfig.collectorPort = std::stoi(address.substr(colon + 1));
+        }
+    }
+    catch (const std::exception&) {
+        Utils::logError("sync", "Invalid sync_collector_address: %s", address.c_str());
+        return nullptr;
+    }
+
+    shipperConfig.siteId = config.getSyncSiteId();
+    if (shipperConfig.siteId.empty()) {
+        char hostname[256] = {};
+        gethostname(hostname, sizeof(hostname) - 1);
+        shipperConfig.siteId = hostname;
+    }
+    shipperConfig.batchEntries = config.getSyncBatchEntries();
+    shipperConfig.batchDelayMs = config.getSyncBatchDelayMs();
+
+    auto log = std::make_shared<Utils::AppendLog>();
+    if (!log->open(config.getSyncWalPath())) {
+        return nullptr;
+    }
+
+    // A log that has never held anything starts with the history recorded
+    // before sync was turned on
+    if (log->endOffset() == 0) {
+        for (const auto& entry : database->getEntries()) {
+            log->append(Sync::encodeEntry(entry));
+        }
+        log->sync();
+    }
+
+    auto shipper = std::make_shared<Sync::EntryShipper>(log, shipperConfig);
+    database->registerEntryCallback([log, shipper](const Data::WasteEntry& entry) {
+        if (log->append(Sync::encodeEntry(entry))) {
+            shipper->notify();
+        }
+    });
+    shipper->start();
+    return shipper;
+}
+
+} // namespace
 
 int main(int argc, char* argv[]) {
     std::cout << "Starting Food Waste Monitoring System..." << std::endl;
@@ -27,14 +317,107 @@ int main(int argc, char* argv[]) {
         // Load configuration
         Utils::ConfigLoader config("config.json");
 
+        // Thresholds, frame rate, logging and training budgets are re-applied
+        // when config.json changes; every process watches it on its own
+        Utils::ConfigStore configStore;
+        if (!configStore.initialize(config)) {
+            Utils::Logger::instance().flush();
+            return 1;
+        }
+        auto settings = configStore.current();
+
+        // Components log through a background writer instead of blocking on the console
+        Utils::Logger::instance().configure(loggerConfigFrom(*settings));
+        configStore.subscribe([](const Utils::ConfigSnapshot& previous, const Utils::ConfigSnapshot& current) {
+            if (current.logLevel != previous.logLevel || current.logJson != previous.logJson ||
+                current.logFile != previous.logFile) {
+                Utils::Logger::instance().configure(loggerConfigFrom(current));
+            }
+        });
+
+        // Threads pin themselves to their configured cores as they start
+        auto& placement = Utils::ThreadPlacement::instance();
+        Utils::PlacementConfig placementConfig = loadPlacementConfig(config);
+        placement.configure(placementConfig);
+        if (hasArgument(argc, argv, "--topology")) {
+            std::cout << placement.describe();
+            return 0;
+        }
+
+        // "single" runs everything in this process. "capture" splits the
+        // pipeline: it starts "inference" workers and the "aggregator" (the
+        // database, training and UI) as separate processes.
+        std::string role = getArgumentValue(argc, argv, "--role", "single");
+        if (role == "capture" || role == "inference") {
+            configStore.startWatching();
+            int status = role == "capture" ? runCaptureProcess(config, configStore) :
+                                             runInferenceWorker(config, configStore, placementConfig);
+            Utils::Logger::instance().flush();
+            return status;
+        }
+        if (role != "single" && role != "aggregator") {
+            std::cerr << "Unknown role: " << role << std::endl;
+            return 1;
+        }
+
+        // Frames and detections come from the workers through the ring
+        std::unique_ptr<IPC::SharedFrameRing> frameRing;
+        if (role == "aggregator") {
+            IPC::installStopHandler();
+            IPC::exitWithParent();
+
+            frameRing = std::make_unique<IPC::SharedFrameRing>();
+            while (!frameRing->attach(config.getIpcRingName())) {
+                if (IPC::stopRequested()) {
+                    return 0;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            }
+        }
+
+        // One worker pool for every subsystem, with a core budget per priority class
+        Utils::SchedulerConfig schedulerConfig;
+        schedulerConfig.realtimeCores = config.getSchedulerRealtimeCores();
+        schedulerConfig.ingestCores = config.getSchedulerIngestCores();
+        schedulerConfig.analyticsCores = config.getSchedulerAnalyticsCores();
+        schedulerConfig.backgroundCores = config.getTrainingMaxCores();
+        schedulerConfig.backgroundNiceLevel = config.getTrainingNiceLevel();
+        Utils::TaskScheduler::instance().configure(schedulerConfig);
+
+        // The frame loop runs inference and the UI; pin it after the workers
+        // exist so they don't inherit its set, but before OpenCV starts its pool
+        placement.bindCurrentThread(placementConfig.inference, "main");
+
         // Initialize components
         auto cameraManager = std::make_shared<Camera::CameraManager>(config.getCameraIndex());
         auto database = std::make_shared<Data::WasteDatabase>(config.getDatabasePath());
+
+        // The live model is whichever registry version CURRENT points at. On
+        // first start the configured model is imported as the initial version.
+        auto modelRegistry = std::make_shared<Training::ModelRegistry>(config.getModelRegistryPath());
+        if (hasArgument(argc, argv, "--rollback")) {
+            modelRegistry->rollback();
+        }
+        if (modelRegistry->getCurrentVersion().empty()) {
+            Training::ModelVersion imported;
+            imported.source = "imported";
+            modelRegistry->promote(modelRegistry->registerModel(config.getModelPath(), imported));
+        }
+
+        std::string modelPath = config.getModelPath();
+        Training::ModelVersion liveVersion;
+        if (modelRegistry->getVersion(modelRegistry->getCurrentVersion(), liveVersion)) {
+            modelPath = liveVersion.modelPath;
+            std::cout << "Loading model version " << liveVersion.id << std::endl;
+        }
+
         auto detector = std::make_shared<Detection::FoodDetector>(
-            config.getModelPath(),
+            modelPath,
             config.getClassesPath(),
-            config.getConfidenceThreshold()
+            settings->confidenceThreshold
         );
+        detector->setMetricsEnabled(true);
+        detector->setCpuSet(placementConfig.inference);
         auto analyzer = std::make_shared<Analysis::StatsAnalyzer>(database);
         auto trainer = std::make_shared<Training::ModelTrainer>(
             database,
@@ -42,63 +425,208 @@ int main(int argc, char* argv[]) {
             config.getTrainingDataPath(),
             config.getLearningRate()
         );
+        trainer->setSampleBudget(config.getTrainingSampleBudget());
+
+        // Newly trained models run in shadow on sampled frames before going live
+        Training::ShadowConfig shadowConfig;
+        shadowConfig.sampleRate = config.getShadowSampleRate();
+        shadowConfig.minFrames = config.getShadowMinFrames();
+        shadowConfig.minCandidateDetections = config.getShadowMinDetections();
+        shadowConfig.maxDisagreementRate = config.getShadowMaxDisagreement();
+        shadowConfig.maxLatencyRatio = config.getShadowMaxLatencyRatio();
+        shadowConfig.minConfidenceRatio = config.getShadowMinConfidenceRatio();
+        shadowConfig.scoreThreshold = settings->confidenceThreshold;
+        shadowConfig.cpus = placementConfig.shadow;
+        auto shadowEvaluator = std::make_shared<Training::ShadowEvaluator>(detector, shadowConfig);
+        shadowEvaluator->setPromotionHandler([detector, modelRegistry](const std::string& candidatePath) {
+            // Load first so CURRENT never points at a model that failed to load
+            return detector->loadModel(candidatePath) &&
+                   modelRegistry->promote(modelRegistry->findVersionByPath(candidatePath));
+        });
+        trainer->setModelRegistry(modelRegistry);
+        trainer->setCandidateHandler([shadowEvaluator](const std::string& modelPath) {
+            shadowEvaluator->submitCandidate(modelPath);
+        });
+
+        // Training runs in the background so it never blocks the frame loop
+        auto trainingJobs = std::make_shared<Training::TrainingJobManager>(trainer, jobLimitsFrom(*settings));
+
+        // Periodic training waits for quiet periods outside of meal times
+        auto trainingScheduler = std::make_shared<Training::TrainingScheduler>(
+            database, trainingJobs, schedulerConfigFrom(*settings));
+
         auto ui = std::make_shared<UI::UserInterface>(
             cameraManager,
             detector,
             analyzer,
             trainer,
+            trainingJobs,
+            trainingScheduler,
             config
         );
 
+        // Per-stage latency, served to Prometheus and dumped to a file
+        auto& metrics = Utils::MetricsRegistry::instance();
+        auto& frameTime = metrics.histogram("frame_seconds", "Processing one camera frame end to end");
+        auto& renderTime = metrics.histogram("render_seconds", "Drawing and displaying a frame");
+
+        std::unique_ptr<Utils::MetricsServer> metricsServer;
+        if (config.getMetricsPort() > 0) {
+            metricsServer = std::make_unique<Utils::MetricsServer>(metrics, config.getMetricsPort());
+            metricsServer->start();
+        }
+
+        // Dashboards and reports query the running monitor instead of reading
+        // the CSV while it is being rewritten. Started before any detections
+        // so its snapshot misses none.
+        std::unique_ptr<Data::QueryService> queryService;
+        if (!config.getQuerySocketPath().empty()) {
+            Data::QueryServiceConfig queryConfig;
+            queryConfig.socketPath = config.getQuerySocketPath();
+            queryService = std::make_unique<Data::QueryService>(database, queryConfig);
+            queryService->start();
+        }
+
+        auto entryShipper = startEntryShipper(config, database);
+        std::string metricsDumpPath = config.getMetricsDumpPath();
+        auto lastMetricsDump = std::chrono::steady_clock::now();
+
+        // Timeline tracing. A dump request (SIGUSR1 or 't') starts tracing
+        // when it is off and writes the recorded spans when it is on.
+        auto& tracer = Utils::Tracer::instance();
+        tracer.setThreadName("main");
+        tracer.setEnabled(settings->traceEnabled);
+        tracer.installSignalHandler();
+        std::string traceOutputDir = config.getTraceOutputDir();
+
+        // Applied from the frame loop, between frames
+        cameraManager->setFrameRate(settings->cameraFrameRate);
+        configStore.subscribe([=, &tracer](const Utils::ConfigSnapshot& previous, const Utils::ConfigSnapshot& current) {
+            detector->setConfidenceThreshold(current.confidenceThreshold);
+            shadowEvaluator->setScoreThreshold(current.confidenceThreshold);
+            if (current.cameraFrameRate != previous.cameraFrameRate) {
+                cameraManager->setFrameRate(current.cameraFrameRate);
+            }
+            if (current.traceEnabled != previous.traceEnabled) {
+                tracer.setEnabled(current.traceEnabled);
+            }
+            trainingJobs->setLimits(jobLimitsFrom(current));
+            trainingScheduler->setConfig(schedulerConfigFrom(current));
+            if (current.trainingMaxCores != previous.trainingMaxCores ||
+                current.trainingNiceLevel != previous.trainingNiceLevel) {
+                // The other budgets keep their startup values
+                Utils::SchedulerConfig backgroundConfig = schedulerConfig;
+                backgroundConfig.backgroundCores = current.trainingMaxCores;
+                backgroundConfig.backgroundNiceLevel = current.trainingNiceLevel;
+                Utils::TaskScheduler::instance().configure(backgroundConfig);
+            }
+        });
+        configStore.startWatching();
+
         // Main processing loop
         ui->start();
+        bool placementReported = false;
+
+        while (ui->isRunning() && !IPC::stopRequested()) {
+            configStore.applyPending();
 
-        // Scheduled periodic training
-        auto lastTrainingTime = std::chrono::steady_clock::now();
+            IPC::FrameSlot slot;
+            Detection::DetectionResult detectionResults;
+            bool haveFrame = frameRing ? frameRing->takeResult(slot, detectionResults, RESULT_WAIT_MS)
+                                       : cameraManager->hasNewFrame();
 
-        while (ui->isRunning()) {
             // Process current frame
-            if (cameraManager->hasNewFrame()) {
-                cv::Mat frame = cameraManager->getLatestFrame();
+            if (haveFrame) {
+                Utils::ScopedTimer frameTimer(frameTime);
+                Utils::TraceSpan frameTrace("frame");
+                cv::Mat frame;
 
-                // Detect food waste in the frame
-                auto detectionResults = detector->detectFoodWaste(frame);
+                if (frameRing) {
+                    // Detected by a worker; the frame is a view of the shared slot
+                    frame = slot.frame;
+                    std::string timestamp = formatTimestamp(slot.captureTimeNs);
+                    for (auto& item : detectionResults) {
+                        item.timestamp = timestamp;
+                    }
+                    trainingJobs->reportDetectionLatency(slot.inferenceMs);
+                } else {
+                    frame = cameraManager->getLatestFrame();
+
+                    // Detect food waste in the frame
+                    auto detectStart = std::chrono::steady_clock::now();
+                    detectionResults = detector->detectFoodWaste(frame);
+                    trainingJobs->reportDetectionLatency(std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - detectStart).count());
+                }
+                trainingScheduler->recordDetections(static_cast<int>(detectionResults.size()));
+                shadowEvaluator->offerFrame(frame);
 
                 // Update database with new detections
                 if (!detectionResults.empty()) {
                     database->addDetections(detectionResults);
-                    analyzer->updateStats();
+
+                    // Recomputed on an analytics worker, off the frame loop
+                    analyzer->requestUpdate();
                 }
 
                 // Display processed frame with detections
+                Utils::ScopedTimer renderTimer(renderTime);
                 ui->updateFrame(frame, detectionResults);
+                if (frameRing) {
+                    frameRing->releaseSlot(slot);
+                }
+
+                // By the first frame capture, inference and workers have all bound themselves
+                if (!placementReported) {
+                    std::cout << placement.describe();
+                    placementReported = true;
+                }
+            }
+
+            if (tracer.consumeDumpRequest()) {
+                if (!Utils::Tracer::isEnabled()) {
+                    tracer.setEnabled(true);
+                    std::cout << "Tracing started; request another dump to save it" << std::endl;
+                } else {
+                    tracer.writeChromeTrace(traceOutputDir + "/trace_" + std::to_string(time(nullptr)) + ".json");
+                }
             }
 
-            // Check if it's time for periodic training
-            auto currentTime = std::chrono::steady_clock::now();
-            auto elapsedHours = std::chrono::duration_cast<std::chrono::hours>(
-                currentTime - lastTrainingTime
-            ).count();
-
-            if (elapsedHours >= config.getTrainingIntervalHours()) {
-                std::cout << "Starting periodic model training..." << std::endl;
-                trainer->trainModel();
-                lastTrainingTime = currentTime;
-                std::cout << "Model training completed." << std::endl;
+            if (!metricsDumpPath.empty() &&
+                std::chrono::steady_clock::now() - lastMetricsDump >= METRICS_DUMP_INTERVAL) {
+                metrics.dumpToFile(metricsDumpPath);
+                lastMetricsDump = std::chrono::steady_clock::now();
             }
 
+            // Start periodic training once it is due and the hall is quiet
+            trainingScheduler->tick();
+
             // Handle user input
             ui->processEvents();
         }
 
+        // Stop any running training job before tearing down
+        trainingJobs->cancelJob();
+
+        if (queryService) {
+            queryService->stop();
+        }
+        if (entryShipper) {
+            entryShipper->stop();
+        }
+
         // Save final data before exit
         database->saveToFile();
-        detector->saveModel(config.getModelPath());
+        if (!metricsDumpPath.empty()) {
+            metrics.dumpToFile(metricsDumpPath);
+        }
+        Utils::Logger::instance().flush();
 
         std::cout << "Food Waste Monitoring System shut down successfully." << std::endl;
         return 0;
     }
     catch (const std::exception& e) {
+        Utils::Logger::instance().flush();
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
     }